@@ -450,6 +450,34 @@ if(MSVC)
   endif()
 endif()
 
+# Instruction sets the dispatched files (see ocv_add_dispatched_file) are compiled for in addition
+# to the baseline ones. The best variant is chosen at run time, so the binaries stay portable.
+if((X86 OR X86_64) AND (CMAKE_COMPILER_IS_GNUCXX OR CMAKE_COMPILER_IS_CLANGCXX) AND NOT MINGW)
+  set(CPU_DISPATCH "SSE4_1;AVX;AVX2" CACHE STRING "Instruction sets to build the dispatched code for (SSE4_1, AVX, AVX2)")
+  set(CPU_DISPATCH_FLAGS_SSE4_1 "-mssse3 -msse4.1")
+  set(CPU_DISPATCH_FLAGS_AVX "-mavx")
+  set(CPU_DISPATCH_FLAGS_AVX2 "-mavx2 -mfma")
+elseif(MSVC AND (X86 OR X86_64) AND NOT MSVC_VERSION LESS 1800)
+  set(CPU_DISPATCH "AVX;AVX2" CACHE STRING "Instruction sets to build the dispatched code for (AVX, AVX2)")
+  set(CPU_DISPATCH_FLAGS_AVX "/arch:AVX")
+  set(CPU_DISPATCH_FLAGS_AVX2 "/arch:AVX2")
+else()
+  set(CPU_DISPATCH "" CACHE STRING "Instruction sets to build the dispatched code for")
+endif()
+
+set(CPU_DISPATCH_FINAL "")
+foreach(mode ${CPU_DISPATCH})
+  if((mode STREQUAL "SSE4_1" AND (ENABLE_SSE41 OR ENABLE_AVX OR ENABLE_AVX2)) OR
+     (mode STREQUAL "AVX" AND (ENABLE_AVX OR ENABLE_AVX2)) OR
+     (mode STREQUAL "AVX2" AND ENABLE_AVX2))
+    # already enabled for the whole library
+  elseif(DEFINED CPU_DISPATCH_FLAGS_${mode})
+    list(APPEND CPU_DISPATCH_FINAL ${mode})
+  else()
+    message(WARNING "CPU_DISPATCH: the instruction set ${mode} is not supported by the compiler, skipping")
+  endif()
+endforeach()
+
 if(APPLE AND NOT CMAKE_CROSSCOMPILING AND NOT DEFINED ENV{LDFLAGS} AND EXISTS "/usr/local/lib")
   link_directories("/usr/local/lib")
 endif()
@@ -645,6 +645,54 @@ macro(ocv_set_module_sources)
   set(OPENCV_MODULE_${the_module}_SOURCES ${OPENCV_MODULE_${the_module}_SOURCES} CACHE INTERNAL "List of source files for ${the_module}")
 endmacro()
 
+# compiles src/<filename>.simd.hpp once more for each of the listed instruction sets that is in
+# CPU_DISPATCH_FINAL, and generates <filename>.simd_declarations.hpp with the declarations of the
+# compiled variants and the CV_CPU_DISPATCH_<mode> macros (see opencv2/core/cv_cpu_dispatch.h)
+# Must be called before ocv_glob_module_sources() / ocv_define_module().
+# Usage:
+# ocv_add_dispatched_file(<filename> <list of instruction sets>)
+macro(ocv_add_dispatched_file filename)
+  set(__simd_file "${CMAKE_CURRENT_LIST_DIR}/src/${filename}.simd.hpp")
+  set(__modes ${ARGN})
+  set(__declarations_str "// generated by ocv_add_dispatched_file(), do not edit\n\n#define CV_CPU_SIMD_FILENAME \"${__simd_file}\"\n")
+  foreach(__mode SSE4_1 AVX AVX2)
+    list(FIND CPU_DISPATCH_FINAL ${__mode} __mode_built)
+    list(FIND __modes ${__mode} __mode_requested)
+    if(__mode_built EQUAL -1 OR __mode_requested EQUAL -1)
+      set(__declarations_str "${__declarations_str}\n#define CV_CPU_DISPATCH_${__mode}(fn, args)\n")
+    else()
+      string(TOLOWER "${__mode}" __mode_lower)
+      set(__file "${CMAKE_CURRENT_BINARY_DIR}/${filename}.${__mode_lower}.cpp")
+      set(__codestr "// generated by ocv_add_dispatched_file(), do not edit\n\n#include \"${__simd_file}\"\n")
+      if(EXISTS "${__file}")
+        file(READ "${__file}" __content)
+      else()
+        set(__content "")
+      endif()
+      if(NOT "${__content}" STREQUAL "${__codestr}")
+        file(WRITE "${__file}" "${__codestr}")
+      endif()
+      set_source_files_properties("${__file}" PROPERTIES
+          COMPILE_FLAGS "${CPU_DISPATCH_FLAGS_${__mode}}"
+          COMPILE_DEFINITIONS "CV_CPU_DISPATCH_MODE=${__mode}")
+      # the dispatched objects go after the regular ones, so that the linker keeps the baseline copies
+      # of the inline functions they share
+      list(APPEND OPENCV_MODULE_DISPATCHED_SOURCES "${__file}")
+      set(__declarations_str "${__declarations_str}\n#define CV_CPU_DISPATCH_MODE ${__mode}\n#include \"opencv2/core/cv_cpu_include_simd_declarations.h\"\n#define CV_CPU_DISPATCH_${__mode}(fn, args) if( CV_CPU_HAS_SUPPORT_${__mode} ) return opt_${__mode}::fn args;\n")
+    endif()
+  endforeach()
+  set(__declarations_str "${__declarations_str}\n#undef CV_CPU_SIMD_FILENAME\n")
+  set(__file "${CMAKE_CURRENT_BINARY_DIR}/${filename}.simd_declarations.hpp")
+  if(EXISTS "${__file}")
+    file(READ "${__file}" __content)
+  else()
+    set(__content "")
+  endif()
+  if(NOT "${__content}" STREQUAL "${__declarations_str}")
+    file(WRITE "${__file}" "${__declarations_str}")
+  endif()
+endmacro()
+
 # finds and sets headers and sources for the standard OpenCV module
 # Usage:
 # ocv_glob_module_sources([EXCLUDE_CUDA] <extra sources&headers in the same format as used in ocv_set_module_sources>)
@@ -710,8 +758,14 @@ macro(ocv_glob_module_sources)
     list(APPEND lib_srcs ${cl_kernels} "${CMAKE_CURRENT_BINARY_DIR}/${OCL_NAME}.cpp" "${CMAKE_CURRENT_BINARY_DIR}/${OCL_NAME}.hpp")
   endif()
 
+  if(OPENCV_MODULE_DISPATCHED_SOURCES)
+    ocv_source_group("Src\\dispatched\\autogenerated" FILES ${OPENCV_MODULE_DISPATCHED_SOURCES})
+  endif()
+
   ocv_set_module_sources(${_argn} HEADERS ${lib_hdrs} ${lib_hdrs_detail}
-                         SOURCES ${lib_srcs} ${lib_int_hdrs} ${lib_cuda_srcs} ${lib_cuda_hdrs})
+                         SOURCES ${lib_srcs} ${lib_int_hdrs} ${lib_cuda_srcs} ${lib_cuda_hdrs}
+                                 ${OPENCV_MODULE_DISPATCHED_SOURCES})
+  set(OPENCV_MODULE_DISPATCHED_SOURCES "")
 endmacro()
 
 # creates OpenCV module in current folder
@@ -207,7 +207,24 @@ enum KmeansFlags {
         user-supplied labels instead of computing them from the initial centers. For the second and
         further attempts, use the random or semi-random centers. Use one of KMEANS_\*_CENTERS flag
         to specify the exact method.*/
-    KMEANS_USE_INITIAL_LABELS = 1
+    KMEANS_USE_INITIAL_LABELS = 1,
+    /** Skip most of the distance computations using the triangle inequality, as proposed by Elkan
+        [Elkan2003]. The result is the same as without the flag. The bounds take N*K floats, so it
+        suits the moderate number of clusters.*/
+    KMEANS_ELKAN              = 4,
+    /** Skip most of the distance computations keeping a single bound per sample, as proposed by
+        Hamerly [Hamerly2010]. The result is the same as without the flag.*/
+    KMEANS_HAMERLY            = 8,
+    /** Update the centers after every small random batch of the samples, as proposed by Sculley
+        [Sculley2010]. An iteration is a pass over the shuffled samples. The result is approximate,
+        but it takes much fewer iterations on the large datasets. KMEANS_PP_CENTERS is run on a random
+        subset of the samples in this mode.*/
+    KMEANS_MINI_BATCH         = 16,
+    /** Compute the distances from the samples to the centers in blocks using matrix multiplication.
+        It is several times faster starting from 16 or so dimensions, but in the near ties the found
+        closest center can differ from the one found directly. Used in the standard and the mini-batch
+        modes.*/
+    KMEANS_USE_GEMM           = 32
 };
 
 //! type of line
@@ -1603,6 +1620,24 @@ input matrices.
 CV_EXPORTS_W void gemm(InputArray src1, InputArray src2, double alpha,
                        InputArray src3, double beta, OutputArray dst, int flags = 0);
 
+/** @overload
+Multiplies the sparse matrix in the CSR format by the dense one:
+\f[\texttt{dst} =  \texttt{alpha} \cdot \texttt{src1} \cdot \texttt{src2} +  \texttt{beta} \cdot \texttt{src3}\f]
+The rows of the result are computed in parallel, with the work split by the number of the non-zero
+elements. The sparse-vector (src2 is a single column) and sparse-dense products are both supported.
+With GEMM_1_T the transposed sparse matrix is built first, in O(nnz) time.
+@param src1 sparse matrix of CV_32FC1 or CV_64FC1 type.
+@param src2 dense matrix of the same type as src1.
+@param alpha weight of the matrix product.
+@param src3 optional dense matrix of the same type added to the product.
+@param beta weight of src3.
+@param dst output dense matrix.
+@param flags combination of cv::GemmFlags.
+@sa CsrMat
+*/
+CV_EXPORTS void gemm(const CsrMat& src1, InputArray src2, double alpha,
+                     InputArray src3, double beta, OutputArray dst, int flags = 0);
+
 /** @brief Calculates the product of a matrix and its transposition.
 
 The function cv::mulTransposed calculates the product of src and its
@@ -1882,11 +1917,25 @@ in the descending order.
 @param eigenvectors output matrix of eigenvectors; it has the same size and type as src; the
 eigenvectors are stored as subsequent matrix rows, in the same order as the corresponding
 eigenvalues.
+The small matrices are processed with the Jacobi method. The larger ones are reduced to the
+tridiagonal form with Householder reflections first and then the eigenpairs are found with the
+implicit QL algorithm; this part runs in parallel.
 @sa completeSymm , PCA
 */
 CV_EXPORTS_W bool eigen(InputArray src, OutputArray eigenvalues,
                         OutputArray eigenvectors = noArray());
 
+/** @overload
+Computes only the count largest eigenvalues and the corresponding eigenvectors. For the large
+matrices they are found with bisection and inverse iteration, which is much faster than the complete
+decomposition when count is small compared to the matrix size.
+@param src input symmetric matrix of CV_32FC1 or CV_64FC1 type.
+@param eigenvalues output vector of count eigenvalues of the same type as src, in the descending order.
+@param eigenvectors output count x src.cols matrix of the corresponding eigenvectors, stored as rows.
+@param count number of the eigenpairs to compute, 0 < count <= src.rows.
+*/
+CV_EXPORTS bool eigen(InputArray src, OutputArray eigenvalues, OutputArray eigenvectors, int count);
+
 /** @brief Calculates the covariance matrix of a set of vectors.
 
 The function cv::calcCovarMatrix calculates the covariance matrix and, optionally, the mean vector of
@@ -2000,6 +2049,9 @@ efficiently, whose sizes can be factorized in a product of small prime numbers (
 current implementation). Such an efficient DFT size can be calculated using the getOptimalDFTSize
 method.
 
+The transform setup is cached per thread, so the repeated calls with the same size, type and flags
+do not compute it again. To transform many arrays of the same size at once, use dftBatch.
+
 The sample below illustrates how to calculate a DFT-based convolution of two 2D real arrays:
 @code
     void convolveDFT(InputArray A, InputArray B, OutputArray C)
@@ -2097,6 +2149,20 @@ the convolution sample in dft description.
 */
 CV_EXPORTS_W void idft(InputArray src, OutputArray dst, int flags = 0, int nonzeroRows = 0);
 
+/** @brief Performs a forward or inverse Discrete Fourier transform of several arrays of the same size.
+
+The function is equivalent to calling dft for every array of the batch, but the arrays are
+transformed in parallel. Like dft, it reuses the transform setup (the factorization of the size
+and the twiddle factors) computed for the previous arrays of the same size, type and flags.
+@param src input arrays, they should have the same size and type (see dft).
+@param dst output vector of arrays; its elements are (re)allocated as in dft. It can be the same
+vector as src to transform the arrays in-place.
+@param flags transformation flags, representing a combination of the cv::DftFlags
+@param nonzeroRows the number of nonzero rows in every array (see dft).
+@sa dft, idft
+*/
+CV_EXPORTS_W void dftBatch(InputArrayOfArrays src, OutputArrayOfArrays dst, int flags = 0, int nonzeroRows = 0);
+
 /** @brief Performs a forward or inverse discrete Cosine transform of 1D or 2D array.
 
 The function cv::dct performs a forward or inverse discrete Cosine transform (DCT) of a 1D or 2D
@@ -2369,7 +2435,9 @@ public:
     @param flags operation flags; currently the parameter is only used to
     specify the data layout. (Flags)
     @param maxComponents maximum number of components that PCA should
-    retain; by default, all the components are retained.
+    retain; by default, all the components are retained. When it is much smaller than the
+    dimensionality (and the number of samples), the components are found by SVD::computeTruncated
+    applied to the centered data, without computing the covariance matrix.
     */
     PCA& operator()(InputArray data, InputArray mean, int flags, int maxComponents = 0);
 
@@ -2617,6 +2685,26 @@ public:
       */
     static void compute( InputArray src, OutputArray w, int flags = 0 );
 
+    /** @brief computes the k largest singular values and the corresponding singular vectors
+
+    The method uses the randomized range finder by Halko, Martinsson and Tropp: the matrix is
+    multiplied by k + oversampling random vectors, the power iterations refine the found subspace,
+    and only the projection of the matrix onto it is decomposed directly. It needs O(m\*n\*k) operations
+    instead of O(m\*n\*min(m,n)), and the products are computed by the multi-threaded gemm. The
+    result is approximate; the accuracy grows with the gap between the k-th and the following
+    singular values and with the number of the power iterations. The random vectors are generated
+    with a fixed seed, so the result is reproducible.
+    @param src decomposed matrix of CV_32F or CV_64F type, m x n
+    @param w k largest singular values, k x 1
+    @param u the corresponding left singular vectors, m x k
+    @param vt the corresponding right singular vectors as rows, k x n
+    @param k number of the computed singular values, 0 < k <= min(m,n)
+    @param oversampling number of the additional random vectors
+    @param powerIterations number of the power iterations
+      */
+    static void computeTruncated( InputArray src, OutputArray w, OutputArray u, OutputArray vt,
+                                  int k, int oversampling = 10, int powerIterations = 4 );
+
     /** @brief performs back substitution
       */
     static void backSubst( InputArray w, InputArray u,
@@ -2877,6 +2965,43 @@ private:
     int mti;
 };
 
+//! Flags for mapMatFile
+enum MapMatFileFlags
+{
+    MAP_MAT_READ_ONLY     = 0, //!< the pages are shared with the file and other processes, writing to the matrices is not allowed
+    MAP_MAT_COPY_ON_WRITE = 1  //!< the modified pages become private copies, the file is never changed
+};
+
+/** @brief Writes the matrices to a raw binary file which can be mapped into memory by mapMatFile.
+
+The file consists of a header, which describes the type and the size of every matrix, followed by the
+matrix elements stored continuously, each matrix aligned to 64 bytes. The data is written in the byte
+order of the machine; mapMatFile refuses a file written with the other byte order.
+
+@param filename name of the file
+@param mats the matrices to write: a single Mat or a vector of them, at most 32 dimensions each
+@sa mapMatFile
+*/
+CV_EXPORTS void saveMatFile(const String& filename, InputArrayOfArrays mats);
+
+/** @brief Maps the file written by saveMatFile into memory and returns the matrices which refer to it.
+
+Nothing is read at this point: the pages are loaded on the first access and the processes which map the
+same file share them. The mapping is released when the last of the matrices (and of their copies and
+ROIs) is released.
+
+@param filename name of the file
+@param mats the matrices stored in the file
+@param flags MAP_MAT_READ_ONLY or MAP_MAT_COPY_ON_WRITE, see cv::MapMatFileFlags
+@sa saveMatFile
+*/
+CV_EXPORTS void mapMatFile(const String& filename, std::vector<Mat>& mats, int flags = MAP_MAT_READ_ONLY);
+
+/** @overload
+Returns the first matrix of the file.
+*/
+CV_EXPORTS Mat mapMatFile(const String& filename, int flags = MAP_MAT_READ_ONLY);
+
 //! @} core_array
 
 //! @addtogroup core_cluster
@@ -2918,6 +3043,11 @@ compactness value are returned by the function. Basically, you can use only the
 function, set the number of attempts to 1, initialize labels each time using a custom algorithm,
 pass them with the ( flags = KMEANS_USE_INITIAL_LABELS ) flag, and then choose the best
 (most-compact) clustering.
+
+For the large datasets and the large number of clusters, the iterations can be accelerated by
+KMEANS_ELKAN or KMEANS_HAMERLY that give the same result, or replaced by KMEANS_MINI_BATCH that
+gives an approximate one. KMEANS_USE_GEMM speeds up the distance computations in the standard and
+the mini-batch modes.
 */
 CV_EXPORTS_W double kmeans( InputArray data, int K, InputOutputArray bestLabels,
                             TermCriteria criteria, int attempts,
@@ -22,6 +22,17 @@ public:
     virtual size_t getMaxReservedSize() const = 0;
     virtual void setMaxReservedSize(size_t size) = 0;
     virtual void freeAllReservedBuffers() = 0;
+
+    /** @brief Returns the usage statistics of the pool
+
+    @param hits number of the requests served from the reserved buffers
+    @param misses number of the requests which have required a new allocation
+
+    The counters are accumulated since the pool has been created or resetStatistics() has been called.
+    Pools which don't collect statistics return zeros.
+     */
+    virtual void getStatistics(size_t& hits, size_t& misses) const { hits = misses = 0; }
+    virtual void resetStatistics() { }
 };
 
 //! @}
@@ -0,0 +1,98 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                          License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2016, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+// The support of the runtime dispatching of the code compiled for several instruction sets.
+//
+// A module marks a file <name>.simd.hpp as dispatched with ocv_add_dispatched_file() in its
+// CMakeLists.txt. The build system then compiles the file once more for each of the requested
+// instruction sets (SSE4_1, AVX, AVX2), with CV_CPU_DISPATCH_MODE set to the name of the set and
+// with the corresponding compiler flags. The code of the file is placed into
+// the CV_CPU_OPTIMIZATION_NAMESPACE namespace, which is cpu_baseline for the regular build
+// and opt_<mode> (opt_AVX2, ...) for the dispatched ones. The universal intrinsics are put into
+// hal_baseline / hal_<mode> the same way, so that the inline functions compiled with the different
+// flags never get merged by the linker.
+//
+// The regular translation unit includes <name>.simd.hpp itself and the generated
+// <name>.simd_declarations.hpp, and calls the best variant of the function for the current CPU with
+// CV_CPU_DISPATCH(func, (args)), see modules/core/src/mathfuncs_core.cpp.
+//
+// The mechanism is not specific to the core module. At the moment it is used by the mathfuncs_core,
+// arithm, convert, merge and split kernels of core and by the 32f separable filters of imgproc
+// (modules/imgproc/src/filter.simd.hpp). The rest of the code is compiled for the baseline
+// instruction set only.
+
+#ifndef OPENCV_CORE_CV_CPU_DISPATCH_H
+#define OPENCV_CORE_CV_CPU_DISPATCH_H
+
+#define CV_CPU_CAT_(a, b) a ## b
+#define CV_CPU_CAT(a, b) CV_CPU_CAT_(a, b)
+
+#ifdef CV_CPU_DISPATCH_MODE
+#  define CV_CPU_OPTIMIZATION_NAMESPACE CV_CPU_CAT(opt_, CV_CPU_DISPATCH_MODE)
+#  define CV_CPU_OPTIMIZATION_HAL_NAMESPACE CV_CPU_CAT(hal_, CV_CPU_DISPATCH_MODE)
+#else
+#  define CV_CPU_OPTIMIZATION_NAMESPACE cpu_baseline
+#  define CV_CPU_OPTIMIZATION_HAL_NAMESPACE hal_baseline
+#endif
+
+#define CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN namespace CV_CPU_OPTIMIZATION_NAMESPACE {
+#define CV_CPU_OPTIMIZATION_NAMESPACE_END }
+#define CV_CPU_OPTIMIZATION_HAL_NAMESPACE_BEGIN namespace CV_CPU_OPTIMIZATION_HAL_NAMESPACE {
+#define CV_CPU_OPTIMIZATION_HAL_NAMESPACE_END }
+
+#ifdef __cplusplus
+namespace cv { CV_EXPORTS bool checkHardwareSupport(int feature); }
+
+// the run-time checks of the instruction sets the code can be dispatched to
+#define CV_CPU_HAS_SUPPORT_SSE4_1 (cv::checkHardwareSupport(CV_CPU_SSE4_1))
+#define CV_CPU_HAS_SUPPORT_AVX (cv::checkHardwareSupport(CV_CPU_AVX))
+#define CV_CPU_HAS_SUPPORT_AVX2 (cv::checkHardwareSupport(CV_CPU_AVX2) && cv::checkHardwareSupport(CV_CPU_FMA3))
+
+// calls the variant of the function for the best instruction set supported by the CPU;
+// the CV_CPU_DISPATCH_<mode> macros are defined by the generated <name>.simd_declarations.hpp
+#define CV_CPU_DISPATCH(fn, args) \
+    CV_CPU_DISPATCH_AVX2(fn, args) \
+    CV_CPU_DISPATCH_AVX(fn, args) \
+    CV_CPU_DISPATCH_SSE4_1(fn, args) \
+    return cpu_baseline::fn args
+#endif
+
+#endif // OPENCV_CORE_CV_CPU_DISPATCH_H
@@ -0,0 +1,19 @@
+// This file is included by the generated <name>.simd_declarations.hpp files, once per dispatched
+// instruction set. It declares the functions of CV_CPU_SIMD_FILENAME in the opt_<CV_CPU_DISPATCH_MODE>
+// namespace; the definitions are compiled in the separate translation units.
+// See opencv2/core/cv_cpu_dispatch.h.
+
+#ifndef CV_CPU_DISPATCH_MODE
+#  error "CV_CPU_DISPATCH_MODE is not defined"
+#endif
+
+#undef CV_CPU_OPTIMIZATION_NAMESPACE
+#define CV_CPU_OPTIMIZATION_NAMESPACE CV_CPU_CAT(opt_, CV_CPU_DISPATCH_MODE)
+#define CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+#include CV_CPU_SIMD_FILENAME
+
+#undef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+#undef CV_CPU_OPTIMIZATION_NAMESPACE
+#define CV_CPU_OPTIMIZATION_NAMESPACE cpu_baseline
+#undef CV_CPU_DISPATCH_MODE
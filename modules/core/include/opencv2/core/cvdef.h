@@ -478,4 +478,6 @@ Cv64suf;
 
 //! @}
 
+#include "opencv2/core/cv_cpu_dispatch.h"
+
 #endif // OPENCV_CORE_CVDEF_H
@@ -302,6 +302,18 @@ template <typename T> struct V_SIMD128Traits
 
 #endif
 
+#if CV_SSE2 && CV_AVX2
+
+#include "opencv2/core/hal/intrin_avx.hpp"
+
+#endif
+
+// the intrinsics are defined in the namespace specific to the instruction set the code is compiled for
+// (see opencv2/core/cv_cpu_dispatch.h), but are used as if they were defined in cv
+namespace cv {
+using namespace CV_CPU_OPTIMIZATION_HAL_NAMESPACE;
+}
+
 //! @addtogroup core_hal_intrin
 //! @{
 
@@ -315,6 +327,16 @@ template <typename T> struct V_SIMD128Traits
 #define CV_SIMD128_64F 0
 #endif
 
+#ifndef CV_SIMD256
+//! Set to 1 if 256-bit vector types (v_uint8x32, v_float32x8, ...) are available (AVX2 is enabled)
+#define CV_SIMD256 0
+#endif
+
+#ifndef CV_SIMD256_64F
+//! Set to 1 if current intrinsics implementation supports 256-bit 64-bit float vectors
+#define CV_SIMD256_64F 0
+#endif
+
 //! @}
 
 //==================================================================================================
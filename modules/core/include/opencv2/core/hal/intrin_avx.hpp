@@ -0,0 +1,967 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                          License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Copyright (C) 2013, OpenCV Foundation, all rights reserved.
+// Copyright (C) 2015, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#ifndef OPENCV_HAL_INTRIN_AVX_HPP
+#define OPENCV_HAL_INTRIN_AVX_HPP
+
+#define CV_SIMD256 1
+#define CV_SIMD256_64F 1
+
+namespace cv
+{
+
+CV_CPU_OPTIMIZATION_HAL_NAMESPACE_BEGIN
+
+//! @cond IGNORED
+
+///////// Utils ////////////
+
+inline __m256i _v256_combine(const __m128i& lo, const __m128i& hi)
+{ return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1); }
+
+inline __m256 _v256_combine(const __m128& lo, const __m128& hi)
+{ return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1); }
+
+inline __m256d _v256_combine(const __m128d& lo, const __m128d& hi)
+{ return _mm256_insertf128_pd(_mm256_castpd128_pd256(lo), hi, 1); }
+
+inline __m128i _v256_extract_high(const __m256i& v)
+{ return _mm256_extracti128_si256(v, 1); }
+
+inline __m128 _v256_extract_high(const __m256& v)
+{ return _mm256_extractf128_ps(v, 1); }
+
+inline __m128d _v256_extract_high(const __m256d& v)
+{ return _mm256_extractf128_pd(v, 1); }
+
+inline __m128i _v256_extract_low(const __m256i& v)
+{ return _mm256_castsi256_si128(v); }
+
+inline __m128 _v256_extract_low(const __m256& v)
+{ return _mm256_castps256_ps128(v); }
+
+inline __m128d _v256_extract_low(const __m256d& v)
+{ return _mm256_castpd256_pd128(v); }
+
+// AVX2 pack/unpack instructions work inside 128-bit lanes,
+// this restores the natural order of 64-bit blocks after them
+inline __m256i _v256_shuffle_odd_64(const __m256i& v)
+{ return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0)); }
+
+///////// Types ////////////
+
+struct v_uint8x32
+{
+    typedef uchar lane_type;
+    enum { nlanes = 32 };
+
+    v_uint8x32() {}
+    explicit v_uint8x32(__m256i v) : val(v) {}
+    uchar get0() const { return (uchar)_mm_cvtsi128_si32(_mm256_castsi256_si128(val)); }
+
+    __m256i val;
+};
+
+struct v_int8x32
+{
+    typedef schar lane_type;
+    enum { nlanes = 32 };
+
+    v_int8x32() {}
+    explicit v_int8x32(__m256i v) : val(v) {}
+    schar get0() const { return (schar)_mm_cvtsi128_si32(_mm256_castsi256_si128(val)); }
+
+    __m256i val;
+};
+
+struct v_uint16x16
+{
+    typedef ushort lane_type;
+    enum { nlanes = 16 };
+
+    v_uint16x16() {}
+    explicit v_uint16x16(__m256i v) : val(v) {}
+    ushort get0() const { return (ushort)_mm_cvtsi128_si32(_mm256_castsi256_si128(val)); }
+
+    __m256i val;
+};
+
+struct v_int16x16
+{
+    typedef short lane_type;
+    enum { nlanes = 16 };
+
+    v_int16x16() {}
+    explicit v_int16x16(__m256i v) : val(v) {}
+    short get0() const { return (short)_mm_cvtsi128_si32(_mm256_castsi256_si128(val)); }
+
+    __m256i val;
+};
+
+struct v_uint32x8
+{
+    typedef unsigned lane_type;
+    enum { nlanes = 8 };
+
+    v_uint32x8() {}
+    explicit v_uint32x8(__m256i v) : val(v) {}
+    v_uint32x8(unsigned v0, unsigned v1, unsigned v2, unsigned v3,
+               unsigned v4, unsigned v5, unsigned v6, unsigned v7)
+    {
+        val = _mm256_setr_epi32((int)v0, (int)v1, (int)v2, (int)v3,
+                                (int)v4, (int)v5, (int)v6, (int)v7);
+    }
+    unsigned get0() const { return (unsigned)_mm_cvtsi128_si32(_mm256_castsi256_si128(val)); }
+
+    __m256i val;
+};
+
+struct v_int32x8
+{
+    typedef int lane_type;
+    enum { nlanes = 8 };
+
+    v_int32x8() {}
+    explicit v_int32x8(__m256i v) : val(v) {}
+    v_int32x8(int v0, int v1, int v2, int v3, int v4, int v5, int v6, int v7)
+    {
+        val = _mm256_setr_epi32(v0, v1, v2, v3, v4, v5, v6, v7);
+    }
+    int get0() const { return _mm_cvtsi128_si32(_mm256_castsi256_si128(val)); }
+
+    __m256i val;
+};
+
+struct v_float32x8
+{
+    typedef float lane_type;
+    enum { nlanes = 8 };
+
+    v_float32x8() {}
+    explicit v_float32x8(__m256 v) : val(v) {}
+    v_float32x8(float v0, float v1, float v2, float v3, float v4, float v5, float v6, float v7)
+    {
+        val = _mm256_setr_ps(v0, v1, v2, v3, v4, v5, v6, v7);
+    }
+    float get0() const { return _mm_cvtss_f32(_mm256_castps256_ps128(val)); }
+
+    __m256 val;
+};
+
+struct v_uint64x4
+{
+    typedef uint64 lane_type;
+    enum { nlanes = 4 };
+
+    v_uint64x4() {}
+    explicit v_uint64x4(__m256i v) : val(v) {}
+    v_uint64x4(uint64 v0, uint64 v1, uint64 v2, uint64 v3)
+    {
+        val = _mm256_setr_epi64x((int64)v0, (int64)v1, (int64)v2, (int64)v3);
+    }
+    uint64 get0() const
+    {
+        uint64 CV_DECL_ALIGNED(32) buf[4];
+        _mm256_store_si256((__m256i*)buf, val);
+        return buf[0];
+    }
+
+    __m256i val;
+};
+
+struct v_int64x4
+{
+    typedef int64 lane_type;
+    enum { nlanes = 4 };
+
+    v_int64x4() {}
+    explicit v_int64x4(__m256i v) : val(v) {}
+    v_int64x4(int64 v0, int64 v1, int64 v2, int64 v3)
+    {
+        val = _mm256_setr_epi64x(v0, v1, v2, v3);
+    }
+    int64 get0() const
+    {
+        int64 CV_DECL_ALIGNED(32) buf[4];
+        _mm256_store_si256((__m256i*)buf, val);
+        return buf[0];
+    }
+
+    __m256i val;
+};
+
+struct v_float64x4
+{
+    typedef double lane_type;
+    enum { nlanes = 4 };
+
+    v_float64x4() {}
+    explicit v_float64x4(__m256d v) : val(v) {}
+    v_float64x4(double v0, double v1, double v2, double v3)
+    {
+        val = _mm256_setr_pd(v0, v1, v2, v3);
+    }
+    double get0() const { return _mm_cvtsd_f64(_mm256_castpd256_pd128(val)); }
+
+    __m256d val;
+};
+
+//////////////// Load and store operations ///////////////
+
+#define OPENCV_HAL_IMPL_AVX_LOADSTORE(_Tpvec, _Tp) \
+inline _Tpvec v256_load(const _Tp* ptr) \
+{ return _Tpvec(_mm256_loadu_si256((const __m256i*)ptr)); } \
+inline _Tpvec v256_load_aligned(const _Tp* ptr) \
+{ return _Tpvec(_mm256_load_si256((const __m256i*)ptr)); } \
+inline _Tpvec v256_load_low(const _Tp* ptr) \
+{ return _Tpvec(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)ptr))); } \
+inline _Tpvec v256_load_halves(const _Tp* ptr0, const _Tp* ptr1) \
+{ \
+    return _Tpvec(_v256_combine(_mm_loadu_si128((const __m128i*)ptr0), \
+                                _mm_loadu_si128((const __m128i*)ptr1))); \
+} \
+inline void v_store(_Tp* ptr, const _Tpvec& a) \
+{ _mm256_storeu_si256((__m256i*)ptr, a.val); } \
+inline void v_store_aligned(_Tp* ptr, const _Tpvec& a) \
+{ _mm256_store_si256((__m256i*)ptr, a.val); } \
+inline void v_store_low(_Tp* ptr, const _Tpvec& a) \
+{ _mm_storeu_si128((__m128i*)ptr, _v256_extract_low(a.val)); } \
+inline void v_store_high(_Tp* ptr, const _Tpvec& a) \
+{ _mm_storeu_si128((__m128i*)ptr, _v256_extract_high(a.val)); }
+
+OPENCV_HAL_IMPL_AVX_LOADSTORE(v_uint8x32, uchar)
+OPENCV_HAL_IMPL_AVX_LOADSTORE(v_int8x32, schar)
+OPENCV_HAL_IMPL_AVX_LOADSTORE(v_uint16x16, ushort)
+OPENCV_HAL_IMPL_AVX_LOADSTORE(v_int16x16, short)
+OPENCV_HAL_IMPL_AVX_LOADSTORE(v_uint32x8, unsigned)
+OPENCV_HAL_IMPL_AVX_LOADSTORE(v_int32x8, int)
+OPENCV_HAL_IMPL_AVX_LOADSTORE(v_uint64x4, uint64)
+OPENCV_HAL_IMPL_AVX_LOADSTORE(v_int64x4, int64)
+
+#define OPENCV_HAL_IMPL_AVX_LOADSTORE_FLT(_Tpvec, _Tp, suffix, halfreg) \
+inline _Tpvec v256_load(const _Tp* ptr) \
+{ return _Tpvec(_mm256_loadu_##suffix(ptr)); } \
+inline _Tpvec v256_load_aligned(const _Tp* ptr) \
+{ return _Tpvec(_mm256_load_##suffix(ptr)); } \
+inline _Tpvec v256_load_low(const _Tp* ptr) \
+{ return _Tpvec(_mm256_cast##suffix##128_##suffix##256(_mm_loadu_##suffix(ptr))); } \
+inline _Tpvec v256_load_halves(const _Tp* ptr0, const _Tp* ptr1) \
+{ return _Tpvec(_v256_combine(_mm_loadu_##suffix(ptr0), _mm_loadu_##suffix(ptr1))); } \
+inline void v_store(_Tp* ptr, const _Tpvec& a) \
+{ _mm256_storeu_##suffix(ptr, a.val); } \
+inline void v_store_aligned(_Tp* ptr, const _Tpvec& a) \
+{ _mm256_store_##suffix(ptr, a.val); } \
+inline void v_store_low(_Tp* ptr, const _Tpvec& a) \
+{ _mm_storeu_##suffix(ptr, _v256_extract_low(a.val)); } \
+inline void v_store_high(_Tp* ptr, const _Tpvec& a) \
+{ _mm_storeu_##suffix(ptr, _v256_extract_high(a.val)); }
+
+OPENCV_HAL_IMPL_AVX_LOADSTORE_FLT(v_float32x8, float, ps, __m128)
+OPENCV_HAL_IMPL_AVX_LOADSTORE_FLT(v_float64x4, double, pd, __m128d)
+
+//////////////// Initialization, reinterpretation, halves ///////////////
+
+#define OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, _Tpvec0, cast) \
+inline _Tpvec v_reinterpret_as_##suffix(const _Tpvec0& a) \
+{ return _Tpvec(cast(a.val)); }
+
+#define OPENCV_HAL_IMPL_AVX_INIT(_Tpvec, _Tp, suffix, ssuffix, ctype_s, zero, from_si, from_ps, from_pd) \
+inline _Tpvec v256_setzero_##suffix() { return _Tpvec(zero()); } \
+inline _Tpvec v256_setall_##suffix(_Tp v) { return _Tpvec(_mm256_set1_##ssuffix((ctype_s)v)); } \
+OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, v_uint8x32,  from_si) \
+OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, v_int8x32,   from_si) \
+OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, v_uint16x16, from_si) \
+OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, v_int16x16,  from_si) \
+OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, v_uint32x8,  from_si) \
+OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, v_int32x8,   from_si) \
+OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, v_uint64x4,  from_si) \
+OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, v_int64x4,   from_si) \
+OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, v_float32x8, from_ps) \
+OPENCV_HAL_IMPL_AVX_CAST(_Tpvec, suffix, v_float64x4, from_pd)
+
+OPENCV_HAL_IMPL_AVX_INIT(v_uint8x32,  uchar,    u8,  epi8,   char,   _mm256_setzero_si256, OPENCV_HAL_NOP, _mm256_castps_si256, _mm256_castpd_si256)
+OPENCV_HAL_IMPL_AVX_INIT(v_int8x32,   schar,    s8,  epi8,   char,   _mm256_setzero_si256, OPENCV_HAL_NOP, _mm256_castps_si256, _mm256_castpd_si256)
+OPENCV_HAL_IMPL_AVX_INIT(v_uint16x16, ushort,   u16, epi16,  short,  _mm256_setzero_si256, OPENCV_HAL_NOP, _mm256_castps_si256, _mm256_castpd_si256)
+OPENCV_HAL_IMPL_AVX_INIT(v_int16x16,  short,    s16, epi16,  short,  _mm256_setzero_si256, OPENCV_HAL_NOP, _mm256_castps_si256, _mm256_castpd_si256)
+OPENCV_HAL_IMPL_AVX_INIT(v_uint32x8,  unsigned, u32, epi32,  int,    _mm256_setzero_si256, OPENCV_HAL_NOP, _mm256_castps_si256, _mm256_castpd_si256)
+OPENCV_HAL_IMPL_AVX_INIT(v_int32x8,   int,      s32, epi32,  int,    _mm256_setzero_si256, OPENCV_HAL_NOP, _mm256_castps_si256, _mm256_castpd_si256)
+OPENCV_HAL_IMPL_AVX_INIT(v_uint64x4,  uint64,   u64, epi64x, int64,  _mm256_setzero_si256, OPENCV_HAL_NOP, _mm256_castps_si256, _mm256_castpd_si256)
+OPENCV_HAL_IMPL_AVX_INIT(v_int64x4,   int64,    s64, epi64x, int64,  _mm256_setzero_si256, OPENCV_HAL_NOP, _mm256_castps_si256, _mm256_castpd_si256)
+OPENCV_HAL_IMPL_AVX_INIT(v_float32x8, float,    f32, ps,     float,  _mm256_setzero_ps, _mm256_castsi256_ps, OPENCV_HAL_NOP, _mm256_castpd_ps)
+OPENCV_HAL_IMPL_AVX_INIT(v_float64x4, double,   f64, pd,     double, _mm256_setzero_pd, _mm256_castsi256_pd, _mm256_castps_pd, OPENCV_HAL_NOP)
+
+#define OPENCV_HAL_IMPL_AVX_HALVES(_Tpvec, _Tpvec128) \
+inline _Tpvec128 v_get_low(const _Tpvec& a) { return _Tpvec128(_v256_extract_low(a.val)); } \
+inline _Tpvec128 v_get_high(const _Tpvec& a) { return _Tpvec128(_v256_extract_high(a.val)); } \
+inline _Tpvec v256_combine(const _Tpvec128& lo, const _Tpvec128& hi) \
+{ return _Tpvec(_v256_combine(lo.val, hi.val)); }
+
+OPENCV_HAL_IMPL_AVX_HALVES(v_uint8x32, v_uint8x16)
+OPENCV_HAL_IMPL_AVX_HALVES(v_int8x32, v_int8x16)
+OPENCV_HAL_IMPL_AVX_HALVES(v_uint16x16, v_uint16x8)
+OPENCV_HAL_IMPL_AVX_HALVES(v_int16x16, v_int16x8)
+OPENCV_HAL_IMPL_AVX_HALVES(v_uint32x8, v_uint32x4)
+OPENCV_HAL_IMPL_AVX_HALVES(v_int32x8, v_int32x4)
+OPENCV_HAL_IMPL_AVX_HALVES(v_uint64x4, v_uint64x2)
+OPENCV_HAL_IMPL_AVX_HALVES(v_int64x4, v_int64x2)
+OPENCV_HAL_IMPL_AVX_HALVES(v_float32x8, v_float32x4)
+OPENCV_HAL_IMPL_AVX_HALVES(v_float64x4, v_float64x2)
+
+//////////////// Arithmetics ///////////////
+
+#define OPENCV_HAL_IMPL_AVX_BIN_OP(bin_op, _Tpvec, intrin) \
+inline _Tpvec operator bin_op (const _Tpvec& a, const _Tpvec& b) \
+{ return _Tpvec(intrin(a.val, b.val)); } \
+inline _Tpvec& operator bin_op##= (_Tpvec& a, const _Tpvec& b) \
+{ a.val = intrin(a.val, b.val); return a; }
+
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_uint8x32, _mm256_adds_epu8)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_uint8x32, _mm256_subs_epu8)
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_int8x32, _mm256_adds_epi8)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_int8x32, _mm256_subs_epi8)
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_uint16x16, _mm256_adds_epu16)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_uint16x16, _mm256_subs_epu16)
+OPENCV_HAL_IMPL_AVX_BIN_OP(*, v_uint16x16, _mm256_mullo_epi16)
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_int16x16, _mm256_adds_epi16)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_int16x16, _mm256_subs_epi16)
+OPENCV_HAL_IMPL_AVX_BIN_OP(*, v_int16x16, _mm256_mullo_epi16)
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_uint32x8, _mm256_add_epi32)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_uint32x8, _mm256_sub_epi32)
+OPENCV_HAL_IMPL_AVX_BIN_OP(*, v_uint32x8, _mm256_mullo_epi32)
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_int32x8, _mm256_add_epi32)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_int32x8, _mm256_sub_epi32)
+OPENCV_HAL_IMPL_AVX_BIN_OP(*, v_int32x8, _mm256_mullo_epi32)
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_uint64x4, _mm256_add_epi64)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_uint64x4, _mm256_sub_epi64)
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_int64x4, _mm256_add_epi64)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_int64x4, _mm256_sub_epi64)
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_float32x8, _mm256_add_ps)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_float32x8, _mm256_sub_ps)
+OPENCV_HAL_IMPL_AVX_BIN_OP(*, v_float32x8, _mm256_mul_ps)
+OPENCV_HAL_IMPL_AVX_BIN_OP(/, v_float32x8, _mm256_div_ps)
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_float64x4, _mm256_add_pd)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_float64x4, _mm256_sub_pd)
+OPENCV_HAL_IMPL_AVX_BIN_OP(*, v_float64x4, _mm256_mul_pd)
+OPENCV_HAL_IMPL_AVX_BIN_OP(/, v_float64x4, _mm256_div_pd)
+
+#define OPENCV_HAL_IMPL_AVX_BIN_FUNC(func, _Tpvec, intrin) \
+inline _Tpvec func(const _Tpvec& a, const _Tpvec& b) \
+{ return _Tpvec(intrin(a.val, b.val)); }
+
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_add_wrap, v_uint8x32, _mm256_add_epi8)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_add_wrap, v_int8x32, _mm256_add_epi8)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_add_wrap, v_uint16x16, _mm256_add_epi16)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_add_wrap, v_int16x16, _mm256_add_epi16)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_sub_wrap, v_uint8x32, _mm256_sub_epi8)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_sub_wrap, v_int8x32, _mm256_sub_epi8)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_sub_wrap, v_uint16x16, _mm256_sub_epi16)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_sub_wrap, v_int16x16, _mm256_sub_epi16)
+
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_min, v_uint8x32, _mm256_min_epu8)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_max, v_uint8x32, _mm256_max_epu8)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_min, v_int8x32, _mm256_min_epi8)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_max, v_int8x32, _mm256_max_epi8)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_min, v_uint16x16, _mm256_min_epu16)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_max, v_uint16x16, _mm256_max_epu16)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_min, v_int16x16, _mm256_min_epi16)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_max, v_int16x16, _mm256_max_epi16)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_min, v_uint32x8, _mm256_min_epu32)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_max, v_uint32x8, _mm256_max_epu32)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_min, v_int32x8, _mm256_min_epi32)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_max, v_int32x8, _mm256_max_epi32)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_min, v_float32x8, _mm256_min_ps)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_max, v_float32x8, _mm256_max_ps)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_min, v_float64x4, _mm256_min_pd)
+OPENCV_HAL_IMPL_AVX_BIN_FUNC(v_max, v_float64x4, _mm256_max_pd)
+
+// the unpack instructions interleave inside 128-bit lanes,
+// so the products are put back into the natural order with a cross-lane permutation
+inline void v_mul_expand(const v_int16x16& a, const v_int16x16& b,
+                         v_int32x8& c, v_int32x8& d)
+{
+    __m256i v0 = _mm256_mullo_epi16(a.val, b.val);
+    __m256i v1 = _mm256_mulhi_epi16(a.val, b.val);
+    __m256i lo = _mm256_unpacklo_epi16(v0, v1);
+    __m256i hi = _mm256_unpackhi_epi16(v0, v1);
+    c.val = _mm256_permute2x128_si256(lo, hi, 0x20);
+    d.val = _mm256_permute2x128_si256(lo, hi, 0x31);
+}
+
+inline void v_mul_expand(const v_uint16x16& a, const v_uint16x16& b,
+                         v_uint32x8& c, v_uint32x8& d)
+{
+    __m256i v0 = _mm256_mullo_epi16(a.val, b.val);
+    __m256i v1 = _mm256_mulhi_epu16(a.val, b.val);
+    __m256i lo = _mm256_unpacklo_epi16(v0, v1);
+    __m256i hi = _mm256_unpackhi_epi16(v0, v1);
+    c.val = _mm256_permute2x128_si256(lo, hi, 0x20);
+    d.val = _mm256_permute2x128_si256(lo, hi, 0x31);
+}
+
+inline void v_mul_expand(const v_uint32x8& a, const v_uint32x8& b,
+                         v_uint64x4& c, v_uint64x4& d)
+{
+    __m256i v0 = _mm256_mul_epu32(a.val, b.val);
+    __m256i v1 = _mm256_mul_epu32(_mm256_srli_epi64(a.val, 32), _mm256_srli_epi64(b.val, 32));
+    __m256i lo = _mm256_unpacklo_epi64(v0, v1);
+    __m256i hi = _mm256_unpackhi_epi64(v0, v1);
+    c.val = _mm256_permute2x128_si256(lo, hi, 0x20);
+    d.val = _mm256_permute2x128_si256(lo, hi, 0x31);
+}
+
+inline v_int32x8 v_dotprod(const v_int16x16& a, const v_int16x16& b)
+{
+    return v_int32x8(_mm256_madd_epi16(a.val, b.val));
+}
+
+//////////////// Bitwise logic ///////////////
+
+#define OPENCV_HAL_IMPL_AVX_LOGIC_OP(_Tpvec, suffix, not_const) \
+OPENCV_HAL_IMPL_AVX_BIN_OP(&, _Tpvec, _mm256_and_##suffix) \
+OPENCV_HAL_IMPL_AVX_BIN_OP(|, _Tpvec, _mm256_or_##suffix) \
+OPENCV_HAL_IMPL_AVX_BIN_OP(^, _Tpvec, _mm256_xor_##suffix) \
+inline _Tpvec operator ~ (const _Tpvec& a) \
+{ return _Tpvec(_mm256_xor_##suffix(a.val, not_const)); }
+
+OPENCV_HAL_IMPL_AVX_LOGIC_OP(v_uint8x32, si256, _mm256_set1_epi32(-1))
+OPENCV_HAL_IMPL_AVX_LOGIC_OP(v_int8x32, si256, _mm256_set1_epi32(-1))
+OPENCV_HAL_IMPL_AVX_LOGIC_OP(v_uint16x16, si256, _mm256_set1_epi32(-1))
+OPENCV_HAL_IMPL_AVX_LOGIC_OP(v_int16x16, si256, _mm256_set1_epi32(-1))
+OPENCV_HAL_IMPL_AVX_LOGIC_OP(v_uint32x8, si256, _mm256_set1_epi32(-1))
+OPENCV_HAL_IMPL_AVX_LOGIC_OP(v_int32x8, si256, _mm256_set1_epi32(-1))
+OPENCV_HAL_IMPL_AVX_LOGIC_OP(v_uint64x4, si256, _mm256_set1_epi32(-1))
+OPENCV_HAL_IMPL_AVX_LOGIC_OP(v_int64x4, si256, _mm256_set1_epi32(-1))
+OPENCV_HAL_IMPL_AVX_LOGIC_OP(v_float32x8, ps, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))
+OPENCV_HAL_IMPL_AVX_LOGIC_OP(v_float64x4, pd, _mm256_castsi256_pd(_mm256_set1_epi32(-1)))
+
+#define OPENCV_HAL_IMPL_AVX_SELECT(_Tpvec, suffix) \
+inline _Tpvec v_select(const _Tpvec& mask, const _Tpvec& a, const _Tpvec& b) \
+{ return _Tpvec(_mm256_blendv_##suffix(b.val, a.val, mask.val)); }
+
+OPENCV_HAL_IMPL_AVX_SELECT(v_uint8x32, epi8)
+OPENCV_HAL_IMPL_AVX_SELECT(v_int8x32, epi8)
+OPENCV_HAL_IMPL_AVX_SELECT(v_uint16x16, epi8)
+OPENCV_HAL_IMPL_AVX_SELECT(v_int16x16, epi8)
+OPENCV_HAL_IMPL_AVX_SELECT(v_uint32x8, epi8)
+OPENCV_HAL_IMPL_AVX_SELECT(v_int32x8, epi8)
+OPENCV_HAL_IMPL_AVX_SELECT(v_float32x8, ps)
+OPENCV_HAL_IMPL_AVX_SELECT(v_float64x4, pd)
+
+//////////////// Shifts ///////////////
+
+#define OPENCV_HAL_IMPL_AVX_SHIFT_OP(_Tpuvec, _Tpsvec, suffix, srai) \
+inline _Tpuvec operator << (const _Tpuvec& a, int imm) \
+{ return _Tpuvec(_mm256_slli_##suffix(a.val, imm)); } \
+inline _Tpsvec operator << (const _Tpsvec& a, int imm) \
+{ return _Tpsvec(_mm256_slli_##suffix(a.val, imm)); } \
+inline _Tpuvec operator >> (const _Tpuvec& a, int imm) \
+{ return _Tpuvec(_mm256_srli_##suffix(a.val, imm)); } \
+inline _Tpsvec operator >> (const _Tpsvec& a, int imm) \
+{ return _Tpsvec(srai(a.val, imm)); } \
+template<int imm> inline _Tpuvec v_shl(const _Tpuvec& a) \
+{ return _Tpuvec(_mm256_slli_##suffix(a.val, imm)); } \
+template<int imm> inline _Tpsvec v_shl(const _Tpsvec& a) \
+{ return _Tpsvec(_mm256_slli_##suffix(a.val, imm)); } \
+template<int imm> inline _Tpuvec v_shr(const _Tpuvec& a) \
+{ return _Tpuvec(_mm256_srli_##suffix(a.val, imm)); } \
+template<int imm> inline _Tpsvec v_shr(const _Tpsvec& a) \
+{ return _Tpsvec(srai(a.val, imm)); }
+
+inline __m256i _v256_srai_epi64(const __m256i& a, int imm)
+{
+    __m256i smask = _mm256_cmpgt_epi64(_mm256_setzero_si256(), a);
+    return _mm256_xor_si256(_mm256_srli_epi64(_mm256_xor_si256(a, smask), imm), smask);
+}
+
+OPENCV_HAL_IMPL_AVX_SHIFT_OP(v_uint16x16, v_int16x16, epi16, _mm256_srai_epi16)
+OPENCV_HAL_IMPL_AVX_SHIFT_OP(v_uint32x8, v_int32x8, epi32, _mm256_srai_epi32)
+OPENCV_HAL_IMPL_AVX_SHIFT_OP(v_uint64x4, v_int64x4, epi64, _v256_srai_epi64)
+
+//////////////// Comparison ///////////////
+
+#define OPENCV_HAL_IMPL_AVX_CMP_OP_INT(_Tpuvec, _Tpsvec, suffix, sbit) \
+inline _Tpuvec operator == (const _Tpuvec& a, const _Tpuvec& b) \
+{ return _Tpuvec(_mm256_cmpeq_##suffix(a.val, b.val)); } \
+inline _Tpuvec operator != (const _Tpuvec& a, const _Tpuvec& b) \
+{ return ~(a == b); } \
+inline _Tpsvec operator == (const _Tpsvec& a, const _Tpsvec& b) \
+{ return _Tpsvec(_mm256_cmpeq_##suffix(a.val, b.val)); } \
+inline _Tpsvec operator != (const _Tpsvec& a, const _Tpsvec& b) \
+{ return ~(a == b); } \
+inline _Tpuvec operator < (const _Tpuvec& a, const _Tpuvec& b) \
+{ \
+    __m256i smask = _mm256_set1_##suffix(sbit); \
+    return _Tpuvec(_mm256_cmpgt_##suffix(_mm256_xor_si256(b.val, smask), _mm256_xor_si256(a.val, smask))); \
+} \
+inline _Tpuvec operator > (const _Tpuvec& a, const _Tpuvec& b) \
+{ return b < a; } \
+inline _Tpuvec operator <= (const _Tpuvec& a, const _Tpuvec& b) \
+{ return ~(b < a); } \
+inline _Tpuvec operator >= (const _Tpuvec& a, const _Tpuvec& b) \
+{ return ~(a < b); } \
+inline _Tpsvec operator < (const _Tpsvec& a, const _Tpsvec& b) \
+{ return _Tpsvec(_mm256_cmpgt_##suffix(b.val, a.val)); } \
+inline _Tpsvec operator > (const _Tpsvec& a, const _Tpsvec& b) \
+{ return _Tpsvec(_mm256_cmpgt_##suffix(a.val, b.val)); } \
+inline _Tpsvec operator <= (const _Tpsvec& a, const _Tpsvec& b) \
+{ return ~(a > b); } \
+inline _Tpsvec operator >= (const _Tpsvec& a, const _Tpsvec& b) \
+{ return ~(a < b); }
+
+OPENCV_HAL_IMPL_AVX_CMP_OP_INT(v_uint8x32, v_int8x32, epi8, (char)-128)
+OPENCV_HAL_IMPL_AVX_CMP_OP_INT(v_uint16x16, v_int16x16, epi16, (short)-32768)
+OPENCV_HAL_IMPL_AVX_CMP_OP_INT(v_uint32x8, v_int32x8, epi32, (int)0x80000000)
+
+#define OPENCV_HAL_IMPL_AVX_CMP_FLT(bin_op, imm8, _Tpvec, suffix) \
+inline _Tpvec operator bin_op (const _Tpvec& a, const _Tpvec& b) \
+{ return _Tpvec(_mm256_cmp_##suffix(a.val, b.val, imm8)); }
+
+#define OPENCV_HAL_IMPL_AVX_CMP_OP_FLT(_Tpvec, suffix) \
+OPENCV_HAL_IMPL_AVX_CMP_FLT(==, _CMP_EQ_OQ,  _Tpvec, suffix) \
+OPENCV_HAL_IMPL_AVX_CMP_FLT(!=, _CMP_NEQ_UQ, _Tpvec, suffix) \
+OPENCV_HAL_IMPL_AVX_CMP_FLT(<,  _CMP_LT_OQ,  _Tpvec, suffix) \
+OPENCV_HAL_IMPL_AVX_CMP_FLT(>,  _CMP_GT_OQ,  _Tpvec, suffix) \
+OPENCV_HAL_IMPL_AVX_CMP_FLT(<=, _CMP_LE_OQ,  _Tpvec, suffix) \
+OPENCV_HAL_IMPL_AVX_CMP_FLT(>=, _CMP_GE_OQ,  _Tpvec, suffix)
+
+OPENCV_HAL_IMPL_AVX_CMP_OP_FLT(v_float32x8, ps)
+OPENCV_HAL_IMPL_AVX_CMP_OP_FLT(v_float64x4, pd)
+
+//////////////// Math ///////////////
+
+inline v_float32x8 v_sqrt(const v_float32x8& x)
+{ return v_float32x8(_mm256_sqrt_ps(x.val)); }
+
+inline v_float32x8 v_invsqrt(const v_float32x8& x)
+{
+    const __m256 _0_5 = _mm256_set1_ps(0.5f), _1_5 = _mm256_set1_ps(1.5f);
+    __m256 t = x.val;
+    __m256 h = _mm256_mul_ps(t, _0_5);
+    t = _mm256_rsqrt_ps(t);
+    t = _mm256_mul_ps(t, _mm256_sub_ps(_1_5, _mm256_mul_ps(_mm256_mul_ps(t, t), h)));
+    return v_float32x8(t);
+}
+
+inline v_float64x4 v_sqrt(const v_float64x4& x)
+{ return v_float64x4(_mm256_sqrt_pd(x.val)); }
+
+inline v_float64x4 v_invsqrt(const v_float64x4& x)
+{
+    const __m256d v_1 = _mm256_set1_pd(1.);
+    return v_float64x4(_mm256_div_pd(v_1, _mm256_sqrt_pd(x.val)));
+}
+
+inline v_float32x8 v_magnitude(const v_float32x8& a, const v_float32x8& b)
+{ return v_sqrt(a*a + b*b); }
+
+inline v_float64x4 v_magnitude(const v_float64x4& a, const v_float64x4& b)
+{ return v_sqrt(a*a + b*b); }
+
+inline v_float32x8 v_sqr_magnitude(const v_float32x8& a, const v_float32x8& b)
+{ return a*a + b*b; }
+
+inline v_float64x4 v_sqr_magnitude(const v_float64x4& a, const v_float64x4& b)
+{ return a*a + b*b; }
+
+#if CV_FMA3
+inline v_float32x8 v_muladd(const v_float32x8& a, const v_float32x8& b, const v_float32x8& c)
+{ return v_float32x8(_mm256_fmadd_ps(a.val, b.val, c.val)); }
+
+inline v_float64x4 v_muladd(const v_float64x4& a, const v_float64x4& b, const v_float64x4& c)
+{ return v_float64x4(_mm256_fmadd_pd(a.val, b.val, c.val)); }
+#else
+inline v_float32x8 v_muladd(const v_float32x8& a, const v_float32x8& b, const v_float32x8& c)
+{ return v_float32x8(_mm256_add_ps(_mm256_mul_ps(a.val, b.val), c.val)); }
+
+inline v_float64x4 v_muladd(const v_float64x4& a, const v_float64x4& b, const v_float64x4& c)
+{ return v_float64x4(_mm256_add_pd(_mm256_mul_pd(a.val, b.val), c.val)); }
+#endif
+
+inline v_uint8x32 v_abs(const v_int8x32& x)
+{ return v_uint8x32(_mm256_abs_epi8(x.val)); }
+
+inline v_uint16x16 v_abs(const v_int16x16& x)
+{ return v_uint16x16(_mm256_abs_epi16(x.val)); }
+
+inline v_uint32x8 v_abs(const v_int32x8& x)
+{ return v_uint32x8(_mm256_abs_epi32(x.val)); }
+
+inline v_float32x8 v_abs(const v_float32x8& x)
+{ return v_float32x8(_mm256_and_ps(x.val, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)))); }
+
+inline v_float64x4 v_abs(const v_float64x4& x)
+{ return v_float64x4(_mm256_and_pd(x.val, _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_set1_epi32(-1), 1)))); }
+
+inline v_uint8x32 v_absdiff(const v_uint8x32& a, const v_uint8x32& b)
+{ return v_uint8x32(_mm256_or_si256(_mm256_subs_epu8(a.val, b.val), _mm256_subs_epu8(b.val, a.val))); }
+
+inline v_uint16x16 v_absdiff(const v_uint16x16& a, const v_uint16x16& b)
+{ return v_uint16x16(_mm256_or_si256(_mm256_subs_epu16(a.val, b.val), _mm256_subs_epu16(b.val, a.val))); }
+
+inline v_uint32x8 v_absdiff(const v_uint32x8& a, const v_uint32x8& b)
+{ return v_max(a, b) - v_min(a, b); }
+
+inline v_uint8x32 v_absdiff(const v_int8x32& a, const v_int8x32& b)
+{ return v_uint8x32(_mm256_sub_epi8(_mm256_max_epi8(a.val, b.val), _mm256_min_epi8(a.val, b.val))); }
+
+inline v_uint16x16 v_absdiff(const v_int16x16& a, const v_int16x16& b)
+{ return v_uint16x16(_mm256_sub_epi16(_mm256_max_epi16(a.val, b.val), _mm256_min_epi16(a.val, b.val))); }
+
+inline v_uint32x8 v_absdiff(const v_int32x8& a, const v_int32x8& b)
+{ return v_uint32x8(_mm256_sub_epi32(_mm256_max_epi32(a.val, b.val), _mm256_min_epi32(a.val, b.val))); }
+
+inline v_float32x8 v_absdiff(const v_float32x8& a, const v_float32x8& b)
+{ return v_abs(a - b); }
+
+inline v_float64x4 v_absdiff(const v_float64x4& a, const v_float64x4& b)
+{ return v_abs(a - b); }
+
+//////////////// Conversions ///////////////
+
+inline v_int32x8 v_round(const v_float32x8& a)
+{ return v_int32x8(_mm256_cvtps_epi32(a.val)); }
+
+inline v_int32x8 v_trunc(const v_float32x8& a)
+{ return v_int32x8(_mm256_cvttps_epi32(a.val)); }
+
+inline v_int32x8 v_floor(const v_float32x8& a)
+{ return v_int32x8(_mm256_cvttps_epi32(_mm256_floor_ps(a.val))); }
+
+inline v_int32x8 v_ceil(const v_float32x8& a)
+{ return v_int32x8(_mm256_cvttps_epi32(_mm256_ceil_ps(a.val))); }
+
+// the double-precision versions fill the lower half of the result and zero the upper one
+inline v_int32x8 v_round(const v_float64x4& a)
+{ return v_int32x8(_v256_combine(_mm256_cvtpd_epi32(a.val), _mm_setzero_si128())); }
+
+inline v_int32x8 v_trunc(const v_float64x4& a)
+{ return v_int32x8(_v256_combine(_mm256_cvttpd_epi32(a.val), _mm_setzero_si128())); }
+
+inline v_int32x8 v_floor(const v_float64x4& a)
+{ return v_trunc(v_float64x4(_mm256_floor_pd(a.val))); }
+
+inline v_int32x8 v_ceil(const v_float64x4& a)
+{ return v_trunc(v_float64x4(_mm256_ceil_pd(a.val))); }
+
+inline v_float32x8 v_cvt_f32(const v_int32x8& a)
+{ return v_float32x8(_mm256_cvtepi32_ps(a.val)); }
+
+inline v_float32x8 v_cvt_f32(const v_float64x4& a)
+{ return v_float32x8(_v256_combine(_mm256_cvtpd_ps(a.val), _mm_setzero_ps())); }
+
+inline v_float64x4 v_cvt_f64(const v_int32x8& a)
+{ return v_float64x4(_mm256_cvtepi32_pd(_v256_extract_low(a.val))); }
+
+inline v_float64x4 v_cvt_f64_high(const v_int32x8& a)
+{ return v_float64x4(_mm256_cvtepi32_pd(_v256_extract_high(a.val))); }
+
+inline v_float64x4 v_cvt_f64(const v_float32x8& a)
+{ return v_float64x4(_mm256_cvtps_pd(_v256_extract_low(a.val))); }
+
+inline v_float64x4 v_cvt_f64_high(const v_float32x8& a)
+{ return v_float64x4(_mm256_cvtps_pd(_v256_extract_high(a.val))); }
+
+//////////////// Expand and pack ///////////////
+
+#define OPENCV_HAL_IMPL_AVX_EXPAND(_Tpvec, _Tpwvec, _Tp, intrin) \
+inline void v_expand(const _Tpvec& a, _Tpwvec& b0, _Tpwvec& b1) \
+{ \
+    b0.val = intrin(_v256_extract_low(a.val)); \
+    b1.val = intrin(_v256_extract_high(a.val)); \
+} \
+inline _Tpwvec v256_load_expand(const _Tp* ptr) \
+{ return _Tpwvec(intrin(_mm_loadu_si128((const __m128i*)ptr))); }
+
+OPENCV_HAL_IMPL_AVX_EXPAND(v_uint8x32, v_uint16x16, uchar, _mm256_cvtepu8_epi16)
+OPENCV_HAL_IMPL_AVX_EXPAND(v_int8x32, v_int16x16, schar, _mm256_cvtepi8_epi16)
+OPENCV_HAL_IMPL_AVX_EXPAND(v_uint16x16, v_uint32x8, ushort, _mm256_cvtepu16_epi32)
+OPENCV_HAL_IMPL_AVX_EXPAND(v_int16x16, v_int32x8, short, _mm256_cvtepi16_epi32)
+OPENCV_HAL_IMPL_AVX_EXPAND(v_uint32x8, v_uint64x4, unsigned, _mm256_cvtepu32_epi64)
+OPENCV_HAL_IMPL_AVX_EXPAND(v_int32x8, v_int64x4, int, _mm256_cvtepi32_epi64)
+
+inline v_uint32x8 v256_load_expand_q(const uchar* ptr)
+{ return v_uint32x8(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)ptr))); }
+
+inline v_int32x8 v256_load_expand_q(const schar* ptr)
+{ return v_int32x8(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)ptr))); }
+
+inline v_uint8x32 v_pack(const v_uint16x16& a, const v_uint16x16& b)
+{
+    __m256i delta = _mm256_set1_epi16(255);
+    return v_uint8x32(_v256_shuffle_odd_64(_mm256_packus_epi16(_mm256_min_epu16(a.val, delta),
+                                                                _mm256_min_epu16(b.val, delta))));
+}
+
+inline v_int8x32 v_pack(const v_int16x16& a, const v_int16x16& b)
+{ return v_int8x32(_v256_shuffle_odd_64(_mm256_packs_epi16(a.val, b.val))); }
+
+inline v_uint8x32 v_pack_u(const v_int16x16& a, const v_int16x16& b)
+{ return v_uint8x32(_v256_shuffle_odd_64(_mm256_packus_epi16(a.val, b.val))); }
+
+inline v_uint16x16 v_pack(const v_uint32x8& a, const v_uint32x8& b)
+{
+    __m256i delta = _mm256_set1_epi32(65535);
+    return v_uint16x16(_v256_shuffle_odd_64(_mm256_packus_epi32(_mm256_min_epu32(a.val, delta),
+                                                                 _mm256_min_epu32(b.val, delta))));
+}
+
+inline v_int16x16 v_pack(const v_int32x8& a, const v_int32x8& b)
+{ return v_int16x16(_v256_shuffle_odd_64(_mm256_packs_epi32(a.val, b.val))); }
+
+inline v_uint16x16 v_pack_u(const v_int32x8& a, const v_int32x8& b)
+{ return v_uint16x16(_v256_shuffle_odd_64(_mm256_packus_epi32(a.val, b.val))); }
+
+#define OPENCV_HAL_IMPL_AVX_PACK_STORE(_Tp, _Tpwvec, pack) \
+inline void pack##_store(_Tp* ptr, const _Tpwvec& a) \
+{ \
+    _mm_storeu_si128((__m128i*)ptr, _v256_extract_low(pack(a, a).val)); \
+}
+
+OPENCV_HAL_IMPL_AVX_PACK_STORE(uchar, v_uint16x16, v_pack)
+OPENCV_HAL_IMPL_AVX_PACK_STORE(schar, v_int16x16, v_pack)
+OPENCV_HAL_IMPL_AVX_PACK_STORE(uchar, v_int16x16, v_pack_u)
+OPENCV_HAL_IMPL_AVX_PACK_STORE(ushort, v_uint32x8, v_pack)
+OPENCV_HAL_IMPL_AVX_PACK_STORE(short, v_int32x8, v_pack)
+OPENCV_HAL_IMPL_AVX_PACK_STORE(ushort, v_int32x8, v_pack_u)
+
+#define OPENCV_HAL_IMPL_AVX_RSHR_PACK(_Tpvec, _Tpwvec, _Tpwuvec, _Tp, wsuffix, pack, srl) \
+template<int n> inline _Tpvec v_rshr_##pack(const _Tpwvec& a, const _Tpwvec& b) \
+{ \
+    __m256i delta = _mm256_set1_##wsuffix(1 << (n-1)); \
+    return v_##pack(_Tpwvec(srl(_mm256_add_##wsuffix(a.val, delta), n)), \
+                    _Tpwvec(srl(_mm256_add_##wsuffix(b.val, delta), n))); \
+} \
+template<int n> inline void v_rshr_##pack##_store(_Tp* ptr, const _Tpwvec& a) \
+{ \
+    __m256i delta = _mm256_set1_##wsuffix(1 << (n-1)); \
+    v_##pack##_store(ptr, _Tpwvec(srl(_mm256_add_##wsuffix(a.val, delta), n))); \
+}
+
+OPENCV_HAL_IMPL_AVX_RSHR_PACK(v_uint8x32, v_uint16x16, v_uint16x16, uchar, epi16, pack, _mm256_srli_epi16)
+OPENCV_HAL_IMPL_AVX_RSHR_PACK(v_int8x32, v_int16x16, v_uint16x16, schar, epi16, pack, _mm256_srai_epi16)
+OPENCV_HAL_IMPL_AVX_RSHR_PACK(v_uint8x32, v_int16x16, v_uint16x16, uchar, epi16, pack_u, _mm256_srai_epi16)
+OPENCV_HAL_IMPL_AVX_RSHR_PACK(v_uint16x16, v_uint32x8, v_uint32x8, ushort, epi32, pack, _mm256_srli_epi32)
+OPENCV_HAL_IMPL_AVX_RSHR_PACK(v_int16x16, v_int32x8, v_uint32x8, short, epi32, pack, _mm256_srai_epi32)
+OPENCV_HAL_IMPL_AVX_RSHR_PACK(v_uint16x16, v_int32x8, v_uint32x8, ushort, epi32, pack_u, _mm256_srai_epi32)
+
+//////////////// Reductions and masks ///////////////
+
+// reduce the two 128-bit halves first, then finish with the 128-bit implementation
+#define OPENCV_HAL_IMPL_AVX_REDUCE(_Tpvec, _Tpvec128, scalartype, func, intrin128) \
+inline scalartype v_reduce_##func(const _Tpvec& a) \
+{ \
+    return v_reduce_##func(_Tpvec128(intrin128(_v256_extract_low(a.val), _v256_extract_high(a.val)))); \
+}
+
+OPENCV_HAL_IMPL_AVX_REDUCE(v_uint32x8, v_uint32x4, unsigned, sum, _mm_add_epi32)
+OPENCV_HAL_IMPL_AVX_REDUCE(v_uint32x8, v_uint32x4, unsigned, max, _mm_max_epu32)
+OPENCV_HAL_IMPL_AVX_REDUCE(v_uint32x8, v_uint32x4, unsigned, min, _mm_min_epu32)
+OPENCV_HAL_IMPL_AVX_REDUCE(v_int32x8, v_int32x4, int, sum, _mm_add_epi32)
+OPENCV_HAL_IMPL_AVX_REDUCE(v_int32x8, v_int32x4, int, max, _mm_max_epi32)
+OPENCV_HAL_IMPL_AVX_REDUCE(v_int32x8, v_int32x4, int, min, _mm_min_epi32)
+OPENCV_HAL_IMPL_AVX_REDUCE(v_float32x8, v_float32x4, float, sum, _mm_add_ps)
+OPENCV_HAL_IMPL_AVX_REDUCE(v_float32x8, v_float32x4, float, max, _mm_max_ps)
+OPENCV_HAL_IMPL_AVX_REDUCE(v_float32x8, v_float32x4, float, min, _mm_min_ps)
+
+inline int v_signmask(const v_uint8x32& a) { return _mm256_movemask_epi8(a.val); }
+inline int v_signmask(const v_int8x32& a) { return _mm256_movemask_epi8(a.val); }
+
+inline int v_signmask(const v_int16x16& a)
+{
+    // packs work inside 128-bit lanes: bits 0..7 and 16..23 hold the sign bits of the elements
+    int m = _mm256_movemask_epi8(_mm256_packs_epi16(a.val, a.val));
+    return (m & 255) | ((m >> 8) & 0xff00);
+}
+inline int v_signmask(const v_uint16x16& a) { return v_signmask(v_reinterpret_as_s16(a)); }
+
+inline int v_signmask(const v_float32x8& a) { return _mm256_movemask_ps(a.val); }
+inline int v_signmask(const v_int32x8& a) { return v_signmask(v_reinterpret_as_f32(a)); }
+inline int v_signmask(const v_uint32x8& a) { return v_signmask(v_reinterpret_as_f32(a)); }
+inline int v_signmask(const v_float64x4& a) { return _mm256_movemask_pd(a.val); }
+
+#define OPENCV_HAL_IMPL_AVX_CHECK(_Tpvec, allmask) \
+inline bool v_check_all(const _Tpvec& a) { return v_signmask(a) == allmask; } \
+inline bool v_check_any(const _Tpvec& a) { return v_signmask(a) != 0; }
+
+OPENCV_HAL_IMPL_AVX_CHECK(v_uint8x32, -1)
+OPENCV_HAL_IMPL_AVX_CHECK(v_int8x32, -1)
+OPENCV_HAL_IMPL_AVX_CHECK(v_uint16x16, 0xffff)
+OPENCV_HAL_IMPL_AVX_CHECK(v_int16x16, 0xffff)
+OPENCV_HAL_IMPL_AVX_CHECK(v_uint32x8, 255)
+OPENCV_HAL_IMPL_AVX_CHECK(v_int32x8, 255)
+OPENCV_HAL_IMPL_AVX_CHECK(v_float32x8, 255)
+OPENCV_HAL_IMPL_AVX_CHECK(v_float64x4, 15)
+
+//////////////// Interleave and deinterleave ///////////////
+
+inline void v_load_deinterleave(const uchar* ptr, v_uint8x32& a, v_uint8x32& b)
+{
+    const __m256i sh = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+                                        0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    // a0..a7 b0..b7 | a8..a15 b8..b15 -> a0..a15 | b0..b15
+    __m256i p0 = _v256_shuffle_odd_64(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)ptr), sh));
+    __m256i p1 = _v256_shuffle_odd_64(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(ptr + 32)), sh));
+    a.val = _mm256_permute2x128_si256(p0, p1, 0x20);
+    b.val = _mm256_permute2x128_si256(p0, p1, 0x31);
+}
+
+inline void v_store_interleave(uchar* ptr, const v_uint8x32& a, const v_uint8x32& b)
+{
+    __m256i lo = _mm256_unpacklo_epi8(a.val, b.val); // pixels 0..7 | 16..23
+    __m256i hi = _mm256_unpackhi_epi8(a.val, b.val); // pixels 8..15 | 24..31
+    _mm256_storeu_si256((__m256i*)ptr, _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i*)(ptr + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+inline void v_load_deinterleave(const uchar* ptr, v_uint8x32& a, v_uint8x32& b,
+                                v_uint8x32& c, v_uint8x32& d)
+{
+    const __m256i sh = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+                                        0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    // every register becomes [a0..a7 | b0..b7 | c0..c7 | d0..d7] as four 64-bit blocks
+    __m256i p0 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)ptr), sh), perm);
+    __m256i p1 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(ptr + 32)), sh), perm);
+    __m256i p2 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(ptr + 64)), sh), perm);
+    __m256i p3 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(ptr + 96)), sh), perm);
+
+    __m256i ac01 = _mm256_unpacklo_epi64(p0, p1); // a0..a15 | c0..c15
+    __m256i bd01 = _mm256_unpackhi_epi64(p0, p1); // b0..b15 | d0..d15
+    __m256i ac23 = _mm256_unpacklo_epi64(p2, p3);
+    __m256i bd23 = _mm256_unpackhi_epi64(p2, p3);
+
+    a.val = _mm256_permute2x128_si256(ac01, ac23, 0x20);
+    c.val = _mm256_permute2x128_si256(ac01, ac23, 0x31);
+    b.val = _mm256_permute2x128_si256(bd01, bd23, 0x20);
+    d.val = _mm256_permute2x128_si256(bd01, bd23, 0x31);
+}
+
+inline void v_store_interleave(uchar* ptr, const v_uint8x32& a, const v_uint8x32& b,
+                               const v_uint8x32& c, const v_uint8x32& d)
+{
+    __m256i ab0 = _mm256_unpacklo_epi8(a.val, b.val); // a0 b0 .. a7 b7 | a16 b16 .. a23 b23
+    __m256i ab1 = _mm256_unpackhi_epi8(a.val, b.val); // a8 b8 .. a15 b15 | a24 b24 ..
+    __m256i cd0 = _mm256_unpacklo_epi8(c.val, d.val);
+    __m256i cd1 = _mm256_unpackhi_epi8(c.val, d.val);
+
+    __m256i p0 = _mm256_unpacklo_epi16(ab0, cd0); // pixels 0..3 | 16..19
+    __m256i p1 = _mm256_unpackhi_epi16(ab0, cd0); // pixels 4..7 | 20..23
+    __m256i p2 = _mm256_unpacklo_epi16(ab1, cd1); // pixels 8..11 | 24..27
+    __m256i p3 = _mm256_unpackhi_epi16(ab1, cd1); // pixels 12..15 | 28..31
+
+    _mm256_storeu_si256((__m256i*)ptr, _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256((__m256i*)(ptr + 32), _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256((__m256i*)(ptr + 64), _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256((__m256i*)(ptr + 96), _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+// the remaining layouts are processed as two independent 128-bit halves
+// by means of the SSE implementation
+#define OPENCV_HAL_IMPL_AVX_INTERLEAVE_3CH(_Tpvec, _Tp, _Tpvec128) \
+inline void v_load_deinterleave(const _Tp* ptr, _Tpvec& a, _Tpvec& b, _Tpvec& c) \
+{ \
+    _Tpvec128 a0, b0, c0, a1, b1, c1; \
+    v_load_deinterleave(ptr, a0, b0, c0); \
+    v_load_deinterleave(ptr + _Tpvec128::nlanes*3, a1, b1, c1); \
+    a = v256_combine(a0, a1); b = v256_combine(b0, b1); c = v256_combine(c0, c1); \
+} \
+inline void v_store_interleave(_Tp* ptr, const _Tpvec& a, const _Tpvec& b, const _Tpvec& c) \
+{ \
+    v_store_interleave(ptr, v_get_low(a), v_get_low(b), v_get_low(c)); \
+    v_store_interleave(ptr + _Tpvec128::nlanes*3, v_get_high(a), v_get_high(b), v_get_high(c)); \
+}
+
+#define OPENCV_HAL_IMPL_AVX_INTERLEAVE_4CH(_Tpvec, _Tp, _Tpvec128) \
+inline void v_load_deinterleave(const _Tp* ptr, _Tpvec& a, _Tpvec& b, _Tpvec& c, _Tpvec& d) \
+{ \
+    _Tpvec128 a0, b0, c0, d0, a1, b1, c1, d1; \
+    v_load_deinterleave(ptr, a0, b0, c0, d0); \
+    v_load_deinterleave(ptr + _Tpvec128::nlanes*4, a1, b1, c1, d1); \
+    a = v256_combine(a0, a1); b = v256_combine(b0, b1); \
+    c = v256_combine(c0, c1); d = v256_combine(d0, d1); \
+} \
+inline void v_store_interleave(_Tp* ptr, const _Tpvec& a, const _Tpvec& b, \
+                               const _Tpvec& c, const _Tpvec& d) \
+{ \
+    v_store_interleave(ptr, v_get_low(a), v_get_low(b), v_get_low(c), v_get_low(d)); \
+    v_store_interleave(ptr + _Tpvec128::nlanes*4, v_get_high(a), v_get_high(b), \
+                       v_get_high(c), v_get_high(d)); \
+}
+
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_3CH(v_uint8x32, uchar, v_uint8x16)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_3CH(v_int8x32, schar, v_int8x16)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_3CH(v_uint16x16, ushort, v_uint16x8)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_3CH(v_int16x16, short, v_int16x8)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_3CH(v_uint32x8, unsigned, v_uint32x4)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_3CH(v_int32x8, int, v_int32x4)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_3CH(v_float32x8, float, v_float32x4)
+
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_4CH(v_int8x32, schar, v_int8x16)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_4CH(v_uint16x16, ushort, v_uint16x8)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_4CH(v_int16x16, short, v_int16x8)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_4CH(v_uint32x8, unsigned, v_uint32x4)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_4CH(v_int32x8, int, v_int32x4)
+OPENCV_HAL_IMPL_AVX_INTERLEAVE_4CH(v_float32x8, float, v_float32x4)
+
+inline void v_load_deinterleave(const float* ptr, v_float32x8& a, v_float32x8& b)
+{
+    v_float32x4 a0, b0, a1, b1;
+    v_load_deinterleave(ptr, a0, b0);
+    v_load_deinterleave(ptr + 8, a1, b1);
+    a = v256_combine(a0, a1); b = v256_combine(b0, b1);
+}
+
+inline void v_store_interleave(float* ptr, const v_float32x8& a, const v_float32x8& b)
+{
+    v_store_interleave(ptr, v_get_low(a), v_get_low(b));
+    v_store_interleave(ptr + 8, v_get_high(a), v_get_high(b));
+}
+
+//! @endcond
+
+CV_CPU_OPTIMIZATION_HAL_NAMESPACE_END
+
+}
+
+#endif
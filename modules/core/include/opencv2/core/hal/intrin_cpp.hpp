@@ -53,6 +53,8 @@
 namespace cv
 {
 
+CV_CPU_OPTIMIZATION_HAL_NAMESPACE_BEGIN
+
 /** @addtogroup core_hal_intrin
 
 "Universal intrinsics" is a types and functions set intended to simplify vectorization of code on
@@ -83,6 +85,21 @@ check the CV_SIMD128_64F preprocessor definition:
 #endif
 @endcode
 
+When the code is compiled with AVX2 enabled, 256-bit counterparts of these types are also available
+(cv::v_uint8x32, cv::v_int16x16, cv::v_float32x8, cv::v_float64x4, ...). They are created with the
+v256_ prefixed functions (v256_load, v256_setall_f32, ...) and share the names of all the other
+operations with the 128-bit types. The code using them must be guarded by the CV_SIMD256
+preprocessor definition:
+@code
+#if CV_SIMD256
+    for( ; x <= len - v_float32x8::nlanes; x += v_float32x8::nlanes )
+        v_store(dst + x, v256_load(src1 + x) + v256_load(src2 + x));
+#endif
+@endcode
+Unless the whole library is built with AVX2, such code is only compiled in the files marked with
+ocv_add_dispatched_file(), which are called through CV_CPU_DISPATCH on the CPUs that support AVX2
+(see modules/core/src/split.simd.hpp for an example).
+
 ### Load and store operations
 
 These operations allow to set contents of the register explicitly or by loading it from some memory
@@ -1785,6 +1802,8 @@ static inline bool hasSIMD128()
 //! @}
 
 
+CV_CPU_OPTIMIZATION_HAL_NAMESPACE_END
+
 }
 
 #endif
@@ -51,6 +51,8 @@
 namespace cv
 {
 
+CV_CPU_OPTIMIZATION_HAL_NAMESPACE_BEGIN
+
 //! @cond IGNORED
 
 #define CV_SIMD128 1
@@ -1229,6 +1231,8 @@ static inline bool hasSIMD128()
 
 //! @endcond
 
+CV_CPU_OPTIMIZATION_HAL_NAMESPACE_END
+
 }
 
 #endif
@@ -54,6 +54,8 @@
 namespace cv
 {
 
+CV_CPU_OPTIMIZATION_HAL_NAMESPACE_BEGIN
+
 //! @cond IGNORED
 
 struct v_uint8x16
@@ -1739,6 +1741,8 @@ static inline bool hasSIMD128()
 
 //! @endcond
 
+CV_CPU_OPTIMIZATION_HAL_NAMESPACE_END
+
 }
 
 #endif
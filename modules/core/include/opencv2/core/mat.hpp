@@ -1971,6 +1971,17 @@ public:
     static MatAllocator* getStdAllocator();
     static MatAllocator* getDefaultAllocator();
     static void setDefaultAllocator(MatAllocator* allocator);
+    /** @brief the allocator which keeps the released buffers for reuse
+
+    The released buffers are kept in per-thread lists, one per size class, so frequent allocations of
+    the same size don't reach the system allocator. The pool is controlled by
+    getBufferPoolController(): the reserved size is limited by setMaxReservedSize() (128Mb by default,
+    the OPENCV_MAT_BUFFERPOOL_LIMIT environment variable overrides it) and getStatistics() reports
+    how many allocations have been served from the pool. The allocator becomes the default one if
+    OPENCV_MAT_BUFFERPOOL_LIMIT is set to a non-zero value, otherwise it is used only after
+    setDefaultAllocator(getPoolAllocator()).
+    */
+    static MatAllocator* getPoolAllocator();
 
     //! interaction with UMat
     UMatData* u;
@@ -2853,6 +2864,80 @@ public:
 
 
 
+///////////////////////////// compressed sparse row matrix /////////////////////////////
+
+/** @brief The class CsrMat represents 2D sparse matrices in the compressed sparse row (CSR) format.
+
+Unlike SparseMat, which is a hash table suited for the random insertion, CsrMat stores the non-zero
+elements of each row contiguously, sorted by the column index, which makes the row-wise iteration
+and the matrix products fast. The elements of the row i are values[k], at the columns colIdx[k],
+for rowPtr[i] <= k < rowPtr[i+1]. The matrix is usually built from a SparseMat or a dense Mat
+and then multiplied by dense matrices with cv::gemm:
+@code
+    SparseMat sparse(2, sz, CV_32F);
+    ... // fill the matrix
+    CsrMat A(sparse);
+    Mat x = ..., y;
+    gemm(A, x, 1, noArray(), 0, y);              // y = A*x
+    gemm(A, y, 1, noArray(), 0, x, GEMM_1_T);    // x = A^T*y
+@endcode
+Only the single-channel floating-point matrices (CV_32FC1 and CV_64FC1) are supported.
+ */
+class CV_EXPORTS CsrMat
+{
+public:
+    //! the default constructor
+    CsrMat();
+    /** @brief creates the rows x cols matrix of the specified type without the non-zero elements
+    @param rows the number of rows.
+    @param cols the number of columns.
+    @param type the matrix type, CV_32FC1 or CV_64FC1.
+     */
+    CsrMat(int rows, int cols, int type);
+    /** @brief converts a 2D sparse matrix to the CSR format
+    @param m the source 2D matrix of CV_32FC1 or CV_64FC1 type.
+     */
+    explicit CsrMat(const SparseMat& m);
+    /** @brief collects the non-zero elements of a dense matrix
+    @param m the source matrix of CV_32FC1 or CV_64FC1 type.
+     */
+    explicit CsrMat(const Mat& m);
+
+    //! allocates the matrix with room for nnz elements; rowPtr is filled with zeros
+    void create(int rows, int cols, int type, int nnz);
+    //! releases the data
+    void release();
+    //! returns the deep copy of the matrix
+    CsrMat clone() const;
+    //! converts the matrix to the dense one
+    void copyTo(OutputArray m) const;
+    //! converts the matrix to the 2D sparse matrix
+    void copyTo(SparseMat& m) const;
+    //! returns the transposed matrix, also in the CSR format
+    CsrMat t() const;
+
+    //! returns the value of the element (i, j), or 0 if it is not stored
+    double value(int i, int j) const;
+    //! returns the number of the stored elements
+    int nnz() const;
+    //! returns the matrix type, CV_32FC1 or CV_64FC1
+    int type() const;
+    //! returns the matrix size
+    Size size() const;
+    //! returns true if the matrix has no rows or no columns
+    bool empty() const;
+
+    int rows, cols;
+    //! 1 x nnz array of the element values
+    Mat values;
+    //! 1 x nnz array of the column indices of the elements (CV_32S)
+    Mat colIdx;
+    //! 1 x (rows + 1) array of the offsets of the rows in values and colIdx (CV_32S)
+    Mat rowPtr;
+};
+
+
+
 ////////////////////////////////// MatConstIterator //////////////////////////////////
 
 class CV_EXPORTS MatConstIterator
@@ -3366,6 +3451,14 @@ Here are examples of matrix expressions:
     Mat sharpened = img*(1+amount) + blurred*(-amount);
     img.copyTo(sharpened, lowContrastMask);
 @endcode
+
+The chains of element-wise operations (addition, subtraction, scaling, per-element multiplication and
+division, absolute value, minimum, maximum and comparison) are not evaluated operator by operator.
+Instead, they are collected into a single fused expression that is evaluated in one pass over the
+operands, tile by tile and in parallel, when it is assigned to a matrix. For example,
+`Mat mask = abs(a - b)*s + c > t;` reads a, b and c once and does not allocate any temporary
+matrices. The intermediate results are still rounded and saturated to the type they would have if
+the operations were evaluated one by one.
 */
 class CV_EXPORTS MatExpr
 {
@@ -3450,26 +3543,38 @@ CV_EXPORTS MatExpr operator / (const MatExpr& e1, const MatExpr& e2);
 CV_EXPORTS MatExpr operator < (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator < (const Mat& a, double s);
 CV_EXPORTS MatExpr operator < (double s, const Mat& a);
+CV_EXPORTS MatExpr operator < (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator < (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator <= (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator <= (const Mat& a, double s);
 CV_EXPORTS MatExpr operator <= (double s, const Mat& a);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator <= (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator == (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator == (const Mat& a, double s);
 CV_EXPORTS MatExpr operator == (double s, const Mat& a);
+CV_EXPORTS MatExpr operator == (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator == (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator != (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator != (const Mat& a, double s);
 CV_EXPORTS MatExpr operator != (double s, const Mat& a);
+CV_EXPORTS MatExpr operator != (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator != (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator >= (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator >= (const Mat& a, double s);
 CV_EXPORTS MatExpr operator >= (double s, const Mat& a);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator >= (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator > (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator > (const Mat& a, double s);
 CV_EXPORTS MatExpr operator > (double s, const Mat& a);
+CV_EXPORTS MatExpr operator > (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator > (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator & (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator & (const Mat& a, const Scalar& s);
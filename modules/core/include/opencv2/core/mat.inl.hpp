@@ -2360,6 +2360,46 @@ SparseMatConstIterator_<_Tp> SparseMat_<_Tp>::end() const
 
 
 
+///////////////////////////// CsrMat ////////////////////////////
+
+inline
+CsrMat::CsrMat()
+    : rows(0), cols(0)
+{}
+
+inline
+CsrMat::CsrMat(int _rows, int _cols, int _type)
+    : rows(0), cols(0)
+{
+    create(_rows, _cols, _type, 0);
+}
+
+inline
+int CsrMat::nnz() const
+{
+    return (int)colIdx.total();
+}
+
+inline
+int CsrMat::type() const
+{
+    return values.type();
+}
+
+inline
+Size CsrMat::size() const
+{
+    return Size(cols, rows);
+}
+
+inline
+bool CsrMat::empty() const
+{
+    return rows == 0 || cols == 0;
+}
+
+
+
 ////////////////////////// MatConstIterator /////////////////////////
 
 inline
@@ -87,7 +87,9 @@ indentation for that purpose (similar to the Python programming language).
 
 The same functions can read and write data in both formats; the particular format is determined by
 the extension of the opened file, ".xml" for XML files, ".yml" or ".yaml" for YAML and ".json" for
-JSON.
+JSON. Files with the ".cvbin" extension use a binary format, which stores the same node tree together
+with an index of the top-level nodes; the matrix elements are stored as is, so no parsing is needed to
+read them.
  */
 typedef struct CvFileStorage CvFileStorage;
 typedef struct CvFileNode CvFileNode;
@@ -315,9 +317,15 @@ public:
         FORMAT_XML  = (1<<3), //!< flag, XML format
         FORMAT_YAML = (2<<3), //!< flag, YAML format
         FORMAT_JSON = (3<<3), //!< flag, JSON format
+        FORMAT_BINARY = (4<<3), //!< flag, binary format (files only, appending is not supported)
 
         BASE64      = 64,     //!< flag, write rawdata in Base64 by default. (consider using WRITE_BASE64)
         WRITE_BASE64 = BASE64 | WRITE, //!< flag, enable both WRITE and BASE64
+        LAZY        = 128,    //!< flag, index the top-level nodes (and the elements of the top-level plain
+                              //!< maps in XML/YAML/JSON) on opening and parse each of them on the first
+                              //!< access; the file is read through a memory mapping. The storage must
+                              //!< not be accessed from several threads concurrently. The matrices read from
+                              //!< a binary storage refer to its (copy-on-write) mapping instead of copying it.
     };
     enum
     {
@@ -133,6 +133,28 @@ namespace cv
     // Returns a static string if there is a parallel framework,
     // NULL otherwise.
     CV_EXPORTS const char* currentParallelFramework();
+
+    // The time per element measured for one call site of parallel_for_, from which the number of
+    // stripes of its next calls is chosen (see OPENCV_PARALLEL_ADAPTIVE_STRIPES)
+    struct CV_EXPORTS ParallelStripeStats
+    {
+        ParallelStripeStats() : ticksPerElem(-1.), calls(0) {}
+
+        // counts the call and returns true if it should be timed: the first ones, then one in sampleInterval
+        bool sample();
+        // adds the time the call on len elements took
+        void update(int len, int64 ticks);
+        // returns the number of stripes for len elements, nstripes while nothing has been measured
+        double stripes(int len, double ticksPerSecond, double nstripes) const;
+
+        double ticksPerElem;
+        unsigned calls;
+
+        static const double minParallelTime;
+        static const double stripeTime;
+        static const unsigned warmupCalls;
+        static const unsigned sampleInterval;
+    };
 } //namespace cv
 
 /****************************************************************************************\
@@ -438,13 +460,38 @@ namespace cv
 {
 namespace instr
 {
+// a finished region recorded with FLAGS_TIMELINE
+struct InstrTimelineEvent
+{
+    const char* name;
+    uint64      begin;
+    uint64      end;
+    TYPE        instrType;
+    IMPL        implType;
+};
+
+// ring buffer of the regions finished by one thread; only that thread writes into it
+struct InstrTimeline
+{
+    InstrTimeline(int _threadId, int capacity, int _generation)
+        : threadId(_threadId), generation(_generation), written(0), sync(0), events(capacity) {}
+
+    int                              threadId;
+    int                              generation; // resetTrace() call the buffer has been cleared after
+    volatile uint64                  written; // the number of the recorded regions
+    volatile int                     sync;    // updated atomically to publish the recorded region
+    std::vector<InstrTimelineEvent>  events;
+};
+
 struct InstrTLSStruct
 {
     InstrTLSStruct()
     {
         pCurrentNode = NULL;
+        pTimeline    = NULL;
     }
-    InstrNode* pCurrentNode;
+    InstrNode*     pCurrentNode;
+    InstrTimeline* pTimeline;
 };
 
 class InstrStruct
@@ -455,19 +502,30 @@ public:
         useInstr    = false;
         flags       = FLAGS_MAPPING;
         maxDepth    = 0;
+        timelineCapacity = 1 << 16;
+        timelineGeneration = 0;
 
         rootNode.m_payload = NodeData("ROOT", NULL, 0, NULL, false, TYPE_GENERAL, IMPL_PLAIN);
         tlsStruct.get()->pCurrentNode = &rootNode;
     }
+    ~InstrStruct()
+    {
+        for(size_t i = 0; i < timelines.size(); i++)
+            delete timelines[i];
+    }
 
     Mutex mutexCreate;
     Mutex mutexCount;
+    Mutex mutexTimeline;
 
     bool       useInstr;
     int        flags;
     int        maxDepth;
+    int        timelineCapacity;
+    volatile int timelineGeneration; // incremented by resetTrace(), the threads clear their buffers themselves
     InstrNode  rootNode;
     TLSData<InstrTLSStruct> tlsStruct;
+    std::vector<InstrTimeline*> timelines; // the buffers of all the threads, they outlive the threads
 };
 
 class CV_EXPORTS IntrumentationRegion
@@ -481,6 +539,8 @@ private:
     uint64  m_regionTicks;
 };
 
+InstrTimeline*          getInstrumentTimeline();
+
 CV_EXPORTS InstrStruct& getInstrumentStruct();
 InstrTLSStruct&         getInstrumentTLSStruct();
 CV_EXPORTS InstrNode*   getCurrentNode();
@@ -1670,8 +1670,10 @@ typedef struct CvFileStorage CvFileStorage;
 #define CV_STORAGE_FORMAT_XML    8
 #define CV_STORAGE_FORMAT_YAML  16
 #define CV_STORAGE_FORMAT_JSON  24
+#define CV_STORAGE_FORMAT_BINARY 32
 #define CV_STORAGE_BASE64       64
 #define CV_STORAGE_WRITE_BASE64  (CV_STORAGE_BASE64 | CV_STORAGE_WRITE)
+#define CV_STORAGE_LAZY        128
 
 /** @brief List of attributes. :
 
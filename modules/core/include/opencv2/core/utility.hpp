@@ -239,6 +239,58 @@ The exact meaning of return value depends on the threading framework used by Ope
  */
 CV_EXPORTS_W int getThreadNum();
 
+/** @brief Pins the worker threads of the current thread pool to the given logical CPUs.
+
+The pool is restarted with one thread per listed CPU: the thread calling parallel_for_ takes part
+in the loop as well, so it should be pinned by the application to the first CPU of the list.
+The CPUs are reordered by the NUMA node they belong to, and the idle threads steal the work from
+the threads of the same node first. An empty list removes the pinning and restores the default
+number of threads.
+
+The initial affinity of the default pool can be set with the OPENCV_THREAD_AFFINITY environment
+variable, which accepts a CPU list ("0-7,16-23") or a list of NUMA nodes ("node:0,1").
+
+Only the pthreads backend on Linux supports the affinity; with the other frameworks the call is
+ignored.
+@param cpus Indices of the logical CPUs.
+@sa getThreadAffinity, setThreadPool, getNumaNodeCPUs
+ */
+CV_EXPORTS void setThreadAffinity(const std::vector<int>& cpus);
+
+/** @brief Returns the CPUs the current thread pool is pinned to, or an empty list if it is not pinned.
+@sa setThreadAffinity
+ */
+CV_EXPORTS void getThreadAffinity(std::vector<int>& cpus);
+
+/** @brief Selects the thread pool used by parallel_for_ called from the current thread.
+
+The pools are created on demand and are independent: each one has its own worker threads, number
+of threads and affinity, so that several application threads (e.g. one per NUMA node) can run
+their parallel loops without competing for the same workers. setNumThreads and setThreadAffinity
+apply to the pool selected by the calling thread. Pool 0 is the default one.
+
+Only the pthreads backend supports several pools; with the other frameworks the call is ignored.
+@param pool Index of the pool.
+@sa getThreadPool
+ */
+CV_EXPORTS void setThreadPool(int pool);
+
+/** @brief Returns the index of the thread pool selected by the current thread.
+@sa setThreadPool
+ */
+CV_EXPORTS int getThreadPool();
+
+/** @brief Returns the number of NUMA nodes of the system (1 if the topology is not known).
+ */
+CV_EXPORTS int getNumberOfNumaNodes();
+
+/** @brief Returns the logical CPUs of the given NUMA node.
+@param node Index of the node, 0 <= node < getNumberOfNumaNodes(). The nodes are numbered in the order of
+the system ids of the online nodes, which may have gaps.
+@param cpus The output list of the CPUs.
+ */
+CV_EXPORTS void getNumaNodeCPUs(int node, std::vector<int>& cpus);
+
 /** @brief Returns full configuration time cmake output.
 
 Returned value is raw cmake output including version control system revision, compiler version,
@@ -474,9 +526,96 @@ public:
 };
 
 /** @brief Parallel data processor
+
+@param range The range of indices to process.
+@param body The body called for the parts of the range.
+@param nstripes The number of parts the range is split into. By default (nstripes \<= 0) the
+number is chosen at run time from the time the previous calls of the same body type with the ranges
+of similar length took: the cheap loops are executed by the calling thread, the expensive ones are
+split into the stripes of about 20 microseconds of work.
 */
 CV_EXPORTS void parallel_for_(const Range& range, const ParallelLoopBody& body, double nstripes=-1.);
 
+/** @brief Base class for tasks executed by parallel_async
+*/
+class CV_EXPORTS ParallelTask
+{
+public:
+    virtual ~ParallelTask();
+    virtual void operator() () = 0;
+};
+
+/** @brief Handle of a task started by parallel_async
+
+The handle is a reference to the task: all the copies refer to the same task. The task is kept alive
+by the library until it has finished even if all the handles have been released.
+*/
+class CV_EXPORTS AsyncTask
+{
+public:
+    AsyncTask();
+
+    //! returns true if the handle refers to a task
+    bool valid() const;
+
+    //! returns true if the task has finished, successfully or not
+    bool ready() const;
+
+    /** @brief Waits until the task has finished.
+
+    The exception thrown by the task, or by any of the tasks it depends on, is rethrown here. While
+    waiting, the calling thread executes the tasks that are queued, so it is fine to wait for a task
+    from inside another one.
+    */
+    void wait() const;
+
+    struct Impl;
+    Ptr<Impl> p;
+};
+
+/** @brief Runs the task asynchronously
+
+The task is executed by the thread pool used by parallel_for_ once all the dependencies have finished.
+Any parallel_for_ called by the task shares the same pool, so several tasks which process big data
+can overlap without oversubscribing the CPU. If one of the dependencies fails the task is not executed
+and wait() rethrows the error of the dependency.
+
+When OpenCV is built with a parallel framework other than pthreads, or when it runs in one thread
+(see setNumThreads), the task is executed by the calling thread as soon as its dependencies are done.
+
+@param task the task to execute
+@param dependencies tasks which must finish before the task starts; invalid handles are ignored
+
+Example:
+@code
+    Mat gray, edges;
+    AsyncTask t1 = parallel_async(makeParallelTask([&]() { cvtColor(frame, gray, COLOR_BGR2GRAY); }));
+    AsyncTask t2 = parallel_async(makeParallelTask([&]() { Canny(gray, edges, 50, 150); }),
+                                  std::vector<AsyncTask>(1, t1));
+    ... // decode the next frame meanwhile
+    t2.wait();
+@endcode
+*/
+CV_EXPORTS AsyncTask parallel_async(const Ptr<ParallelTask>& task,
+                                    const std::vector<AsyncTask>& dependencies = std::vector<AsyncTask>());
+
+template<typename Functor> class ParallelTaskFunctor : public ParallelTask
+{
+public:
+    ParallelTaskFunctor(const Functor& _f) : f(_f) {}
+    virtual void operator() () { f(); }
+protected:
+    Functor f;
+};
+
+/** @brief Wraps a functor without arguments (a function pointer, a functional object, a lambda) into a ParallelTask
+*/
+template<typename Functor> static inline
+Ptr<ParallelTask> makeParallelTask(const Functor& f)
+{
+    return makePtr<ParallelTaskFunctor<Functor> >(f);
+}
+
 /////////////////////////////// forEach method of cv::Mat ////////////////////////////
 template<typename _Tp, typename Functor> inline
 void Mat::forEach_impl(const Functor& operation) {
@@ -1155,11 +1294,29 @@ enum FLAGS
     FLAGS_NONE              = 0,
     FLAGS_MAPPING           = 0x01,
     FLAGS_EXPAND_SAME_NAMES = 0x02,
+    FLAGS_TIMELINE          = 0x04, // record the begin and the end of every region, see dumpTimeline
 };
 
 CV_EXPORTS void       setFlags(FLAGS modeFlags);
 static inline void    setFlags(int modeFlags) { setFlags((FLAGS)modeFlags); }
 CV_EXPORTS FLAGS      getFlags();
+
+/** @brief Sets the number of the regions kept for every thread when FLAGS_TIMELINE is set.
+
+The regions are recorded into per-thread ring buffers, so only the latest ones are kept. The new
+capacity applies to the threads which have not recorded anything yet (and to all of them after
+resetTrace).
+ */
+CV_EXPORTS void       setTimelineCapacity(int regions);
+
+/** @brief Writes the regions recorded with FLAGS_TIMELINE in the Chrome trace event format.
+
+The file can be opened with chrome://tracing or Perfetto UI. Every thread gets its own timeline, the
+implementation (plain, IPP or OpenCL) is used as the event category. The function should be called
+when no instrumented code is running. Returns false if the instrumentation is not available or the
+file can't be written.
+ */
+CV_EXPORTS bool       dumpTimeline(const String& filename);
 }
 
 } //namespace cv
@@ -270,3 +270,18 @@ PERF_TEST_P(Size_MatType, reciprocal, TYPICAL_MATS_CORE_ARITHM)
 
     SANITY_CHECK_NOTHING();
 }
+
+PERF_TEST_P(Size_MatType, fusedExpr, testing::Combine(
+                testing::Values(TYPICAL_MAT_SIZES_CORE_ARITHM),
+                testing::Values(CV_8UC1, CV_16SC1, CV_32FC1)))
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    cv::Mat a(sz, type), b(sz, type), c(sz, type), d(sz, type);
+
+    declare.in(a, b, c, WARMUP_RNG).out(d);
+
+    TEST_CYCLE() d = abs(a - b)*0.5 + c.mul(a, 1./255) - b;
+
+    SANITY_CHECK_NOTHING();
+}
@@ -38,6 +38,49 @@ PERF_TEST_P(Size_MatType_FlagsType_NzeroRows, dft, TEST_MATS_DFT)
     SANITY_CHECK(dst, 1e-5, ERROR_RELATIVE);
 }
 
+typedef std::tr1::tuple<Size, MatType> Size_MatType_t;
+typedef perf::TestBaseWithParam<Size_MatType_t> Size_MatType;
+
+PERF_TEST_P(Size_MatType, dft_small, testing::Combine(
+                                     testing::Values(cv::Size(8, 8), cv::Size(16, 16), cv::Size(64, 1),
+                                                     cv::Size(32, 32), cv::Size(64, 64), cv::Size(128, 128)),
+                                     testing::Values(CV_32FC1, CV_32FC2)))
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    // the per-call overhead dominates for the small transforms
+    TEST_CYCLE_MULTIRUN(100) dft(src, dst);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Size_MatType, dftBatch, testing::Combine(
+                                    testing::Values(cv::Size(32, 32), cv::Size(128, 128), cv::Size(320, 240)),
+                                    testing::Values(CV_32FC1, CV_32FC2)))
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    const int batchSize = 64;
+
+    std::vector<Mat> src(batchSize), dst(batchSize);
+    for (int i = 0; i < batchSize; i++)
+    {
+        src[i].create(sz, type);
+        dst[i].create(sz, type);
+        declare.in(src[i], WARMUP_RNG);
+    }
+
+    TEST_CYCLE() dftBatch(src, dst);
+
+    SANITY_CHECK_NOTHING();
+}
+
 ///////////////////////////////////////////////////////dct//////////////////////////////////////////////////////
 
 CV_ENUM(DCT_FlagsType, 0, DCT_INVERSE , DCT_ROWS, DCT_INVERSE|DCT_ROWS)
@@ -0,0 +1,93 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+using std::tr1::tuple;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(GemmFlagType, 0, GEMM_1_T, GEMM_2_T, GEMM_3_T, GEMM_1_T|GEMM_2_T)
+
+typedef tuple<int, MatType, GemmFlagType> GemmParams;
+typedef TestBaseWithParam<GemmParams> GemmFixture;
+
+PERF_TEST_P(GemmFixture, gemm,
+            testing::Combine(
+                testing::Values(64, 128, 256, 512, 1024),
+                testing::Values(CV_32FC1, CV_64FC1, CV_32FC2, CV_64FC2),
+                GemmFlagType::all()
+                )
+            )
+{
+    const int n = get<0>(GetParam());
+    const int type = get<1>(GetParam()), flags = get<2>(GetParam());
+
+    Mat a(n, n, type), b(n, n, type), c(n, n, type), d(n, n, type);
+
+    declare.in(a, b, c, WARMUP_RNG).out(d);
+    declare.time(100);
+
+    TEST_CYCLE() cv::gemm(a, b, 0.5, c, 1.5, d, flags);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef tuple<int, int> GemmThreadsParams;
+typedef TestBaseWithParam<GemmThreadsParams> GemmThreadsFixture;
+
+PERF_TEST_P(GemmThreadsFixture, gemm_scaling,
+            testing::Combine(
+                testing::Values(512, 1024, 2048),
+                testing::Values(1, 2, 4, 8, 16)
+                )
+            )
+{
+    const int n = get<0>(GetParam()), threads = get<1>(GetParam());
+
+    Mat a(n, n, CV_32FC1), b(n, n, CV_32FC1), d(n, n, CV_32FC1);
+
+    declare.in(a, b, WARMUP_RNG).out(d);
+    declare.time(300);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() cv::gemm(a, b, 1.0, noArray(), 0.0, d);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef tuple<int, int, int> CsrGemmParams;
+typedef TestBaseWithParam<CsrGemmParams> CsrGemmFixture;
+
+PERF_TEST_P(CsrGemmFixture, gemm_csr,
+            testing::Combine(
+                testing::Values(1, 16),         // columns of the dense matrix
+                testing::Values(0, GEMM_1_T),
+                testing::Values(1, 2, 4)        // threads
+                )
+            )
+{
+    const int k = get<0>(GetParam()), flags = get<1>(GetParam()), threads = get<2>(GetParam());
+    const int n = 100000, nnzPerRow = 16;
+
+    // a random graph-like matrix with nnzPerRow elements in each row
+    int sz[] = { n, n };
+    SparseMat sparse(2, sz, CV_32F);
+    RNG& rng = theRNG();
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < nnzPerRow; j++)
+            sparse.ref<float>(i, rng.uniform(0, n)) = rng.uniform(-1.f, 1.f);
+    CsrMat a(sparse);
+
+    Mat b(n, k, CV_32F), d(n, k, CV_32F);
+    declare.in(b, WARMUP_RNG).out(d);
+    declare.time(100);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() cv::gemm(a, b, 1.0, noArray(), 0.0, d, flags);
+
+    SANITY_CHECK_NOTHING();
+}
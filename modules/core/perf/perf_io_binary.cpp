@@ -0,0 +1,100 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<cv::Size, MatType> Size_MatType_t;
+typedef TestBaseWithParam<Size_MatType_t> Size_MatType;
+
+#define MAT_SIZES      ::perf::sz1080p
+#define MAT_TYPES      CV_8UC1, CV_32FC1, CV_32FC3
+
+
+PERF_TEST_P(Size_MatType, fs_binary_write,
+            testing::Combine(testing::Values(MAT_SIZES),
+                             testing::Values(MAT_TYPES))
+             )
+{
+    Size   size = get<0>(GetParam());
+    int    type = get<1>(GetParam());
+
+    Mat src(size.height, size.width, type);
+    declare.in(src, WARMUP_RNG);
+
+    cv::String file_name = cv::tempfile(".cvbin");
+    cv::String key       = "test_mat";
+
+    TEST_CYCLE_MULTIRUN(2)
+    {
+        FileStorage fs(file_name, cv::FileStorage::WRITE);
+        fs << key << src;
+        fs.release();
+    }
+
+    remove(file_name.c_str());
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Size_MatType, fs_binary_read,
+            testing::Combine(testing::Values(MAT_SIZES),
+                             testing::Values(MAT_TYPES))
+             )
+{
+    Size   size = get<0>(GetParam());
+    int    type = get<1>(GetParam());
+
+    Mat src(size.height, size.width, type);
+    Mat dst = src.clone();
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    cv::String file_name = cv::tempfile(".cvbin");
+    cv::String key       = "test_mat";
+    {
+        FileStorage fs(file_name, cv::FileStorage::WRITE);
+        fs << key << src;
+    }
+
+    TEST_CYCLE_MULTIRUN(2)
+    {
+        FileStorage fs(file_name, cv::FileStorage::READ);
+        fs[key] >> dst;
+        fs.release();
+    }
+
+    remove(file_name.c_str());
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Size_MatType, fs_binary_read_lazy,
+            testing::Combine(testing::Values(MAT_SIZES),
+                             testing::Values(MAT_TYPES))
+             )
+{
+    Size   size = get<0>(GetParam());
+    int    type = get<1>(GetParam());
+
+    Mat src(size.height, size.width, type);
+    Mat dst = src.clone();
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    cv::String file_name = cv::tempfile(".cvbin");
+    cv::String key       = "test_mat";
+    {
+        FileStorage fs(file_name, cv::FileStorage::WRITE);
+        fs << key << src;
+    }
+
+    TEST_CYCLE_MULTIRUN(2)
+    {
+        FileStorage fs(file_name, cv::FileStorage::READ + cv::FileStorage::LAZY);
+        fs[key] >> dst;
+        fs.release();
+    }
+
+    dst.release();
+    remove(file_name.c_str());
+    SANITY_CHECK_NOTHING();
+}
@@ -96,3 +96,32 @@ PERF_TEST_P(Size_MatType, Mat_Clone_Roi,
 
     SANITY_CHECK(destination, 1);
 }
+
+CV_ENUM(MatAllocatorType, 0, 1)
+
+typedef std::tr1::tuple<Size, MatAllocatorType> Size_Allocator_t;
+typedef perf::TestBaseWithParam<Size_Allocator_t> Size_Allocator;
+
+// a loop which creates temporary matrices of the frame size, as a typical processing pipeline does
+PERF_TEST_P(Size_Allocator, Mat_create_release,
+            testing::Combine(testing::Values(szVGA, sz1080p),
+                             MatAllocatorType::all())
+             )
+{
+    Size size = get<0>(GetParam());
+    MatAllocator* a = (int)get<1>(GetParam()) ? Mat::getPoolAllocator() : Mat::getStdAllocator();
+    Mat src(size, CV_8UC3, Scalar::all(1));
+
+    declare.in(src);
+
+    TEST_CYCLE_MULTIRUN(10)
+    {
+        Mat tmp, dst;
+        tmp.allocator = a;
+        dst.allocator = a;
+        src.convertTo(tmp, CV_32F);
+        tmp.convertTo(dst, CV_8U);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
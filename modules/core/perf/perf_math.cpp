@@ -83,3 +83,70 @@ PERF_TEST_P( MaxDim_MaxPoints, kmeans,
 
     SANITY_CHECK(sortedClusterPointsNumber);
 }
+
+CV_ENUM(KMeansMode, 0, KMEANS_ELKAN, KMEANS_HAMERLY, KMEANS_USE_GEMM, KMEANS_MINI_BATCH,
+        KMEANS_MINI_BATCH + KMEANS_USE_GEMM)
+
+typedef std::tr1::tuple<KMeansMode, int, int> KMeansMode_Dims_K_t;
+typedef perf::TestBaseWithParam<KMeansMode_Dims_K_t> KMeansMode_Dims_K;
+
+PERF_TEST_P( KMeansMode_Dims_K, kmeans_large,
+             testing::Combine( KMeansMode::all(),
+                               testing::Values( 16, 128 ),
+                               testing::Values( 64, 256 ) ) )
+{
+    const int mode = get<0>(GetParam());
+    const int dims = get<1>(GetParam());
+    const int K = get<2>(GetParam());
+    const int N = 50000;
+    RNG& rng = theRNG();
+
+    // the samples around 2*K random points, so the clusters are not trivial
+    Mat data0(2*K, dims, CV_32F), data(N, dims, CV_32F), initLabels(N, 1, CV_32S);
+    rng.fill(data0, RNG::UNIFORM, -10, 10);
+    for( int i = 0; i < N; i++ )
+    {
+        Mat sample = data.row(i);
+        rng.fill(sample, RNG::NORMAL, 0, 2);
+        sample += data0.row(rng.uniform(0, data0.rows));
+    }
+    rng.fill(initLabels, RNG::UNIFORM, 0, K);
+
+    declare.in(data).time(300);
+
+    Mat labels, centers;
+    TEST_CYCLE()
+    {
+        initLabels.copyTo(labels);
+        kmeans(data, K, labels, TermCriteria(TermCriteria::MAX_ITER+TermCriteria::EPS, 30, 0),
+               1, KMEANS_USE_INITIAL_LABELS | mode, centers);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef std::tr1::tuple<int, int> MatSize_EigenCount_t;
+typedef perf::TestBaseWithParam<MatSize_EigenCount_t> MatSize_EigenCount;
+
+PERF_TEST_P( MatSize_EigenCount, eigen_symmetric,
+             testing::Combine( testing::Values( 32, 128, 512 ),
+                               testing::Values( 0, 16 ) ) )
+{
+    const int n = get<0>(GetParam());
+    const int count = get<1>(GetParam());
+
+    Mat a(n, n, CV_64F), src, evals, evects;
+    declare.in(a, WARMUP_RNG).time(60);
+    src = a + a.t();
+
+    if( count > 0 )
+    {
+        TEST_CYCLE() eigen(src, evals, evects, count);
+    }
+    else
+    {
+        TEST_CYCLE() eigen(src, evals, evects);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
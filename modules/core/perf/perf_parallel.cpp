@@ -0,0 +1,150 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+using std::tr1::tuple;
+using std::tr1::get;
+
+namespace {
+
+// with the triangular load the cost of the rows grows linearly, the last stripes are the heaviest ones
+class RowLoad : public ParallelLoopBody
+{
+public:
+    RowLoad(const Mat& _src, Mat& _dst, bool _triangular) : src(&_src), dst(&_dst), triangular(_triangular) {}
+
+    void operator()(const Range& r) const
+    {
+        for (int y = r.start; y < r.end; y++)
+        {
+            const float* s = src->ptr<float>(y);
+            float* d = dst->ptr<float>(y);
+            int len = triangular ? (int)((int64)src->cols * (y + 1) / src->rows) : src->cols;
+            for (int x = 0; x < len; x++)
+                d[x] = std::sqrt(std::abs(s[x])) + std::exp(-s[x]*s[x]);
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    bool triangular;
+};
+
+// every row is processed by a nested parallel_for_, like a pipeline stage calling another OpenCV function
+class NestedLoad : public ParallelLoopBody
+{
+public:
+    NestedLoad(const Mat& _src, Mat& _dst, int _blocks) : src(&_src), dst(&_dst), blocks(_blocks) {}
+
+    void operator()(const Range& r) const
+    {
+        int rowsPerBlock = src->rows / blocks;
+        for (int b = r.start; b < r.end; b++)
+        {
+            Range rows(b * rowsPerBlock, b == blocks - 1 ? src->rows : (b + 1) * rowsPerBlock);
+            Mat s = src->rowRange(rows), d = dst->rowRange(rows);
+            parallel_for_(Range(0, s.rows), RowLoad(s, d, true));
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    int blocks;
+};
+
+}
+
+CV_ENUM(ParallelLoadType, 0, 1, 2)
+
+typedef tuple<ParallelLoadType, int> ParallelParams;
+typedef TestBaseWithParam<ParallelParams> ParallelFixture;
+
+// 0 - uniform load, 1 - triangular load, 2 - nested triangular loads
+PERF_TEST_P(ParallelFixture, parallel_for_scaling,
+            testing::Combine(
+                ParallelLoadType::all(),
+                testing::Values(1, 2, 4, 8, 16)
+                )
+            )
+{
+    const int loadType = get<0>(GetParam()), threads = get<1>(GetParam());
+
+    Mat src(1024, 1024, CV_32FC1), dst(src.size(), src.type(), Scalar::all(0));
+
+    declare.in(src, WARMUP_RNG).out(dst);
+    declare.time(100);
+
+    declare.tbb_threads(threads);
+
+    if (loadType == 0)
+    {
+        TEST_CYCLE() parallel_for_(Range(0, src.rows), RowLoad(src, dst, false));
+    }
+    else if (loadType == 1)
+    {
+        TEST_CYCLE() parallel_for_(Range(0, src.rows), RowLoad(src, dst, true));
+    }
+    else
+    {
+        TEST_CYCLE() parallel_for_(Range(0, 8), NestedLoad(src, dst, 8));
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+// the same rows go to the same pinned threads from one call to another
+PERF_TEST_P(ParallelFixture, parallel_for_pinned,
+            testing::Combine(
+                testing::Values((int)0),
+                testing::Values(2, 4, 8, 16)
+                )
+            )
+{
+    const int threads = get<1>(GetParam());
+
+    std::vector<int> cpus, node_cpus;
+    for (int node = 0; node < getNumberOfNumaNodes(); node++)
+    {
+        getNumaNodeCPUs(node, node_cpus);
+        cpus.insert(cpus.end(), node_cpus.begin(), node_cpus.end());
+    }
+    cpus.resize(std::min((int)cpus.size(), threads));
+
+    std::vector<int> prevCpus;
+    getThreadAffinity(prevCpus);
+    setThreadAffinity(cpus);
+
+    // the buffers are created by the pinned pool, so their rows are local to the threads
+    Mat src(4096, 1024, CV_32FC1), dst(src.size(), src.type(), Scalar::all(0));
+
+    declare.in(src, WARMUP_RNG).out(dst);
+    declare.time(100);
+
+    TEST_CYCLE() parallel_for_(Range(0, src.rows), RowLoad(src, dst, false));
+
+    setThreadAffinity(prevCpus);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef TestBaseWithParam<Size> ParallelSmallFixture;
+
+// the loops too small to be worth waking the pool up run on the calling thread
+PERF_TEST_P(ParallelSmallFixture, parallel_for_small,
+            testing::Values(Size(16, 16), Size(64, 64), Size(128, 128), Size(640, 480))
+            )
+{
+    const Size sz = GetParam();
+
+    Mat src(sz, CV_32FC1), dst(src.size(), src.type(), Scalar::all(0));
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() parallel_for_(Range(0, src.rows), RowLoad(src, dst, false));
+
+    SANITY_CHECK_NOTHING();
+}
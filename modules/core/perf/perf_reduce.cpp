@@ -66,3 +66,36 @@ PERF_TEST_P(Size_MatType_ROp, reduceC,
 
     SANITY_CHECK(vec, 1);
 }
+
+typedef std::tr1::tuple<MatType, ROp, int, int> MatType_ROp_Dim_Threads_t;
+typedef perf::TestBaseWithParam<MatType_ROp_Dim_Threads_t> MatType_ROp_Dim_Threads;
+
+PERF_TEST_P(MatType_ROp_Dim_Threads, reduce_scaling,
+            testing::Combine(
+                testing::Values(CV_8UC1, CV_32FC1),
+                testing::Values((int)CV_REDUCE_SUM, (int)CV_REDUCE_MAX),
+                testing::Values(0, 1),
+                testing::Values(1, 2, 4)
+                )
+            )
+{
+    int matType = get<0>(GetParam());
+    int reduceOp = get<1>(GetParam());
+    int dim = get<2>(GetParam());
+    int threads = get<3>(GetParam());
+
+    int ddepth = -1;
+    if( CV_MAT_DEPTH(matType) < CV_32S && reduceOp == CV_REDUCE_SUM )
+        ddepth = CV_32S;
+
+    Mat src(sz2160p, matType);
+    Mat vec;
+
+    declare.in(src, WARMUP_RNG).out(vec);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() reduce(src, vec, dim, reduceOp, ddepth);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -50,3 +50,51 @@ PERF_TEST_P(sortIdxFixture, sorIdx, TYPICAL_MATS_SORT)
 
     SANITY_CHECK_NOTHING();
 }
+
+// the short rows go through the sorting network, the long ones through the radix sort
+typedef tuple<Size, MatType, int> sortScalingParams;
+typedef TestBaseWithParam<sortScalingParams> sortScalingFixture;
+
+PERF_TEST_P(sortScalingFixture, sort_scaling,
+            testing::Combine(
+                testing::Values(Size(8, 200000), Size(16, 100000), Size(4096, 512)),
+                testing::Values(CV_8UC1, CV_16SC1, CV_32FC1, CV_64FC1),
+                testing::Values(1, 2, 4)
+                )
+            )
+{
+    const Size sz = get<0>(GetParam());
+    const int type = get<1>(GetParam()), threads = get<2>(GetParam());
+
+    cv::Mat a(sz, type), b(sz, type);
+
+    declare.in(a, WARMUP_RNG).out(b);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() cv::sort(a, b, SORT_EVERY_ROW | SORT_ASCENDING);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(sortScalingFixture, sortIdx_scaling,
+            testing::Combine(
+                testing::Values(Size(16, 100000), Size(4096, 512)),
+                testing::Values(CV_8UC1, CV_32FC1),
+                testing::Values(1, 2, 4)
+                )
+            )
+{
+    const Size sz = get<0>(GetParam());
+    const int type = get<1>(GetParam()), threads = get<2>(GetParam());
+
+    cv::Mat a(sz, type), b(sz, CV_32SC1);
+
+    declare.in(a, WARMUP_RNG).out(b);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() cv::sortIdx(a, b, SORT_EVERY_ROW | SORT_ASCENDING);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -50,9 +50,41 @@
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
 
+#include "arithm.simd.hpp"
+#include "arithm.simd_declarations.hpp" // generated by ocv_add_dispatched_file(), see CMakeLists.txt
+
 namespace cv
 {
 
+/****************************************************************************************\
+*                            256-bit kernels of Div_SIMD/Recip_SIMD                      *
+\****************************************************************************************/
+
+int divWide(const uchar* src1, const uchar* src2, uchar* dst, int width, double scale)
+{
+    CV_CPU_DISPATCH(divWide, (src1, src2, dst, width, scale));
+}
+
+int divWide(const float* src1, const float* src2, float* dst, int width, double scale)
+{
+    CV_CPU_DISPATCH(divWide, (src1, src2, dst, width, scale));
+}
+
+int divWide(const double* src1, const double* src2, double* dst, int width, double scale)
+{
+    CV_CPU_DISPATCH(divWide, (src1, src2, dst, width, scale));
+}
+
+int recipWide(const float* src2, float* dst, int width, double scale)
+{
+    CV_CPU_DISPATCH(recipWide, (src2, dst, width, scale));
+}
+
+int recipWide(const double* src2, double* dst, int width, double scale)
+{
+    CV_CPU_DISPATCH(recipWide, (src2, dst, width, scale));
+}
+
 /****************************************************************************************\
 *                                   logical operations                                   *
 \****************************************************************************************/
@@ -0,0 +1,219 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+// The 256-bit kernels of the division and reciprocal (Div_SIMD and Recip_SIMD in arithm_simd.hpp).
+// The file is compiled into the regular build (the cpu_baseline namespace, via arithm.cpp) and once
+// more for each instruction set listed in ocv_add_dispatched_file() of modules/core/CMakeLists.txt.
+// Without CV_SIMD256 the functions process nothing.
+
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv {
+CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN
+
+// process the first width elements as far as the 256-bit kernels go,
+// returns the number of processed elements
+int divWide(const uchar* src1, const uchar* src2, uchar* dst, int width, double scale);
+int divWide(const float* src1, const float* src2, float* dst, int width, double scale);
+int divWide(const double* src1, const double* src2, double* dst, int width, double scale);
+int recipWide(const float* src2, float* dst, int width, double scale);
+int recipWide(const double* src2, double* dst, int width, double scale);
+
+#ifndef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+#if CV_SIMD256
+
+int divWide(const uchar* src1, const uchar* src2, uchar* dst, int width, double scale)
+{
+    int x = 0;
+    v_float32x8 v_scale = v256_setall_f32((float)scale);
+    v_uint16x16 v_zero = v256_setzero_u16();
+
+    for ( ; x <= width - 16; x += 16)
+    {
+        v_uint16x16 v_src1 = v256_load_expand(src1 + x);
+        v_uint16x16 v_src2 = v256_load_expand(src2 + x);
+
+        v_uint32x8 t0, t1, t2, t3;
+        v_expand(v_src1, t0, t1);
+        v_expand(v_src2, t2, t3);
+
+        v_float32x8 f0 = v_cvt_f32(v_reinterpret_as_s32(t0));
+        v_float32x8 f1 = v_cvt_f32(v_reinterpret_as_s32(t1));
+
+        v_float32x8 f2 = v_cvt_f32(v_reinterpret_as_s32(t2));
+        v_float32x8 f3 = v_cvt_f32(v_reinterpret_as_s32(t3));
+
+        f0 = f0 * v_scale / f2;
+        f1 = f1 * v_scale / f3;
+
+        v_int32x8 i0 = v_round(f0), i1 = v_round(f1);
+        v_uint16x16 res = v_pack_u(i0, i1);
+
+        res = v_select(v_src2 == v_zero, v_zero, res);
+        v_pack_store(dst + x, res);
+    }
+
+    return x;
+}
+
+int divWide(const float* src1, const float* src2, float* dst, int width, double scale)
+{
+    int x = 0;
+    v_float32x8 v_scale = v256_setall_f32((float)scale);
+    v_float32x8 v_zero = v256_setzero_f32();
+
+    for ( ; x <= width - 16; x += 16)
+    {
+        v_float32x8 f0 = v256_load(src1 + x);
+        v_float32x8 f1 = v256_load(src1 + x + 8);
+        v_float32x8 f2 = v256_load(src2 + x);
+        v_float32x8 f3 = v256_load(src2 + x + 8);
+
+        v_float32x8 res0 = f0 * v_scale / f2;
+        v_float32x8 res1 = f1 * v_scale / f3;
+
+        res0 = v_select(f2 == v_zero, v_zero, res0);
+        res1 = v_select(f3 == v_zero, v_zero, res1);
+
+        v_store(dst + x, res0);
+        v_store(dst + x + 8, res1);
+    }
+
+    return x;
+}
+
+int recipWide(const float* src2, float* dst, int width, double scale)
+{
+    int x = 0;
+    v_float32x8 v_scale = v256_setall_f32((float)scale);
+    v_float32x8 v_zero = v256_setzero_f32();
+
+    for ( ; x <= width - 16; x += 16)
+    {
+        v_float32x8 f0 = v256_load(src2 + x);
+        v_float32x8 f1 = v256_load(src2 + x + 8);
+
+        v_float32x8 res0 = v_scale / f0;
+        v_float32x8 res1 = v_scale / f1;
+
+        res0 = v_select(f0 == v_zero, v_zero, res0);
+        res1 = v_select(f1 == v_zero, v_zero, res1);
+
+        v_store(dst + x, res0);
+        v_store(dst + x + 8, res1);
+    }
+
+    return x;
+}
+
+#else
+
+int divWide(const uchar*, const uchar*, uchar*, int, double) { return 0; }
+int divWide(const float*, const float*, float*, int, double) { return 0; }
+int recipWide(const float*, float*, int, double) { return 0; }
+
+#endif
+
+#if CV_SIMD256_64F
+
+int divWide(const double* src1, const double* src2, double* dst, int width, double scale)
+{
+    int x = 0;
+    v_float64x4 v_scale = v256_setall_f64(scale);
+    v_float64x4 v_zero = v256_setzero_f64();
+
+    for ( ; x <= width - 8; x += 8)
+    {
+        v_float64x4 f0 = v256_load(src1 + x);
+        v_float64x4 f1 = v256_load(src1 + x + 4);
+        v_float64x4 f2 = v256_load(src2 + x);
+        v_float64x4 f3 = v256_load(src2 + x + 4);
+
+        v_float64x4 res0 = f0 * v_scale / f2;
+        v_float64x4 res1 = f1 * v_scale / f3;
+
+        res0 = v_select(f2 == v_zero, v_zero, res0);
+        res1 = v_select(f3 == v_zero, v_zero, res1);
+
+        v_store(dst + x, res0);
+        v_store(dst + x + 4, res1);
+    }
+
+    return x;
+}
+
+int recipWide(const double* src2, double* dst, int width, double scale)
+{
+    int x = 0;
+    v_float64x4 v_scale = v256_setall_f64(scale);
+    v_float64x4 v_zero = v256_setzero_f64();
+
+    for ( ; x <= width - 8; x += 8)
+    {
+        v_float64x4 f0 = v256_load(src2 + x);
+        v_float64x4 f1 = v256_load(src2 + x + 4);
+
+        v_float64x4 res0 = v_scale / f0;
+        v_float64x4 res1 = v_scale / f1;
+
+        res0 = v_select(f0 == v_zero, v_zero, res0);
+        res1 = v_select(f1 == v_zero, v_zero, res1);
+
+        v_store(dst + x, res0);
+        v_store(dst + x + 4, res1);
+    }
+
+    return x;
+}
+
+#else
+
+int divWide(const double*, const double*, double*, int, double) { return 0; }
+int recipWide(const double*, double*, int, double) { return 0; }
+
+#endif
+
+#endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+CV_CPU_OPTIMIZATION_NAMESPACE_END
+} // cv::
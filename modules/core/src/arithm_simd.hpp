@@ -49,6 +49,14 @@ namespace cv {
 
 struct NOP {};
 
+// the 256-bit kernels from arithm.simd.hpp for the CPUs that support them, see arithm.cpp;
+// return the number of processed elements
+int divWide(const uchar* src1, const uchar* src2, uchar* dst, int width, double scale);
+int divWide(const float* src1, const float* src2, float* dst, int width, double scale);
+int divWide(const double* src1, const double* src2, double* dst, int width, double scale);
+int recipWide(const float* src2, float* dst, int width, double scale);
+int recipWide(const double* src2, double* dst, int width, double scale);
+
 #if CV_SSE2 || CV_NEON
 #define IF_SIMD(op) op
 #else
@@ -1206,6 +1214,8 @@ struct Div_SIMD<uchar>
         if (!haveSIMD)
             return x;
 
+        x = divWide(src1, src2, dst, width, scale);
+
         v_float32x4 v_scale = v_setall_f32((float)scale);
         v_uint16x8 v_zero = v_setzero_u16();
 
@@ -1432,6 +1442,8 @@ struct Div_SIMD<float>
         if (!haveSIMD)
             return x;
 
+        x = divWide(src1, src2, dst, width, scale);
+
         v_float32x4 v_scale = v_setall_f32((float)scale);
         v_float32x4 v_zero = v_setzero_f32();
 
@@ -1674,6 +1686,8 @@ struct Recip_SIMD<float>
         if (!haveSIMD)
             return x;
 
+        x = recipWide(src2, dst, width, scale);
+
         v_float32x4 v_scale = v_setall_f32((float)scale);
         v_float32x4 v_zero = v_setzero_f32();
 
@@ -1711,6 +1725,8 @@ struct Div_SIMD<double>
         if (!haveSIMD)
             return x;
 
+        x = divWide(src1, src2, dst, width, scale);
+
         v_float64x2 v_scale = v_setall_f64(scale);
         v_float64x2 v_zero = v_setzero_f64();
 
@@ -1724,8 +1740,8 @@ struct Div_SIMD<double>
             v_float64x2 res0 = f0 * v_scale / f2;
             v_float64x2 res1 = f1 * v_scale / f3;
 
-            res0 = v_select(f0 == v_zero, v_zero, res0);
-            res1 = v_select(f1 == v_zero, v_zero, res1);
+            res0 = v_select(f2 == v_zero, v_zero, res0);
+            res1 = v_select(f3 == v_zero, v_zero, res1);
 
             v_store(dst + x, res0);
             v_store(dst + x + 2, res1);
@@ -1748,6 +1764,8 @@ struct Recip_SIMD<double>
         if (!haveSIMD)
             return x;
 
+        x = recipWide(src2, dst, width, scale);
+
         v_float64x2 v_scale = v_setall_f64(scale);
         v_float64x2 v_zero = v_setzero_f64();
 
@@ -46,6 +46,9 @@
 #include "opencl_kernels_core.hpp"
 #include "opencv2/core/hal/intrin.hpp"
 
+#include "convert.simd.hpp"
+#include "convert.simd_declarations.hpp" // generated by ocv_add_dispatched_file(), see CMakeLists.txt
+
 #include "opencv2/core/openvx/ovx_defs.hpp"
 
 #ifdef __APPLE__
@@ -3852,6 +3855,31 @@ struct Cvt_SIMD<double, float>
     }
 };
 
+// to/from float, the 256-bit kernels from convert.simd.hpp for the CPUs that support them
+
+#define CVT_SIMD_WIDE(src_type, dst_type)                                       \
+static int cvtWide(const src_type * src, dst_type * dst, int width)             \
+{                                                                               \
+    CV_CPU_DISPATCH(cvtWide, (src, dst, width));                                \
+}                                                                               \
+                                                                                \
+template <>                                                                     \
+struct Cvt_SIMD<src_type, dst_type>                                             \
+{                                                                               \
+    int operator() (const src_type * src, dst_type * dst, int width) const      \
+    {                                                                           \
+        return cvtWide(src, dst, width);                                        \
+    }                                                                           \
+}
+
+CVT_SIMD_WIDE(uchar, float);
+CVT_SIMD_WIDE(ushort, float);
+CVT_SIMD_WIDE(short, float);
+CVT_SIMD_WIDE(int, float);
+CVT_SIMD_WIDE(float, uchar);
+CVT_SIMD_WIDE(float, ushort);
+CVT_SIMD_WIDE(float, int);
+
 
 #elif CV_NEON
 
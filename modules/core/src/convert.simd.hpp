@@ -0,0 +1,157 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+// The 256-bit kernels of the conversions to and from float (Cvt_SIMD in convert.cpp). The file is
+// compiled into the regular build (the cpu_baseline namespace, via convert.cpp) and once more for
+// each instruction set listed in ocv_add_dispatched_file() of modules/core/CMakeLists.txt.
+// Without CV_SIMD256 the functions process nothing.
+
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv {
+CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN
+
+// convert the first width elements as far as the 256-bit kernels go,
+// returns the number of processed elements
+int cvtWide(const uchar* src, float* dst, int width);
+int cvtWide(const ushort* src, float* dst, int width);
+int cvtWide(const short* src, float* dst, int width);
+int cvtWide(const int* src, float* dst, int width);
+int cvtWide(const float* src, uchar* dst, int width);
+int cvtWide(const float* src, ushort* dst, int width);
+int cvtWide(const float* src, int* dst, int width);
+
+#ifndef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+#if CV_SIMD256
+
+int cvtWide(const uchar* src, float* dst, int width)
+{
+    int x = 0;
+    for ( ; x <= width - 16; x += 16)
+    {
+        v_uint32x8 v_src0, v_src1;
+        v_expand(v256_load_expand(src + x), v_src0, v_src1);
+        v_store(dst + x, v_cvt_f32(v_reinterpret_as_s32(v_src0)));
+        v_store(dst + x + 8, v_cvt_f32(v_reinterpret_as_s32(v_src1)));
+    }
+    return x;
+}
+
+int cvtWide(const ushort* src, float* dst, int width)
+{
+    int x = 0;
+    for ( ; x <= width - 16; x += 16)
+    {
+        v_uint32x8 v_src0, v_src1;
+        v_expand(v256_load(src + x), v_src0, v_src1);
+        v_store(dst + x, v_cvt_f32(v_reinterpret_as_s32(v_src0)));
+        v_store(dst + x + 8, v_cvt_f32(v_reinterpret_as_s32(v_src1)));
+    }
+    return x;
+}
+
+int cvtWide(const short* src, float* dst, int width)
+{
+    int x = 0;
+    for ( ; x <= width - 16; x += 16)
+    {
+        v_int32x8 v_src0, v_src1;
+        v_expand(v256_load(src + x), v_src0, v_src1);
+        v_store(dst + x, v_cvt_f32(v_src0));
+        v_store(dst + x + 8, v_cvt_f32(v_src1));
+    }
+    return x;
+}
+
+int cvtWide(const int* src, float* dst, int width)
+{
+    int x = 0;
+    for ( ; x <= width - 8; x += 8)
+        v_store(dst + x, v_cvt_f32(v256_load(src + x)));
+    return x;
+}
+
+int cvtWide(const float* src, uchar* dst, int width)
+{
+    int x = 0;
+    for ( ; x <= width - 32; x += 32)
+    {
+        v_int16x16 v_dst0 = v_pack(v_round(v256_load(src + x)), v_round(v256_load(src + x + 8)));
+        v_int16x16 v_dst1 = v_pack(v_round(v256_load(src + x + 16)), v_round(v256_load(src + x + 24)));
+        v_store(dst + x, v_pack_u(v_dst0, v_dst1));
+    }
+    return x;
+}
+
+int cvtWide(const float* src, ushort* dst, int width)
+{
+    int x = 0;
+    for ( ; x <= width - 16; x += 16)
+        v_store(dst + x, v_pack_u(v_round(v256_load(src + x)), v_round(v256_load(src + x + 8))));
+    return x;
+}
+
+int cvtWide(const float* src, int* dst, int width)
+{
+    int x = 0;
+    for ( ; x <= width - 8; x += 8)
+        v_store(dst + x, v_round(v256_load(src + x)));
+    return x;
+}
+
+#else
+
+int cvtWide(const uchar*, float*, int) { return 0; }
+int cvtWide(const ushort*, float*, int) { return 0; }
+int cvtWide(const short*, float*, int) { return 0; }
+int cvtWide(const int*, float*, int) { return 0; }
+int cvtWide(const float*, uchar*, int) { return 0; }
+int cvtWide(const float*, ushort*, int) { return 0; }
+int cvtWide(const float*, int*, int) { return 0; }
+
+#endif
+
+#endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+CV_CPU_OPTIMIZATION_NAMESPACE_END
+} // cv::
@@ -3320,41 +3320,198 @@ Ptr<DFT2D> DFT2D::create(int width, int height, int depth,
 } // cv::
 
 
-void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
+namespace cv {
+
+struct DftPlanKey
 {
-    CV_INSTRUMENT_REGION()
+    int width, height, depth, src_channels, dst_channels, flags, nonzero_rows;
+    bool useIpp;
 
-#ifdef HAVE_CLAMDFFT
-    CV_OCL_RUN(ocl::haveAmdFft() && ocl::Device::getDefault().type() != ocl::Device::TYPE_CPU &&
-            _dst.isUMat() && _src0.dims() <= 2 && nonzero_rows == 0,
-               ocl_dft_amdfft(_src0, _dst, flags))
-#endif
+    bool operator == (const DftPlanKey& k) const
+    {
+        return width == k.width && height == k.height && depth == k.depth &&
+            src_channels == k.src_channels && dst_channels == k.dst_channels &&
+            flags == k.flags && nonzero_rows == k.nonzero_rows && useIpp == k.useIpp;
+    }
+};
 
-#ifdef HAVE_OPENCL
-    CV_OCL_RUN(_dst.isUMat() && _src0.dims() <= 2,
-               ocl_dft(_src0, _dst, flags, nonzero_rows))
-#endif
+// The recently used transforms of one thread. A plan keeps the twiddle factors and the working
+// buffers, so it is reused by the subsequent calls with the same parameters, but it can't be
+// shared between threads. The plans of all the threads take at most OPENCV_DFT_PLAN_CACHE_LIMIT
+// bytes (16MB by default): a thread evicts its least recently used plans to make room for a new
+// one, and a plan that still doesn't fit is used once and dropped. MAX_PLANS only keeps the lookup
+// short. setNumThreads() frees the plans of all the threads, including the stopped pool threads,
+// whose thread-local data is not released until the process exits.
+class DftPlanCache
+{
+public:
+    enum { MAX_PLANS = 16 };
 
-    Mat src0 = _src0.getMat(), src = src0;
+    struct Plan
+    {
+        DftPlanKey key;
+        Ptr<hal::DFT2D> impl;
+        int size;
+        bool busy;
+    };
+
+    ~DftPlanCache() { clear(); }
+
+    void apply(const Mat& src, Mat& dst, int flags, int nonzero_rows)
+    {
+        DftPlanKey key;
+        key.width = src.cols;
+        key.height = src.rows;
+        key.depth = src.depth();
+        key.src_channels = src.channels();
+        key.dst_channels = dst.channels();
+        key.flags = flags;
+        key.nonzero_rows = nonzero_rows;
+        key.useIpp = ipp::useIPP();
+
+        // the plan is not available to the nested calls (e.g. made by other tasks executed
+        // by this thread while the transform waits for its own parallel loop)
+        Ptr<hal::DFT2D> impl = acquire(key);
+        if( !impl )
+        {
+            impl = hal::DFT2D::create(key.width, key.height, key.depth,
+                                      key.src_channels, key.dst_channels, flags, nonzero_rows);
+            insert(key, impl);
+        }
+
+        try
+        {
+            impl->apply(src.data, src.step, dst.data, dst.step);
+        }
+        catch (...)
+        {
+            release(impl);
+            throw;
+        }
+        release(impl);
+    }
+
+    // frees the plans which are not in use; may be called from any thread
+    void clear()
+    {
+        AutoLock lock(mutex);
+        for( size_t i = plans.size(); i > 0; i-- )
+            if( !plans[i-1].busy )
+                evict(i-1);
+    }
+
+protected:
+    Ptr<hal::DFT2D> acquire(const DftPlanKey& key)
+    {
+        AutoLock lock(mutex);
+        for( size_t i = 0; i < plans.size(); i++ )
+            if( plans[i].key == key && !plans[i].busy )
+            {
+                // keep the most recently used plans in front, the last one is evicted first
+                std::rotate(plans.begin(), plans.begin() + i, plans.begin() + i + 1);
+                plans[0].busy = true;
+                return plans[0].impl;
+            }
+        return Ptr<hal::DFT2D>();
+    }
+
+    void insert(const DftPlanKey& key, const Ptr<hal::DFT2D>& impl)
+    {
+        Plan plan;
+        plan.key = key;
+        plan.impl = impl;
+        plan.size = planSize(key);
+        plan.busy = true;
+
+        AutoLock lock(mutex);
+        int limit = sizeLimit();
+        for( size_t i = plans.size(); i > 0 && (plans.size() >= MAX_PLANS ||
+             CV_XADD(&totalSize, 0) + plan.size > limit); i-- )
+            if( !plans[i-1].busy )
+                evict(i-1);
+
+        if( plan.size > limit || plans.size() >= MAX_PLANS )
+            return;
+        if( CV_XADD(&totalSize, plan.size) + plan.size > limit )
+        {
+            // the other threads have taken the room meanwhile
+            CV_XADD(&totalSize, -plan.size);
+            return;
+        }
+        plans.insert(plans.begin(), plan);
+    }
+
+    void release(const Ptr<hal::DFT2D>& impl)
+    {
+        AutoLock lock(mutex);
+        for( size_t i = 0; i < plans.size(); i++ )
+            if( plans[i].impl == impl )
+                plans[i].busy = false;
+    }
+
+    // called with the mutex locked
+    void evict(size_t i)
+    {
+        CV_XADD(&totalSize, -plans[i].size);
+        plans.erase(plans.begin() + i);
+    }
+
+    // the twiddle factors, the index tables and the row buffers of both stages, approximately
+    static int planSize(const DftPlanKey& key)
+    {
+        size_t complexSize = key.depth == CV_32F ? sizeof(Complexf) : sizeof(Complexd);
+        size_t size = ((size_t)key.width + key.height)*(complexSize*4 + sizeof(int)) + 1024;
+        return (int)std::min(size, (size_t)INT_MAX/2);
+    }
+
+    static int sizeLimit()
+    {
+        static size_t limit = getConfigurationParameterForSize("OPENCV_DFT_PLAN_CACHE_LIMIT", (size_t)16 << 20);
+        return (int)std::min(limit, (size_t)INT_MAX/4);
+    }
+
+    std::vector<Plan> plans;
+    Mutex mutex;
+
+    // the size of the plans of all the threads
+    static int totalSize;
+};
+
+int DftPlanCache::totalSize = 0;
+
+static TLSData<DftPlanCache>& getDftPlanCache()
+{
+    CV_SINGLETON_LAZY_INIT_REF(TLSData<DftPlanCache>, new TLSData<DftPlanCache>())
+}
+
+void releaseDftPlans()
+{
+    std::vector<DftPlanCache*> caches;
+    getDftPlanCache().gather(caches);
+    for( size_t i = 0; i < caches.size(); i++ )
+        caches[i]->clear();
+}
+
+static int dftDstType( int type, int flags )
+{
     bool inv = (flags & DFT_INVERSE) != 0;
-    int type = src.type();
-    int depth = src.depth();
+    int depth = CV_MAT_DEPTH(type);
 
     CV_Assert( type == CV_32FC1 || type == CV_32FC2 || type == CV_64FC1 || type == CV_64FC2 );
 
-    if( !inv && src.channels() == 1 && (flags & DFT_COMPLEX_OUTPUT) )
-        _dst.create( src.size(), CV_MAKETYPE(depth, 2) );
-    else if( inv && src.channels() == 2 && (flags & DFT_REAL_OUTPUT) )
-        _dst.create( src.size(), depth );
-    else
-        _dst.create( src.size(), type );
-
-    Mat dst = _dst.getMat();
+    if( !inv && CV_MAT_CN(type) == 1 && (flags & DFT_COMPLEX_OUTPUT) )
+        return CV_MAKETYPE(depth, 2);
+    if( inv && CV_MAT_CN(type) == 2 && (flags & DFT_REAL_OUTPUT) )
+        return depth;
+    return type;
+}
 
+static void dftApply( const Mat& src, Mat& dst, int flags, int nonzero_rows )
+{
     int f = 0;
     if (src.isContinuous() && dst.isContinuous())
         f |= CV_HAL_DFT_IS_CONTINUOUS;
-    if (inv)
+    if (flags & DFT_INVERSE)
         f |= CV_HAL_DFT_INVERSE;
     if (flags & DFT_ROWS)
         f |= CV_HAL_DFT_ROWS;
@@ -3362,8 +3519,86 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
         f |= CV_HAL_DFT_SCALE;
     if (src.data == dst.data)
         f |= CV_HAL_DFT_IS_INPLACE;
-    Ptr<hal::DFT2D> c = hal::DFT2D::create(src.cols, src.rows, depth, src.channels(), dst.channels(), f, nonzero_rows);
-    c->apply(src.data, src.step, dst.data, dst.step);
+    getDftPlanCache().get()->apply(src, dst, f, nonzero_rows);
+}
+
+class DftBatchInvoker : public ParallelLoopBody
+{
+public:
+    DftBatchInvoker(const std::vector<Mat>& _src, std::vector<Mat>& _dst, int _flags, int _nonzero_rows) :
+        src(_src), dst(_dst), flags(_flags), nonzero_rows(_nonzero_rows)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+            dftApply(src[i], dst[i], flags, nonzero_rows);
+    }
+
+private:
+    const std::vector<Mat>& src;
+    std::vector<Mat>& dst;
+    int flags;
+    int nonzero_rows;
+
+    DftBatchInvoker& operator=(const DftBatchInvoker&);
+};
+
+}
+
+void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
+{
+    CV_INSTRUMENT_REGION()
+
+#ifdef HAVE_CLAMDFFT
+    CV_OCL_RUN(ocl::haveAmdFft() && ocl::Device::getDefault().type() != ocl::Device::TYPE_CPU &&
+            _dst.isUMat() && _src0.dims() <= 2 && nonzero_rows == 0,
+               ocl_dft_amdfft(_src0, _dst, flags))
+#endif
+
+#ifdef HAVE_OPENCL
+    CV_OCL_RUN(_dst.isUMat() && _src0.dims() <= 2,
+               ocl_dft(_src0, _dst, flags, nonzero_rows))
+#endif
+
+    Mat src = _src0.getMat();
+
+    _dst.create( src.size(), dftDstType(src.type(), flags) );
+    Mat dst = _dst.getMat();
+
+    dftApply(src, dst, flags, nonzero_rows);
+}
+
+
+void cv::dftBatch( InputArrayOfArrays _src, OutputArrayOfArrays _dst, int flags, int nonzero_rows )
+{
+    CV_INSTRUMENT_REGION()
+
+    std::vector<Mat> src;
+    _src.getMatVector(src);
+    int i, n = (int)src.size();
+    if( n == 0 )
+    {
+        _dst.release();
+        return;
+    }
+
+    int type = src[0].type(), dtype = dftDstType(type, flags);
+    for( i = 1; i < n; i++ )
+        CV_Assert( src[i].size == src[0].size && src[i].type() == type );
+    CV_Assert( src[0].dims <= 2 );
+
+    CV_Assert( _dst.isMatVector() );
+    _dst.create(n, 1, dtype);
+    std::vector<Mat> dst(n);
+    for( i = 0; i < n; i++ )
+    {
+        _dst.create(src[i].dims, src[i].size.p, dtype, i);
+        dst[i] = _dst.getMat(i);
+    }
+
+    parallel_for_(Range(0, n), DftBatchInvoker(src, dst, flags, nonzero_rows));
 }
 
 
@@ -212,6 +212,532 @@ private:
     const Mat& centers;
 };
 
+enum { KMEANS_GEMM_ROWS = 64, KMEANS_GEMM_CENTERS = 256, KMEANS_MINI_BATCH_SIZE = 1024 };
+
+/*
+The distances are computed through matrix multiplication: |x - c|^2 = |x|^2 - 2*x*c + |c|^2.
+The samples and the centers are processed in blocks, so both blocks stay in cache. The product
+loses the precision when the data is far from the origin comparing to the cluster size, so the
+samples and the centers are shifted by the mean of the centers before the multiplication, and
+the distance to the found closest center is computed directly.
+*/
+class KMeansDistanceComputerGEMM : public ParallelLoopBody
+{
+public:
+    KMeansDistanceComputerGEMM( double *_distances,
+                                int *_labels,
+                                const Mat& _data,
+                                const Mat& _centers,
+                                const Mat& _shiftedCenters,
+                                const float* _origin,
+                                const float* _halfNorms )
+        : distances(_distances),
+          labels(_labels),
+          data(_data),
+          centers(_centers),
+          shiftedCenters(_shiftedCenters),
+          origin(_origin),
+          halfNorms(_halfNorms)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int N = data.rows;
+        const int K = centers.rows;
+        const int dims = centers.cols;
+        float minDist[KMEANS_GEMM_ROWS];
+        Mat samples(KMEANS_GEMM_ROWS, dims, CV_32F), prod;
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            const int i0 = b*KMEANS_GEMM_ROWS, i1 = std::min(i0 + KMEANS_GEMM_ROWS, N);
+            Mat block = samples.rowRange(0, i1 - i0);
+
+            for( int i = i0; i < i1; i++ )
+            {
+                const float* sample = data.ptr<float>(i);
+                float* s = block.ptr<float>(i - i0);
+                for( int j = 0; j < dims; j++ )
+                    s[j] = sample[j] - origin[j];
+                minDist[i - i0] = FLT_MAX;
+                labels[i] = 0;
+            }
+
+            for( int k0 = 0; k0 < K; k0 += KMEANS_GEMM_CENTERS )
+            {
+                const int k1 = std::min(k0 + KMEANS_GEMM_CENTERS, K);
+                gemm(block, shiftedCenters.rowRange(k0, k1), 1, noArray(), 0, prod, GEMM_2_T);
+
+                for( int i = i0; i < i1; i++ )
+                {
+                    // |x - c|^2/2 - |x|^2/2
+                    const float* p = prod.ptr<float>(i - i0) - k0;
+                    float d0 = minDist[i - i0];
+                    int k_best = labels[i];
+                    for( int k = k0; k < k1; k++ )
+                    {
+                        float d = halfNorms[k] - p[k];
+                        if( d0 > d )
+                        {
+                            d0 = d;
+                            k_best = k;
+                        }
+                    }
+                    minDist[i - i0] = d0;
+                    labels[i] = k_best;
+                }
+            }
+
+            for( int i = i0; i < i1; i++ )
+                distances[i] = normL2Sqr(data.ptr<float>(i), centers.ptr<float>(labels[i]), dims);
+        }
+    }
+
+private:
+    KMeansDistanceComputerGEMM& operator=(const KMeansDistanceComputerGEMM&); // to quiet MSVC
+
+    double *distances;
+    int *labels;
+    const Mat& data;
+    const Mat& centers;
+    const Mat& shiftedCenters;
+    const float* origin;
+    const float* halfNorms;
+};
+
+static void assignLabels( const Mat& data, const Mat& centers, int* labels, double* distances, bool useGEMM )
+{
+    const int N = data.rows, K = centers.rows, dims = centers.cols;
+    if( useGEMM )
+    {
+        Mat origin, shiftedCenters;
+        reduce(centers, origin, 0, REDUCE_AVG);
+        subtract(centers, repeat(origin, K, 1), shiftedCenters);
+
+        std::vector<float> halfNorms(K);
+        for( int k = 0; k < K; k++ )
+        {
+            const float* center = shiftedCenters.ptr<float>(k);
+            float s = 0.f;
+            for( int j = 0; j < dims; j++ )
+                s += center[j]*center[j];
+            halfNorms[k] = 0.5f*s;
+        }
+        parallel_for_(Range(0, (N + KMEANS_GEMM_ROWS - 1)/KMEANS_GEMM_ROWS),
+                      KMeansDistanceComputerGEMM(distances, labels, data, centers, shiftedCenters,
+                                                 origin.ptr<float>(), &halfNorms[0]));
+    }
+    else
+        parallel_for_(Range(0, N),
+                      KMeansDistanceComputer(distances, labels, data, centers));
+}
+
+/*
+The distances between the centers, needed for the bounds of Elkan and Hamerly:
+halfMinDist[k] is the half of the distance from the k-th center to the closest other center,
+halfDist (Elkan only) keeps the half distances between all the pairs of the centers.
+*/
+class KMeansCenterDistanceComputer : public ParallelLoopBody
+{
+public:
+    KMeansCenterDistanceComputer( const Mat& _centers, float* _halfMinDist, Mat* _halfDist )
+        : centers(_centers), halfMinDist(_halfMinDist), halfDist(_halfDist)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int K = centers.rows;
+        const int dims = centers.cols;
+
+        for( int a = range.start; a < range.end; a++ )
+        {
+            const float* center = centers.ptr<float>(a);
+            float* hd = halfDist ? halfDist->ptr<float>(a) : 0;
+            float minDist = FLT_MAX;
+            for( int k = 0; k < K; k++ )
+            {
+                float d = k == a ? 0.f : 0.5f*std::sqrt(normL2Sqr(center, centers.ptr<float>(k), dims));
+                if( hd )
+                    hd[k] = d;
+                if( k != a )
+                    minDist = std::min(minDist, d);
+            }
+            halfMinDist[a] = minDist;
+        }
+    }
+
+private:
+    KMeansCenterDistanceComputer& operator=(const KMeansCenterDistanceComputer&); // to quiet MSVC
+
+    const Mat& centers;
+    float* halfMinDist;
+    Mat* halfDist;
+};
+
+/*
+Hamerly (2010) Making k-means even faster.
+Every sample keeps a lower bound of the distance to the second closest center. The distance to
+the assigned center is computed on every iteration, the other centers are checked only if it
+exceeds the bound or the half distance to the closest other center.
+*/
+class KMeansHamerlyComputer : public ParallelLoopBody
+{
+public:
+    KMeansHamerlyComputer( double *_distances,
+                           int *_labels,
+                           float *_lower,
+                           const Mat& _data,
+                           const Mat& _centers,
+                           const float* _halfMinDist,
+                           int _maxShiftIdx, float _maxShift, float _maxShift2,
+                           bool _full )
+        : distances(_distances),
+          labels(_labels),
+          lower(_lower),
+          data(_data),
+          centers(_centers),
+          halfMinDist(_halfMinDist),
+          maxShiftIdx(_maxShiftIdx),
+          maxShift(_maxShift),
+          maxShift2(_maxShift2),
+          full(_full)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int K = centers.rows;
+        const int dims = centers.cols;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const float *sample = data.ptr<float>(i);
+            if( !full )
+            {
+                int a = labels[i];
+                float l = std::max(lower[i] - (a == maxShiftIdx ? maxShift2 : maxShift), 0.f);
+                float d = normL2Sqr(sample, centers.ptr<float>(a), dims);
+                lower[i] = l;
+                distances[i] = d;
+                if( std::sqrt(d) <= std::max(l, halfMinDist[a]) )
+                    continue;
+            }
+
+            int k_best = 0;
+            float min_dist = FLT_MAX, min_dist2 = FLT_MAX;
+            for( int k = 0; k < K; k++ )
+            {
+                float d = normL2Sqr(sample, centers.ptr<float>(k), dims);
+                if( min_dist > d )
+                {
+                    min_dist2 = min_dist;
+                    min_dist = d;
+                    k_best = k;
+                }
+                else if( min_dist2 > d )
+                    min_dist2 = d;
+            }
+
+            distances[i] = min_dist;
+            labels[i] = k_best;
+            lower[i] = std::sqrt(min_dist2);
+        }
+    }
+
+private:
+    KMeansHamerlyComputer& operator=(const KMeansHamerlyComputer&); // to quiet MSVC
+
+    double *distances;
+    int *labels;
+    float *lower;
+    const Mat& data;
+    const Mat& centers;
+    const float* halfMinDist;
+    int maxShiftIdx;
+    float maxShift, maxShift2;
+    bool full;
+};
+
+/*
+Elkan (2003) Using the triangle inequality to accelerate k-means.
+Every sample keeps a lower bound of the distance to every center, so it takes N*K floats.
+The distance to the center c is computed only if it can be closer than the current one
+according to the bound and to the distance between the centers.
+*/
+class KMeansElkanComputer : public ParallelLoopBody
+{
+public:
+    KMeansElkanComputer( double *_distances,
+                         int *_labels,
+                         Mat& _lower,
+                         const Mat& _data,
+                         const Mat& _centers,
+                         const float* _halfMinDist,
+                         const Mat& _halfDist,
+                         const float* _shift,
+                         bool _full )
+        : distances(_distances),
+          labels(_labels),
+          lower(_lower),
+          data(_data),
+          centers(_centers),
+          halfMinDist(_halfMinDist),
+          halfDist(_halfDist),
+          shift(_shift),
+          full(_full)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int K = centers.rows;
+        const int dims = centers.cols;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const float *sample = data.ptr<float>(i);
+            float* l = lower.ptr<float>(i);
+
+            if( full )
+            {
+                int k_best = 0;
+                float min_dist = FLT_MAX;
+                for( int k = 0; k < K; k++ )
+                {
+                    float d = normL2Sqr(sample, centers.ptr<float>(k), dims);
+                    l[k] = std::sqrt(d);
+                    if( min_dist > d )
+                    {
+                        min_dist = d;
+                        k_best = k;
+                    }
+                }
+                distances[i] = min_dist;
+                labels[i] = k_best;
+                continue;
+            }
+
+            for( int k = 0; k < K; k++ )
+                l[k] = std::max(l[k] - shift[k], 0.f);
+
+            int a = labels[i];
+            float d = normL2Sqr(sample, centers.ptr<float>(a), dims);
+            float u = std::sqrt(d);
+            l[a] = u;
+
+            if( u > halfMinDist[a] )
+            {
+                for( int k = 0; k < K; k++ )
+                {
+                    if( k == a || u <= l[k] || u <= halfDist.at<float>(a, k) )
+                        continue;
+                    float dk = normL2Sqr(sample, centers.ptr<float>(k), dims);
+                    l[k] = std::sqrt(dk);
+                    if( l[k] < u || (l[k] == u && k < a) )
+                    {
+                        a = k;
+                        d = dk;
+                        u = l[k];
+                    }
+                }
+            }
+
+            distances[i] = d;
+            labels[i] = a;
+        }
+    }
+
+private:
+    KMeansElkanComputer& operator=(const KMeansElkanComputer&); // to quiet MSVC
+
+    double *distances;
+    int *labels;
+    Mat& lower;
+    const Mat& data;
+    const Mat& centers;
+    const float* halfMinDist;
+    const Mat& halfDist;
+    const float* shift;
+    bool full;
+};
+
+/*
+computes the centers as the means of the clusters. If some cluster appeared to be empty then:
+  1. find the biggest cluster
+  2. find the farthest from the center point in the biggest cluster
+  3. exclude the farthest point from the biggest cluster and form a new 1-point cluster.
+The indices of the moved points are stored in moved.
+*/
+static void computeCenters( const Mat& data, int* labels, Mat& centers, std::vector<int>& counters,
+                            Mat& temp, std::vector<int>& moved )
+{
+    int i, j, k, N = data.rows, K = centers.rows, dims = data.cols;
+    const float* sample;
+
+    centers = Scalar(0);
+    for( k = 0; k < K; k++ )
+        counters[k] = 0;
+    moved.clear();
+
+    for( i = 0; i < N; i++ )
+    {
+        sample = data.ptr<float>(i);
+        k = labels[i];
+        float* center = centers.ptr<float>(k);
+        j=0;
+        #if CV_ENABLE_UNROLLED
+        for(; j <= dims - 4; j += 4 )
+        {
+            float t0 = center[j] + sample[j];
+            float t1 = center[j+1] + sample[j+1];
+
+            center[j] = t0;
+            center[j+1] = t1;
+
+            t0 = center[j+2] + sample[j+2];
+            t1 = center[j+3] + sample[j+3];
+
+            center[j+2] = t0;
+            center[j+3] = t1;
+        }
+        #endif
+        for( ; j < dims; j++ )
+            center[j] += sample[j];
+        counters[k]++;
+    }
+
+    for( k = 0; k < K; k++ )
+    {
+        if( counters[k] != 0 )
+            continue;
+
+        int max_k = 0;
+        for( int k1 = 1; k1 < K; k1++ )
+        {
+            if( counters[max_k] < counters[k1] )
+                max_k = k1;
+        }
+
+        double max_dist = 0;
+        int farthest_i = -1;
+        float* new_center = centers.ptr<float>(k);
+        float* old_center = centers.ptr<float>(max_k);
+        float* _old_center = temp.ptr<float>(); // normalized
+        float scale = 1.f/counters[max_k];
+        for( j = 0; j < dims; j++ )
+            _old_center[j] = old_center[j]*scale;
+
+        for( i = 0; i < N; i++ )
+        {
+            if( labels[i] != max_k )
+                continue;
+            sample = data.ptr<float>(i);
+            double dist = normL2Sqr(sample, _old_center, dims);
+
+            if( max_dist <= dist )
+            {
+                max_dist = dist;
+                farthest_i = i;
+            }
+        }
+
+        counters[max_k]--;
+        counters[k]++;
+        labels[farthest_i] = k;
+        moved.push_back(farthest_i);
+        sample = data.ptr<float>(farthest_i);
+
+        for( j = 0; j < dims; j++ )
+        {
+            old_center[j] -= sample[j];
+            new_center[j] += sample[j];
+        }
+    }
+
+    for( k = 0; k < K; k++ )
+    {
+        float* center = centers.ptr<float>(k);
+        CV_Assert( counters[k] != 0 );
+
+        float scale = 1.f/counters[k];
+        for( j = 0; j < dims; j++ )
+            center[j] *= scale;
+    }
+}
+
+/*
+Sculley (2010) Web-scale k-means clustering.
+The centers are updated after every small random batch of the samples, with the learning rate
+decreasing as 1/(number of the samples assigned to the center so far). Every iteration is one
+pass over the shuffled data, only the current batch needs to stay in cache.
+*/
+static void miniBatchKMeans( const Mat& data, Mat& centers, Mat& old_centers, int* labels,
+                             const TermCriteria& criteria, RNG& rng, bool useGEMM )
+{
+    const int N = data.rows, K = centers.rows, dims = data.cols;
+    const int batchSize = std::min(N, (int)KMEANS_MINI_BATCH_SIZE);
+    std::vector<int> order(N), counts(K, 0), batchLabels(batchSize);
+    std::vector<double> batchDist(batchSize);
+    Mat batch(batchSize, dims, CV_32F);
+    int i, j, k;
+
+    for( i = 0; i < N; i++ )
+    {
+        order[i] = i;
+        labels[i] = -1;
+    }
+
+    for( int iter = 0; iter < std::max(criteria.maxCount, 1); iter++ )
+    {
+        int changed = 0;
+        centers.copyTo(old_centers);
+
+        for( i = N - 1; i > 0; i-- )
+            std::swap(order[i], order[rng.uniform(0, i + 1)]);
+
+        for( int b = 0; b < N; b += batchSize )
+        {
+            const int n = std::min(batchSize, N - b);
+            for( i = 0; i < n; i++ )
+                memcpy(batch.ptr<float>(i), data.ptr<float>(order[b + i]), dims*sizeof(float));
+
+            assignLabels(batch.rowRange(0, n), centers, &batchLabels[0], &batchDist[0], useGEMM);
+
+            for( i = 0; i < n; i++ )
+            {
+                const float* sample = batch.ptr<float>(i);
+                k = batchLabels[i];
+                if( labels[order[b + i]] != k )
+                {
+                    labels[order[b + i]] = k;
+                    changed++;
+                }
+                float* center = centers.ptr<float>(k);
+                float eta = 1.f/++counts[k];
+                for( j = 0; j < dims; j++ )
+                    center[j] += (sample[j] - center[j])*eta;
+            }
+        }
+
+        // the centers that did not get any sample are moved to the random samples
+        double max_center_shift = 0;
+        for( k = 0; k < K; k++ )
+        {
+            float* center = centers.ptr<float>(k);
+            if( counts[k] == 0 )
+                memcpy(center, data.ptr<float>(rng.uniform(0, N)), dims*sizeof(float));
+            max_center_shift = std::max(max_center_shift,
+                                        (double)normL2Sqr(center, old_centers.ptr<float>(k), dims));
+        }
+
+        // the stochastic updates do not let the centers stop, so it also stops when no sample changes its cluster
+        if( max_center_shift <= criteria.epsilon || changed == 0 )
+            break;
+    }
+}
+
 }
 
 double cv::kmeans( InputArray _data, int K,
@@ -232,6 +758,13 @@ double cv::kmeans( InputArray _data, int K,
     CV_Assert( data0.dims <= 2 && type == CV_32F && K > 0 );
     CV_Assert( N >= K );
 
+    const bool useElkan = (flags & KMEANS_ELKAN) != 0;
+    const bool useHamerly = (flags & KMEANS_HAMERLY) != 0;
+    const bool useMiniBatch = (flags & KMEANS_MINI_BATCH) != 0;
+    const bool useGEMM = (flags & KMEANS_USE_GEMM) != 0;
+    if( (int)useElkan + (int)useHamerly + (int)useMiniBatch > 1 )
+        CV_Error( CV_StsBadFlag, "Only one of KMEANS_ELKAN, KMEANS_HAMERLY and KMEANS_MINI_BATCH can be specified" );
+
     Mat data(N, dims, CV_32F, data0.ptr(), isrow ? dims * sizeof(float) : static_cast<size_t>(data0.step));
 
     _bestLabels.create(N, 1, CV_32S, -1, true);
@@ -257,13 +790,25 @@ double cv::kmeans( InputArray _data, int K,
     int* labels = _labels.ptr<int>();
 
     Mat centers(K, dims, type), old_centers(K, dims, type), temp(1, dims, type);
-    std::vector<int> counters(K);
+    std::vector<int> counters(K), moved;
     std::vector<Vec2f> _box(dims);
     Vec2f* box = &_box[0];
     double best_compactness = DBL_MAX, compactness = 0;
     RNG& rng = theRNG();
     int a, iter, i, j, k;
 
+    // the bounds of the distances from the samples to the centers
+    Mat lowerBounds, halfDist;
+    std::vector<float> halfMinDist, shift;
+    if( useElkan || useHamerly )
+    {
+        lowerBounds.create(N, useElkan ? K : 1, CV_32F);
+        halfMinDist.resize(K);
+        shift.resize(K);
+        if( useElkan )
+            halfDist.create(K, K, CV_32F);
+    }
+
     if( criteria.type & TermCriteria::EPS )
         criteria.epsilon = std::max(criteria.epsilon, 0.);
     else
@@ -296,152 +841,148 @@ double cv::kmeans( InputArray _data, int K,
         }
     }
 
+    Mat dists(1, N, CV_64F);
+    double* dist = dists.ptr<double>(0);
+
     for( a = 0; a < attempts; a++ )
     {
-        double max_center_shift = DBL_MAX;
-        for( iter = 0;; )
+        if( useMiniBatch )
         {
-            swap(centers, old_centers);
-
-            if( iter == 0 && (a > 0 || !(flags & KMEANS_USE_INITIAL_LABELS)) )
+            if( a == 0 && (flags & KMEANS_USE_INITIAL_LABELS) )
             {
-                if( flags & KMEANS_PP_CENTERS )
-                    generateCentersPP(data, centers, K, rng, SPP_TRIALS);
-                else
+                for( i = 0; i < N; i++ )
+                    CV_Assert( (unsigned)labels[i] < (unsigned)K );
+                computeCenters(data, labels, centers, counters, temp, moved);
+            }
+            else if( flags & KMEANS_PP_CENTERS )
+            {
+                // k-means++ is run on a random subset, like the updates
+                const int initSize = std::max(3*(int)KMEANS_MINI_BATCH_SIZE, 3*K);
+                Mat initData = data;
+                if( N > initSize )
                 {
-                    for( k = 0; k < K; k++ )
-                        generateRandomCenter(_box, centers.ptr<float>(k), rng);
+                    initData.create(initSize, dims, CV_32F);
+                    for( i = 0; i < initSize; i++ )
+                        data.row(rng.uniform(0, N)).copyTo(initData.row(i));
                 }
+                generateCentersPP(initData, centers, K, rng, SPP_TRIALS);
             }
             else
             {
-                if( iter == 0 && a == 0 && (flags & KMEANS_USE_INITIAL_LABELS) )
-                {
-                    for( i = 0; i < N; i++ )
-                        CV_Assert( (unsigned)labels[i] < (unsigned)K );
-                }
-
-                // compute centers
-                centers = Scalar(0);
                 for( k = 0; k < K; k++ )
-                    counters[k] = 0;
+                    generateRandomCenter(_box, centers.ptr<float>(k), rng);
+            }
 
-                for( i = 0; i < N; i++ )
-                {
-                    sample = data.ptr<float>(i);
-                    k = labels[i];
-                    float* center = centers.ptr<float>(k);
-                    j=0;
-                    #if CV_ENABLE_UNROLLED
-                    for(; j <= dims - 4; j += 4 )
-                    {
-                        float t0 = center[j] + sample[j];
-                        float t1 = center[j+1] + sample[j+1];
+            miniBatchKMeans(data, centers, old_centers, labels, criteria, rng, useGEMM);
 
-                        center[j] = t0;
-                        center[j+1] = t1;
+            assignLabels(data, centers, labels, dist, useGEMM);
+            compactness = 0;
+            for( i = 0; i < N; i++ )
+            {
+                compactness += dist[i];
+            }
 
-                        t0 = center[j+2] + sample[j+2];
-                        t1 = center[j+3] + sample[j+3];
+            // the final centers are the means of the clusters, and none of them is empty
+            computeCenters(data, labels, centers, counters, temp, moved);
+        }
+        else
+        {
+            double max_center_shift = DBL_MAX;
+            bool haveBounds = false;
+            for( iter = 0;; )
+            {
+                swap(centers, old_centers);
 
-                        center[j+2] = t0;
-                        center[j+3] = t1;
+                if( iter == 0 && (a > 0 || !(flags & KMEANS_USE_INITIAL_LABELS)) )
+                {
+                    if( flags & KMEANS_PP_CENTERS )
+                        generateCentersPP(data, centers, K, rng, SPP_TRIALS);
+                    else
+                    {
+                        for( k = 0; k < K; k++ )
+                            generateRandomCenter(_box, centers.ptr<float>(k), rng);
                     }
-                    #endif
-                    for( ; j < dims; j++ )
-                        center[j] += sample[j];
-                    counters[k]++;
                 }
-
-                if( iter > 0 )
-                    max_center_shift = 0;
-
-                for( k = 0; k < K; k++ )
+                else
                 {
-                    if( counters[k] != 0 )
-                        continue;
-
-                    // if some cluster appeared to be empty then:
-                    //   1. find the biggest cluster
-                    //   2. find the farthest from the center point in the biggest cluster
-                    //   3. exclude the farthest point from the biggest cluster and form a new 1-point cluster.
-                    int max_k = 0;
-                    for( int k1 = 1; k1 < K; k1++ )
+                    if( iter == 0 && a == 0 && (flags & KMEANS_USE_INITIAL_LABELS) )
                     {
-                        if( counters[max_k] < counters[k1] )
-                            max_k = k1;
+                        for( i = 0; i < N; i++ )
+                            CV_Assert( (unsigned)labels[i] < (unsigned)K );
                     }
 
-                    double max_dist = 0;
-                    int farthest_i = -1;
-                    float* new_center = centers.ptr<float>(k);
-                    float* old_center = centers.ptr<float>(max_k);
-                    float* _old_center = temp.ptr<float>(); // normalized
-                    float scale = 1.f/counters[max_k];
-                    for( j = 0; j < dims; j++ )
-                        _old_center[j] = old_center[j]*scale;
+                    computeCenters(data, labels, centers, counters, temp, moved);
 
-                    for( i = 0; i < N; i++ )
+                    // the bound of the moved point does not cover its previous center anymore
+                    if( useHamerly )
                     {
-                        if( labels[i] != max_k )
-                            continue;
-                        sample = data.ptr<float>(i);
-                        double dist = normL2Sqr(sample, _old_center, dims);
-
-                        if( max_dist <= dist )
-                        {
-                            max_dist = dist;
-                            farthest_i = i;
-                        }
+                        for( size_t m = 0; m < moved.size(); m++ )
+                            lowerBounds.at<float>(moved[m]) = 0.f;
                     }
 
-                    counters[max_k]--;
-                    counters[k]++;
-                    labels[farthest_i] = k;
-                    sample = data.ptr<float>(farthest_i);
-
-                    for( j = 0; j < dims; j++ )
+                    if( iter > 0 )
                     {
-                        old_center[j] -= sample[j];
-                        new_center[j] += sample[j];
+                        max_center_shift = 0;
+                        for( k = 0; k < K; k++ )
+                        {
+                            double dist_k = 0;
+                            const float* center = centers.ptr<float>(k);
+                            const float* old_center = old_centers.ptr<float>(k);
+                            for( j = 0; j < dims; j++ )
+                            {
+                                double t = center[j] - old_center[j];
+                                dist_k += t*t;
+                            }
+                            max_center_shift = std::max(max_center_shift, dist_k);
+                        }
                     }
                 }
 
-                for( k = 0; k < K; k++ )
-                {
-                    float* center = centers.ptr<float>(k);
-                    CV_Assert( counters[k] != 0 );
-
-                    float scale = 1.f/counters[k];
-                    for( j = 0; j < dims; j++ )
-                        center[j] *= scale;
+                if( ++iter == MAX(criteria.maxCount, 2) || max_center_shift <= criteria.epsilon )
+                    break;
 
-                    if( iter > 0 )
+                // assign labels
+                if( useElkan || useHamerly )
+                {
+                    int maxShiftIdx = -1;
+                    float maxShift = 0.f, maxShift2 = 0.f;
+                    if( haveBounds )
                     {
-                        double dist = 0;
-                        const float* old_center = old_centers.ptr<float>(k);
-                        for( j = 0; j < dims; j++ )
+                        for( k = 0; k < K; k++ )
                         {
-                            double t = center[j] - old_center[j];
-                            dist += t*t;
+                            shift[k] = std::sqrt(normL2Sqr(centers.ptr<float>(k), old_centers.ptr<float>(k), dims));
+                            if( shift[k] > maxShift )
+                            {
+                                maxShift2 = maxShift;
+                                maxShift = shift[k];
+                                maxShiftIdx = k;
+                            }
+                            else
+                                maxShift2 = std::max(maxShift2, shift[k]);
                         }
-                        max_center_shift = std::max(max_center_shift, dist);
                     }
-                }
-            }
 
-            if( ++iter == MAX(criteria.maxCount, 2) || max_center_shift <= criteria.epsilon )
-                break;
+                    parallel_for_(Range(0, K),
+                                  KMeansCenterDistanceComputer(centers, &halfMinDist[0], useElkan ? &halfDist : 0));
+                    if( useElkan )
+                        parallel_for_(Range(0, N),
+                                      KMeansElkanComputer(dist, labels, lowerBounds, data, centers,
+                                                          &halfMinDist[0], halfDist, &shift[0], !haveBounds));
+                    else
+                        parallel_for_(Range(0, N),
+                                      KMeansHamerlyComputer(dist, labels, lowerBounds.ptr<float>(), data, centers,
+                                                            &halfMinDist[0], maxShiftIdx, maxShift, maxShift2,
+                                                            !haveBounds));
+                    haveBounds = true;
+                }
+                else
+                    assignLabels(data, centers, labels, dist, useGEMM);
 
-            // assign labels
-            Mat dists(1, N, CV_64F);
-            double* dist = dists.ptr<double>(0);
-            parallel_for_(Range(0, N),
-                         KMeansDistanceComputer(dist, labels, data, centers));
-            compactness = 0;
-            for( i = 0; i < N; i++ )
-            {
-                compactness += dist[i];
+                compactness = 0;
+                for( i = 0; i < N; i++ )
+                {
+                    compactness += dist[i];
+                }
             }
         }
 
@@ -1386,10 +1386,540 @@ bool cv::solve( InputArray _src, InputArray _src2arg, OutputArray _dst, int meth
 
 /////////////////// finding eigenvalues and eigenvectors of a symmetric matrix ///////////////
 
-bool cv::eigen( InputArray _src, OutputArray _evals, OutputArray _evects )
+namespace cv
 {
-    CV_INSTRUMENT_REGION()
 
+// Jacobi rotations are kept for the small matrices, where they are fast and very accurate. The
+// larger ones are first reduced to the tridiagonal form T = Q'*A*Q with Householder reflections;
+// then either all the eigenpairs of T are found with the implicit QL iterations or just the few
+// largest ones with bisection and inverse iteration. The O(n^3) parts run in parallel.
+enum { EIGEN_JACOBI_MAX_SIZE = 32, EIGEN_MAX_QL_ITERS = 30, EIGEN_MAX_INVIT_ITERS = 5 };
+
+// p = tau*A22*v, where A22 is the trailing submatrix starting at (i0, i0)
+class EigenSymvInvoker : public ParallelLoopBody
+{
+public:
+    EigenSymvInvoker(const Mat& _a, int _i0, const double* _v, double _tau, double* _p)
+        : a(&_a), i0(_i0), v(_v), tau(_tau), p(_p) {}
+
+    void operator()(const Range& range) const
+    {
+        int m = a->cols - i0;
+        for( int r = range.start; r < range.end; r++ )
+        {
+            const double* ar = a->ptr<double>(i0 + r) + i0;
+            double s = 0;
+            for( int j = 0; j < m; j++ )
+                s += ar[j]*v[j];
+            p[r] = tau*s;
+        }
+    }
+
+private:
+    const Mat* a;
+    int i0;
+    const double* v;
+    double tau;
+    double* p;
+};
+
+// A22 -= v*w' + w*v'
+class EigenRank2Updater : public ParallelLoopBody
+{
+public:
+    EigenRank2Updater(Mat& _a, int _i0, const double* _v, const double* _w)
+        : a(&_a), i0(_i0), v(_v), w(_w) {}
+
+    void operator()(const Range& range) const
+    {
+        int m = a->cols - i0;
+        for( int r = range.start; r < range.end; r++ )
+        {
+            double* ar = a->ptr<double>(i0 + r) + i0;
+            double vr = v[r], wr = w[r];
+            for( int j = 0; j < m; j++ )
+                ar[j] -= vr*w[j] + wr*v[j];
+        }
+    }
+
+private:
+    Mat* a;
+    int i0;
+    const double* v;
+    const double* w;
+};
+
+// Reduces the symmetric matrix a to the tridiagonal form with the diagonal d and the subdiagonal e
+// (e[n-1] = 0). The Householder vector of the i-th step is stored in the row i of a, after the
+// diagonal, and its scale factor in tau[i].
+static void tridiagonalize( Mat& a, double* d, double* e, double* tau )
+{
+    int n = a.rows;
+    AutoBuffer<double> _buf(n*2);
+    double *p = _buf, *w = p + n;
+
+    for( int i = 0; i < n - 2; i++ )
+    {
+        double* x = a.ptr<double>(i) + i + 1;
+        int j, m = n - i - 1;
+        double sigma = 0;
+
+        d[i] = x[-1];
+        for( j = 1; j < m; j++ )
+            sigma += x[j]*x[j];
+        if( sigma == 0 )
+        {
+            e[i] = x[0];
+            tau[i] = 0;
+            continue;
+        }
+
+        double mu = std::sqrt(x[0]*x[0] + sigma);
+        double beta = x[0] <= 0 ? mu : -mu;
+        double scale = 1./(x[0] - beta);
+        tau[i] = (beta - x[0])/beta;
+        e[i] = beta;
+        for( j = 1; j < m; j++ )
+            x[j] *= scale;
+        x[0] = 1.;
+
+        double nstripes = (double)m*m/(1 << 16);
+        parallel_for_(Range(0, m), EigenSymvInvoker(a, i + 1, x, tau[i], p), nstripes);
+
+        double K = 0;
+        for( j = 0; j < m; j++ )
+            K += p[j]*x[j];
+        K *= 0.5*tau[i];
+        for( j = 0; j < m; j++ )
+            w[j] = p[j] - K*x[j];
+        parallel_for_(Range(0, m), EigenRank2Updater(a, i + 1, x, w), nstripes);
+    }
+
+    if( n > 1 )
+    {
+        d[n-2] = a.at<double>(n-2, n-2);
+        e[n-2] = a.at<double>(n-2, n-1);
+    }
+    if( n > 0 )
+    {
+        d[n-1] = a.at<double>(n-1, n-1);
+        e[n-1] = 0;
+    }
+}
+
+// applies the plane rotations of one QL sweep, (c[i], s[i]) for i = m-1 down to l, to the rows of z
+class EigenRotationInvoker : public ParallelLoopBody
+{
+public:
+    EigenRotationInvoker(Mat& _z, const double* _c, const double* _s, int _l, int _m)
+        : z(&_z), c(_c), s(_s), l(_l), m(_m) {}
+
+    void operator()(const Range& range) const
+    {
+        for( int k = range.start; k < range.end; k++ )
+        {
+            double* zk = z->ptr<double>(k);
+            for( int i = m - 1; i >= l; i-- )
+            {
+                double h = zk[i+1];
+                zk[i+1] = s[i]*zk[i] + c[i]*h;
+                zk[i] = c[i]*zk[i] - s[i]*h;
+            }
+        }
+    }
+
+private:
+    Mat* z;
+    const double* c;
+    const double* s;
+    int l, m;
+};
+
+// The implicit QL method (tql2 from EISPACK). On return d contains the eigenvalues of the
+// tridiagonal matrix (not sorted) and the columns of z, if it is given, are rotated by the
+// corresponding eigenvectors.
+static bool tridiagQL( double* d, double* e, int n, Mat* z )
+{
+    const double eps = std::numeric_limits<double>::epsilon();
+    AutoBuffer<double> _cs(n*2);
+    double *cs = _cs, *sn = cs + n;
+    double f = 0, tst1 = 0;
+    bool ok = true;
+
+    for( int l = 0; l < n; l++ )
+    {
+        tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+        int m = l;
+        while( m < n - 1 && std::abs(e[m]) > eps*tst1 )
+            m++;
+
+        for( int iter = 0; m > l && std::abs(e[l]) > eps*tst1; iter++ )
+        {
+            if( iter >= EIGEN_MAX_QL_ITERS )
+            {
+                ok = false;
+                break;
+            }
+
+            double g = d[l];
+            double p = (d[l+1] - g)/(2*e[l]);
+            double r = hypot(p, 1.);
+            if( p < 0 )
+                r = -r;
+            d[l] = e[l]/(p + r);
+            d[l+1] = e[l]*(p + r);
+            double dl1 = d[l+1], h = g - d[l];
+            for( int i = l + 2; i < n; i++ )
+                d[i] -= h;
+            f += h;
+
+            p = d[m];
+            double c = 1, c2 = c, c3 = c, el1 = e[l+1], s = 0, s2 = 0;
+            for( int i = m - 1; i >= l; i-- )
+            {
+                c3 = c2;
+                c2 = c;
+                s2 = s;
+                g = c*e[i];
+                h = c*p;
+                r = hypot(p, e[i]);
+                e[i+1] = s*r;
+                s = e[i]/r;
+                c = p/r;
+                p = c*d[i] - s*g;
+                d[i+1] = h + s*(c*g + s*d[i]);
+                cs[i] = c;
+                sn[i] = s;
+            }
+            p = -s*s2*c3*el1*e[l]/dl1;
+            e[l] = s*p;
+            d[l] = c*p;
+
+            if( z )
+                parallel_for_(Range(0, z->rows), EigenRotationInvoker(*z, cs, sn, l, m),
+                              (double)z->rows*(m - l)/(1 << 16));
+        }
+        d[l] += f;
+        e[l] = 0;
+    }
+    return ok;
+}
+
+// the number of eigenvalues of the tridiagonal matrix that are less than x (Sturm sequence count)
+static int sturmCount( const double* d, const double* e2, int n, double x, double pivmin )
+{
+    int count = 0;
+    double q = 1;
+    for( int i = 0; i < n; i++ )
+    {
+        q = d[i] - x - (i > 0 ? e2[i-1]/q : 0.);
+        if( std::abs(q) < pivmin )
+            q = -pivmin;
+        count += q < 0;
+    }
+    return count;
+}
+
+// finds the count largest eigenvalues of the tridiagonal matrix with bisection, in descending order
+static void tridiagBisect( const double* d, const double* e, int n, double* w, int count )
+{
+    const double eps = std::numeric_limits<double>::epsilon();
+    AutoBuffer<double> _e2(n);
+    double* e2 = _e2;
+    double lo = DBL_MAX, hi = -DBL_MAX, maxe2 = 1;
+    int i;
+
+    for( i = 0; i < n; i++ )
+    {
+        double r = std::abs(e[i]) + (i > 0 ? std::abs(e[i-1]) : 0.);
+        lo = std::min(lo, d[i] - r);
+        hi = std::max(hi, d[i] + r);
+        e2[i] = e[i]*e[i];
+        maxe2 = std::max(maxe2, e2[i]);
+    }
+    double tnorm = std::max(std::abs(lo), std::abs(hi));
+    double pivmin = DBL_MIN*maxe2;
+    lo -= 2*eps*tnorm + pivmin;
+    hi += 2*eps*tnorm + pivmin;
+
+    for( int j = 0; j < count; j++ )
+    {
+        // the eigenvalue number n-1-j in ascending order; it is not above the previous one
+        int idx = n - 1 - j;
+        double a = lo, b = j > 0 ? std::min(hi, w[j-1] + 2*eps*tnorm) : hi;
+        for( i = 0; i < 128 && b - a > eps*(std::abs(a) + std::abs(b)) + pivmin; i++ )
+        {
+            double c = (a + b)*0.5;
+            if( sturmCount(d, e2, n, c, pivmin) > idx )
+                b = c;
+            else
+                a = c;
+        }
+        // the multiple eigenvalues may come out slightly out of order
+        w[j] = j > 0 ? std::min((a + b)*0.5, w[j-1]) : (a + b)*0.5;
+    }
+}
+
+// Computes the eigenvectors of the tridiagonal matrix for the eigenvalues w[j0..j1) with inverse
+// iteration; the eigenvalues are sorted in descending order and split into clusters, which are
+// processed independently. Inside a cluster the vectors are reorthogonalized.
+class EigenInverseIterationInvoker : public ParallelLoopBody
+{
+public:
+    EigenInverseIterationInvoker(const double* _d, const double* _e, int _n, const double* _w,
+                                 const int* _clusters, double _tnorm, Mat& _z)
+        : d(_d), e(_e), n(_n), w(_w), clusters(_clusters), tnorm(_tnorm), z(&_z) {}
+
+    void operator()(const Range& range) const
+    {
+        const double eps = std::numeric_limits<double>::epsilon();
+        double eps3 = 10*eps*tnorm + DBL_MIN;
+        double tol = std::sqrt((double)n)*eps3;
+        AutoBuffer<double> _buf(n*5);
+        AutoBuffer<uchar> _piv(n);
+        double *dd = _buf, *du = dd + n, *du2 = du + n, *dl = du2 + n, *b = dl + n;
+        uchar* piv = _piv;
+
+        for( int c = range.start; c < range.end; c++ )
+        {
+            double lambda = 0;
+            for( int j = clusters[c]; j < clusters[c+1]; j++ )
+            {
+                // the close eigenvalues are separated a bit to get the different vectors
+                lambda = j > clusters[c] ? std::min(w[j], lambda - eps3) : w[j];
+                factorize(lambda, eps3, dd, du, du2, dl, piv);
+
+                double* x = z->ptr<double>(j);
+                RNG rng(0x12345678 + j);
+                for( int i = 0; i < n; i++ )
+                    x[i] = rng.uniform(-1., 1.);
+
+                for( int iter = 0, converged = 0; iter < EIGEN_MAX_INVIT_ITERS && converged < 2; iter++ )
+                {
+                    normalize(x, n, true);
+                    std::copy(x, x + n, b);
+                    solve(dd, du, du2, dl, piv, b, x);
+                    for( int k = clusters[c]; k < j; k++ )
+                    {
+                        const double* zk = z->ptr<double>(k);
+                        double s = 0;
+                        for( int i = 0; i < n; i++ )
+                            s += x[i]*zk[i];
+                        for( int i = 0; i < n; i++ )
+                            x[i] -= s*zk[i];
+                    }
+                    // the residual of the normalized vector is about 1/||x||
+                    if( normalize(x, n, false)*tol >= 1 )
+                        converged++;
+                }
+                normalize(x, n, true);
+            }
+        }
+    }
+
+private:
+    static double normalize( double* x, int n, bool scale )
+    {
+        double s = 0;
+        for( int i = 0; i < n; i++ )
+            s += x[i]*x[i];
+        s = std::sqrt(s);
+        if( scale && s > 0 )
+            for( int i = 0; i < n; i++ )
+                x[i] /= s;
+        return s;
+    }
+
+    // LU factorization of T - lambda*I with partial pivoting (as in LAPACK dgttrf)
+    void factorize( double lambda, double eps3, double* dd, double* du, double* du2,
+                    double* dl, uchar* piv ) const
+    {
+        int i;
+        for( i = 0; i < n; i++ )
+        {
+            dd[i] = d[i] - lambda;
+            du[i] = dl[i] = e[i];
+            du2[i] = 0;
+        }
+        for( i = 0; i < n - 1; i++ )
+        {
+            if( std::abs(dd[i]) >= std::abs(dl[i]) )
+            {
+                if( std::abs(dd[i]) < eps3 )
+                    dd[i] = dd[i] < 0 ? -eps3 : eps3;
+                double f = dl[i]/dd[i];
+                dl[i] = f;
+                dd[i+1] -= f*du[i];
+                piv[i] = 0;
+            }
+            else
+            {
+                double f = dd[i]/dl[i];
+                dd[i] = dl[i];
+                dl[i] = f;
+                double t = du[i];
+                du[i] = dd[i+1];
+                dd[i+1] = t - f*dd[i+1];
+                if( i < n - 2 )
+                {
+                    du2[i] = du[i+1];
+                    du[i+1] = -f*du[i+1];
+                }
+                piv[i] = 1;
+            }
+        }
+        if( n > 0 && std::abs(dd[n-1]) < eps3 )
+            dd[n-1] = dd[n-1] < 0 ? -eps3 : eps3;
+    }
+
+    void solve( const double* dd, const double* du, const double* du2, const double* dl,
+                const uchar* piv, double* b, double* x ) const
+    {
+        int i;
+        for( i = 0; i < n - 1; i++ )
+        {
+            if( !piv[i] )
+                b[i+1] -= dl[i]*b[i];
+            else
+            {
+                double t = b[i] - dl[i]*b[i+1];
+                b[i] = b[i+1];
+                b[i+1] = t;
+            }
+        }
+        for( i = n - 1; i >= 0; i-- )
+        {
+            double s = b[i];
+            if( i < n - 1 )
+                s -= du[i]*x[i+1];
+            if( i < n - 2 )
+                s -= du2[i]*x[i+2];
+            x[i] = s/dd[i];
+        }
+    }
+
+    const double* d;
+    const double* e;
+    int n;
+    const double* w;
+    const int* clusters;
+    double tnorm;
+    Mat* z;
+};
+
+// z = Q*z for each row of z, where Q is the product of the reflections stored by tridiagonalize()
+// (the sign of each row is normalized as well)
+class EigenBackTransformInvoker : public ParallelLoopBody
+{
+public:
+    EigenBackTransformInvoker(const Mat& _a, const double* _tau, Mat& _z)
+        : a(&_a), tau(_tau), z(&_z) {}
+
+    void operator()(const Range& range) const
+    {
+        int n = a->rows;
+        for( int k = range.start; k < range.end; k++ )
+        {
+            double* zk = z->ptr<double>(k);
+            for( int i = n - 3; i >= 0; i-- )
+            {
+                if( tau[i] == 0 )
+                    continue;
+                const double* v = a->ptr<double>(i) + i + 1;
+                double* x = zk + i + 1;
+                int j, m = n - i - 1;
+                double s = 0;
+                for( j = 0; j < m; j++ )
+                    s += v[j]*x[j];
+                s *= tau[i];
+                for( j = 0; j < m; j++ )
+                    x[j] -= s*v[j];
+            }
+
+            // QL and inverse iteration may return the vectors of the opposite signs,
+            // so the largest component is made positive for the results to be consistent
+            int jmax = 0;
+            for( int j = 1; j < n; j++ )
+                if( std::abs(zk[j]) > std::abs(zk[jmax]) )
+                    jmax = j;
+            if( zk[jmax] < 0 )
+                for( int j = 0; j < n; j++ )
+                    zk[j] = -zk[j];
+        }
+    }
+
+private:
+    const Mat* a;
+    const double* tau;
+    Mat* z;
+};
+
+// Finds the count largest eigenvalues (in descending order) and, optionally, the corresponding
+// eigenvectors (stored as rows) of the symmetric matrix a of CV_64F type; a is destroyed.
+static bool eigenTridiagonal( Mat& a, Mat& w, Mat* v, int count )
+{
+    int n = a.rows;
+    AutoBuffer<double> _buf(n*3);
+    double *d = _buf, *e = d + n, *tau = e + n;
+    bool ok = true;
+
+    tridiagonalize(a, d, e, tau);
+
+    w.create(count, 1, CV_64F);
+    if( count == n )
+    {
+        Mat z, idx;
+        if( v )
+            z = Mat::eye(n, n, CV_64F);
+        ok = tridiagQL(d, e, n, v ? &z : 0);
+        sortIdx(Mat(n, 1, CV_64F, d), idx, SORT_EVERY_COLUMN | SORT_DESCENDING);
+
+        const int* ip = idx.ptr<int>();
+        for( int j = 0; j < n; j++ )
+            w.at<double>(j) = d[ip[j]];
+        if( v )
+        {
+            v->create(n, n, CV_64F);
+            for( int j = 0; j < n; j++ )
+            {
+                double* vj = v->ptr<double>(j);
+                for( int k = 0; k < n; k++ )
+                    vj[k] = z.at<double>(k, ip[j]);
+            }
+        }
+    }
+    else
+    {
+        double* wp = w.ptr<double>();
+        tridiagBisect(d, e, n, wp, count);
+        if( v )
+        {
+            double tnorm = 0;
+            for( int i = 0; i < n; i++ )
+                tnorm = std::max(tnorm, std::abs(d[i]) + std::abs(e[i]) + (i > 0 ? std::abs(e[i-1]) : 0.));
+
+            // the eigenvalues closer than 1e-3*||T|| go to the same cluster
+            std::vector<int> clusters(1, 0);
+            for( int j = 1; j < count; j++ )
+                if( wp[j-1] - wp[j] > 1e-3*tnorm )
+                    clusters.push_back(j);
+            clusters.push_back(count);
+
+            v->create(count, n, CV_64F);
+            int nclusters = (int)clusters.size() - 1;
+            parallel_for_(Range(0, nclusters),
+                          EigenInverseIterationInvoker(d, e, n, wp, &clusters[0], tnorm, *v));
+        }
+    }
+
+    if( v )
+        parallel_for_(Range(0, v->rows), EigenBackTransformInvoker(a, tau, *v),
+                      (double)v->rows*n*n/(1 << 18));
+    return ok;
+}
+
+static bool eigen_( InputArray _src, OutputArray _evals, OutputArray _evects, int count )
+{
     Mat src = _src.getMat();
     int type = src.type();
     int n = src.rows;
@@ -1397,11 +1927,27 @@ bool cv::eigen( InputArray _src, OutputArray _evals, OutputArray _evects )
     CV_Assert( src.rows == src.cols );
     CV_Assert (type == CV_32F || type == CV_64F);
 
+    if( n > EIGEN_JACOBI_MAX_SIZE )
+    {
+        Mat a, w, v;
+        src.convertTo(a, CV_64F);
+        bool ok = eigenTridiagonal(a, w, _evects.needed() ? &v : 0, count);
+        w.convertTo(_evals, type);
+        if( _evects.needed() )
+            v.convertTo(_evects, type);
+        return ok;
+    }
+
     Mat v;
     if( _evects.needed() )
     {
-        _evects.create(n, n, type);
-        v = _evects.getMat();
+        if( count == n )
+        {
+            _evects.create(n, n, type);
+            v = _evects.getMat();
+        }
+        else
+            v.create(n, n, type);
     }
 
     size_t elemSize = src.elemSize(), astep = alignSize(n*elemSize, 16);
@@ -1414,10 +1960,29 @@ bool cv::eigen( InputArray _src, OutputArray _evals, OutputArray _evects )
         Jacobi(a.ptr<float>(), a.step, w.ptr<float>(), v.ptr<float>(), v.step, n, ptr) :
         Jacobi(a.ptr<double>(), a.step, w.ptr<double>(), v.ptr<double>(), v.step, n, ptr);
 
-    w.copyTo(_evals);
+    w.rowRange(0, count).copyTo(_evals);
+    if( _evects.needed() && count < n )
+        v.rowRange(0, count).copyTo(_evects);
     return ok;
 }
 
+}
+
+bool cv::eigen( InputArray _src, OutputArray _evals, OutputArray _evects )
+{
+    CV_INSTRUMENT_REGION()
+
+    return eigen_(_src, _evals, _evects, _src.rows());
+}
+
+bool cv::eigen( InputArray _src, OutputArray _evals, OutputArray _evects, int count )
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( 0 < count && count <= _src.rows() );
+    return eigen_(_src, _evals, _evects, count);
+}
+
 namespace cv
 {
 
@@ -1510,6 +2075,99 @@ void SVD::compute( InputArray a, OutputArray w, int flags )
     _SVDcompute(a, w, noArray(), noArray(), flags);
 }
 
+// Makes the rows of q orthonormal by the Gram-Schmidt process, with the projections computed
+// by gemm and repeated twice for stability. The rows that turn out to be linearly dependent on
+// the previous ones are replaced by the random vectors.
+static void orthonormalizeRows( Mat& q, RNG& rng )
+{
+    Mat r, t;
+    for( int i = 0; i < q.rows; i++ )
+    {
+        Mat qi = q.row(i);
+        double norm0 = norm(qi);
+        for( int attempt = 0;; attempt++ )
+        {
+            if( i > 0 )
+            {
+                Mat prev = q.rowRange(0, i);
+                for( int pass = 0; pass < 2; pass++ )
+                {
+                    gemm(qi, prev, 1, noArray(), 0, r, GEMM_2_T);
+                    gemm(r, prev, -1, qi, 1, t);
+                    t.copyTo(qi);
+                }
+            }
+            double nrm = norm(qi);
+            if( nrm > norm0*1e-4 && nrm > 0 )
+            {
+                qi *= 1./nrm;
+                break;
+            }
+            if( attempt == 2 )
+            {
+                qi = Scalar::all(0);
+                break;
+            }
+            rng.fill(qi, RNG::NORMAL, 0, 1);
+            norm0 = norm(qi);
+        }
+    }
+}
+
+void SVD::computeTruncated( InputArray _src, OutputArray _w, OutputArray _u, OutputArray _vt,
+                            int k, int oversampling, int powerIterations )
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat src = _src.getMat();
+    int m = src.rows, n = src.cols, type = src.type();
+    CV_Assert( type == CV_32F || type == CV_64F );
+    CV_Assert( 0 < k && k <= std::min(m, n) && oversampling >= 0 && powerIterations >= 0 );
+
+    int l = std::min(k + oversampling, std::min(m, n));
+    if( l == std::min(m, n) )
+    {
+        // nothing to gain from the random projection
+        Mat w, u, vt;
+        _SVDcompute(src, w, u, vt, 0);
+        w.rowRange(0, k).copyTo(_w);
+        if( _u.needed() )
+            u.colRange(0, k).copyTo(_u);
+        if( _vt.needed() )
+            vt.rowRange(0, k).copyTo(_vt);
+        return;
+    }
+
+    // Halko, Martinsson, Tropp (2011) Finding structure with randomness.
+    // The rows of qt form an orthonormal basis of the approximate range of src: src*omega,
+    // refined by the power iterations (src*src^T)^q*src*omega. The vectors are kept as rows,
+    // so all the products are the plain gemm calls over src.
+    RNG rng(0x12345678);
+    Mat omega(l, n, type), qt, zt;
+    rng.fill(omega, RNG::NORMAL, 0, 1);
+    gemm(omega, src, 1, noArray(), 0, qt, GEMM_2_T);
+    orthonormalizeRows(qt, rng);
+
+    for( int iter = 0; iter < powerIterations; iter++ )
+    {
+        gemm(qt, src, 1, noArray(), 0, zt);
+        orthonormalizeRows(zt, rng);
+        gemm(zt, src, 1, noArray(), 0, qt, GEMM_2_T);
+        orthonormalizeRows(qt, rng);
+    }
+
+    // src ~ qt^T*b, the small matrix b is decomposed directly
+    Mat b, wb, ub, vtb;
+    gemm(qt, src, 1, noArray(), 0, b);
+    _SVDcompute(b, wb, ub, vtb, 0);
+
+    wb.rowRange(0, k).copyTo(_w);
+    if( _u.needed() )
+        gemm(qt, ub.colRange(0, k), 1, noArray(), 0, _u, GEMM_1_T);
+    if( _vt.needed() )
+        vtb.rowRange(0, k).copyTo(_vt);
+}
+
 void SVD::backSubst( InputArray _w, InputArray _u, InputArray _vt,
                      InputArray _rhs, OutputArray _dst )
 {
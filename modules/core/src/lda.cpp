@@ -1073,6 +1073,29 @@ void LDA::lda(InputArrayOfArrays _src, InputArray _lbls) {
         mulTransposed(tmp, tmp, true);
         add(Sb, tmp, Sb);
     }
+    // Sb*v = lambda*Sw*v turns into the symmetric problem Cs*y = lambda*y with Sw = L*L',
+    // Cs = inv(L)*Sb*inv(L)' and v = inv(L)'*y, so only the leading eigenpairs need to be found
+    Mat L = Sw.clone();
+    if (hal::Cholesky64f(L.ptr<double>(), L.step, D, 0, 0, 0)) {
+        // clear the upper triangle left from Sw
+        for (int i = 0; i < D; i++) {
+            double* Li = L.ptr<double>(i);
+            std::fill(Li + i + 1, Li + D, 0.);
+        }
+        Mat Y, Cs;
+        solve(L, Sb, Y, DECOMP_LU);
+        solve(L, Y.t(), Cs, DECOMP_LU);
+        completeSymm(Cs);
+        eigen(Cs, _eigenvalues, Y, std::min(_num_components, D));
+        solve(L.t(), Y.t(), _eigenvectors, DECOMP_LU);
+        for (int i = 0; i < _eigenvectors.cols; i++) {
+            Mat v = _eigenvectors.col(i);
+            normalize(v, v);
+        }
+        _eigenvalues = _eigenvalues.reshape(1, 1);
+        return;
+    }
+    // Sw is not positive-definite; fall back to the nonsymmetric problem
     // invert Sw
     Mat Swi = Sw.inv();
     // M = inv(Sw)*Sb
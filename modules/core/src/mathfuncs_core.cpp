@@ -42,160 +42,10 @@
 
 #include "precomp.hpp"
 
-using namespace std;
-
-namespace {
-
-static const float atan2_p1 = 0.9997878412794807f*(float)(180/CV_PI);
-static const float atan2_p3 = -0.3258083974640975f*(float)(180/CV_PI);
-static const float atan2_p5 = 0.1555786518463281f*(float)(180/CV_PI);
-static const float atan2_p7 = -0.04432655554792128f*(float)(180/CV_PI);
-
-using namespace cv;
-
-#if CV_SIMD128
-
-template <typename T>
-struct v_atan
-{
-    typedef V_RegTrait128<T> Trait;
-    typedef typename Trait::reg VT; // vector type
-    enum { WorkWidth = VT::nlanes * 2 };
-
-    v_atan(const T & scale)
-        : s(Trait::all(scale))
-    {
-        eps = Trait::all(DBL_EPSILON);
-        z = Trait::zero();
-        p7 = Trait::all(atan2_p7);
-        p5 = Trait::all(atan2_p5);
-        p3 = Trait::all(atan2_p3);
-        p1 = Trait::all(atan2_p1);
-        val90 = Trait::all(90.f);
-        val180 = Trait::all(180.f);
-        val360 = Trait::all(360.f);
-    }
-
-    inline int operator()(int len, const T * Y, const T * X, T * angle)
-    {
-        int i = 0;
-        const int c = VT::nlanes;
-        for ( ; i <= len - c * 2; i += c * 2)
-        {
-            VT x1 = v_load(X + i);
-            VT x2 = v_load(X + i + c);
-            VT y1 = v_load(Y + i);
-            VT y2 = v_load(Y + i + c);
-            v_store(&angle[i], s * one(x1, y1));
-            v_store(&angle[i + c], s * one(x2, y2));
-        }
-        return i;
-    }
-
-private:
-    inline VT one(VT & x, VT & y)
-    {
-        VT ax = v_abs(x);
-        VT ay = v_abs(y);
-        VT c = v_min(ax, ay) / (v_max(ax, ay) + eps);
-        VT cc = c * c;
-        VT a = (((p7 * cc + p5) * cc + p3) * cc + p1) * c;
-        a = v_select(ax >= ay, a, val90 - a);
-        a = v_select(x < z, val180 - a, a);
-        a = v_select(y < z, val360 - a, a);
-        return a;
-    }
-
-private:
-    VT eps;
-    VT z;
-    VT p7;
-    VT p5;
-    VT p3;
-    VT p1;
-    VT val90;
-    VT val180;
-    VT val360;
-    VT s;
-};
-
-#if !CV_SIMD128_64F
-
-// emulation
-template <>
-struct v_atan<double>
-{
-    v_atan(double scale) : impl(static_cast<float>(scale)) {}
-    inline int operator()(int len, const double * Y, const double * X, double * angle)
-    {
-        int i = 0;
-        const int c = v_atan<float>::WorkWidth;
-        float bufY[c];
-        float bufX[c];
-        float bufA[c];
-        for ( ; i <= len - c ; i += c)
-        {
-            for (int j = 0; j < c; ++j)
-            {
-                bufY[j] = static_cast<float>(Y[i + j]);
-                bufX[j] = static_cast<float>(X[i + j]);
-            }
-            impl(c, bufY, bufX, bufA);
-            for (int j = 0; j < c; ++j)
-            {
-                angle[i + j] = bufA[j];
-            }
-        }
-        return i;
-    }
-private:
-    v_atan<float> impl;
-};
-#endif
-
-#endif
-
-template <typename T>
-static inline T atanImpl(T y, T x)
-{
-    T ax = std::abs(x), ay = std::abs(y);
-    T a, c, c2;
-    if( ax >= ay )
-    {
-        c = ay/(ax + static_cast<T>(DBL_EPSILON));
-        c2 = c*c;
-        a = (((atan2_p7*c2 + atan2_p5)*c2 + atan2_p3)*c2 + atan2_p1)*c;
-    }
-    else
-    {
-        c = ax/(ay + static_cast<T>(DBL_EPSILON));
-        c2 = c*c;
-        a = 90.f - (((atan2_p7*c2 + atan2_p5)*c2 + atan2_p3)*c2 + atan2_p1)*c;
-    }
-    if( x < 0 )
-        a = 180.f - a;
-    if( y < 0 )
-        a = 360.f - a;
-    return a;
-}
-
-template <typename T>
-static inline void atanImpl(const T *Y, const T *X, T *angle, int len, bool angleInDegrees)
-{
-    int i = 0;
-    T scale = angleInDegrees ? 1 : static_cast<T>(CV_PI/180);
+#include "mathfuncs_core.simd.hpp"
+#include "mathfuncs_core.simd_declarations.hpp" // generated by ocv_add_dispatched_file(), see CMakeLists.txt
 
-#if CV_SIMD128
-    i = v_atan<T>(scale)(len, Y, X, angle);
-#endif
-
-    for( ; i < len; i++ )
-    {
-        angle[i] = atanImpl<T>(Y[i], X[i]) * scale;
-    }
-}
-
-} // anonymous::
+using namespace std;
 
 namespace cv { namespace hal {
 
@@ -206,7 +56,7 @@ void fastAtan32f(const float *Y, const float *X, float *angle, int len, bool ang
     CV_INSTRUMENT_REGION()
 
     CALL_HAL(fastAtan32f, cv_hal_fastAtan32f, Y, X, angle, len, angleInDegrees);
-    atanImpl<float>(Y, X, angle, len, angleInDegrees);
+    CV_CPU_DISPATCH(fastAtan32f, (Y, X, angle, len, angleInDegrees));
 }
 
 void fastAtan64f(const double *Y, const double *X, double *angle, int len, bool angleInDegrees)
@@ -214,7 +64,7 @@ void fastAtan64f(const double *Y, const double *X, double *angle, int len, bool
     CV_INSTRUMENT_REGION()
 
     CALL_HAL(fastAtan64f, cv_hal_fastAtan64f, Y, X, angle, len, angleInDegrees);
-    atanImpl<double>(Y, X, angle, len, angleInDegrees);
+    CV_CPU_DISPATCH(fastAtan64f, (Y, X, angle, len, angleInDegrees));
 }
 
 // deprecated
@@ -232,25 +82,7 @@ void magnitude32f(const float* x, const float* y, float* mag, int len)
     CALL_HAL(magnitude32f, cv_hal_magnitude32f, x, y, mag, len);
     CV_IPP_RUN_FAST(CV_INSTRUMENT_FUN_IPP(ippsMagnitude_32f, x, y, mag, len) >= 0);
 
-    int i = 0;
-
-#if CV_SIMD128
-    for( ; i <= len - 8; i += 8 )
-    {
-        v_float32x4 x0 = v_load(x + i), x1 = v_load(x + i + 4);
-        v_float32x4 y0 = v_load(y + i), y1 = v_load(y + i + 4);
-        x0 = v_sqrt(v_muladd(x0, x0, y0*y0));
-        x1 = v_sqrt(v_muladd(x1, x1, y1*y1));
-        v_store(mag + i, x0);
-        v_store(mag + i + 4, x1);
-    }
-#endif
-
-    for( ; i < len; i++ )
-    {
-        float x0 = x[i], y0 = y[i];
-        mag[i] = std::sqrt(x0*x0 + y0*y0);
-    }
+    CV_CPU_DISPATCH(magnitude32f, (x, y, mag, len));
 }
 
 void magnitude64f(const double* x, const double* y, double* mag, int len)
@@ -260,25 +92,7 @@ void magnitude64f(const double* x, const double* y, double* mag, int len)
     CALL_HAL(magnitude64f, cv_hal_magnitude64f, x, y, mag, len);
     CV_IPP_RUN_FAST(CV_INSTRUMENT_FUN_IPP(ippsMagnitude_64f, x, y, mag, len) >= 0);
 
-    int i = 0;
-
-#if CV_SIMD128_64F
-    for( ; i <= len - 4; i += 4 )
-    {
-        v_float64x2 x0 = v_load(x + i), x1 = v_load(x + i + 2);
-        v_float64x2 y0 = v_load(y + i), y1 = v_load(y + i + 2);
-        x0 = v_sqrt(v_muladd(x0, x0, y0*y0));
-        x1 = v_sqrt(v_muladd(x1, x1, y1*y1));
-        v_store(mag + i, x0);
-        v_store(mag + i + 2, x1);
-    }
-#endif
-
-    for( ; i < len; i++ )
-    {
-        double x0 = x[i], y0 = y[i];
-        mag[i] = std::sqrt(x0*x0 + y0*y0);
-    }
+    CV_CPU_DISPATCH(magnitude64f, (x, y, mag, len));
 }
 
 
@@ -289,20 +103,7 @@ void invSqrt32f(const float* src, float* dst, int len)
     CALL_HAL(invSqrt32f, cv_hal_invSqrt32f, src, dst, len);
     CV_IPP_RUN_FAST(CV_INSTRUMENT_FUN_IPP(ippsInvSqrt_32f_A21, src, dst, len) >= 0);
 
-    int i = 0;
-
-#if CV_SIMD128
-    for( ; i <= len - 8; i += 8 )
-    {
-        v_float32x4 t0 = v_load(src + i), t1 = v_load(src + i + 4);
-        t0 = v_invsqrt(t0);
-        t1 = v_invsqrt(t1);
-        v_store(dst + i, t0); v_store(dst + i + 4, t1);
-    }
-#endif
-
-    for( ; i < len; i++ )
-        dst[i] = 1/std::sqrt(src[i]);
+    CV_CPU_DISPATCH(invSqrt32f, (src, dst, len));
 }
 
 
@@ -313,16 +114,7 @@ void invSqrt64f(const double* src, double* dst, int len)
     CALL_HAL(invSqrt64f, cv_hal_invSqrt64f, src, dst, len);
     CV_IPP_RUN_FAST(CV_INSTRUMENT_FUN_IPP(ippsInvSqrt_64f_A50, src, dst, len) >= 0);
 
-    int i = 0;
-
-#if CV_SSE2
-    __m128d v_1 = _mm_set1_pd(1.0);
-    for ( ; i <= len - 2; i += 2)
-        _mm_storeu_pd(dst + i, _mm_div_pd(v_1, _mm_sqrt_pd(_mm_loadu_pd(src + i))));
-#endif
-
-    for( ; i < len; i++ )
-        dst[i] = 1/std::sqrt(src[i]);
+    CV_CPU_DISPATCH(invSqrt64f, (src, dst, len));
 }
 
 
@@ -333,20 +125,7 @@ void sqrt32f(const float* src, float* dst, int len)
     CALL_HAL(sqrt32f, cv_hal_sqrt32f, src, dst, len);
     CV_IPP_RUN_FAST(CV_INSTRUMENT_FUN_IPP(ippsSqrt_32f_A21, src, dst, len) >= 0);
 
-    int i = 0;
-
-#if CV_SIMD128
-    for( ; i <= len - 8; i += 8 )
-    {
-        v_float32x4 t0 = v_load(src + i), t1 = v_load(src + i + 4);
-        t0 = v_sqrt(t0);
-        t1 = v_sqrt(t1);
-        v_store(dst + i, t0); v_store(dst + i + 4, t1);
-    }
-#endif
-
-    for( ; i < len; i++ )
-        dst[i] = std::sqrt(src[i]);
+    CV_CPU_DISPATCH(sqrt32f, (src, dst, len));
 }
 
 
@@ -357,20 +136,7 @@ void sqrt64f(const double* src, double* dst, int len)
     CALL_HAL(sqrt64f, cv_hal_sqrt64f, src, dst, len);
     CV_IPP_RUN_FAST(CV_INSTRUMENT_FUN_IPP(ippsSqrt_64f_A50, src, dst, len) >= 0);
 
-    int i = 0;
-
-#if CV_SIMD128_64F
-    for( ; i <= len - 4; i += 4 )
-    {
-        v_float64x2 t0 = v_load(src + i), t1 = v_load(src + i + 2);
-        t0 = v_sqrt(t0);
-        t1 = v_sqrt(t1);
-        v_store(dst + i, t0); v_store(dst + i + 2, t1);
-    }
-#endif
-
-    for( ; i < len; i++ )
-        dst[i] = std::sqrt(src[i]);
+    CV_CPU_DISPATCH(sqrt64f, (src, dst, len));
 }
 
 // Workaround for ICE in MSVS 2015 update 3 (issue #7795)
@@ -1583,5 +1349,5 @@ void invSqrt(const double* src, double* dst, int len)
 
 float cv::fastAtan2( float y, float x )
 {
-    return atanImpl<float>(y, x);
+    return cv::hal::cpu_baseline::atanImpl<float>(y, x);
 }
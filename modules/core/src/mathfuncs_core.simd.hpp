@@ -0,0 +1,448 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+// The kernels of the element-wise math functions of cv::hal. The file is compiled into the regular
+// build (the cpu_baseline namespace, via mathfuncs_core.cpp) and once more for each instruction set
+// listed in ocv_add_dispatched_file() of modules/core/CMakeLists.txt (opt_AVX2, ...).
+// There is no include guard: the generated mathfuncs_core.simd_declarations.hpp includes the file
+// again with CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY defined to declare the dispatched variants.
+
+#include "opencv2/core/hal/intrin.hpp"
+#include <cfloat>
+#include <cmath>
+
+namespace cv { namespace hal {
+CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN
+
+void fastAtan32f(const float *Y, const float *X, float *angle, int len, bool angleInDegrees);
+void fastAtan64f(const double *Y, const double *X, double *angle, int len, bool angleInDegrees);
+void magnitude32f(const float* x, const float* y, float* mag, int len);
+void magnitude64f(const double* x, const double* y, double* mag, int len);
+void invSqrt32f(const float* src, float* dst, int len);
+void invSqrt64f(const double* src, double* dst, int len);
+void sqrt32f(const float* src, float* dst, int len);
+void sqrt64f(const double* src, double* dst, int len);
+
+#ifndef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+static const float atan2_p1 = 0.9997878412794807f*(float)(180/CV_PI);
+static const float atan2_p3 = -0.3258083974640975f*(float)(180/CV_PI);
+static const float atan2_p5 = 0.1555786518463281f*(float)(180/CV_PI);
+static const float atan2_p7 = -0.04432655554792128f*(float)(180/CV_PI);
+
+#if CV_SIMD128
+
+template <typename VT> struct v_math_ops;
+
+template <> struct v_math_ops<v_float32x4>
+{
+    static inline v_float32x4 all(float v) { return v_setall_f32(v); }
+    static inline v_float32x4 load(const float* ptr) { return v_load(ptr); }
+};
+
+#if CV_SIMD128_64F
+template <> struct v_math_ops<v_float64x2>
+{
+    static inline v_float64x2 all(double v) { return v_setall_f64(v); }
+    static inline v_float64x2 load(const double* ptr) { return v_load(ptr); }
+};
+#endif
+
+#if CV_SIMD256
+template <> struct v_math_ops<v_float32x8>
+{
+    static inline v_float32x8 all(float v) { return v256_setall_f32(v); }
+    static inline v_float32x8 load(const float* ptr) { return v256_load(ptr); }
+};
+#endif
+
+#if CV_SIMD256_64F
+template <> struct v_math_ops<v_float64x4>
+{
+    static inline v_float64x4 all(double v) { return v256_setall_f64(v); }
+    static inline v_float64x4 load(const double* ptr) { return v256_load(ptr); }
+};
+#endif
+
+template <typename VT>
+struct v_atan
+{
+    typedef v_math_ops<VT> Ops;
+    typedef typename VT::lane_type T;
+    enum { WorkWidth = VT::nlanes * 2 };
+
+    v_atan(const T & scale)
+        : s(Ops::all(scale))
+    {
+        eps = Ops::all(DBL_EPSILON);
+        z = Ops::all(0);
+        p7 = Ops::all(atan2_p7);
+        p5 = Ops::all(atan2_p5);
+        p3 = Ops::all(atan2_p3);
+        p1 = Ops::all(atan2_p1);
+        val90 = Ops::all(90.f);
+        val180 = Ops::all(180.f);
+        val360 = Ops::all(360.f);
+    }
+
+    inline int operator()(int len, const T * Y, const T * X, T * angle)
+    {
+        int i = 0;
+        const int c = VT::nlanes;
+        for ( ; i <= len - c * 2; i += c * 2)
+        {
+            VT x1 = Ops::load(X + i);
+            VT x2 = Ops::load(X + i + c);
+            VT y1 = Ops::load(Y + i);
+            VT y2 = Ops::load(Y + i + c);
+            v_store(&angle[i], s * one(x1, y1));
+            v_store(&angle[i + c], s * one(x2, y2));
+        }
+        return i;
+    }
+
+private:
+    inline VT one(VT & x, VT & y)
+    {
+        VT ax = v_abs(x);
+        VT ay = v_abs(y);
+        VT c = v_min(ax, ay) / (v_max(ax, ay) + eps);
+        VT cc = c * c;
+        VT a = (((p7 * cc + p5) * cc + p3) * cc + p1) * c;
+        a = v_select(ax >= ay, a, val90 - a);
+        a = v_select(x < z, val180 - a, a);
+        a = v_select(y < z, val360 - a, a);
+        return a;
+    }
+
+private:
+    VT eps;
+    VT z;
+    VT p7;
+    VT p5;
+    VT p3;
+    VT p1;
+    VT val90;
+    VT val180;
+    VT val360;
+    VT s;
+};
+
+#if !CV_SIMD128_64F
+
+// emulation
+struct v_atan_64f_emulated
+{
+    v_atan_64f_emulated(double scale) : impl(static_cast<float>(scale)) {}
+    inline int operator()(int len, const double * Y, const double * X, double * angle)
+    {
+        int i = 0;
+        const int c = v_atan<v_float32x4>::WorkWidth;
+        float bufY[c];
+        float bufX[c];
+        float bufA[c];
+        for ( ; i <= len - c ; i += c)
+        {
+            for (int j = 0; j < c; ++j)
+            {
+                bufY[j] = static_cast<float>(Y[i + j]);
+                bufX[j] = static_cast<float>(X[i + j]);
+            }
+            impl(c, bufY, bufX, bufA);
+            for (int j = 0; j < c; ++j)
+            {
+                angle[i + j] = bufA[j];
+            }
+        }
+        return i;
+    }
+private:
+    v_atan<v_float32x4> impl;
+};
+#endif
+
+#endif
+
+template <typename T>
+static inline T atanImpl(T y, T x)
+{
+    T ax = std::abs(x), ay = std::abs(y);
+    T a, c, c2;
+    if( ax >= ay )
+    {
+        c = ay/(ax + static_cast<T>(DBL_EPSILON));
+        c2 = c*c;
+        a = (((atan2_p7*c2 + atan2_p5)*c2 + atan2_p3)*c2 + atan2_p1)*c;
+    }
+    else
+    {
+        c = ax/(ay + static_cast<T>(DBL_EPSILON));
+        c2 = c*c;
+        a = 90.f - (((atan2_p7*c2 + atan2_p5)*c2 + atan2_p3)*c2 + atan2_p1)*c;
+    }
+    if( x < 0 )
+        a = 180.f - a;
+    if( y < 0 )
+        a = 360.f - a;
+    return a;
+}
+
+///////////////////////////////////// ATAN2 ////////////////////////////////////
+
+void fastAtan32f(const float *Y, const float *X, float *angle, int len, bool angleInDegrees)
+{
+    int i = 0;
+    float scale = angleInDegrees ? 1.f : static_cast<float>(CV_PI/180);
+
+#if CV_SIMD256
+    i = v_atan<v_float32x8>(scale)(len, Y, X, angle);
+#elif CV_SIMD128
+    i = v_atan<v_float32x4>(scale)(len, Y, X, angle);
+#endif
+
+    for( ; i < len; i++ )
+        angle[i] = atanImpl<float>(Y[i], X[i]) * scale;
+}
+
+void fastAtan64f(const double *Y, const double *X, double *angle, int len, bool angleInDegrees)
+{
+    int i = 0;
+    double scale = angleInDegrees ? 1. : CV_PI/180;
+
+#if CV_SIMD256_64F
+    i = v_atan<v_float64x4>(scale)(len, Y, X, angle);
+#elif CV_SIMD128_64F
+    i = v_atan<v_float64x2>(scale)(len, Y, X, angle);
+#elif CV_SIMD128
+    i = v_atan_64f_emulated(scale)(len, Y, X, angle);
+#endif
+
+    for( ; i < len; i++ )
+        angle[i] = atanImpl<double>(Y[i], X[i]) * scale;
+}
+
+///////////////////////////////////// MAGNITUDE ////////////////////////////////////
+
+void magnitude32f(const float* x, const float* y, float* mag, int len)
+{
+    int i = 0;
+
+#if CV_SIMD256
+    for( ; i <= len - 16; i += 16 )
+    {
+        v_float32x8 x0 = v256_load(x + i), x1 = v256_load(x + i + 8);
+        v_float32x8 y0 = v256_load(y + i), y1 = v256_load(y + i + 8);
+        x0 = v_sqrt(v_muladd(x0, x0, y0*y0));
+        x1 = v_sqrt(v_muladd(x1, x1, y1*y1));
+        v_store(mag + i, x0);
+        v_store(mag + i + 8, x1);
+    }
+#endif
+
+#if CV_SIMD128
+    for( ; i <= len - 8; i += 8 )
+    {
+        v_float32x4 x0 = v_load(x + i), x1 = v_load(x + i + 4);
+        v_float32x4 y0 = v_load(y + i), y1 = v_load(y + i + 4);
+        x0 = v_sqrt(v_muladd(x0, x0, y0*y0));
+        x1 = v_sqrt(v_muladd(x1, x1, y1*y1));
+        v_store(mag + i, x0);
+        v_store(mag + i + 4, x1);
+    }
+#endif
+
+    for( ; i < len; i++ )
+    {
+        float x0 = x[i], y0 = y[i];
+        mag[i] = std::sqrt(x0*x0 + y0*y0);
+    }
+}
+
+void magnitude64f(const double* x, const double* y, double* mag, int len)
+{
+    int i = 0;
+
+#if CV_SIMD256_64F
+    for( ; i <= len - 8; i += 8 )
+    {
+        v_float64x4 x0 = v256_load(x + i), x1 = v256_load(x + i + 4);
+        v_float64x4 y0 = v256_load(y + i), y1 = v256_load(y + i + 4);
+        x0 = v_sqrt(v_muladd(x0, x0, y0*y0));
+        x1 = v_sqrt(v_muladd(x1, x1, y1*y1));
+        v_store(mag + i, x0);
+        v_store(mag + i + 4, x1);
+    }
+#endif
+
+#if CV_SIMD128_64F
+    for( ; i <= len - 4; i += 4 )
+    {
+        v_float64x2 x0 = v_load(x + i), x1 = v_load(x + i + 2);
+        v_float64x2 y0 = v_load(y + i), y1 = v_load(y + i + 2);
+        x0 = v_sqrt(v_muladd(x0, x0, y0*y0));
+        x1 = v_sqrt(v_muladd(x1, x1, y1*y1));
+        v_store(mag + i, x0);
+        v_store(mag + i + 2, x1);
+    }
+#endif
+
+    for( ; i < len; i++ )
+    {
+        double x0 = x[i], y0 = y[i];
+        mag[i] = std::sqrt(x0*x0 + y0*y0);
+    }
+}
+
+///////////////////////////////////// SQRT ////////////////////////////////////
+
+void invSqrt32f(const float* src, float* dst, int len)
+{
+    int i = 0;
+
+#if CV_SIMD256
+    for( ; i <= len - 16; i += 16 )
+    {
+        v_float32x8 t0 = v256_load(src + i), t1 = v256_load(src + i + 8);
+        t0 = v_invsqrt(t0);
+        t1 = v_invsqrt(t1);
+        v_store(dst + i, t0); v_store(dst + i + 8, t1);
+    }
+#endif
+
+#if CV_SIMD128
+    for( ; i <= len - 8; i += 8 )
+    {
+        v_float32x4 t0 = v_load(src + i), t1 = v_load(src + i + 4);
+        t0 = v_invsqrt(t0);
+        t1 = v_invsqrt(t1);
+        v_store(dst + i, t0); v_store(dst + i + 4, t1);
+    }
+#endif
+
+    for( ; i < len; i++ )
+        dst[i] = 1/std::sqrt(src[i]);
+}
+
+void invSqrt64f(const double* src, double* dst, int len)
+{
+    int i = 0;
+
+#if CV_SIMD256_64F
+    for( ; i <= len - 8; i += 8 )
+    {
+        v_float64x4 t0 = v256_load(src + i), t1 = v256_load(src + i + 4);
+        t0 = v_invsqrt(t0);
+        t1 = v_invsqrt(t1);
+        v_store(dst + i, t0); v_store(dst + i + 4, t1);
+    }
+#endif
+
+#if CV_SSE2
+    __m128d v_1 = _mm_set1_pd(1.0);
+    for ( ; i <= len - 2; i += 2)
+        _mm_storeu_pd(dst + i, _mm_div_pd(v_1, _mm_sqrt_pd(_mm_loadu_pd(src + i))));
+#endif
+
+    for( ; i < len; i++ )
+        dst[i] = 1/std::sqrt(src[i]);
+}
+
+void sqrt32f(const float* src, float* dst, int len)
+{
+    int i = 0;
+
+#if CV_SIMD256
+    for( ; i <= len - 16; i += 16 )
+    {
+        v_float32x8 t0 = v256_load(src + i), t1 = v256_load(src + i + 8);
+        t0 = v_sqrt(t0);
+        t1 = v_sqrt(t1);
+        v_store(dst + i, t0); v_store(dst + i + 8, t1);
+    }
+#endif
+
+#if CV_SIMD128
+    for( ; i <= len - 8; i += 8 )
+    {
+        v_float32x4 t0 = v_load(src + i), t1 = v_load(src + i + 4);
+        t0 = v_sqrt(t0);
+        t1 = v_sqrt(t1);
+        v_store(dst + i, t0); v_store(dst + i + 4, t1);
+    }
+#endif
+
+    for( ; i < len; i++ )
+        dst[i] = std::sqrt(src[i]);
+}
+
+void sqrt64f(const double* src, double* dst, int len)
+{
+    int i = 0;
+
+#if CV_SIMD256_64F
+    for( ; i <= len - 8; i += 8 )
+    {
+        v_float64x4 t0 = v256_load(src + i), t1 = v256_load(src + i + 4);
+        t0 = v_sqrt(t0);
+        t1 = v_sqrt(t1);
+        v_store(dst + i, t0); v_store(dst + i + 4, t1);
+    }
+#endif
+
+#if CV_SIMD128_64F
+    for( ; i <= len - 4; i += 4 )
+    {
+        v_float64x2 t0 = v_load(src + i), t1 = v_load(src + i + 2);
+        t0 = v_sqrt(t0);
+        t1 = v_sqrt(t1);
+        v_store(dst + i, t0); v_store(dst + i + 2, t1);
+    }
+#endif
+
+    for( ; i < len; i++ )
+        dst[i] = std::sqrt(src[i]);
+}
+
+#endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+CV_CPU_OPTIMIZATION_NAMESPACE_END
+}} // cv::hal::
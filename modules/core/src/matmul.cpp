@@ -865,6 +865,343 @@ static bool ocl_gemm( InputArray matA, InputArray matB, double alpha,
 }
 #endif
 
+/****************************************************************************************\
+*                        Packed, cache-blocked, multi-threaded GEMM                      *
+\****************************************************************************************/
+
+// Built-in GEMM engine that is used when no external BLAS is plugged in via HAL.
+// op(A) and op(B) are copied block by block into contiguous panels (MR rows of A and
+// NR columns of B interleaved along K), so the register-blocked micro-kernel streams
+// both operands linearly from L1/L2. Blocks of D are distributed over parallel_for_.
+//
+// Complex matrices are processed by the same real-valued micro-kernel: a row of A is
+// treated as K*2 reals (re, im, re, im, ...) and every row k of B is expanded into two
+// rows (br, bi, ...) and (-bi, br, ...), so that their product gives
+// (ar*br - ai*bi, ar*bi + ai*br) in the interleaved layout of D.
+//
+// The micro-kernel sums at most KC products in _Tp; the partial sums of consecutive
+// KC blocks are added up in double (like GEMMSingleMul/GEMMBlockMul do for CV_32F),
+// so the precision does not degrade with the length of the product.
+
+template<typename _Tp> struct GEMMPackedBlock
+{
+    enum { MR = 4, NR = 8, MC = 64, NC = 256, KC = 256 };
+};
+
+template<> struct GEMMPackedBlock<double>
+{
+    enum { MR = 4, NR = 4, MC = 64, NC = 128, KC = 256 };
+};
+
+// acc[MR][NR] = sum_k a[k][0..MR) x b[k][0..NR)
+template<typename _Tp> static void
+GEMMPackedMicroKernel( int kc, const _Tp* a, const _Tp* b, _Tp* acc, bool )
+{
+    const int MR = GEMMPackedBlock<_Tp>::MR, NR = GEMMPackedBlock<_Tp>::NR;
+    int i, j;
+
+    for( i = 0; i < MR*NR; i++ )
+        acc[i] = 0;
+
+    for( ; kc > 0; kc--, a += MR, b += NR )
+        for( i = 0; i < MR; i++ )
+        {
+            _Tp ai = a[i];
+            for( j = 0; j < NR; j++ )
+                acc[i*NR + j] += ai*b[j];
+        }
+}
+
+#if CV_SIMD128
+template<> void
+GEMMPackedMicroKernel<float>( int kc, const float* a, const float* b, float* acc, bool haveSIMD )
+{
+    if( !haveSIMD )
+    {
+        for( int i = 0; i < 4*8; i++ )
+            acc[i] = 0.f;
+        for( ; kc > 0; kc--, a += 4, b += 8 )
+            for( int i = 0; i < 4; i++ )
+                for( int j = 0; j < 8; j++ )
+                    acc[i*8 + j] += a[i]*b[j];
+        return;
+    }
+
+    v_float32x4 s00 = v_setzero_f32(), s01 = v_setzero_f32();
+    v_float32x4 s10 = v_setzero_f32(), s11 = v_setzero_f32();
+    v_float32x4 s20 = v_setzero_f32(), s21 = v_setzero_f32();
+    v_float32x4 s30 = v_setzero_f32(), s31 = v_setzero_f32();
+
+    for( ; kc > 0; kc--, a += 4, b += 8 )
+    {
+        v_float32x4 b0 = v_load(b), b1 = v_load(b + 4), t;
+
+        t = v_setall_f32(a[0]);
+        s00 = v_muladd(t, b0, s00); s01 = v_muladd(t, b1, s01);
+        t = v_setall_f32(a[1]);
+        s10 = v_muladd(t, b0, s10); s11 = v_muladd(t, b1, s11);
+        t = v_setall_f32(a[2]);
+        s20 = v_muladd(t, b0, s20); s21 = v_muladd(t, b1, s21);
+        t = v_setall_f32(a[3]);
+        s30 = v_muladd(t, b0, s30); s31 = v_muladd(t, b1, s31);
+    }
+
+    v_store(acc, s00); v_store(acc + 4, s01);
+    v_store(acc + 8, s10); v_store(acc + 12, s11);
+    v_store(acc + 16, s20); v_store(acc + 20, s21);
+    v_store(acc + 24, s30); v_store(acc + 28, s31);
+}
+#endif
+
+#if CV_SIMD128_64F
+template<> void
+GEMMPackedMicroKernel<double>( int kc, const double* a, const double* b, double* acc, bool haveSIMD )
+{
+    if( !haveSIMD )
+    {
+        for( int i = 0; i < 4*4; i++ )
+            acc[i] = 0.;
+        for( ; kc > 0; kc--, a += 4, b += 4 )
+            for( int i = 0; i < 4; i++ )
+                for( int j = 0; j < 4; j++ )
+                    acc[i*4 + j] += a[i]*b[j];
+        return;
+    }
+
+    v_float64x2 s00 = v_setzero_f64(), s01 = v_setzero_f64();
+    v_float64x2 s10 = v_setzero_f64(), s11 = v_setzero_f64();
+    v_float64x2 s20 = v_setzero_f64(), s21 = v_setzero_f64();
+    v_float64x2 s30 = v_setzero_f64(), s31 = v_setzero_f64();
+
+    for( ; kc > 0; kc--, a += 4, b += 4 )
+    {
+        v_float64x2 b0 = v_load(b), b1 = v_load(b + 2), t;
+
+        t = v_setall_f64(a[0]);
+        s00 = v_muladd(t, b0, s00); s01 = v_muladd(t, b1, s01);
+        t = v_setall_f64(a[1]);
+        s10 = v_muladd(t, b0, s10); s11 = v_muladd(t, b1, s11);
+        t = v_setall_f64(a[2]);
+        s20 = v_muladd(t, b0, s20); s21 = v_muladd(t, b1, s21);
+        t = v_setall_f64(a[3]);
+        s30 = v_muladd(t, b0, s30); s31 = v_muladd(t, b1, s31);
+    }
+
+    v_store(acc, s00); v_store(acc + 2, s01);
+    v_store(acc + 4, s10); v_store(acc + 6, s11);
+    v_store(acc + 8, s20); v_store(acc + 10, s21);
+    v_store(acc + 12, s30); v_store(acc + 14, s31);
+}
+#endif
+
+template<typename _Tp> class GEMMPackedInvoker : public ParallelLoopBody
+{
+public:
+    enum
+    {
+        MR = GEMMPackedBlock<_Tp>::MR, NR = GEMMPackedBlock<_Tp>::NR,
+        MC = GEMMPackedBlock<_Tp>::MC, NC = GEMMPackedBlock<_Tp>::NC,
+        KC = GEMMPackedBlock<_Tp>::KC
+    };
+
+    // m, n and k are the sizes of op(A) (m x k), op(B) (k x n) and D (m x n) in elements;
+    // all the steps are given in _Tp units.
+    GEMMPackedInvoker( const _Tp* _a, size_t _a_step, const _Tp* _b, size_t _b_step,
+                       const _Tp* _c, size_t _c_step, _Tp* _d, size_t _d_step,
+                       int _m, int _n, int _k, int _cn, double _alpha, double _beta, int flags )
+        : a(_a), b(_b), c(_c), d(_d), d_step(_d_step),
+          m(_m), n(_n*_cn), k(_k), cn(_cn), alpha(_alpha), beta(_beta)
+    {
+        if( flags & GEMM_1_T )
+            a_step0 = cn, a_step1 = _a_step;
+        else
+            a_step0 = _a_step, a_step1 = cn;
+
+        if( flags & GEMM_2_T )
+            b_step0 = cn, b_step1 = _b_step;
+        else
+            b_step0 = _b_step, b_step1 = cn;
+
+        if( !c )
+            c_step0 = c_step1 = 0;
+        else if( flags & GEMM_3_T )
+            c_step0 = cn, c_step1 = _c_step;
+        else
+            c_step0 = _c_step, c_step1 = cn;
+
+        m_blocks = (m + MC - 1)/MC;
+        n_blocks = (n + NC - 1)/NC;
+        haveSIMD = hasSIMD128();
+    }
+
+    int blocks() const { return m_blocks*n_blocks; }
+
+    void operator()( const Range& range ) const
+    {
+        AutoBuffer<_Tp> _buf(MC*KC + KC*NC + MR*NR);
+        AutoBuffer<double> _sum(MC*NC);
+        _Tp* a_buf = _buf;
+        _Tp* b_buf = a_buf + MC*KC;
+        _Tp* acc = b_buf + KC*NC;
+        double* sum = _sum;
+        // one step along K consumes kc*cn reals of a row of A and kc*cn rows of packed B
+        int kc_max = KC/cn;
+
+        for( int blk = range.start; blk < range.end; blk++ )
+        {
+            int i0 = (blk / n_blocks)*MC, j0 = (blk % n_blocks)*NC;
+            int mc = std::min(m - i0, (int)MC), nc = std::min(n - j0, (int)NC);
+
+            for( int k0 = 0; k0 < k; k0 += kc_max )
+            {
+                int kc = std::min(k - k0, kc_max), kr = kc*cn;
+                packA( a_buf, i0, mc, k0, kc );
+                packB( b_buf, j0, nc, k0, kc );
+
+                for( int j = 0; j < nc; j += NR )
+                    for( int i = 0; i < mc; i += MR )
+                    {
+                        GEMMPackedMicroKernel<_Tp>( kr, a_buf + i*kr, b_buf + j*kr, acc, haveSIMD );
+                        accumulate( acc, sum + i*NC + j, std::min(mc - i, (int)MR),
+                                    std::min(nc - j, (int)NR), k0 == 0 );
+                    }
+            }
+
+            store( sum, i0, mc, j0, nc );
+        }
+    }
+
+protected:
+    // a_buf[p][kk][r] = op(A)(i0 + p*MR + r, k0 + kk/cn)[kk%cn], zero-padded to MR rows
+    void packA( _Tp* a_buf, int i0, int mc, int k0, int kc ) const
+    {
+        int kr = kc*cn;
+        for( int i = 0; i < mc; i += MR, a_buf += MR*kr )
+        {
+            int mr = std::min(mc - i, (int)MR);
+            for( int r = 0; r < MR; r++ )
+            {
+                _Tp* dst = a_buf + r;
+                if( r >= mr )
+                {
+                    for( int kk = 0; kk < kr; kk++ )
+                        dst[kk*MR] = 0;
+                    continue;
+                }
+                const _Tp* src = a + (i0 + i + r)*a_step0 + k0*a_step1;
+                for( int kk = 0; kk < kc; kk++, src += a_step1, dst += MR*cn )
+                {
+                    dst[0] = src[0];
+                    if( cn == 2 )
+                        dst[MR] = src[1];
+                }
+            }
+        }
+    }
+
+    // b_buf[p][kk][col] = op(B')(k0*cn + kk, j0 + p*NR + col), zero-padded to NR columns,
+    // where B' is op(B) itself for real data and the expanded 2k x 2n matrix for complex data
+    void packB( _Tp* b_buf, int j0, int nc, int k0, int kc ) const
+    {
+        int kr = kc*cn;
+        for( int j = 0; j < nc; j += NR, b_buf += NR*kr )
+        {
+            int nr = std::min(nc - j, (int)NR);
+            for( int kk = 0; kk < kc; kk++ )
+            {
+                const _Tp* src = b + (k0 + kk)*b_step0 + ((j0 + j)/cn)*b_step1;
+                _Tp* dst = b_buf + kk*cn*NR;
+                int col = 0;
+                if( cn == 1 )
+                {
+                    for( ; col < nr; col++, src += b_step1 )
+                        dst[col] = src[0];
+                }
+                else
+                {
+                    for( ; col < nr; col += 2, src += b_step1 )
+                    {
+                        _Tp re = src[0], im = src[1];
+                        dst[col] = re; dst[col + 1] = im;
+                        dst[NR + col] = -im; dst[NR + col + 1] = re;
+                    }
+                    for( int t = col; t < NR; t++ )
+                        dst[NR + t] = 0;
+                }
+                for( ; col < NR; col++ )
+                    dst[col] = 0;
+            }
+        }
+    }
+
+    // sum = acc on the first pass along K, sum += acc on the next ones
+    static void accumulate( const _Tp* _acc, double* sum, int mr, int nr, bool first )
+    {
+        for( int i = 0; i < mr; i++, _acc += NR, sum += NC )
+        {
+            if( first )
+                for( int j = 0; j < nr; j++ )
+                    sum[j] = _acc[j];
+            else
+                for( int j = 0; j < nr; j++ )
+                    sum[j] += _acc[j];
+        }
+    }
+
+    // D = alpha*sum + beta*op(C)
+    void store( const double* sum, int i0, int mc, int j0, int nc ) const
+    {
+        for( int i = 0; i < mc; i++, sum += NC )
+        {
+            _Tp* dst = d + (i0 + i)*d_step + j0;
+            if( c )
+            {
+                const _Tp* src = c + (i0 + i)*c_step0;
+                for( int j = 0; j < nc; j++ )
+                {
+                    int jj = j0 + j;
+                    dst[j] = (_Tp)(alpha*sum[j] + beta*src[(jj/cn)*c_step1 + jj%cn]);
+                }
+            }
+            else
+            {
+                for( int j = 0; j < nc; j++ )
+                    dst[j] = (_Tp)(alpha*sum[j]);
+            }
+        }
+    }
+
+private:
+    const _Tp *a, *b, *c;
+    _Tp* d;
+    size_t a_step0, a_step1, b_step0, b_step1, c_step0, c_step1, d_step;
+    int m, n, k, cn;
+    int m_blocks, n_blocks;
+    double alpha, beta;
+    bool haveSIMD;
+};
+
+template<typename _Tp> static void
+GEMMPacked( const Mat& A, const Mat& B, double alpha, const Mat& C, double beta,
+            Mat& D, int len, int flags )
+{
+    int cn = D.channels();
+    GEMMPackedInvoker<_Tp> invoker( A.ptr<_Tp>(), A.step/sizeof(_Tp), B.ptr<_Tp>(), B.step/sizeof(_Tp),
+                                    C.empty() ? 0 : C.ptr<_Tp>(), C.step/sizeof(_Tp),
+                                    D.ptr<_Tp>(), D.step/sizeof(_Tp),
+                                    D.rows, D.cols, len, cn, alpha, beta, flags );
+    parallel_for_( Range(0, invoker.blocks()), invoker, invoker.blocks() );
+}
+
+static bool
+GEMMPackedApplicable( Size d_size, int len )
+{
+    // smaller products are served better by the existing single-pass kernels
+    const int min_size = 64;
+    return d_size.width >= min_size/4 && d_size.height >= min_size/4 && len >= min_size/4 &&
+           (double)d_size.width*d_size.height*len >= (double)min_size*min_size*min_size;
+}
+
 static void gemmImpl( Mat A, Mat B, double alpha,
            Mat C, double beta, Mat D, int flags )
 {
@@ -1157,6 +1494,15 @@ static void gemmImpl( Mat A, Mat B, double alpha,
         }
     }
 
+    if( GEMMPackedApplicable(d_size, len) )
+    {
+        if( CV_MAT_DEPTH(type) == CV_32F )
+            GEMMPacked<float>( A, B, alpha, C, beta, D, len, flags );
+        else
+            GEMMPacked<double>( A, B, alpha, C, beta, D, len, flags );
+        return;
+    }
+
     {
     size_t b_step = B.step;
     GEMMSingleMulFunc singleMulFunc;
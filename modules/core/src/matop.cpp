@@ -203,6 +203,100 @@ public:
     static void makeExpr(MatExpr& res, int method, int ndims, const int* sizes, int type, double alpha=1);
 };
 
+// The chains of element-wise operations are collected into MatExprChain and evaluated in one pass,
+// tile by tile; see MatOp_Fused::assign.
+enum
+{
+    FUSED_LOAD = 0, FUSED_ADDW, FUSED_MUL, FUSED_DIV, FUSED_RECIP,
+    FUSED_ABSDIFF, FUSED_MIN, FUSED_MAX, FUSED_CMP
+};
+
+// a fused operand is evaluated into a temporary matrix instead of being copied into the chain
+// when the chain would get this long
+enum { FUSED_MAX_INSTRS = 32, FUSED_TILE_SIZE = 256 };
+
+struct FusedInstr
+{
+    FusedInstr(int _opcode = FUSED_LOAD, double _alpha = 1, double _beta = 0,
+               const Scalar& _s = Scalar(), int _cmpop = 0)
+        : opcode(_opcode), src1(-1), src2(-1), depth(-1), cmpop(_cmpop),
+          alpha(_alpha), beta(_beta), s(_s) {}
+
+    int opcode;
+    // the instructions computing the operands; FUSED_LOAD keeps the index of the matrix in src1
+    int src1, src2;
+    // the result is rounded and saturated to this depth, as if it were stored to a matrix
+    int depth;
+    int cmpop;
+    double alpha, beta;
+    // the scalar operand, used when there is no second operand
+    Scalar s;
+};
+
+struct MatExprChain
+{
+    std::vector<Mat> args;
+    std::vector<FusedInstr> code;
+};
+
+class MatOp_Fused : public MatOp
+{
+public:
+    MatOp_Fused() {}
+    virtual ~MatOp_Fused() {}
+
+    bool elementWise(const MatExpr& /*expr*/) const { return false; }
+    void assign(const MatExpr& expr, Mat& m, int type=-1) const;
+    void roi(const MatExpr& expr, const Range& rowRange, const Range& colRange, MatExpr& res) const;
+
+    Size size(const MatExpr& expr) const;
+    int type(const MatExpr& expr) const;
+
+    static bool makeExpr(MatExpr& res, const MatExpr& e1, const MatExpr* e2, const FusedInstr& instr);
+    static void makeExpr(MatExpr& res, MatExprChain& chain);
+
+private:
+    static int append(MatExprChain& chain, const MatExpr& e);
+    static int appendOp(MatExprChain& chain, const MatExpr& e);
+    static int push(MatExprChain& chain, const FusedInstr& instr);
+    static int load(MatExprChain& chain, const Mat& m);
+};
+
+static MatOp_Fused g_MatOp_Fused;
+
+// MatExpr has no room for the chain without changing its layout, so the chain is reference-counted
+// through the UMatData of MatExpr::c, like the data of a matrix: the copies of the expression share
+// it and the last one deletes it. The header has no data, so nothing can read or write the chain
+// through it; if c is replaced, the expression is rejected by fusedChain().
+class FusedChainAllocator : public MatAllocator
+{
+public:
+    UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                       int flags, UMatUsageFlags usageFlags) const
+    {
+        // the chain holders are created by MatOp_Fused::makeExpr, this is never called
+        return Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(UMatData* u, int /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const
+    {
+        return u != 0;
+    }
+
+    void deallocate(UMatData* u) const
+    {
+        if(!u)
+            return;
+
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        delete (MatExprChain*)u->userdata;
+        delete u;
+    }
+};
+
+static FusedChainAllocator g_FusedChainAllocator;
+
 static MatOp_Initializer* getGlobalMatOpInitializer()
 {
     CV_SINGLETON_LAZY_INIT(MatOp_Initializer, new MatOp_Initializer())
@@ -220,6 +314,20 @@ static inline bool isSolve(const MatExpr& e) { return e.op == &g_MatOp_Solve; }
 static inline bool isGEMM(const MatExpr& e) { return e.op == &g_MatOp_GEMM; }
 static inline bool isMatProd(const MatExpr& e) { return e.op == &g_MatOp_GEMM && (!e.c.data || e.beta == 0); }
 static inline bool isInitializer(const MatExpr& e) { return e.op == getGlobalMatOpInitializer(); }
+static inline bool isFused(const MatExpr& e) { return e.op == &g_MatOp_Fused; }
+static inline const MatExprChain& fusedChain(const MatExpr& e)
+{
+    if( !e.c.u || e.c.u->currAllocator != &g_FusedChainAllocator )
+        CV_Error(CV_StsBadArg, "The fused expression has no operands");
+    return *(const MatExprChain*)e.c.u->userdata;
+}
+// true if the fused chain of e is copied into the chain rather than evaluated
+static inline bool fitsChain(const MatExprChain& chain, const MatExpr& e)
+{
+    return isFused(e) && chain.code.size() + fusedChain(e).code.size() < FUSED_MAX_INSTRS;
+}
+// the expressions the generic code below uses directly, without evaluating them first
+static inline bool isCheap(const MatExpr& e) { return isIdentity(e) || isScaled(e) || isReciprocal(e); }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -337,6 +445,10 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
     if( this == e2.op )
     {
+        if( (!isCheap(e1) || !isCheap(e2)) &&
+            MatOp_Fused::makeExpr(res, e1, &e2, FusedInstr(FUSED_ADDW, 1, 1)) )
+            return;
+
         double alpha = 1, beta = 1;
         Scalar s;
         Mat m1, m2;
@@ -368,6 +480,9 @@ void MatOp::add(const MatExpr& expr1, const Scalar& s, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION()
 
+    if( !isCheap(expr1) && MatOp_Fused::makeExpr(res, expr1, 0, FusedInstr(FUSED_ADDW, 1, 0, s)) )
+        return;
+
     Mat m1;
     expr1.op->assign(expr1, m1);
     MatOp_AddEx::makeExpr(res, m1, Mat(), 1, 0, s);
@@ -380,6 +495,10 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
     if( this == e2.op )
     {
+        if( (!isCheap(e1) || !isCheap(e2)) &&
+            MatOp_Fused::makeExpr(res, e1, &e2, FusedInstr(FUSED_ADDW, 1, -1)) )
+            return;
+
         double alpha = 1, beta = -1;
         Scalar s;
         Mat m1, m2;
@@ -411,6 +530,9 @@ void MatOp::subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION()
 
+    if( !isCheap(expr) && MatOp_Fused::makeExpr(res, expr, 0, FusedInstr(FUSED_ADDW, -1, 0, s)) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), -1, 0, s);
@@ -423,6 +545,10 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 
     if( this == e2.op )
     {
+        if( (!isCheap(e1) || !isCheap(e2)) &&
+            MatOp_Fused::makeExpr(res, e1, &e2, FusedInstr(FUSED_MUL, scale)) )
+            return;
+
         Mat m1, m2;
 
         if( isReciprocal(e1) )
@@ -474,6 +600,9 @@ void MatOp::multiply(const MatExpr& expr, double s, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION()
 
+    if( !isCheap(expr) && MatOp_Fused::makeExpr(res, expr, 0, FusedInstr(FUSED_ADDW, s)) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), s, 0);
@@ -486,6 +615,10 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
 
     if( this == e2.op )
     {
+        if( (!isCheap(e1) || !isCheap(e2)) &&
+            MatOp_Fused::makeExpr(res, e1, &e2, FusedInstr(FUSED_DIV, scale)) )
+            return;
+
         if( isReciprocal(e1) && isReciprocal(e2) )
             MatOp_Bin::makeExpr(res, '/', e2.a, e1.a, e1.alpha/e2.alpha);
         else
@@ -526,6 +659,9 @@ void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION()
 
+    if( !isCheap(expr) && MatOp_Fused::makeExpr(res, expr, 0, FusedInstr(FUSED_RECIP, s)) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, '/', m, Mat(), s);
@@ -536,6 +672,9 @@ void MatOp::abs(const MatExpr& expr, MatExpr& res) const
 {
     CV_INSTRUMENT_REGION()
 
+    if( !isCheap(expr) && MatOp_Fused::makeExpr(res, expr, 0, FusedInstr(FUSED_ABSDIFF)) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, 'a', m, Mat());
@@ -932,6 +1071,20 @@ MatExpr operator / (const MatExpr& e1, const MatExpr& e2)
     return en;
 }
 
+static MatExpr compareExpr(const MatExpr& e, int cmpop, double s)
+{
+    MatExpr res;
+    if( isIdentity(e) )
+        MatOp_Cmp::makeExpr(res, cmpop, e.a, s);
+    else if( !MatOp_Fused::makeExpr(res, e, 0, FusedInstr(FUSED_CMP, 1, 0, Scalar::all(s), cmpop)) )
+    {
+        Mat m;
+        e.op->assign(e, m);
+        MatOp_Cmp::makeExpr(res, cmpop, m, s);
+    }
+    return res;
+}
+
 MatExpr operator < (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -953,6 +1106,16 @@ MatExpr operator < (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator < (const MatExpr& e, double s)
+{
+    return compareExpr(e, CV_CMP_LT, s);
+}
+
+MatExpr operator < (double s, const MatExpr& e)
+{
+    return compareExpr(e, CV_CMP_GT, s);
+}
+
 MatExpr operator <= (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -974,6 +1137,16 @@ MatExpr operator <= (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator <= (const MatExpr& e, double s)
+{
+    return compareExpr(e, CV_CMP_LE, s);
+}
+
+MatExpr operator <= (double s, const MatExpr& e)
+{
+    return compareExpr(e, CV_CMP_GE, s);
+}
+
 MatExpr operator == (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -995,6 +1168,16 @@ MatExpr operator == (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator == (const MatExpr& e, double s)
+{
+    return compareExpr(e, CV_CMP_EQ, s);
+}
+
+MatExpr operator == (double s, const MatExpr& e)
+{
+    return compareExpr(e, CV_CMP_EQ, s);
+}
+
 MatExpr operator != (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1016,6 +1199,16 @@ MatExpr operator != (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator != (const MatExpr& e, double s)
+{
+    return compareExpr(e, CV_CMP_NE, s);
+}
+
+MatExpr operator != (double s, const MatExpr& e)
+{
+    return compareExpr(e, CV_CMP_NE, s);
+}
+
 MatExpr operator >= (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1037,6 +1230,16 @@ MatExpr operator >= (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator >= (const MatExpr& e, double s)
+{
+    return compareExpr(e, CV_CMP_GE, s);
+}
+
+MatExpr operator >= (double s, const MatExpr& e)
+{
+    return compareExpr(e, CV_CMP_LE, s);
+}
+
 MatExpr operator > (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1058,6 +1261,16 @@ MatExpr operator > (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator > (const MatExpr& e, double s)
+{
+    return compareExpr(e, CV_CMP_GT, s);
+}
+
+MatExpr operator > (double s, const MatExpr& e)
+{
+    return compareExpr(e, CV_CMP_LT, s);
+}
+
 MatExpr min(const Mat& a, const Mat& b)
 {
     CV_INSTRUMENT_REGION()
@@ -1769,6 +1982,507 @@ MatExpr Mat::eye(Size size, int type)
     return e;
 }
 
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int MatOp_Fused::load(MatExprChain& chain, const Mat& m)
+{
+    if( m.dims > 2 || m.channels() > 4 )
+        return -1;
+    if( !chain.args.empty() && (m.size() != chain.args[0].size() || m.channels() != chain.args[0].channels()) )
+        return -1;
+    FusedInstr instr(FUSED_LOAD);
+    instr.src1 = (int)chain.args.size();
+    instr.depth = m.depth();
+    chain.args.push_back(m);
+    chain.code.push_back(instr);
+    return (int)chain.code.size() - 1;
+}
+
+int MatOp_Fused::push(MatExprChain& chain, const FusedInstr& instr)
+{
+    if( instr.src1 < 0 )
+        return -1;
+    int depth = chain.code[instr.src1].depth;
+    if( instr.src2 >= 0 && chain.code[instr.src2].depth != depth )
+        return -1;
+    chain.code.push_back(instr);
+    chain.code.back().depth = instr.opcode == FUSED_CMP ? CV_8U : depth;
+    return (int)chain.code.size() - 1;
+}
+
+// appends the instructions computing e and returns the index of the result; the operations that
+// can't be fused, as well as the fused chains that don't fit, are evaluated into a temporary matrix
+int MatOp_Fused::append(MatExprChain& chain, const MatExpr& e)
+{
+    size_t nargs = chain.args.size(), ninstrs = chain.code.size();
+    int idx = appendOp(chain, e);
+    if( idx >= 0 )
+        return idx;
+    chain.args.resize(nargs);
+    chain.code.resize(ninstrs);
+
+    Mat m;
+    e.op->assign(e, m);
+    idx = load(chain, m);
+    // makeExpr checks the size and the type of the operands before anything is evaluated
+    CV_Assert( idx >= 0 );
+    return idx;
+}
+
+// appends the instructions of e if it can be fused, returns -1 otherwise
+int MatOp_Fused::appendOp(MatExprChain& chain, const MatExpr& e)
+{
+    if( fitsChain(chain, e) )
+    {
+        const MatExprChain& c = fusedChain(e);
+        int argOfs = (int)chain.args.size(), codeOfs = (int)chain.code.size();
+        if( !chain.args.empty() && (c.args[0].size() != chain.args[0].size() ||
+                                    c.args[0].channels() != chain.args[0].channels()) )
+            return -1;
+        chain.args.insert(chain.args.end(), c.args.begin(), c.args.end());
+        for( size_t i = 0; i < c.code.size(); i++ )
+        {
+            FusedInstr instr = c.code[i];
+            instr.src1 += instr.opcode == FUSED_LOAD ? argOfs : codeOfs;
+            if( instr.src2 >= 0 )
+                instr.src2 += codeOfs;
+            chain.code.push_back(instr);
+        }
+        return (int)chain.code.size() - 1;
+    }
+
+    if( isAddEx(e) )
+    {
+        FusedInstr instr(FUSED_ADDW, e.alpha, e.beta, e.s);
+        instr.src1 = load(chain, e.a);
+        if( e.b.data && (instr.src2 = load(chain, e.b)) < 0 )
+            return -1;
+        return push(chain, instr);
+    }
+
+    if( e.op == &g_MatOp_Bin && e.flags != '&' && e.flags != '|' && e.flags != '^' && e.flags != '~' )
+    {
+        FusedInstr instr;
+        instr.src1 = load(chain, e.a);
+        switch( e.flags )
+        {
+        case '*':
+            instr.opcode = FUSED_MUL;
+            break;
+        case '/':
+            instr.opcode = e.b.data ? FUSED_DIV : FUSED_RECIP;
+            break;
+        case 'a':
+            instr.opcode = FUSED_ABSDIFF;
+            instr.s = e.s;
+            break;
+        default:
+            instr.opcode = e.flags == 'm' || e.flags == 'n' ? FUSED_MIN : FUSED_MAX;
+            instr.s = Scalar::all(e.s[0]);
+        }
+        instr.alpha = e.alpha;
+        if( e.b.data && (instr.src2 = load(chain, e.b)) < 0 )
+            return -1;
+        return push(chain, instr);
+    }
+
+    if( isCmp(e) && e.a.channels() == 1 )
+    {
+        FusedInstr instr(FUSED_CMP, 1, 0, Scalar::all(e.alpha), e.flags);
+        instr.src1 = load(chain, e.a);
+        if( e.b.data && (instr.src2 = load(chain, e.b)) < 0 )
+            return -1;
+        return push(chain, instr);
+    }
+
+    if( isIdentity(e) )
+        return load(chain, e.a);
+
+    return -1;
+}
+
+bool MatOp_Fused::makeExpr(MatExpr& res, const MatExpr& e1, const MatExpr* e2, const FusedInstr& instr)
+{
+    // everything that can make the fusion fail is checked here, before append() evaluates
+    // the operands, so that the callers don't evaluate them once again
+    Size sz = e1.size();
+    int type = e1.type(), cn = CV_MAT_CN(type);
+    if( e1.a.dims > 2 || sz.area() == 0 || cn > 4 || (instr.opcode == FUSED_CMP && cn != 1) )
+        return false;
+    if( e2 && (e2->a.dims > 2 || e2->size() != sz || e2->type() != type) )
+        return false;
+
+    MatExprChain chain;
+    FusedInstr op = instr;
+    if( !e2 && op.opcode == FUSED_ADDW && fitsChain(chain, e1) && fusedChain(e1).code.back().opcode == FUSED_ADDW )
+    {
+        // scaling and adding a scalar are folded into the last weighted sum, like MatOp_AddEx does,
+        // so the intermediate result is not rounded; this is only done when the chain of e1
+        // is copied, a chain evaluated into a temporary matrix ends with a FUSED_LOAD
+        append(chain, e1);
+        FusedInstr& last = chain.code.back();
+        last.alpha *= op.alpha;
+        last.beta *= op.alpha;
+        last.s = last.s*op.alpha + op.s;
+    }
+    else
+    {
+        op.src1 = append(chain, e1);
+        if( e2 )
+            op.src2 = append(chain, *e2);
+        if( push(chain, op) < 0 )
+            return false;
+    }
+
+    makeExpr(res, chain);
+    return true;
+}
+
+// moves the chain into a new holder shared by the expression and its copies
+void MatOp_Fused::makeExpr(MatExpr& res, MatExprChain& chain)
+{
+    MatExprChain* program = new MatExprChain;
+    program->args.swap(chain.args);
+    program->code.swap(chain.code);
+
+    Mat holder;
+    UMatData* u = new UMatData(&g_FusedChainAllocator);
+    u->userdata = program;
+    u->refcount = 1;
+    holder.u = u;
+    res = MatExpr(&g_MatOp_Fused, 0, program->args[0], Mat(), holder);
+}
+
+Size MatOp_Fused::size(const MatExpr& e) const
+{
+    return fusedChain(e).args[0].size();
+}
+
+int MatOp_Fused::type(const MatExpr& e) const
+{
+    const MatExprChain& chain = fusedChain(e);
+    return CV_MAKETYPE(chain.code.back().depth, chain.args[0].channels());
+}
+
+void MatOp_Fused::roi(const MatExpr& e, const Range& rowRange, const Range& colRange, MatExpr& res) const
+{
+    MatExprChain chain = fusedChain(e);
+    for( size_t i = 0; i < chain.args.size(); i++ )
+        chain.args[i] = chain.args[i](rowRange, colRange);
+    makeExpr(res, chain);
+}
+
+// The operations of the fused chains are applied to the tiles kept in float or double arrays;
+// each one is a functor with the scalar version and, where the universal intrinsics support
+// the working type, the vector one
+
+template<typename WT> struct FusedVecTraits { enum { enabled = 0 }; };
+
+#if CV_SIMD128
+template<> struct FusedVecTraits<float>
+{
+    typedef v_float32x4 vec;
+    enum { enabled = 1, nlanes = 4 };
+    static inline vec all(float x) { return v_setall_f32(x); }
+};
+#endif
+
+#if CV_SIMD128_64F
+template<> struct FusedVecTraits<double>
+{
+    typedef v_float64x2 vec;
+    enum { enabled = 1, nlanes = 2 };
+    static inline vec all(double x) { return v_setall_f64(x); }
+};
+#endif
+
+template<typename WT, class Op, int vectorized> struct FusedVecLoop
+{
+    static int run(const WT*, const WT*, const WT*, WT*, int, const Op&) { return 0; }
+};
+
+#if CV_SIMD128
+template<typename WT, class Op> struct FusedVecLoop<WT, Op, 1>
+{
+    static int run(const WT* a, const WT* b, const WT* c, WT* r, int n, const Op& op)
+    {
+        typedef FusedVecTraits<WT> Traits;
+        int i = 0;
+        for( ; i <= n - Traits::nlanes; i += Traits::nlanes )
+            v_store(r + i, op(v_load(a + i), v_load(b + i), v_load(c + i)));
+        return i;
+    }
+};
+#endif
+
+// r = op(a, b, c) for the n elements; the operations that take fewer operands ignore the rest
+template<typename WT, class Op> static void
+fusedLoop( const WT* a, const WT* b, const WT* c, WT* r, int n, const Op& op )
+{
+    int i = FusedVecLoop<WT, Op, FusedVecTraits<WT>::enabled>::run(a, b, c, r, n, op);
+    for( ; i < n; i++ )
+        r[i] = op(a[i], b[i], c[i]);
+}
+
+template<typename WT> struct FusedAddW
+{
+    FusedAddW(WT _alpha, WT _beta) : alpha(_alpha), beta(_beta) {}
+    WT operator()(WT a, WT b, WT s) const { return a*alpha + b*beta + s; }
+    template<typename V> V operator()(const V& a, const V& b, const V& s) const
+    { return a*FusedVecTraits<WT>::all(alpha) + b*FusedVecTraits<WT>::all(beta) + s; }
+    WT alpha, beta;
+};
+
+template<typename WT> struct FusedScaleAdd
+{
+    FusedScaleAdd(WT _alpha) : alpha(_alpha) {}
+    WT operator()(WT a, WT, WT s) const { return a*alpha + s; }
+    template<typename V> V operator()(const V& a, const V&, const V& s) const
+    { return a*FusedVecTraits<WT>::all(alpha) + s; }
+    WT alpha;
+};
+
+template<typename WT> struct FusedMul
+{
+    FusedMul(WT _alpha) : alpha(_alpha) {}
+    WT operator()(WT a, WT b, WT) const { return a*b*alpha; }
+    template<typename V> V operator()(const V& a, const V& b, const V&) const
+    { return a*b*FusedVecTraits<WT>::all(alpha); }
+    WT alpha;
+};
+
+// the division by zero gives zero, as in cv::divide
+template<typename WT> struct FusedDiv
+{
+    FusedDiv(WT _alpha) : alpha(_alpha) {}
+    WT operator()(WT a, WT b, WT) const { return b != 0 ? a*alpha/b : 0; }
+    template<typename V> V operator()(const V& a, const V& b, const V&) const
+    { return (a*FusedVecTraits<WT>::all(alpha)/b) & (b != FusedVecTraits<WT>::all(0)); }
+    WT alpha;
+};
+
+template<typename WT> struct FusedRecip
+{
+    FusedRecip(WT _alpha) : alpha(_alpha) {}
+    WT operator()(WT a, WT, WT) const { return a != 0 ? alpha/a : 0; }
+    template<typename V> V operator()(const V& a, const V&, const V&) const
+    { return (FusedVecTraits<WT>::all(alpha)/a) & (a != FusedVecTraits<WT>::all(0)); }
+    WT alpha;
+};
+
+template<typename WT> struct FusedAbsDiff
+{
+    WT operator()(WT a, WT b, WT) const { return std::abs(a - b); }
+    template<typename V> V operator()(const V& a, const V& b, const V&) const { return v_abs(a - b); }
+};
+
+template<typename WT> struct FusedMin
+{
+    WT operator()(WT a, WT b, WT) const { return std::min(a, b); }
+    template<typename V> V operator()(const V& a, const V& b, const V&) const { return v_min(a, b); }
+};
+
+template<typename WT> struct FusedMax
+{
+    WT operator()(WT a, WT b, WT) const { return std::max(a, b); }
+    template<typename V> V operator()(const V& a, const V& b, const V&) const { return v_max(a, b); }
+};
+
+// the comparisons give 255 or 0; the vector masks select the bits of 255
+#define CV_FUSED_CMP_OP(name, op) \
+template<typename WT> struct name \
+{ \
+    WT operator()(WT a, WT b, WT) const { return a op b ? (WT)255 : (WT)0; } \
+    template<typename V> V operator()(const V& a, const V& b, const V&) const \
+    { return (a op b) & FusedVecTraits<WT>::all(255); } \
+}
+
+CV_FUSED_CMP_OP(FusedCmpEQ, ==);
+CV_FUSED_CMP_OP(FusedCmpNE, !=);
+CV_FUSED_CMP_OP(FusedCmpGT, >);
+CV_FUSED_CMP_OP(FusedCmpGE, >=);
+CV_FUSED_CMP_OP(FusedCmpLT, <);
+CV_FUSED_CMP_OP(FusedCmpLE, <=);
+
+#undef CV_FUSED_CMP_OP
+
+// rounds and saturates the values to the integer type T, as if they were stored to a matrix
+template<typename T, typename WT> struct FusedSaturate
+{
+    FusedSaturate() : lo((int)std::numeric_limits<T>::min()), hi((int)std::numeric_limits<T>::max()) {}
+    WT operator()(WT a, WT, WT) const { return (WT)saturate_cast<T>(a); }
+#if CV_SIMD128
+    v_float32x4 operator()(const v_float32x4& a, const v_float32x4&, const v_float32x4&) const
+    { return v_cvt_f32(v_min(v_max(v_round(a), v_setall_s32(lo)), v_setall_s32(hi))); }
+#endif
+#if CV_SIMD128_64F
+    v_float64x2 operator()(const v_float64x2& a, const v_float64x2&, const v_float64x2&) const
+    { return v_cvt_f64(v_min(v_max(v_round(a), v_setall_s32(lo)), v_setall_s32(hi))); }
+#endif
+    int lo, hi;
+};
+
+// rounds the double values to float
+struct FusedSaturate32f
+{
+    double operator()(double a, double, double) const { return (double)(float)a; }
+#if CV_SIMD128_64F
+    v_float64x2 operator()(const v_float64x2& a, const v_float64x2&, const v_float64x2&) const
+    { return v_cvt_f64(v_cvt_f32(a)); }
+#endif
+};
+
+template<typename WT> class FusedInvoker : public ParallelLoopBody
+{
+public:
+    FusedInvoker(const MatExprChain& _chain, Mat& _dst) : chain(_chain), dst(_dst)
+    {
+        int cn = dst.channels(), wdepth = DataDepth<WT>::value;
+        ninstrs = (int)chain.code.size();
+        tile = FUSED_TILE_SIZE/cn*cn;
+        // the scalar operands are expanded into the arrays of the tile size, so that
+        // the multi-channel elements are processed as plain arrays
+        scalars.resize(ninstrs*tile);
+        for( int k = 0; k < ninstrs; k++ )
+            for( int i = 0; i < tile; i++ )
+                scalars[k*tile + i] = (WT)chain.code[k].s[i % cn];
+        // the operands are loaded and the result is stored by the (vectorized) convertTo kernels
+        loadFuncs.resize(ninstrs);
+        for( int k = 0; k < ninstrs; k++ )
+            if( chain.code[k].opcode == FUSED_LOAD )
+                loadFuncs[k] = getConvertFunc(chain.args[chain.code[k].src1].depth(), wdepth);
+        storeFunc = getConvertFunc(wdepth, dst.depth());
+        CV_Assert(storeFunc != 0);
+    }
+
+    void operator()(const Range& range) const
+    {
+        int width = dst.cols*dst.channels(), nargs = (int)chain.args.size();
+        AutoBuffer<WT> _regs(ninstrs*tile);
+        AutoBuffer<const uchar*> _ptrs(nargs);
+        WT* regs = _regs;
+        const uchar** ptrs = _ptrs;
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            for( int j = 0; j < nargs; j++ )
+                ptrs[j] = chain.args[j].ptr(y);
+            uchar* dptr = dst.ptr(y);
+
+            for( int x = 0; x < width; x += tile )
+            {
+                int n = std::min(tile, width - x);
+                for( int k = 0; k < ninstrs; k++ )
+                    exec(chain.code[k], regs, k, ptrs, x, n);
+                storeFunc((const uchar*)(regs + (ninstrs - 1)*tile), 0, 0, 0,
+                          dptr + x*dst.elemSize1(), 0, Size(n, 1), 0);
+            }
+        }
+    }
+
+private:
+    void exec(const FusedInstr& instr, WT* regs, int k, const uchar** ptrs, int x, int n) const
+    {
+        WT* r = regs + k*tile;
+        const WT* a = regs + instr.src1*tile;
+        const WT* b = instr.src2 >= 0 ? regs + instr.src2*tile : 0;
+        const WT* s = &scalars[k*tile];
+        WT alpha = (WT)instr.alpha, beta = (WT)instr.beta;
+
+        switch( instr.opcode )
+        {
+        case FUSED_LOAD:
+        {
+            const Mat& m = chain.args[instr.src1];
+            loadFuncs[k](ptrs[instr.src1] + x*m.elemSize1(), 0, 0, 0, (uchar*)r, 0, Size(n, 1), 0);
+            return;
+        }
+        case FUSED_ADDW:
+            if( b )
+                fusedLoop(a, b, s, r, n, FusedAddW<WT>(alpha, beta));
+            else
+                fusedLoop(a, a, s, r, n, FusedScaleAdd<WT>(alpha));
+            break;
+        case FUSED_MUL:
+            fusedLoop(a, b, a, r, n, FusedMul<WT>(alpha));
+            break;
+        case FUSED_DIV:
+            fusedLoop(a, b, a, r, n, FusedDiv<WT>(alpha));
+            break;
+        case FUSED_RECIP:
+            fusedLoop(a, a, a, r, n, FusedRecip<WT>(alpha));
+            break;
+        case FUSED_ABSDIFF:
+            fusedLoop(a, b ? b : s, a, r, n, FusedAbsDiff<WT>());
+            break;
+        case FUSED_MIN:
+            fusedLoop(a, b ? b : s, a, r, n, FusedMin<WT>());
+            break;
+        case FUSED_MAX:
+            fusedLoop(a, b ? b : s, a, r, n, FusedMax<WT>());
+            break;
+        case FUSED_CMP:
+            b = b ? b : s;
+            switch( instr.cmpop )
+            {
+            case CMP_EQ: fusedLoop(a, b, a, r, n, FusedCmpEQ<WT>()); break;
+            case CMP_GT: fusedLoop(a, b, a, r, n, FusedCmpGT<WT>()); break;
+            case CMP_GE: fusedLoop(a, b, a, r, n, FusedCmpGE<WT>()); break;
+            case CMP_LT: fusedLoop(a, b, a, r, n, FusedCmpLT<WT>()); break;
+            case CMP_LE: fusedLoop(a, b, a, r, n, FusedCmpLE<WT>()); break;
+            default: fusedLoop(a, b, a, r, n, FusedCmpNE<WT>());
+            }
+            return;
+        default:
+            CV_Error(CV_StsError, "Unknown operation");
+        }
+
+        // round and saturate the result, as if it were stored to a matrix
+        switch( instr.depth )
+        {
+        case CV_8U: fusedLoop(r, r, r, r, n, FusedSaturate<uchar, WT>()); break;
+        case CV_8S: fusedLoop(r, r, r, r, n, FusedSaturate<schar, WT>()); break;
+        case CV_16U: fusedLoop(r, r, r, r, n, FusedSaturate<ushort, WT>()); break;
+        case CV_16S: fusedLoop(r, r, r, r, n, FusedSaturate<short, WT>()); break;
+        case CV_32S: fusedLoop(r, r, r, r, n, FusedSaturate<int, WT>()); break;
+        case CV_32F: saturate32f(r, n); break;
+        default: ;
+        }
+    }
+
+    static void saturate32f(float*, int) {}
+    static void saturate32f(double* r, int n) { fusedLoop(r, r, r, r, n, FusedSaturate32f()); }
+
+    const MatExprChain& chain;
+    Mat& dst;
+    int ninstrs, tile;
+    std::vector<WT> scalars;
+    std::vector<BinaryFunc> loadFuncs;
+    BinaryFunc storeFunc;
+};
+
+void MatOp_Fused::assign(const MatExpr& e, Mat& m, int _type) const
+{
+    CV_INSTRUMENT_REGION()
+
+    const MatExprChain& chain = fusedChain(e);
+    int type = _type < 0 ? this->type(e) : CV_MAKETYPE(CV_MAT_DEPTH(_type), chain.args[0].channels());
+    m.create(chain.args[0].size(), type);
+
+    // float is enough to compute the results of 8-bit and 16-bit operations exactly, as the regular
+    // arithmetic functions do; 32-bit integers and doubles need double
+    bool useDouble = m.depth() >= CV_32S && m.depth() != CV_32F;
+    for( size_t i = 0; i < chain.code.size(); i++ )
+        useDouble = useDouble || (chain.code[i].depth >= CV_32S && chain.code[i].depth != CV_32F);
+
+    double nstripes = (double)m.total()*m.channels()*chain.code.size()/(1 << 16);
+    if( useDouble )
+        parallel_for_(Range(0, m.rows), FusedInvoker<double>(chain, m), nstripes);
+    else
+        parallel_for_(Range(0, m.rows), FusedInvoker<float>(chain, m), nstripes);
+}
+
 }
 
 /* End of file. */
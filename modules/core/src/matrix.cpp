@@ -168,28 +168,303 @@ BufferPoolController* MatAllocator::getBufferPoolController(const char* id) cons
     return &dummy;
 }
 
+// computes the steps of a new matrix (unless they are given with the user data) and its size in bytes
+static size_t computeAllocationSize(int dims, const int* sizes, int type, void* data0, size_t* step)
+{
+    size_t total = CV_ELEM_SIZE(type);
+    for( int i = dims-1; i >= 0; i-- )
+    {
+        if( step )
+        {
+            if( data0 && step[i] != CV_AUTOSTEP )
+            {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            }
+            else
+                step[i] = total;
+        }
+        total *= sizes[i];
+    }
+    return total;
+}
+
+/*
+   The pages of a new buffer are placed on the NUMA node of the CPU which touches them first.
+   When the thread pool is pinned (see setThreadAffinity), a large buffer is touched by the pool
+   threads along the first dimension, the same way the parallel loops split the rows between them,
+   so the rows stay local to the threads that will process them.
+*/
+class FirstTouchInvoker : public ParallelLoopBody
+{
+public:
+    FirstTouchInvoker(uchar* _data, size_t _rowSize) : data(_data), rowSize(_rowSize) {}
+
+    void operator()(const Range& range) const
+    {
+        const size_t pageSize = 4096;
+        uchar* begin = data + range.start*rowSize;
+        uchar* end = data + range.end*rowSize;
+        for( uchar* p = begin; p < end; p += pageSize )
+            *p = 0;
+    }
+
+private:
+    uchar* data;
+    size_t rowSize;
+};
+
+static void firstTouch(uchar* data, int dims, const int* sizes, const size_t* step)
+{
+    static const size_t minFirstTouchSize = (size_t)4 << 20;
+    if( dims < 1 || sizes[0] < 2 || step[0]*sizes[0] < minFirstTouchSize )
+        return;
+
+    if( getThreadAffinitySize() > 1 )
+        parallel_for_(Range(0, sizes[0]), FirstTouchInvoker(data, step[0]));
+}
+
 class StdMatAllocator : public MatAllocator
 {
 public:
     UMatData* allocate(int dims, const int* sizes, int type,
                        void* data0, size_t* step, int /*flags*/, UMatUsageFlags /*usageFlags*/) const
     {
-        size_t total = CV_ELEM_SIZE(type);
-        for( int i = dims-1; i >= 0; i-- )
+        size_t total = computeAllocationSize(dims, sizes, type, data0, step);
+        uchar* data = data0 ? (uchar*)data0 : (uchar*)fastMalloc(total);
+        if( !data0 )
+            firstTouch(data, dims, sizes, step);
+        UMatData* u = new UMatData(this);
+        u->data = u->origdata = data;
+        u->size = total;
+        if(data0)
+            u->flags |= UMatData::USER_ALLOCATED;
+
+        return u;
+    }
+
+    bool allocate(UMatData* u, int /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const
+    {
+        if(!u) return false;
+        return true;
+    }
+
+    void deallocate(UMatData* u) const
+    {
+        if(!u)
+            return;
+
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        if( !(u->flags & UMatData::USER_ALLOCATED) )
+        {
+            fastFree(u->origdata);
+            u->origdata = 0;
+        }
+        delete u;
+    }
+};
+
+/*
+   Pool of the CPU buffers.
+
+   The buffers are grouped by size classes, 8 classes per power of two, so a buffer is at
+   most 12.5% bigger than requested and can be reused for any size of its class. The
+   released buffers are kept in per-thread lists (the typical pattern is a loop which
+   creates and releases the same temporary matrices), the lock of a list is taken by
+   other threads only to collect the statistics or to free the reserved buffers.
+
+   Small buffers are served by fastMalloc directly: the system allocator handles them
+   efficiently and they don't cause page faults. Any bigger buffer is kept as long as the
+   total capacity of the reserved buffers stays within the limit, so full frames are pooled
+   too; when the limit is lowered, the biggest classes are freed first.
+*/
+class MatBufferPool : public BufferPoolController
+{
+public:
+    MatBufferPool() : maxReservedSize(0), reservedUnits(0) {}
+
+    virtual ~MatBufferPool()
+    {
+        freeAllReservedBuffers();
+    }
+
+    uchar* allocate(size_t size)
+    {
+        size_t capacity = 0;
+        int cls = sizeClass(size, capacity);
+        if( cls < 0 )
+            return (uchar*)fastMalloc(size);
+
+        ThreadCache* cache = caches.get();
+        {
+            AutoLock lock(cache->mutex);
+            if( cls < (int)cache->freeLists.size() && !cache->freeLists[cls].empty() )
+            {
+                uchar* data = cache->freeLists[cls].back();
+                cache->freeLists[cls].pop_back();
+                CV_XADD(&reservedUnits, -(int)(capacity / RESERVED_UNIT));
+                cache->hits++;
+                return data;
+            }
+            cache->misses++;
+        }
+
+        return (uchar*)fastMalloc(capacity);
+    }
+
+    void release(uchar* data, size_t size)
+    {
+        size_t capacity = 0;
+        int cls = sizeClass(size, capacity);
+        size_t maxSize = maxReservedSize;
+        if( cls < 0 || capacity > maxSize )
+        {
+            fastFree(data);
+            return;
+        }
+
+        int units = (int)(capacity / RESERVED_UNIT);
+        if( (size_t)(CV_XADD(&reservedUnits, units) + units) * RESERVED_UNIT > maxSize )
+        {
+            CV_XADD(&reservedUnits, -units);
+            fastFree(data);
+            return;
+        }
+
+        ThreadCache* cache = caches.get();
+        AutoLock lock(cache->mutex);
+        if( (int)cache->freeLists.size() <= cls )
+            cache->freeLists.resize(cls + 1);
+        cache->freeLists[cls].push_back(data);
+    }
+
+    virtual size_t getReservedSize() const { return (size_t)reservedUnits * RESERVED_UNIT; }
+    virtual size_t getMaxReservedSize() const { return maxReservedSize; }
+
+    virtual void setMaxReservedSize(size_t size)
+    {
+        size_t oldMaxReservedSize = maxReservedSize;
+        maxReservedSize = size;
+        if( maxReservedSize < oldMaxReservedSize )
+            trim(maxReservedSize);
+    }
+
+    virtual void freeAllReservedBuffers()
+    {
+        trim(0);
+    }
+
+    virtual void getStatistics(size_t& hits, size_t& misses) const
+    {
+        hits = misses = 0;
+
+        std::vector<ThreadCache*> data;
+        caches.gather(data);
+        for( size_t i = 0; i < data.size(); i++ )
+        {
+            if( !data[i] )
+                continue;
+            AutoLock lock(data[i]->mutex);
+            hits += data[i]->hits;
+            misses += data[i]->misses;
+        }
+    }
+
+    virtual void resetStatistics()
+    {
+        std::vector<ThreadCache*> data;
+        caches.gather(data);
+        for( size_t i = 0; i < data.size(); i++ )
         {
-            if( step )
+            if( !data[i] )
+                continue;
+            AutoLock lock(data[i]->mutex);
+            data[i]->hits = data[i]->misses = 0;
+        }
+    }
+
+protected:
+    enum
+    {
+        MIN_POOLED_SIZE_LOG = 12,
+        CLASS_STEPS_LOG = 3,
+        // the smallest difference between the class sizes, all the capacities are multiple of it
+        RESERVED_UNIT = 1 << (MIN_POOLED_SIZE_LOG - CLASS_STEPS_LOG)
+    };
+
+    struct ThreadCache
+    {
+        ThreadCache() : hits(0), misses(0) {}
+
+        Mutex mutex;
+        std::vector<std::vector<uchar*> > freeLists;
+        size_t hits, misses;
+    };
+
+    static int sizeClass(size_t size, size_t& capacity)
+    {
+        if( size < ((size_t)1 << MIN_POOLED_SIZE_LOG) )
+            return -1;
+
+        int p = MIN_POOLED_SIZE_LOG;
+        while( p < (int)sizeof(size_t)*8 - 1 && ((size_t)1 << (p + 1)) <= size )
+            p++;
+
+        int shift = p - CLASS_STEPS_LOG;
+        size_t n = (size + ((size_t)1 << shift) - 1) >> shift;
+        capacity = n << shift;
+        return (p - MIN_POOLED_SIZE_LOG)*(1 << CLASS_STEPS_LOG) + (int)n - (1 << CLASS_STEPS_LOG);
+    }
+
+    static size_t classCapacity(int cls)
+    {
+        int shift = cls / (1 << CLASS_STEPS_LOG) + MIN_POOLED_SIZE_LOG - CLASS_STEPS_LOG;
+        return ((size_t)(cls % (1 << CLASS_STEPS_LOG)) + (1 << CLASS_STEPS_LOG)) << shift;
+    }
+
+    // frees the reserved buffers, the biggest ones first, until the reserved size fits the limit
+    void trim(size_t limit)
+    {
+        std::vector<ThreadCache*> data;
+        caches.gather(data);
+        for( size_t i = 0; i < data.size(); i++ )
+        {
+            if( !data[i] )
+                continue;
+            AutoLock lock(data[i]->mutex);
+            std::vector<std::vector<uchar*> >& lists = data[i]->freeLists;
+            for( int cls = (int)lists.size() - 1; cls >= 0; cls-- )
             {
-                if( data0 && step[i] != CV_AUTOSTEP )
+                size_t capacity = classCapacity(cls);
+                while( !lists[cls].empty() && getReservedSize() > limit )
                 {
-                    CV_Assert(total <= step[i]);
-                    total = step[i];
+                    fastFree(lists[cls].back());
+                    lists[cls].pop_back();
+                    CV_XADD(&reservedUnits, -(int)(capacity / RESERVED_UNIT));
                 }
-                else
-                    step[i] = total;
             }
-            total *= sizes[i];
         }
-        uchar* data = data0 ? (uchar*)data0 : (uchar*)fastMalloc(total);
+    }
+
+    size_t maxReservedSize;
+    int reservedUnits;
+    TLSData<ThreadCache> caches;
+};
+
+class PoolMatAllocator : public MatAllocator
+{
+public:
+    PoolMatAllocator()
+    {
+        pool.setMaxReservedSize(getConfigurationParameterForSize("OPENCV_MAT_BUFFERPOOL_LIMIT", 1 << 27));
+    }
+
+    UMatData* allocate(int dims, const int* sizes, int type,
+                       void* data0, size_t* step, int /*flags*/, UMatUsageFlags /*usageFlags*/) const
+    {
+        size_t total = computeAllocationSize(dims, sizes, type, data0, step);
+        uchar* data = data0 ? (uchar*)data0 : pool.allocate(total);
         UMatData* u = new UMatData(this);
         u->data = u->origdata = data;
         u->size = total;
@@ -214,11 +489,23 @@ public:
         CV_Assert(u->refcount == 0);
         if( !(u->flags & UMatData::USER_ALLOCATED) )
         {
-            fastFree(u->origdata);
+            pool.release(u->origdata, u->size);
             u->origdata = 0;
         }
         delete u;
     }
+
+    BufferPoolController* getBufferPoolController(const char* id) const
+    {
+        if (id != NULL && strcmp(id, "CPU") != 0)
+        {
+            CV_ErrorNoReturn(cv::Error::StsBadArg, "getBufferPoolController(): unknown BufferPool ID\n");
+        }
+        return &pool;
+    }
+
+protected:
+    mutable MatBufferPool pool;
 };
 namespace
 {
@@ -230,7 +517,8 @@ MatAllocator* Mat::getDefaultAllocator()
 {
     if (g_matAllocator == NULL)
     {
-        g_matAllocator = getStdAllocator();
+        static bool usePool = getConfigurationParameterForSize("OPENCV_MAT_BUFFERPOOL_LIMIT", 0) > 0;
+        g_matAllocator = usePool ? getPoolAllocator() : getStdAllocator();
     }
     return g_matAllocator;
 }
@@ -242,6 +530,10 @@ MatAllocator* Mat::getStdAllocator()
 {
     CV_SINGLETON_LAZY_INIT(MatAllocator, new StdMatAllocator())
 }
+MatAllocator* Mat::getPoolAllocator()
+{
+    CV_SINGLETON_LAZY_INIT(MatAllocator, new PoolMatAllocator())
+}
 
 void swap( Mat& a, Mat& b )
 {
@@ -3406,6 +3698,123 @@ cv::Mat cv::Mat::cross(InputArray _m) const
 namespace cv
 {
 
+// accumulates a row into the buffer, returns the number of the processed elements
+template<typename T, class Op> struct ReduceR_SIMD
+{
+    int operator()( const T*, typename Op::rtype*, int ) const { return 0; }
+};
+
+#if CV_SIMD128
+// the source goes first, so the NaNs are handled as in std::max(buf, src)
+#define CV_REDUCE_R_SIMD(_Tp, _Tpvec, _Op, _expr) \
+template<> struct ReduceR_SIMD<_Tp, _Op<_Tp> > \
+{ \
+    ReduceR_SIMD() : haveSIMD(hasSIMD128()) {} \
+    int operator()( const _Tp* src, _Tp* buf, int width ) const \
+    { \
+        int i = 0; \
+        if( haveSIMD ) \
+            for( ; i <= width - _Tpvec::nlanes; i += _Tpvec::nlanes ) \
+            { \
+                _Tpvec s = v_load(src + i), b = v_load(buf + i); \
+                v_store(buf + i, _expr); \
+            } \
+        return i; \
+    } \
+    bool haveSIMD; \
+};
+
+CV_REDUCE_R_SIMD(uchar, v_uint8x16, OpMax, v_max(s, b))
+CV_REDUCE_R_SIMD(uchar, v_uint8x16, OpMin, v_min(s, b))
+CV_REDUCE_R_SIMD(ushort, v_uint16x8, OpMax, v_max(s, b))
+CV_REDUCE_R_SIMD(ushort, v_uint16x8, OpMin, v_min(s, b))
+CV_REDUCE_R_SIMD(short, v_int16x8, OpMax, v_max(s, b))
+CV_REDUCE_R_SIMD(short, v_int16x8, OpMin, v_min(s, b))
+CV_REDUCE_R_SIMD(float, v_float32x4, OpAdd, b + s)
+CV_REDUCE_R_SIMD(float, v_float32x4, OpMax, v_max(s, b))
+CV_REDUCE_R_SIMD(float, v_float32x4, OpMin, v_min(s, b))
+#if CV_SIMD128_64F
+CV_REDUCE_R_SIMD(double, v_float64x2, OpAdd, b + s)
+CV_REDUCE_R_SIMD(double, v_float64x2, OpMax, v_max(s, b))
+CV_REDUCE_R_SIMD(double, v_float64x2, OpMin, v_min(s, b))
+#endif
+
+#undef CV_REDUCE_R_SIMD
+
+template<> struct ReduceR_SIMD<uchar, OpAdd<int> >
+{
+    ReduceR_SIMD() : haveSIMD(hasSIMD128()) {}
+    int operator()( const uchar* src, int* buf, int width ) const
+    {
+        int i = 0;
+        if( haveSIMD )
+            for( ; i <= width - 16; i += 16 )
+            {
+                v_uint16x8 w0, w1;
+                v_uint32x4 s0, s1, s2, s3;
+                v_expand(v_load(src + i), w0, w1);
+                v_expand(w0, s0, s1);
+                v_expand(w1, s2, s3);
+                v_store(buf + i, v_load(buf + i) + v_reinterpret_as_s32(s0));
+                v_store(buf + i + 4, v_load(buf + i + 4) + v_reinterpret_as_s32(s1));
+                v_store(buf + i + 8, v_load(buf + i + 8) + v_reinterpret_as_s32(s2));
+                v_store(buf + i + 12, v_load(buf + i + 12) + v_reinterpret_as_s32(s3));
+            }
+        return i;
+    }
+    bool haveSIMD;
+};
+
+template<> struct ReduceR_SIMD<ushort, OpAdd<float> >
+{
+    ReduceR_SIMD() : haveSIMD(hasSIMD128()) {}
+    int operator()( const ushort* src, float* buf, int width ) const
+    {
+        int i = 0;
+        if( haveSIMD )
+            for( ; i <= width - 4; i += 4 )
+                v_store(buf + i, v_load(buf + i) + v_cvt_f32(v_reinterpret_as_s32(v_load_expand(src + i))));
+        return i;
+    }
+    bool haveSIMD;
+};
+
+template<> struct ReduceR_SIMD<short, OpAdd<float> >
+{
+    ReduceR_SIMD() : haveSIMD(hasSIMD128()) {}
+    int operator()( const short* src, float* buf, int width ) const
+    {
+        int i = 0;
+        if( haveSIMD )
+            for( ; i <= width - 4; i += 4 )
+                v_store(buf + i, v_load(buf + i) + v_cvt_f32(v_load_expand(src + i)));
+        return i;
+    }
+    bool haveSIMD;
+};
+
+#if CV_SIMD128_64F
+template<> struct ReduceR_SIMD<float, OpAdd<double> >
+{
+    ReduceR_SIMD() : haveSIMD(hasSIMD128()) {}
+    int operator()( const float* src, double* buf, int width ) const
+    {
+        int i = 0;
+        if( haveSIMD )
+            for( ; i <= width - 4; i += 4 )
+            {
+                v_float32x4 s = v_load(src + i);
+                v_store(buf + i, v_load(buf + i) + v_cvt_f64(s));
+                v_store(buf + i + 2, v_load(buf + i + 2) + v_cvt_f64_high(s));
+            }
+        return i;
+    }
+    bool haveSIMD;
+};
+#endif
+
+#endif
+
 template<typename T, typename ST, class Op> static void
 reduceR_( const Mat& srcmat, Mat& dstmat )
 {
@@ -3419,6 +3828,7 @@ reduceR_( const Mat& srcmat, Mat& dstmat )
     size_t srcstep = srcmat.step/sizeof(src[0]);
     int i;
     Op op;
+    ReduceR_SIMD<T, Op> vop;
 
     for( i = 0; i < size.width; i++ )
         buf[i] = src[i];
@@ -3426,7 +3836,7 @@ reduceR_( const Mat& srcmat, Mat& dstmat )
     for( ; --size.height; )
     {
         src += srcstep;
-        i = 0;
+        i = vop(src, buf, size.width);
         #if CV_ENABLE_UNROLLED
         for(; i <= size.width - 4; i += 4 )
         {
@@ -3492,6 +3902,31 @@ reduceC_( const Mat& srcmat, Mat& dstmat )
 
 typedef void (*ReduceFunc)( const Mat& src, Mat& dst );
 
+// the columns (dim == 0) or the rows (dim == 1) are reduced independently
+class ReduceInvoker : public ParallelLoopBody
+{
+public:
+    ReduceInvoker( const Mat& _src, Mat& _dst, int _dim, ReduceFunc _func ) :
+        src(_src), dst(_dst), dim(_dim), func(_func)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        Mat srcPart = dim == 0 ? src.colRange(range) : src.rowRange(range);
+        Mat dstPart = dim == 0 ? dst.colRange(range) : dst.rowRange(range);
+        func( srcPart, dstPart );
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    int dim;
+    ReduceFunc func;
+
+    ReduceInvoker& operator=(const ReduceInvoker&);
+};
+
 }
 
 #define reduceSumR8u32s  reduceR_<uchar, int,   OpAdd<int> >
@@ -3912,7 +4347,11 @@ void cv::reduce(InputArray _src, OutputArray _dst, int dim, int op, int dtype)
         CV_Error( CV_StsUnsupportedFormat,
                   "Unsupported combination of input and output array formats" );
 
-    func( src, temp );
+    // when the columns are reduced, every stripe reads at least a few cache lines of each row
+    double nstripes = src.total()/(double)(1<<16);
+    if( dim == 0 )
+        nstripes = std::min(nstripes, src.cols*src.elemSize()/256.);
+    parallel_for_(Range(0, dim == 0 ? src.cols : src.rows), ReduceInvoker(src, temp, dim, func), nstripes);
 
     if( op0 == CV_REDUCE_AVG )
         temp.convertTo(dst, dst.type(), 1./(dim == 0 ? src.rows : src.cols));
@@ -3968,94 +4407,355 @@ static IppFlipFunc getFlipFunc(int depth)
 
 #endif
 
-template<typename T> static void sort_( const Mat& src, Mat& dst, int flags )
+// The rows (or the columns) are sorted independently, so they are distributed between threads.
+// The short vectors are sorted by a sorting network, several vectors at once using SIMD; the long
+// vectors are sorted by the radix sort.
+enum { SORT_NETWORK_MAX_LEN = 16, SORT_COLUMN_BLOCK = 16 };
+
+// Batcher's odd-even merge sort network for len elements. It is built for the next power of two:
+// the comparators touching the elements beyond len are dropped, as if those were +inf.
+static int buildSortNetwork( int len, int* pairs )
+{
+    int n = 1, npairs = 0;
+    while( n < len )
+        n *= 2;
+    for( int p = 1; p < n; p *= 2 )
+        for( int k = p; k >= 1; k /= 2 )
+            for( int j = k % p; j + k < n; j += 2*k )
+                for( int i = 0; i < k && i + j + k < len; i++ )
+                    if( (i + j)/(2*p) == (i + j + k)/(2*p) )
+                    {
+                        pairs[npairs*2] = i + j;
+                        pairs[npairs*2+1] = i + j + k;
+                        npairs++;
+                    }
+    return npairs;
+}
+
+template<typename T> struct SortNetworkSIMD
+{
+    enum { nlanes = 1 };
+    void operator()( T*, int, const int*, int ) const {}
+};
+
+#if CV_SIMD128
+// sorts nlanes vectors at once, buf[j*nlanes + l] is the j-th element of the l-th vector
+#define CV_SORT_NETWORK_SIMD(_Tp, _Tpvec) \
+template<> struct SortNetworkSIMD<_Tp> \
+{ \
+    enum { nlanes = _Tpvec::nlanes }; \
+    void operator()( _Tp* buf, int len, const int* pairs, int npairs ) const \
+    { \
+        _Tpvec v[SORT_NETWORK_MAX_LEN]; \
+        for( int j = 0; j < len; j++ ) \
+            v[j] = v_load(buf + j*nlanes); \
+        for( int k = 0; k < npairs; k++ ) \
+        { \
+            int a = pairs[k*2], b = pairs[k*2+1]; \
+            _Tpvec t = v[a]; \
+            v[a] = v_min(t, v[b]); \
+            v[b] = v_max(t, v[b]); \
+        } \
+        for( int j = 0; j < len; j++ ) \
+            v_store(buf + j*nlanes, v[j]); \
+    } \
+};
+
+CV_SORT_NETWORK_SIMD(uchar, v_uint8x16)
+CV_SORT_NETWORK_SIMD(schar, v_int8x16)
+CV_SORT_NETWORK_SIMD(ushort, v_uint16x8)
+CV_SORT_NETWORK_SIMD(short, v_int16x8)
+CV_SORT_NETWORK_SIMD(int, v_int32x4)
+CV_SORT_NETWORK_SIMD(float, v_float32x4)
+#if CV_SIMD128_64F
+CV_SORT_NETWORK_SIMD(double, v_float64x2)
+#endif
+
+#undef CV_SORT_NETWORK_SIMD
+#endif
+
+// maps the values to unsigned integers preserving their order
+template<typename T> struct RadixSortKey {};
+
+template<> struct RadixSortKey<uchar>
 {
-    AutoBuffer<T> buf;
-    T* bptr;
-    int n, len;
-    bool sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
-    bool inplace = src.data == dst.data;
-    bool sortDescending = (flags & CV_SORT_DESCENDING) != 0;
+    typedef uchar type;
+    static type key( uchar v ) { return v; }
+    static uchar value( type k ) { return k; }
+};
 
-    if( sortRows )
-        n = src.rows, len = src.cols;
-    else
+template<> struct RadixSortKey<schar>
+{
+    typedef uchar type;
+    static type key( schar v ) { return (uchar)((uchar)v ^ 0x80); }
+    static schar value( type k ) { return (schar)(k ^ 0x80); }
+};
+
+template<> struct RadixSortKey<ushort>
+{
+    typedef ushort type;
+    static type key( ushort v ) { return v; }
+    static ushort value( type k ) { return k; }
+};
+
+template<> struct RadixSortKey<short>
+{
+    typedef ushort type;
+    static type key( short v ) { return (ushort)((ushort)v ^ 0x8000); }
+    static short value( type k ) { return (short)(k ^ 0x8000); }
+};
+
+template<> struct RadixSortKey<int>
+{
+    typedef unsigned type;
+    static type key( int v ) { return (unsigned)v ^ 0x80000000u; }
+    static int value( type k ) { return (int)(k ^ 0x80000000u); }
+};
+
+// the negative numbers are inverted, the sign bit is set for the positive ones
+template<> struct RadixSortKey<float>
+{
+    typedef unsigned type;
+    static type key( float v )
+    {
+        Cv32suf u; u.f = v;
+        return u.u ^ ((u.u >> 31) ? 0xffffffffu : 0x80000000u);
+    }
+    static float value( type k )
     {
-        n = src.cols, len = src.rows;
-        buf.allocate(len);
+        Cv32suf u; u.u = k ^ ((k >> 31) ? 0x80000000u : 0xffffffffu);
+        return u.f;
     }
-    bptr = (T*)buf;
+};
 
-#ifdef USE_IPP_SORT
-    int depth = src.depth();
-    IppSortFunc ippSortFunc = 0;
-    IppFlipFunc ippFlipFunc = 0;
-    CV_IPP_CHECK()
+template<> struct RadixSortKey<double>
+{
+    typedef uint64 type;
+    static type key( double v )
     {
-        ippSortFunc = getSortFunc(depth, sortDescending);
-        ippFlipFunc = getFlipFunc(depth);
+        Cv64suf u; u.f = v;
+        return u.u ^ ((u.u >> 63) ? ~(uint64)0 : (uint64)1 << 63);
     }
-#endif
+    static double value( type k )
+    {
+        Cv64suf u; u.u = k ^ ((k >> 63) ? (uint64)1 << 63 : ~(uint64)0);
+        return u.f;
+    }
+};
 
-    for( int i = 0; i < n; i++ )
+// the radix sort is faster than std::sort starting from this length
+template<typename T> static inline int radixSortMinLen() { return sizeof(T) <= 2 ? 64 : sizeof(T) == 4 ? 256 : 1024; }
+
+// LSD radix sort by bytes. It is stable; the passes where all the keys have the same byte are skipped.
+// keys (and idx, if any) are swapped with the temporary buffers, so they point to the result.
+template<typename K> static void radixSort( K*& keys, K*& tmp, int*& idx, int*& itmp, int len )
+{
+    enum { NPASSES = sizeof(K) };
+    int hist[NPASSES][256];
+    memset( hist, 0, sizeof(hist) );
+
+    for( int i = 0; i < len; i++ )
+    {
+        K k = keys[i];
+        for( int p = 0; p < NPASSES; p++ )
+            hist[p][(k >> (p*8)) & 255]++;
+    }
+
+    for( int p = 0; p < NPASSES; p++ )
     {
-        T* ptr = bptr;
-        if( sortRows )
+        int* h = hist[p];
+        if( h[(keys[0] >> (p*8)) & 255] == len )
+            continue;
+        for( int d = 0, sum = 0; d < 256; d++ )
+        {
+            int c = h[d];
+            h[d] = sum;
+            sum += c;
+        }
+        if( idx )
         {
-            T* dptr = dst.ptr<T>(i);
-            if( !inplace )
+            for( int i = 0; i < len; i++ )
             {
-                const T* sptr = src.ptr<T>(i);
-                memcpy(dptr, sptr, sizeof(T) * len);
+                int pos = h[(keys[i] >> (p*8)) & 255]++;
+                tmp[pos] = keys[i];
+                itmp[pos] = idx[i];
             }
-            ptr = dptr;
+            std::swap( idx, itmp );
         }
         else
         {
-            for( int j = 0; j < len; j++ )
-                ptr[j] = src.ptr<T>(j)[i];
+            for( int i = 0; i < len; i++ )
+                tmp[h[(keys[i] >> (p*8)) & 255]++] = keys[i];
         }
+        std::swap( keys, tmp );
+    }
+}
 
-#ifdef USE_IPP_SORT
-        if (!ippSortFunc || CV_INSTRUMENT_FUN_IPP(ippSortFunc, ptr, len) < 0)
-#endif
+template<typename T> class SortInvoker : public ParallelLoopBody
+{
+public:
+    SortInvoker( const Mat& _src, Mat& _dst, int flags ) : src(_src), dst(_dst)
+    {
+        sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
+        sortDescending = (flags & CV_SORT_DESCENDING) != 0;
+        len = sortRows ? src.cols : src.rows;
+        nlanes = 1;
+        npairs = 0;
+        if( len <= SORT_NETWORK_MAX_LEN && SortNetworkSIMD<T>::nlanes > 1 && hasSIMD128() )
         {
+            nlanes = SortNetworkSIMD<T>::nlanes;
+            npairs = buildSortNetwork( len, pairs );
+        }
+        block = nlanes > 1 ? nlanes : sortRows ? 1 : SORT_COLUMN_BLOCK;
+
 #ifdef USE_IPP_SORT
-            if (depth == CV_8U)
-                setIppErrorStatus();
+        ippSortFunc = 0;
+        ippFlipFunc = 0;
+        CV_IPP_CHECK()
+        {
+            ippSortFunc = getSortFunc(src.depth(), sortDescending);
+            ippFlipFunc = getFlipFunc(src.depth());
+        }
 #endif
-            std::sort( ptr, ptr + len );
-            if( sortDescending )
+    }
+
+    // the number of the groups of vectors processed at once
+    int blocks() const { return ((sortRows ? src.rows : src.cols) + block - 1)/block; }
+
+    void operator()( const Range& range ) const
+    {
+        typedef typename RadixSortKey<T>::type K;
+        int n = sortRows ? src.rows : src.cols;
+        bool radix = len >= radixSortMinLen<T>();
+        AutoBuffer<T> _buf(sortRows && nlanes == 1 ? 1 : len*block);
+        AutoBuffer<K> _keys(radix ? len*2 : 1);
+        T* buf = _buf;
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int i0 = b*block, count = std::min(block, n - i0), i, j;
+
+            if( nlanes > 1 )
             {
-#ifdef USE_IPP_SORT
-                if (!ippFlipFunc || CV_INSTRUMENT_FUN_IPP(ippFlipFunc, ptr, len) < 0)
-#endif
+                // buf[j*nlanes + i] is the j-th element of the vector i0 + i
+                if( count < nlanes )
+                    memset( buf, 0, len*nlanes*sizeof(T) );
+                if( sortRows )
                 {
-#ifdef USE_IPP_SORT
-                    setIppErrorStatus();
-#endif
-                    for( int j = 0; j < len/2; j++ )
-                        std::swap(ptr[j], ptr[len-1-j]);
+                    for( i = 0; i < count; i++ )
+                    {
+                        const T* sptr = src.ptr<T>(i0 + i);
+                        for( j = 0; j < len; j++ )
+                            buf[j*nlanes + i] = sptr[j];
+                    }
                 }
-#ifdef USE_IPP_SORT
                 else
                 {
-                    CV_IMPL_ADD(CV_IMPL_IPP);
+                    for( j = 0; j < len; j++ )
+                        memcpy( buf + j*nlanes, src.ptr<T>(j) + i0, count*sizeof(T) );
+                }
+
+                SortNetworkSIMD<T>()( buf, len, pairs, npairs );
+
+                for( j = 0; j < len; j++ )
+                {
+                    const T* bptr = buf + (sortDescending ? len - 1 - j : j)*nlanes;
+                    if( sortRows )
+                        for( i = 0; i < count; i++ )
+                            dst.ptr<T>(i0 + i)[j] = bptr[i];
+                    else
+                        memcpy( dst.ptr<T>(j) + i0, bptr, count*sizeof(T) );
+                }
+            }
+            else if( sortRows )
+            {
+                T* ptr = dst.ptr<T>(i0);
+                if( src.data != dst.data )
+                    memcpy( ptr, src.ptr<T>(i0), len*sizeof(T) );
+                sortVector( ptr, _keys );
+            }
+            else
+            {
+                // the columns are copied by blocks, so the matrix rows are read sequentially
+                for( j = 0; j < len; j++ )
+                {
+                    const T* sptr = src.ptr<T>(j) + i0;
+                    for( i = 0; i < count; i++ )
+                        buf[i*len + j] = sptr[i];
+                }
+                for( i = 0; i < count; i++ )
+                    sortVector( buf + i*len, _keys );
+                for( j = 0; j < len; j++ )
+                {
+                    T* dptr = dst.ptr<T>(j) + i0;
+                    for( i = 0; i < count; i++ )
+                        dptr[i] = buf[i*len + j];
                 }
-#endif
             }
         }
+    }
+
+protected:
+    template<typename K> void sortVector( T* ptr, AutoBuffer<K>& _keys ) const
+    {
 #ifdef USE_IPP_SORT
-        else
+        if( ippSortFunc && CV_INSTRUMENT_FUN_IPP(ippSortFunc, ptr, len) >= 0 )
         {
-            CV_IMPL_ADD(CV_IMPL_IPP);
+            CV_IMPL_ADD(CV_IMPL_IPP|CV_IMPL_MT);
+            return;
         }
+        if( src.depth() == CV_8U )
+            setIppErrorStatus();
 #endif
-
-        if( !sortRows )
+        if( len >= radixSortMinLen<T>() )
+        {
+            K *keys = _keys, *tmp = keys + len;
+            int *idx = 0, *itmp = 0;
+            for( int j = 0; j < len; j++ )
+                keys[j] = RadixSortKey<T>::key(ptr[j]);
+            radixSort( keys, tmp, idx, itmp, len );
             for( int j = 0; j < len; j++ )
-                dst.ptr<T>(j)[i] = ptr[j];
+                ptr[j] = RadixSortKey<T>::value(keys[j]);
+        }
+        else
+            std::sort( ptr, ptr + len );
+
+        if( sortDescending )
+        {
+#ifdef USE_IPP_SORT
+            if( ippFlipFunc && CV_INSTRUMENT_FUN_IPP(ippFlipFunc, ptr, len) >= 0 )
+            {
+                CV_IMPL_ADD(CV_IMPL_IPP|CV_IMPL_MT);
+                return;
+            }
+            setIppErrorStatus();
+#endif
+            std::reverse( ptr, ptr + len );
+        }
     }
+
+    const Mat& src;
+    Mat& dst;
+    bool sortRows;
+    bool sortDescending;
+    int len;
+    int nlanes;
+    int block;
+    int npairs;
+    int pairs[SORT_NETWORK_MAX_LEN*SORT_NETWORK_MAX_LEN];
+#ifdef USE_IPP_SORT
+    IppSortFunc ippSortFunc;
+    IppFlipFunc ippFlipFunc;
+#endif
+
+private:
+    SortInvoker& operator=(const SortInvoker&);
+};
+
+template<typename T> static void sort_( const Mat& src, Mat& dst, int flags )
+{
+    SortInvoker<T> invoker(src, dst, flags);
+    parallel_for_(Range(0, invoker.blocks()), invoker, src.total()/(double)(1<<16));
 }
 
 template<typename _Tp> class LessThanIdx
@@ -4090,95 +4790,130 @@ static IppSortIndexFunc getSortIndexFunc(int depth, bool sortDescending)
 
 #endif
 
-template<typename T> static void sortIdx_( const Mat& src, Mat& dst, int flags )
+template<typename T> class SortIdxInvoker : public ParallelLoopBody
 {
-    AutoBuffer<T> buf;
-    AutoBuffer<int> ibuf;
-    bool sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
-    bool sortDescending = (flags & CV_SORT_DESCENDING) != 0;
-
-    CV_Assert( src.data != dst.data );
-
-    int n, len;
-    if( sortRows )
-        n = src.rows, len = src.cols;
-    else
+public:
+    SortIdxInvoker( const Mat& _src, Mat& _dst, int flags ) : src(_src), dst(_dst)
     {
-        n = src.cols, len = src.rows;
-        buf.allocate(len);
-        ibuf.allocate(len);
-    }
-    T* bptr = (T*)buf;
-    int* _iptr = (int*)ibuf;
+        sortRows = (flags & 1) == CV_SORT_EVERY_ROW;
+        sortDescending = (flags & CV_SORT_DESCENDING) != 0;
+        len = sortRows ? src.cols : src.rows;
+        block = sortRows ? 1 : SORT_COLUMN_BLOCK;
 
 #if defined USE_IPP_SORT && IPP_DISABLE_BLOCK
-    int depth = src.depth();
-    IppSortIndexFunc ippFunc = 0;
-    IppFlipFunc ippFlipFunc = 0;
-    CV_IPP_CHECK()
-    {
-        ippFunc = getSortIndexFunc(depth, sortDescending);
-        ippFlipFunc = getFlipFunc(depth);
-    }
+        ippFunc = 0;
+        ippFlipFunc = 0;
+        CV_IPP_CHECK()
+        {
+            ippFunc = getSortIndexFunc(src.depth(), sortDescending);
+            ippFlipFunc = getFlipFunc(src.depth());
+        }
 #endif
+    }
 
-    for( int i = 0; i < n; i++ )
+    int blocks() const { return ((sortRows ? src.rows : src.cols) + block - 1)/block; }
+
+    void operator()( const Range& range ) const
     {
-        T* ptr = bptr;
-        int* iptr = _iptr;
+        typedef typename RadixSortKey<T>::type K;
+        int n = sortRows ? src.rows : src.cols;
+        bool radix = len >= radixSortMinLen<T>();
+        AutoBuffer<T> _buf(sortRows ? 1 : len*block);
+        AutoBuffer<int> _ibuf(sortRows ? len*(radix ? 1 : 0) + 1 : len*(block + (radix ? 1 : 0)));
+        AutoBuffer<K> _keys(radix ? len*2 : 1);
+        T* buf = _buf;
+        int* ibuf = _ibuf;
 
-        if( sortRows )
-        {
-            ptr = (T*)(src.data + src.step*i);
-            iptr = dst.ptr<int>(i);
-        }
-        else
+        for( int b = range.start; b < range.end; b++ )
         {
-            for( int j = 0; j < len; j++ )
-                ptr[j] = src.ptr<T>(j)[i];
+            int i0 = b*block, count = std::min(block, n - i0), i, j;
+
+            if( sortRows )
+            {
+                sortIdxVector( src.ptr<T>(i0), dst.ptr<int>(i0), ibuf, _keys );
+                continue;
+            }
+
+            // the columns are copied by blocks, so the matrix rows are read sequentially
+            for( j = 0; j < len; j++ )
+            {
+                const T* sptr = src.ptr<T>(j) + i0;
+                for( i = 0; i < count; i++ )
+                    buf[i*len + j] = sptr[i];
+            }
+            for( i = 0; i < count; i++ )
+                sortIdxVector( buf + i*len, ibuf + i*len, ibuf + len*block, _keys );
+            for( j = 0; j < len; j++ )
+            {
+                int* dptr = dst.ptr<int>(j) + i0;
+                for( i = 0; i < count; i++ )
+                    dptr[i] = ibuf[i*len + j];
+            }
         }
+    }
+
+protected:
+    template<typename K> void sortIdxVector( const T* ptr, int* iptr, int* itmp, AutoBuffer<K>& _keys ) const
+    {
         for( int j = 0; j < len; j++ )
             iptr[j] = j;
 
 #if defined USE_IPP_SORT && IPP_DISABLE_BLOCK
-        if (sortRows || !ippFunc || ippFunc(ptr, iptr, len) < 0)
-#endif
+        if( !sortRows && ippFunc && ippFunc((void*)ptr, iptr, len) >= 0 )
         {
-#if defined USE_IPP_SORT && IPP_DISABLE_BLOCK
-            setIppErrorStatus();
+            CV_IMPL_ADD(CV_IMPL_IPP|CV_IMPL_MT);
+            return;
+        }
+        setIppErrorStatus();
 #endif
+        if( len >= radixSortMinLen<T>() )
+        {
+            K *keys = _keys, *tmp = keys + len;
+            int* idx = iptr;
+            for( int j = 0; j < len; j++ )
+                keys[j] = RadixSortKey<T>::key(ptr[j]);
+            radixSort( keys, tmp, idx, itmp, len );
+            if( idx != iptr )
+                memcpy( iptr, idx, len*sizeof(iptr[0]) );
+        }
+        else
             std::sort( iptr, iptr + len, LessThanIdx<T>(ptr) );
-            if( sortDescending )
-            {
-#if defined USE_IPP_SORT && IPP_DISABLE_BLOCK
-                if (!ippFlipFunc || ippFlipFunc(iptr, len) < 0)
-#endif
-                {
-#if defined USE_IPP_SORT && IPP_DISABLE_BLOCK
-                    setIppErrorStatus();
-#endif
-                    for( int j = 0; j < len/2; j++ )
-                        std::swap(iptr[j], iptr[len-1-j]);
-                }
+
+        if( sortDescending )
+        {
 #if defined USE_IPP_SORT && IPP_DISABLE_BLOCK
-                else
-                {
-                    CV_IMPL_ADD(CV_IMPL_IPP);
-                }
-#endif
+            if( ippFlipFunc && ippFlipFunc(iptr, len) >= 0 )
+            {
+                CV_IMPL_ADD(CV_IMPL_IPP|CV_IMPL_MT);
+                return;
             }
+            setIppErrorStatus();
+#endif
+            std::reverse( iptr, iptr + len );
         }
+    }
+
+    const Mat& src;
+    Mat& dst;
+    bool sortRows;
+    bool sortDescending;
+    int len;
+    int block;
 #if defined USE_IPP_SORT && IPP_DISABLE_BLOCK
-        else
-        {
-            CV_IMPL_ADD(CV_IMPL_IPP);
-        }
+    IppSortIndexFunc ippFunc;
+    IppFlipFunc ippFlipFunc;
 #endif
 
-        if( !sortRows )
-            for( int j = 0; j < len; j++ )
-                dst.ptr<int>(j)[i] = iptr[j];
-    }
+private:
+    SortIdxInvoker& operator=(const SortIdxInvoker&);
+};
+
+template<typename T> static void sortIdx_( const Mat& src, Mat& dst, int flags )
+{
+    CV_Assert( src.data != dst.data );
+
+    SortIdxInvoker<T> invoker(src, dst, flags);
+    parallel_for_(Range(0, invoker.blocks()), invoker, src.total()/(double)(1<<16));
 }
 
 typedef void (*SortFunc)(const Mat& src, Mat& dst, int flags);
@@ -4973,7 +5708,7 @@ void SparseMat::create(int d, const int* _sizes, int _type)
         }
     }
     int _sizes_backup[CV_MAX_DIM]; // #5991
-    if (_sizes == hdr->size)
+    if (hdr && _sizes == hdr->size)
     {
         for(int i = 0; i < d; i++ )
             _sizes_backup[i] = _sizes[i];
@@ -0,0 +1,362 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+/*
+   Sparse matrices in the compressed sparse row format.
+
+   The elements of the row i are stored in values and colIdx at the positions
+   [rowPtr[i], rowPtr[i+1]), sorted by the column index. The products with the dense
+   matrices are computed row by row, so the rows can be processed in parallel without
+   any synchronization; the transposed products build the transposed matrix first.
+*/
+
+namespace cv
+{
+
+// the minimal amount of the multiply-adds per stripe of the product
+enum { CSR_GEMM_STRIPE_WORK = 1 << 16 };
+
+template<typename T> static void
+denseToCsr( const Mat& src, CsrMat& dst )
+{
+    int i, j, rows = src.rows, cols = src.cols, nz = 0;
+    for( i = 0; i < rows; i++ )
+    {
+        const T* s = src.ptr<T>(i);
+        for( j = 0; j < cols; j++ )
+            nz += s[j] != 0;
+    }
+
+    dst.create(rows, cols, src.type(), nz);
+    int* rowPtr = dst.rowPtr.ptr<int>();
+    int* colIdx = dst.colIdx.ptr<int>();
+    T* values = dst.values.ptr<T>();
+
+    for( i = 0, nz = 0; i < rows; i++ )
+    {
+        const T* s = src.ptr<T>(i);
+        rowPtr[i] = nz;
+        for( j = 0; j < cols; j++ )
+            if( s[j] != 0 )
+            {
+                colIdx[nz] = j;
+                values[nz++] = s[j];
+            }
+    }
+    rowPtr[rows] = nz;
+}
+
+template<typename T> static void
+sparseToCsr( const SparseMat& src, CsrMat& dst )
+{
+    int rows = src.size(0), cols = src.size(1), nz = (int)src.nzcount();
+    dst.create(rows, cols, src.type(), nz);
+    int* rowPtr = dst.rowPtr.ptr<int>();
+    int* colIdx = dst.colIdx.ptr<int>();
+    T* values = dst.values.ptr<T>();
+
+    SparseMatConstIterator_<T> it = src.begin<T>(), it_end = src.end<T>();
+    for( ; it != it_end; ++it )
+        rowPtr[it.node()->idx[0] + 1]++;
+    for( int i = 0; i < rows; i++ )
+        rowPtr[i+1] += rowPtr[i];
+
+    // the hash table order is arbitrary, so the elements are put to their rows first
+    // and then sorted inside each row
+    std::vector<int> pos(rowPtr, rowPtr + rows);
+    for( it = src.begin<T>(); it != it_end; ++it )
+    {
+        const SparseMat::Node* n = it.node();
+        int k = pos[n->idx[0]]++;
+        colIdx[k] = n->idx[1];
+        values[k] = *it;
+    }
+
+    std::vector<std::pair<int, T> > buf;
+    for( int i = 0; i < rows; i++ )
+    {
+        int k0 = rowPtr[i], k1 = rowPtr[i+1], k;
+        buf.resize(k1 - k0);
+        for( k = k0; k < k1; k++ )
+            buf[k - k0] = std::make_pair(colIdx[k], values[k]);
+        std::sort(buf.begin(), buf.end());
+        for( k = k0; k < k1; k++ )
+        {
+            colIdx[k] = buf[k - k0].first;
+            values[k] = buf[k - k0].second;
+        }
+    }
+}
+
+CsrMat::CsrMat(const SparseMat& m)
+    : rows(0), cols(0)
+{
+    CV_Assert( m.dims() == 2 && (m.type() == CV_32FC1 || m.type() == CV_64FC1) );
+    if( m.type() == CV_32F )
+        sparseToCsr<float>(m, *this);
+    else
+        sparseToCsr<double>(m, *this);
+}
+
+CsrMat::CsrMat(const Mat& m)
+    : rows(0), cols(0)
+{
+    CV_Assert( m.dims <= 2 && (m.type() == CV_32FC1 || m.type() == CV_64FC1) );
+    if( m.type() == CV_32F )
+        denseToCsr<float>(m, *this);
+    else
+        denseToCsr<double>(m, *this);
+}
+
+void CsrMat::create(int _rows, int _cols, int _type, int _nnz)
+{
+    CV_Assert( _rows >= 0 && _cols >= 0 && _nnz >= 0 );
+    CV_Assert( _type == CV_32FC1 || _type == CV_64FC1 );
+    // the arrays can be shared with another matrix, so the new ones are always allocated
+    release();
+    rows = _rows;
+    cols = _cols;
+    values.create(1, _nnz, _type);
+    colIdx.create(1, _nnz, CV_32S);
+    rowPtr = Mat::zeros(1, _rows + 1, CV_32S);
+}
+
+void CsrMat::release()
+{
+    rows = cols = 0;
+    values.release();
+    colIdx.release();
+    rowPtr.release();
+}
+
+CsrMat CsrMat::clone() const
+{
+    CsrMat m;
+    m.rows = rows;
+    m.cols = cols;
+    m.values = values.clone();
+    m.colIdx = colIdx.clone();
+    m.rowPtr = rowPtr.clone();
+    return m;
+}
+
+template<typename T> static void
+csrToDense( const CsrMat& src, Mat& dst )
+{
+    const int* rowPtr = src.rowPtr.ptr<int>();
+    const int* colIdx = src.colIdx.ptr<int>();
+    const T* values = src.values.ptr<T>();
+    for( int i = 0; i < src.rows; i++ )
+    {
+        T* d = dst.ptr<T>(i);
+        for( int k = rowPtr[i]; k < rowPtr[i+1]; k++ )
+            d[colIdx[k]] = values[k];
+    }
+}
+
+template<typename T> static void
+csrToSparse( const CsrMat& src, SparseMat& dst )
+{
+    const int* rowPtr = src.rowPtr.ptr<int>();
+    const int* colIdx = src.colIdx.ptr<int>();
+    const T* values = src.values.ptr<T>();
+    for( int i = 0; i < src.rows; i++ )
+        for( int k = rowPtr[i]; k < rowPtr[i+1]; k++ )
+            dst.ref<T>(i, colIdx[k]) = values[k];
+}
+
+void CsrMat::copyTo(OutputArray _m) const
+{
+    _m.create(rows, cols, type());
+    Mat m = _m.getMat();
+    m = Scalar::all(0);
+    if( type() == CV_32F )
+        csrToDense<float>(*this, m);
+    else
+        csrToDense<double>(*this, m);
+}
+
+void CsrMat::copyTo(SparseMat& m) const
+{
+    int sz[] = { rows, cols };
+    m.create(2, sz, type());
+    if( type() == CV_32F )
+        csrToSparse<float>(*this, m);
+    else
+        csrToSparse<double>(*this, m);
+}
+
+template<typename T> static void
+transposeCsr( const CsrMat& src, CsrMat& dst )
+{
+    int nz = src.nnz();
+    dst.create(src.cols, src.rows, src.type(), nz);
+
+    const int* rowPtr = src.rowPtr.ptr<int>();
+    const int* colIdx = src.colIdx.ptr<int>();
+    const T* values = src.values.ptr<T>();
+    int* trowPtr = dst.rowPtr.ptr<int>();
+    int* tcolIdx = dst.colIdx.ptr<int>();
+    T* tvalues = dst.values.ptr<T>();
+    int i, k;
+
+    for( k = 0; k < nz; k++ )
+        trowPtr[colIdx[k] + 1]++;
+    for( i = 0; i < dst.rows; i++ )
+        trowPtr[i+1] += trowPtr[i];
+
+    // the source rows are scanned in order, so the columns of the result come out sorted
+    std::vector<int> pos(trowPtr, trowPtr + dst.rows);
+    for( i = 0; i < src.rows; i++ )
+        for( k = rowPtr[i]; k < rowPtr[i+1]; k++ )
+        {
+            int p = pos[colIdx[k]]++;
+            tcolIdx[p] = i;
+            tvalues[p] = values[k];
+        }
+}
+
+CsrMat CsrMat::t() const
+{
+    CsrMat m;
+    if( type() == CV_32F )
+        transposeCsr<float>(*this, m);
+    else
+        transposeCsr<double>(*this, m);
+    return m;
+}
+
+double CsrMat::value(int i, int j) const
+{
+    CV_Assert( (unsigned)i < (unsigned)rows && (unsigned)j < (unsigned)cols );
+    const int* rowPtr_ = rowPtr.ptr<int>();
+    const int* c0 = colIdx.ptr<int>() + rowPtr_[i];
+    const int* c1 = colIdx.ptr<int>() + rowPtr_[i+1];
+    const int* c = std::lower_bound(c0, c1, j);
+    if( c == c1 || *c != j )
+        return 0;
+    int k = (int)(c - colIdx.ptr<int>());
+    return type() == CV_32F ? (double)values.at<float>(k) : values.at<double>(k);
+}
+
+// dst = alpha*a*b + beta*c for the rows [rowBounds[s], rowBounds[s+1]) of the stripes s
+template<typename T> class CsrGemmInvoker : public ParallelLoopBody
+{
+public:
+    CsrGemmInvoker(const CsrMat& _a, const Mat& _b, double _alpha, const Mat& _c,
+                   double _beta, Mat& _dst, const int* _rowBounds)
+        : a(&_a), b(&_b), alpha(_alpha), c(&_c), beta(_beta), dst(&_dst), rowBounds(_rowBounds) {}
+
+    void operator()(const Range& range) const
+    {
+        const int* rowPtr = a->rowPtr.ptr<int>();
+        const int* colIdx = a->colIdx.ptr<int>();
+        const T* values = a->values.ptr<T>();
+        int j, n = b->cols;
+        AutoBuffer<double> _buf(n);
+        double* buf = _buf;
+
+        for( int i = rowBounds[range.start]; i < rowBounds[range.end]; i++ )
+        {
+            for( j = 0; j < n; j++ )
+                buf[j] = 0;
+            for( int k = rowPtr[i]; k < rowPtr[i+1]; k++ )
+            {
+                double v = values[k];
+                const T* brow = b->ptr<T>(colIdx[k]);
+                for( j = 0; j < n; j++ )
+                    buf[j] += v*brow[j];
+            }
+
+            T* d = dst->ptr<T>(i);
+            if( c->empty() )
+            {
+                for( j = 0; j < n; j++ )
+                    d[j] = saturate_cast<T>(alpha*buf[j]);
+            }
+            else
+            {
+                const T* crow = c->ptr<T>(i);
+                for( j = 0; j < n; j++ )
+                    d[j] = saturate_cast<T>(alpha*buf[j] + beta*crow[j]);
+            }
+        }
+    }
+
+private:
+    const CsrMat* a;
+    const Mat* b;
+    double alpha;
+    const Mat* c;
+    double beta;
+    Mat* dst;
+    const int* rowBounds;
+};
+
+}
+
+void cv::gemm( const CsrMat& src1, InputArray _src2, double alpha,
+               InputArray _src3, double beta, OutputArray _dst, int flags )
+{
+    CV_INSTRUMENT_REGION()
+
+    CsrMat at;
+    const CsrMat* a = &src1;
+    if( flags & GEMM_1_T )
+    {
+        at = src1.t();
+        a = &at;
+    }
+
+    Mat b = _src2.getMat(), c;
+    int type = a->type();
+    if( flags & GEMM_2_T )
+        b = b.t();
+    if( !_src3.empty() && beta != 0 )
+    {
+        c = _src3.getMat();
+        if( flags & GEMM_3_T )
+            c = c.t();
+    }
+
+    CV_Assert( type == CV_32FC1 || type == CV_64FC1 );
+    CV_Assert( b.type() == type && b.dims <= 2 && b.rows == a->cols );
+    CV_Assert( c.empty() || (c.type() == type && c.rows == a->rows && c.cols == b.cols) );
+
+    // the product is written to a temporary buffer when dst is one of the inputs
+    Mat dst = _dst.getMat(), res;
+    bool inplace = dst.data && (dst.data == b.data || dst.data == c.data);
+    if( inplace )
+        res.create(a->rows, b.cols, type);
+    else
+    {
+        _dst.create(a->rows, b.cols, type);
+        res = _dst.getMat();
+    }
+
+    // the rows are split into the stripes with about the same number of non-zero elements
+    int nz = a->nnz(), rows = a->rows;
+    double work = ((double)nz + rows)*b.cols;
+    int nstripes = std::min(rows, std::min(getNumThreads()*4,
+                   (int)(work/CSR_GEMM_STRIPE_WORK) + 1));
+    nstripes = std::max(nstripes, 1);
+    std::vector<int> rowBounds(nstripes + 1);
+    const int* rowPtr = a->rowPtr.ptr<int>();
+    for( int s = 0; s < nstripes; s++ )
+        rowBounds[s] = (int)(std::lower_bound(rowPtr, rowPtr + rows,
+                       (int)((int64)nz*s/nstripes)) - rowPtr);
+    rowBounds[nstripes] = rows;
+
+    if( type == CV_32F )
+        parallel_for_(Range(0, nstripes),
+                      CsrGemmInvoker<float>(*a, b, alpha, c, beta, res, &rowBounds[0]), nstripes);
+    else
+        parallel_for_(Range(0, nstripes),
+                      CsrGemmInvoker<double>(*a, b, alpha, c, beta, res, &rowBounds[0]), nstripes);
+
+    if( inplace )
+        res.copyTo(_dst);
+}
@@ -0,0 +1,348 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  include <windows.h>
+#  undef small
+#  undef min
+#  undef max
+#  undef abs
+#  if !defined WINRT
+#    define CV_MAP_FILE_WIN32 1
+#  endif
+#elif defined __unix__ || defined __APPLE__ || defined __ANDROID__
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define CV_MAP_FILE_POSIX 1
+#endif
+
+/*
+   Matrices mapped from files.
+
+   The file layout (see saveMatFile):
+
+     MatFileHeader
+     MatFileEntry[count]
+     the elements of every matrix, stored continuously from MatFileEntry::offset
+
+   The whole file is mapped at once and all the matrices refer to a single UMatData,
+   so the mapping lives until the last matrix which uses it is released. When memory
+   mapping is not available the file is read into a regular buffer instead.
+*/
+
+namespace cv
+{
+
+enum
+{
+    MAT_FILE_VERSION = 1,
+    MAT_FILE_BYTE_ORDER = 0x01020304,
+    MAT_FILE_ALIGN = 64
+};
+
+static const char MAT_FILE_SIGNATURE[8] = { 'C', 'V', 'M', 'A', 'T', 'F', 'I', 'L' };
+
+struct MatFileHeader
+{
+    char   signature[8];
+    int    byteOrder;
+    int    version;
+    int    count;
+    int    reserved;
+};
+
+struct MatFileEntry
+{
+    int    type;
+    int    dims;
+    int64  offset;
+    int    size[CV_MAX_DIM];
+};
+
+class MappedFileAllocator : public MatAllocator
+{
+public:
+    UMatData* allocate(int, const int*, int, void*, size_t*, int, UMatUsageFlags) const
+    {
+        CV_Error(Error::StsNotImplemented, "The mapped file allocator can't allocate new matrices");
+        return NULL;
+    }
+
+    bool allocate(UMatData*, int, UMatUsageFlags) const
+    {
+        return false;
+    }
+
+    void deallocate(UMatData* u) const
+    {
+        if(!u)
+            return;
+
+        CV_Assert(u->urefcount == 0);
+        CV_Assert(u->refcount == 0);
+        if( u->origdata )
+        {
+#if defined CV_MAP_FILE_WIN32
+            UnmapViewOfFile(u->origdata);
+#elif defined CV_MAP_FILE_POSIX
+            munmap(u->origdata, u->size);
+#else
+            fastFree(u->origdata);
+#endif
+            u->origdata = 0;
+        }
+        delete u;
+    }
+};
+
+static MatAllocator* getMappedFileAllocator()
+{
+    CV_SINGLETON_LAZY_INIT(MatAllocator, new MappedFileAllocator())
+}
+
+// maps the whole file, returns NULL if the file can't be opened
+static uchar* mapFile(const String& filename, int flags, size_t& size)
+{
+    size = 0;
+#if defined CV_MAP_FILE_WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if( file == INVALID_HANDLE_VALUE )
+        return NULL;
+
+    LARGE_INTEGER fileSize;
+    uchar* data = NULL;
+    if( GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 && (uint64)fileSize.QuadPart <= (uint64)(size_t)-1 )
+    {
+        // the view stays valid after both handles are closed
+        bool copyOnWrite = (flags & MAP_MAT_COPY_ON_WRITE) != 0;
+        HANDLE mapping = CreateFileMappingA(file, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+        if( mapping != NULL )
+        {
+            data = (uchar*)MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if( data )
+                size = (size_t)fileSize.QuadPart;
+        }
+    }
+    CloseHandle(file);
+    if( !data )
+        CV_Error_(Error::StsError, ("Can't map the file %s", filename.c_str()));
+    return data;
+#elif defined CV_MAP_FILE_POSIX
+    int fd = open(filename.c_str(), O_RDONLY);
+    if( fd < 0 )
+        return NULL;
+
+    struct stat st;
+    void* data = MAP_FAILED;
+    if( fstat(fd, &st) == 0 && st.st_size > 0 && (uint64)st.st_size <= (uint64)(size_t)-1 )
+    {
+        size = (size_t)st.st_size;
+        if( flags & MAP_MAT_COPY_ON_WRITE )
+            data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        else
+            data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if( data == MAP_FAILED )
+        CV_Error_(Error::StsError, ("Can't map the file %s", filename.c_str()));
+    return (uchar*)data;
+#else
+    (void)flags;
+    FILE* f = fopen(filename.c_str(), "rb");
+    if( !f )
+        return NULL;
+
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uchar* data = NULL;
+    if( len > 0 )
+    {
+        data = (uchar*)fastMalloc((size_t)len);
+        if( fread(data, 1, (size_t)len, f) == (size_t)len )
+            size = (size_t)len;
+        else
+        {
+            fastFree(data);
+            data = NULL;
+        }
+    }
+    fclose(f);
+    if( !data )
+        CV_Error_(Error::StsError, ("Can't read the file %s", filename.c_str()));
+    return data;
+#endif
+}
+
+UMatData* mapFileData(const String& filename, int flags)
+{
+    size_t fileSize = 0;
+    uchar* data = mapFile(filename, flags, fileSize);
+    if( !data )
+        return NULL;
+
+    UMatData* u = new UMatData(getMappedFileAllocator());
+    u->data = u->origdata = data;
+    u->size = fileSize;
+    CV_XADD(&u->refcount, 1);
+    return u;
+}
+
+void saveMatFile(const String& filename, InputArrayOfArrays _mats)
+{
+    CV_INSTRUMENT_REGION()
+
+    std::vector<Mat> mats;
+    if( _mats.kind() == _InputArray::STD_VECTOR_MAT || _mats.kind() == _InputArray::STD_VECTOR_UMAT ||
+        _mats.kind() == _InputArray::STD_VECTOR_VECTOR )
+        _mats.getMatVector(mats);
+    else
+        mats.push_back(_mats.getMat());
+
+    int count = (int)mats.size();
+    std::vector<MatFileEntry> entries(count);
+
+    int64 offset = alignSize(sizeof(MatFileHeader) + sizeof(MatFileEntry)*count, MAT_FILE_ALIGN);
+    for( int i = 0; i < count; i++ )
+    {
+        const Mat& m = mats[i];
+        MatFileEntry& e = entries[i];
+        memset(&e, 0, sizeof(e));
+        e.type = m.type();
+        e.dims = m.dims;
+        for( int k = 0; k < m.dims; k++ )
+            e.size[k] = m.size[k];
+        e.offset = offset;
+        offset = alignSize((size_t)(offset + m.total()*m.elemSize()), MAT_FILE_ALIGN);
+    }
+
+    MatFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.signature, MAT_FILE_SIGNATURE, sizeof(header.signature));
+    header.byteOrder = MAT_FILE_BYTE_ORDER;
+    header.version = MAT_FILE_VERSION;
+    header.count = count;
+
+    FILE* f = fopen(filename.c_str(), "wb");
+    if( !f )
+        CV_Error_(Error::StsError, ("Can't open the file %s for writing", filename.c_str()));
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    if( ok && count > 0 )
+        ok = fwrite(&entries[0], sizeof(MatFileEntry), count, f) == (size_t)count;
+
+    const char zeros[MAT_FILE_ALIGN] = { 0 };
+    int64 pos = sizeof(MatFileHeader) + sizeof(MatFileEntry)*count;
+    for( int i = 0; i < count && ok; i++ )
+    {
+        size_t pad = (size_t)(entries[i].offset - pos);
+        ok = pad == 0 || fwrite(zeros, 1, pad, f) == pad;
+
+        if( ok && !mats[i].empty() )
+        {
+            const Mat* arrays[] = { &mats[i], 0 };
+            uchar* ptrs[1] = { 0 };
+            NAryMatIterator it(arrays, ptrs, 1);
+            size_t planeSize = it.size*mats[i].elemSize();
+            for( size_t p = 0; p < it.nplanes && ok; p++, ++it )
+                ok = fwrite(ptrs[0], 1, planeSize, f) == planeSize;
+        }
+
+        pos = entries[i].offset + (int64)(mats[i].total()*mats[i].elemSize());
+    }
+    if( ok && pos < offset )
+        ok = fwrite(zeros, 1, (size_t)(offset - pos), f) == (size_t)(offset - pos);
+
+    ok = fclose(f) == 0 && ok;
+    if( !ok )
+        CV_Error_(Error::StsError, ("Can't write the file %s", filename.c_str()));
+}
+
+void mapMatFile(const String& filename, std::vector<Mat>& mats, int flags)
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( flags == MAP_MAT_READ_ONLY || flags == MAP_MAT_COPY_ON_WRITE );
+
+    mats.clear();
+
+    // the mapping is released by the last matrix, or here if there are none
+    UMatData* u = mapFileData(filename, flags);
+    if( !u )
+        CV_Error_(Error::StsObjectNotFound, ("Can't open the file %s", filename.c_str()));
+    uchar* data = u->data;
+    size_t fileSize = u->size;
+
+    try
+    {
+        const MatFileHeader* header = (const MatFileHeader*)data;
+        if( fileSize < sizeof(MatFileHeader) ||
+            memcmp(header->signature, MAT_FILE_SIGNATURE, sizeof(header->signature)) != 0 )
+            CV_Error_(Error::StsParseError, ("%s is not a matrix file", filename.c_str()));
+        if( header->byteOrder != MAT_FILE_BYTE_ORDER )
+            CV_Error_(Error::StsParseError, ("%s has been written on a machine with a different byte order", filename.c_str()));
+        if( header->version != MAT_FILE_VERSION )
+            CV_Error_(Error::StsParseError, ("%s has unsupported version %d", filename.c_str(), header->version));
+        if( header->count < 0 || (uint64)header->count > (fileSize - sizeof(MatFileHeader))/sizeof(MatFileEntry) )
+            CV_Error_(Error::StsParseError, ("%s is corrupted", filename.c_str()));
+
+        const MatFileEntry* entries = (const MatFileEntry*)(data + sizeof(MatFileHeader));
+        mats.resize(header->count);
+        for( int i = 0; i < header->count; i++ )
+        {
+            const MatFileEntry& e = entries[i];
+            bool valid = e.type == CV_MAT_TYPE(e.type) && 0 <= e.dims && e.dims <= CV_MAX_DIM &&
+                         e.offset >= 0 && e.offset % MAT_FILE_ALIGN == 0 && (uint64)e.offset <= fileSize;
+            uint64 total = CV_ELEM_SIZE(e.type);
+            for( int k = 0; k < e.dims && valid; k++ )
+            {
+                valid = e.size[k] >= 0 && (e.size[k] == 0 || total <= (fileSize - e.offset)/e.size[k]);
+                total *= e.size[k];
+            }
+            if( !valid || (e.dims > 0 && total > fileSize - e.offset) )
+                CV_Error_(Error::StsParseError, ("%s is corrupted (matrix %d)", filename.c_str(), i));
+
+            if( e.dims == 0 || total == 0 )
+                continue;
+
+            Mat& m = mats[i];
+            if( e.dims == 1 )
+                m = Mat(e.size[0], 1, e.type, data + e.offset);
+            else
+                m = Mat(e.dims, e.size, e.type, data + e.offset);
+            m.u = u;
+            m.datastart = m.data;
+            m.datalimit = m.dataend = m.data + total;
+            CV_XADD(&u->refcount, 1);
+        }
+    }
+    catch(...)
+    {
+        mats.clear();
+        if( CV_XADD(&u->refcount, -1) == 1 )
+            u->currAllocator->unmap(u);
+        throw;
+    }
+
+    if( CV_XADD(&u->refcount, -1) == 1 )
+        u->currAllocator->unmap(u);
+}
+
+Mat mapMatFile(const String& filename, int flags)
+{
+    std::vector<Mat> mats;
+    mapMatFile(filename, mats, flags);
+    return mats.empty() ? Mat() : mats[0];
+}
+
+}
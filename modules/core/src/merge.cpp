@@ -43,6 +43,9 @@
 
 #include "precomp.hpp"
 
+#include "merge.simd.hpp"
+#include "merge.simd_declarations.hpp" // generated by ocv_add_dispatched_file(), see CMakeLists.txt
+
 namespace cv { namespace hal {
 
 #if CV_NEON
@@ -264,6 +267,32 @@ MERGE4_KERNEL_TEMPLATE(   int,  __m128,   float, _mm_interleave_ps, ps, CV_CPU_S
 
 #endif
 
+#if CV_SSE2
+
+// the 256-bit kernels from merge.simd.hpp for the CPUs that support them
+static int mergeWide(const uchar** src, uchar* dst, int len, int cn)
+{
+    CV_CPU_DISPATCH(mergeWide, (src, dst, len, cn));
+}
+
+static int mergeWide(const ushort** src, ushort* dst, int len, int cn)
+{
+    CV_CPU_DISPATCH(mergeWide, (src, dst, len, cn));
+}
+
+static int mergeWide(const int** src, int* dst, int len, int cn)
+{
+    CV_CPU_DISPATCH(mergeWide, (src, dst, len, cn));
+}
+
+template<typename T> static inline int
+mergeWide(const T**, T*, int, int)
+{
+    return 0;
+}
+
+#endif
+
 template<typename T> static void
 merge_( const T** src, T* dst, int len, int cn )
 {
@@ -295,6 +324,9 @@ merge_( const T** src, T* dst, int len, int cn )
             int inc_i = 32/sizeof(T);
             int inc_j = 2 * inc_i;
 
+            i = mergeWide(src, dst, len, cn);
+            j = i * cn;
+
             VMerge2<T> vmerge;
             if (vmerge.support)
                 for( ; i < len - inc_i; i += inc_i, j += inc_j)
@@ -327,6 +359,9 @@ merge_( const T** src, T* dst, int len, int cn )
             int inc_i = 32/sizeof(T);
             int inc_j = 3 * inc_i;
 
+            i = mergeWide(src, dst, len, cn);
+            j = i * cn;
+
             VMerge3<T> vmerge;
             if (vmerge.support)
                 for( ; i < len - inc_i; i += inc_i, j += inc_j)
@@ -360,6 +395,9 @@ merge_( const T** src, T* dst, int len, int cn )
             int inc_i = 32/sizeof(T);
             int inc_j = 4 * inc_i;
 
+            i = mergeWide(src, dst, len, cn);
+            j = i * cn;
+
             VMerge4<T> vmerge;
             if (vmerge.support)
                 for( ; i < len - inc_i; i += inc_i, j += inc_j)
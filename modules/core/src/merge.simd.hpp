@@ -0,0 +1,140 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+// The 256-bit kernels of cv::merge. The file is compiled into the regular build (the cpu_baseline
+// namespace, via merge.cpp) and once more for each instruction set listed in
+// ocv_add_dispatched_file() of modules/core/CMakeLists.txt. Without CV_SIMD256 the functions
+// process nothing, so merge_() goes on with the 128-bit kernels from the beginning of the row.
+
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv { namespace hal {
+CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN
+
+// merge the first len pixels of a 2-, 3- or 4-channel row as far as the 256-bit kernels go,
+// returns the number of processed pixels
+int mergeWide(const uchar** src, uchar* dst, int len, int cn);
+int mergeWide(const ushort** src, ushort* dst, int len, int cn);
+int mergeWide(const int** src, int* dst, int len, int cn);
+
+#ifndef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+#if CV_SIMD256
+
+// the kernels consume the same 32 bytes per channel as the SSE ones in merge.cpp;
+// only the layouts where they are measurably faster are enabled
+
+template<typename T, typename VT> static int
+mergeWide2_( const T** src, T* dst, int len )
+{
+    const T *src0 = src[0], *src1 = src[1];
+    const int inc_i = VT::nlanes;
+    int i = 0;
+
+    for( ; i < len - inc_i; i += inc_i, dst += inc_i*2 )
+    {
+        VT a = v256_load(src0 + i), b = v256_load(src1 + i);
+        v_store_interleave(dst, a, b);
+    }
+    return i;
+}
+
+template<typename T, typename VT> static int
+mergeWide3_( const T** src, T* dst, int len )
+{
+    const T *src0 = src[0], *src1 = src[1], *src2 = src[2];
+    const int inc_i = VT::nlanes;
+    int i = 0;
+
+    for( ; i < len - inc_i; i += inc_i, dst += inc_i*3 )
+    {
+        VT a = v256_load(src0 + i), b = v256_load(src1 + i), c = v256_load(src2 + i);
+        v_store_interleave(dst, a, b, c);
+    }
+    return i;
+}
+
+template<typename T, typename VT> static int
+mergeWide4_( const T** src, T* dst, int len )
+{
+    const T *src0 = src[0], *src1 = src[1], *src2 = src[2], *src3 = src[3];
+    const int inc_i = VT::nlanes;
+    int i = 0;
+
+    for( ; i < len - inc_i; i += inc_i, dst += inc_i*4 )
+    {
+        VT a = v256_load(src0 + i), b = v256_load(src1 + i);
+        VT c = v256_load(src2 + i), d = v256_load(src3 + i);
+        v_store_interleave(dst, a, b, c, d);
+    }
+    return i;
+}
+
+int mergeWide(const uchar** src, uchar* dst, int len, int cn)
+{
+    return cn == 2 ? mergeWide2_<uchar, v_uint8x32>(src, dst, len) :
+           cn == 4 ? mergeWide4_<uchar, v_uint8x32>(src, dst, len) : 0;
+}
+
+int mergeWide(const ushort** src, ushort* dst, int len, int cn)
+{
+    return cn == 3 ? mergeWide3_<ushort, v_uint16x16>(src, dst, len) :
+           cn == 4 ? mergeWide4_<ushort, v_uint16x16>(src, dst, len) : 0;
+}
+
+int mergeWide(const int** src, int* dst, int len, int cn)
+{
+    return cn == 3 ? mergeWide3_<int, v_int32x8>(src, dst, len) : 0;
+}
+
+#else
+
+int mergeWide(const uchar**, uchar*, int, int) { return 0; }
+int mergeWide(const ushort**, ushort*, int, int) { return 0; }
+int mergeWide(const int**, int*, int, int) { return 0; }
+
+#endif
+
+#endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+CV_CPU_OPTIMIZATION_NAMESPACE_END
+}} // cv::hal::
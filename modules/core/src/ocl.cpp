@@ -48,6 +48,17 @@
 #if !(defined _MSC_VER) || (defined _MSC_VER && _MSC_VER > 1700)
 #include <inttypes.h>
 #endif
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#include <sys/utime.h>
+#else
+#include <unistd.h>
+#include <utime.h>
+#endif
 
 #define CV_OPENCL_ALWAYS_SHOW_BUILD_LOG 0
 #define CV_OPENCL_SHOW_RUN_ERRORS       0
@@ -93,37 +104,6 @@ static bool getBoolParameter(const char* name, bool defaultValue)
 }
 
 
-// TODO Move to some common place
-static size_t getConfigurationParameterForSize(const char* name, size_t defaultValue)
-{
-#ifdef NO_GETENV
-    const char* envValue = NULL;
-#else
-    const char* envValue = getenv(name);
-#endif
-    if (envValue == NULL)
-    {
-        return defaultValue;
-    }
-    cv::String value = envValue;
-    size_t pos = 0;
-    for (; pos < value.size(); pos++)
-    {
-        if (!isdigit(value[pos]))
-            break;
-    }
-    cv::String valueStr = value.substr(0, pos);
-    cv::String suffixStr = value.substr(pos, value.length() - pos);
-    int v = atoi(valueStr.c_str());
-    if (suffixStr.length() == 0)
-        return v;
-    else if (suffixStr == "MB" || suffixStr == "Mb" || suffixStr == "mb")
-        return v * 1024 * 1024;
-    else if (suffixStr == "KB" || suffixStr == "Kb" || suffixStr == "kb")
-        return v * 1024;
-    CV_ErrorNoReturn(cv::Error::StsBadArg, cv::format("Invalid value for %s parameter: %s", name, value.c_str()));
-}
-
 #if CV_OPENCL_SHOW_SVM_LOG
 // TODO add timestamp logging
 #define CV_OPENCL_SVM_TRACE_P printf("line %d (ocl.cpp): ", __LINE__); printf
@@ -2467,6 +2447,166 @@ static unsigned int getSVMCapabilitiesMask()
 } // namespace
 #endif
 
+///////////////////////////////////////// OpenCL binary cache /////////////////////////////////////////
+
+// The compiled programs are kept in the directory set by the OPENCV_OPENCL_CACHE_DIR environment
+// variable, one file per program source, device, driver version and build options, so that the next
+// processes load the binaries instead of compiling the sources again. When the total size of the
+// files exceeds OPENCV_OPENCL_CACHE_LIMIT (256Mb by default), the least recently used ones are removed.
+class OpenCLBinaryCache
+{
+public:
+    OpenCLBinaryCache()
+    {
+#ifdef NO_GETENV
+        const char* envValue = NULL;
+#else
+        const char* envValue = getenv("OPENCV_OPENCL_CACHE_DIR");
+#endif
+        if( envValue && *envValue )
+        {
+            dir = envValue;
+            if( dir[dir.size()-1] != '/' && dir[dir.size()-1] != '\\' )
+                dir += "/";
+            if( !createDirectories(dir) )
+            {
+                std::cerr << "ERROR: Can't create OpenCL cache directory: " << dir << std::endl;
+                dir = String();
+            }
+        }
+        limit = getConfigurationParameterForSize("OPENCV_OPENCL_CACHE_LIMIT", (size_t)256 << 20);
+    }
+
+    bool enabled() const { return !dir.empty(); }
+
+    String getFileName(const ProgramSource& src, const String& prefix) const
+    {
+        return dir + format("%016llx_%016llx.clb", (unsigned long long)src.hash(),
+                            (unsigned long long)crc64((const uchar*)prefix.c_str(), prefix.size()));
+    }
+
+    bool load(const String& filename, String& bin) const
+    {
+        FILE* f = fopen(filename.c_str(), "rb");
+        if( !f )
+            return false;
+        fseek(f, 0, SEEK_END);
+        long sz = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        bool ok = false;
+        if( sz > 0 )
+        {
+            std::vector<char> buf(sz);
+            ok = fread(&buf[0], 1, sz, f) == (size_t)sz;
+            if( ok )
+                bin = String(&buf[0], sz);
+        }
+        fclose(f);
+        if( ok )
+            touch(filename);
+        return ok;
+    }
+
+    void store(const String& filename, const String& bin)
+    {
+        // the file is written under a temporary name and then renamed,
+        // so that the concurrent processes never see the partially written binaries
+        String tmpname = filename + format(".%d.tmp", (int)getProcessId());
+        FILE* f = fopen(tmpname.c_str(), "wb");
+        if( !f )
+            return;
+        bool ok = fwrite(bin.c_str(), 1, bin.size(), f) == bin.size();
+        ok = fclose(f) == 0 && ok;
+#ifdef _WIN32
+        if( ok )
+            remove(filename.c_str());
+#endif
+        if( !ok || rename(tmpname.c_str(), filename.c_str()) != 0 )
+        {
+            remove(tmpname.c_str());
+            return;
+        }
+
+        AutoLock lock(mutex);
+        trim();
+    }
+
+private:
+    void trim() const
+    {
+        std::vector<String> files;
+        glob(dir + "*.clb", files, false);
+
+        std::vector<std::pair<time_t, std::pair<size_t, String> > > entries;
+        size_t total = 0;
+        for( size_t i = 0; i < files.size(); i++ )
+        {
+            struct stat st;
+            if( stat(files[i].c_str(), &st) != 0 )
+                continue;
+            entries.push_back(std::make_pair(st.st_mtime, std::make_pair((size_t)st.st_size, files[i])));
+            total += (size_t)st.st_size;
+        }
+        if( total <= limit )
+            return;
+
+        std::sort(entries.begin(), entries.end());
+        for( size_t i = 0; i < entries.size() && total > limit; i++ )
+        {
+            if( remove(entries[i].second.second.c_str()) == 0 )
+                total -= entries[i].second.first;
+        }
+    }
+
+    static void touch(const String& filename)
+    {
+#ifdef _WIN32
+        _utime(filename.c_str(), NULL);
+#else
+        utime(filename.c_str(), NULL);
+#endif
+    }
+
+    static int getProcessId()
+    {
+#ifdef _WIN32
+        return (int)_getpid();
+#else
+        return (int)getpid();
+#endif
+    }
+
+    static bool createDirectories(const String& path)
+    {
+        for( size_t pos = 1; pos < path.size(); pos++ )
+        {
+            if( path[pos] != '/' && path[pos] != '\\' )
+                continue;
+            String subdir = path.substr(0, pos);
+            struct stat st;
+            if( stat(subdir.c_str(), &st) == 0 )
+                continue;
+#ifdef _WIN32
+            int result = _mkdir(subdir.c_str());
+#else
+            int result = mkdir(subdir.c_str(), 0777);
+#endif
+            if( result != 0 && errno != EEXIST )
+                return false;
+        }
+        return true;
+    }
+
+    String dir;
+    size_t limit;
+    Mutex mutex;
+};
+
+static OpenCLBinaryCache& getOpenCLBinaryCache()
+{
+    CV_SINGLETON_LAZY_INIT_REF(OpenCLBinaryCache, new OpenCLBinaryCache())
+}
+
 struct Context::Impl
 {
     static Context::Impl* get(Context& context) { return context.p; }
@@ -2591,8 +2731,22 @@ struct Context::Impl
         phash_t::iterator it = phash.find(k);
         if( it != phash.end() )
             return it->second;
-        //String filename = format("%08x%08x_%08x%08x.clb2",
-        Program prog(src, buildflags, errmsg);
+        Program prog;
+        // the binaries are stored for the single device only
+        OpenCLBinaryCache& cache = getOpenCLBinaryCache();
+        String filename, bin;
+        if( cache.enabled() && devices.size() == 1 )
+        {
+            filename = cache.getFileName(src, prefix);
+            if( cache.load(filename, bin) && !prog.read(bin, buildflags) )
+                prog = Program();
+        }
+        if( !prog.ptr() )
+        {
+            prog.create(src, buildflags, errmsg);
+            if( prog.ptr() && !filename.empty() && prog.write(bin) )
+                cache.store(filename, bin);
+        }
         if(prog.ptr())
             phash.insert(std::pair<HashKey,Program>(k, prog));
         return prog;
@@ -3582,15 +3736,11 @@ struct Program::Impl
             for( i = 0; i < n; i++ )
                 deviceList[i] = ctx.device(i).ptr();
 
-            Device device = Device::getDefault();
-            if (device.isAMD())
-                buildflags += " -D AMD_DEVICE";
-            else if (device.isIntel())
-                buildflags += " -D INTEL_DEVICE";
-
+            // buildflags keep the options as requested, so that they match Program::getPrefix()
+            String flags = getBuildFlags(buildflags);
             retval = clBuildProgram(handle, n,
                                     (const cl_device_id*)deviceList,
-                                    buildflags.c_str(), 0, 0);
+                                    flags.c_str(), 0, 0);
 #if !CV_OPENCL_ALWAYS_SHOW_BUILD_LOG
             if( retval != CL_SUCCESS )
 #endif
@@ -3608,7 +3758,7 @@ struct Program::Impl
                     {
                         // TODO It is useful to see kernel name & program file name also
                         errmsg = String(buf);
-                        printf("OpenCL program build log: %s\n%s\n", buildflags.c_str(), errmsg.c_str());
+                        printf("OpenCL program build log: %s\n%s\n", flags.c_str(), errmsg.c_str());
                         fflush(stdout);
                     }
                 }
@@ -3651,7 +3801,24 @@ struct Program::Impl
         cl_int binstatus = 0, retval = 0;
         handle = clCreateProgramWithBinary((cl_context)ctx.ptr(), 1, (cl_device_id*)&devid,
                                            &codelen, &bin, &binstatus, &retval);
-        CV_OclDbgAssert(retval == CL_SUCCESS);
+        // the program created from the binary still has to be built before creating the kernels;
+        // if anything fails, the caller compiles the program from the source
+        if( handle && (retval != CL_SUCCESS || binstatus != CL_SUCCESS ||
+            clBuildProgram(handle, 1, (cl_device_id*)&devid, getBuildFlags(buildflags).c_str(), 0, 0) != CL_SUCCESS) )
+        {
+            clReleaseProgram(handle);
+            handle = NULL;
+        }
+    }
+
+    static String getBuildFlags(const String& buildflags)
+    {
+        Device device = Device::getDefault();
+        if (device.isAMD())
+            return buildflags + " -D AMD_DEVICE";
+        else if (device.isIntel())
+            return buildflags + " -D INTEL_DEVICE";
+        return buildflags;
     }
 
     String store()
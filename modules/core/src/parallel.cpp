@@ -42,6 +42,9 @@
 
 #include "precomp.hpp"
 
+#include <map>
+#include <typeinfo>
+
 #if defined WIN32 || defined WINCE
     #include <windows.h>
     #undef small
@@ -121,16 +124,28 @@
 #  define CV_PARALLEL_FRAMEWORK "ms-concurrency"
 #elif defined HAVE_PTHREADS_PF
 #  define CV_PARALLEL_FRAMEWORK "pthreads"
+#  define CV_PARALLEL_PTHREADS 1
 #endif
 
 namespace cv
 {
     ParallelLoopBody::~ParallelLoopBody() {}
+    ParallelTask::~ParallelTask() {}
 #ifdef HAVE_PTHREADS_PF
     void parallel_for_pthreads(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes);
     size_t parallel_pthreads_get_threads_num();
+    int parallel_pthreads_get_requested_threads();
     void parallel_pthreads_set_threads_num(int num);
+    AsyncTask parallel_pthreads_async(const Ptr<ParallelTask>& task, const std::vector<AsyncTask>& dependencies, bool use_pool);
+    bool parallel_pthreads_task_ready(const AsyncTask::Impl& task);
+    void parallel_pthreads_task_wait(AsyncTask::Impl& task);
+    void parallel_pthreads_set_affinity(const std::vector<int>& cpus);
+    void parallel_pthreads_get_affinity(std::vector<int>& cpus);
+    int parallel_pthreads_get_affinity_size();
+    void parallel_pthreads_set_pool(int pool);
+    int parallel_pthreads_get_pool();
 #endif
+    bool parallel_parse_cpu_list(const char* str, std::vector<int>& cpus);
 }
 
 
@@ -163,16 +178,27 @@ namespace
     }
 #endif
 
+    // the time spent in the body by all the threads, collected for StripeTuner
+    struct BusyTime
+    {
+        BusyTime() : ticks(0) {}
+
+        int64 ticks;
+        cv::Mutex mutex;
+    };
+
     class ParallelLoopBodyWrapper : public cv::ParallelLoopBody
     {
     public:
-        ParallelLoopBodyWrapper(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes)
+        ParallelLoopBodyWrapper(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes,
+                                BusyTime* _busy)
         {
 
             body = &_body;
             wholeRange = _r;
             double len = wholeRange.end - wholeRange.start;
             nstripes = cvRound(_nstripes <= 0 ? len : MIN(MAX(_nstripes, 1.), len));
+            busy = _busy;
 
 #ifdef ENABLE_INSTRUMENTATION
             pThreadRoot = cv::instr::getInstrumentTLSStruct().pCurrentNode;
@@ -200,7 +226,18 @@ namespace
                             ((uint64)sr.start*(wholeRange.end - wholeRange.start) + nstripes/2)/nstripes);
             r.end = sr.end >= nstripes ? wholeRange.end : (int)(wholeRange.start +
                             ((uint64)sr.end*(wholeRange.end - wholeRange.start) + nstripes/2)/nstripes);
+            if(!busy)
+            {
+                (*body)(r);
+                return;
+            }
+
+            int64 t = cv::getTickCount();
             (*body)(r);
+            t = cv::getTickCount() - t;
+
+            cv::AutoLock lock(busy->mutex);
+            busy->ticks += t;
         }
         cv::Range stripeRange() const { return cv::Range(0, nstripes); }
 
@@ -208,6 +245,7 @@ namespace
         const cv::ParallelLoopBody* body;
         cv::Range wholeRange;
         int nstripes;
+        BusyTime* busy;
 #ifdef ENABLE_INSTRUMENTATION
         cv::instr::InstrNode *pThreadRoot;
 #endif
@@ -217,8 +255,8 @@ namespace
     class ProxyLoopBody : public ParallelLoopBodyWrapper
     {
     public:
-        ProxyLoopBody(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes)
-        : ParallelLoopBodyWrapper(_body, _r, _nstripes)
+        ProxyLoopBody(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes, BusyTime* _busy)
+        : ParallelLoopBodyWrapper(_body, _r, _nstripes, _busy)
         {}
 
         void operator ()(const tbb::blocked_range<int>& range) const
@@ -239,8 +277,8 @@ namespace
     class ProxyLoopBody : public ParallelLoopBodyWrapper
     {
     public:
-        ProxyLoopBody(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes)
-        : ParallelLoopBodyWrapper(_body, _r, _nstripes)
+        ProxyLoopBody(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes, BusyTime* _busy)
+        : ParallelLoopBodyWrapper(_body, _r, _nstripes, _busy)
         {}
 
         void operator ()(int i) const
@@ -252,7 +290,14 @@ namespace
     typedef ParallelLoopBodyWrapper ProxyLoopBody;
 #endif
 
+#if defined CV_PARALLEL_PTHREADS
+// the pthreads backend keeps the number of threads per thread pool
+static inline int getRequestedThreads() { return cv::parallel_pthreads_get_requested_threads(); }
+#else
+// the number of threads passed to setNumThreads(), 0 disables the parallel execution
 static int numThreads = -1;
+static inline int getRequestedThreads() { return numThreads; }
+#endif
 
 #if defined HAVE_TBB
 static tbb::task_scheduler_init tbbScheduler(tbb::task_scheduler_init::deferred);
@@ -286,6 +331,60 @@ static SchedPtr pplScheduler;
 
 #endif
 
+/*
+   Run-time choice of the number of stripes for the loops called with the default nstripes.
+
+   The time the body takes per element of the range is kept per call site, i.e. per type of the
+   body and per power of two of the range length (see ParallelStripeStats). The next calls of
+   the site are split into the stripes of about stripeTime seconds of work, which is enough to
+   hide the cost of taking a stripe and still leaves room for balancing the load, and the loops
+   which are cheaper than minParallelTime in total are executed by the calling thread, as waking
+   up the pool would take longer than the loop itself. Only a few calls of every site are timed,
+   and every thread keeps its own statistics, so that the tuning costs no lock and almost no
+   time. The tuning can be disabled by setting OPENCV_PARALLEL_ADAPTIVE_STRIPES=0.
+*/
+class StripeTuner
+{
+public:
+    typedef std::pair<const char*, int> Key;
+    typedef std::map<Key, cv::ParallelStripeStats> StatsMap;
+
+    StripeTuner()
+    {
+        const char* env = getenv("OPENCV_PARALLEL_ADAPTIVE_STRIPES");
+        enabled = env == NULL || atoi(env) != 0;
+        ticksPerSecond = cv::getTickFrequency();
+    }
+
+    bool isEnabled() const { return enabled; }
+
+    double getTicksPerSecond() const { return ticksPerSecond; }
+
+    static Key getKey(const cv::ParallelLoopBody& body, int len)
+    {
+        int lenLog2 = 0;
+        while((len >> lenLog2) > 1)
+            lenLog2++;
+        return Key(typeid(body).name(), lenLog2);
+    }
+
+    // the statistics of the call site collected by the calling thread
+    cv::ParallelStripeStats& getStats(const Key& key)
+    {
+        return (*stats.get())[key];
+    }
+
+private:
+    bool enabled;
+    double ticksPerSecond;
+    cv::TLSData<StatsMap> stats;
+};
+
+static StripeTuner& getStripeTuner()
+{
+    CV_SINGLETON_LAZY_INIT_REF(StripeTuner, new StripeTuner())
+}
+
 #endif // CV_PARALLEL_FRAMEWORK
 
 } //namespace
@@ -300,13 +399,28 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
 
 #ifdef CV_PARALLEL_FRAMEWORK
 
-    if(numThreads != 0)
+    if(getRequestedThreads() != 0)
     {
-        ProxyLoopBody pbody(body, range, nstripes);
+        StripeTuner& tuner = getStripeTuner();
+        ParallelStripeStats* stats = 0;
+        bool timed = false;
+        BusyTime busy;
+
+        if( nstripes <= 0 && tuner.isEnabled() )
+        {
+            stats = &tuner.getStats(StripeTuner::getKey(body, range.size()));
+            nstripes = stats->stripes(range.size(), tuner.getTicksPerSecond(), nstripes);
+            timed = stats->sample();
+        }
+
+        ProxyLoopBody pbody(body, range, nstripes, timed ? &busy : 0);
         cv::Range stripeRange = pbody.stripeRange();
         if( stripeRange.end - stripeRange.start == 1 )
         {
+            int64 t = timed ? getTickCount() : 0;
             body(range);
+            if( timed )
+                stats->update(range.size(), getTickCount() - t);
             return;
         }
 
@@ -316,7 +430,7 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
 
 #elif defined HAVE_CSTRIPES
 
-        parallel(MAX(0, numThreads))
+        parallel(MAX(0, getRequestedThreads()))
         {
             int offset = stripeRange.start;
             int len = stripeRange.end - offset;
@@ -363,6 +477,9 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
 
 #endif
 
+        if( timed )
+            stats->update(range.size(), busy.ticks);
+
     }
     else
 
@@ -373,11 +490,115 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
     }
 }
 
+/* ================================   parallel_async  ================================ */
+
+#ifndef HAVE_PTHREADS_PF
+
+// without the pthreads pool the tasks are executed by the thread which starts them,
+// so only the result of the task has to be kept
+struct cv::AsyncTask::Impl
+{
+    Impl() : failed(false) {}
+
+    bool failed;
+    cv::Exception exception;
+};
+
+#endif
+
+cv::AsyncTask::AsyncTask() {}
+
+bool cv::AsyncTask::valid() const
+{
+    return !p.empty();
+}
+
+bool cv::AsyncTask::ready() const
+{
+    CV_Assert(valid());
+#ifdef HAVE_PTHREADS_PF
+    return parallel_pthreads_task_ready(*p);
+#else
+    return true;
+#endif
+}
+
+void cv::AsyncTask::wait() const
+{
+    CV_Assert(valid());
+#ifdef HAVE_PTHREADS_PF
+    parallel_pthreads_task_wait(*p);
+#else
+    if(p->failed)
+        throw p->exception;
+#endif
+}
+
+cv::AsyncTask cv::parallel_async(const Ptr<ParallelTask>& task, const std::vector<AsyncTask>& dependencies)
+{
+    CV_Assert(!task.empty());
+
+#if defined HAVE_PTHREADS_PF
+
+    // the tasks share the pool with parallel_for_ only when it is the pthreads one,
+    // with the other frameworks they are executed in place not to start a second pool
+#if defined CV_PARALLEL_PTHREADS
+    bool use_pool = getRequestedThreads() != 0;
+#else
+    bool use_pool = false;
+#endif
+
+    return parallel_pthreads_async(task, dependencies, use_pool);
+
+#else
+
+    AsyncTask result;
+    result.p = makePtr<AsyncTask::Impl>();
+
+    // the dependencies are done already, they have been executed in place too
+    for(size_t i = 0; i < dependencies.size() && !result.p->failed; ++i)
+    {
+        if(dependencies[i].valid() && dependencies[i].p->failed)
+        {
+            result.p->failed = true;
+            result.p->exception = dependencies[i].p->exception;
+        }
+    }
+
+    if(!result.p->failed)
+    {
+        try
+        {
+            (*task)();
+        }
+        catch(const cv::Exception& e)
+        {
+            result.p->failed = true;
+            result.p->exception = e;
+        }
+        catch(const std::exception& e)
+        {
+            result.p->failed = true;
+            result.p->exception = cv::Exception(cv::Error::StsError, e.what(), CV_Func, __FILE__, __LINE__);
+        }
+        catch(...)
+        {
+            result.p->failed = true;
+            result.p->exception = cv::Exception(cv::Error::StsError, "Unknown exception in parallel_async task",
+                                                CV_Func, __FILE__, __LINE__);
+        }
+    }
+
+    return result;
+
+#endif
+}
+
 int cv::getNumThreads(void)
 {
 #ifdef CV_PARALLEL_FRAMEWORK
 
-    if(numThreads == 0)
+    if(getRequestedThreads() == 0)
         return 1;
 
 #endif
@@ -426,7 +647,9 @@ int cv::getNumThreads(void)
 void cv::setNumThreads( int threads )
 {
     (void)threads;
-#ifdef CV_PARALLEL_FRAMEWORK
+    // the threads which are stopped would keep their plans until the process exits
+    releaseDftPlans();
+#if defined CV_PARALLEL_FRAMEWORK && !defined CV_PARALLEL_PTHREADS
     numThreads = threads;
 #endif
 
@@ -508,6 +731,163 @@ int cv::getThreadNum(void)
 #endif
 }
 
+/* ================================   affinity and NUMA  ================================ */
+
+void cv::setThreadAffinity(const std::vector<int>& cpus)
+{
+    for(size_t i = 0; i < cpus.size(); i++)
+        CV_Assert(0 <= cpus[i] && cpus[i] < 1024);
+
+#if defined CV_PARALLEL_PTHREADS
+    parallel_pthreads_set_affinity(cpus);
+#endif
+}
+
+void cv::getThreadAffinity(std::vector<int>& cpus)
+{
+    cpus.clear();
+#if defined CV_PARALLEL_PTHREADS
+    parallel_pthreads_get_affinity(cpus);
+#endif
+}
+
+int cv::getThreadAffinitySize()
+{
+#if defined CV_PARALLEL_PTHREADS
+    return parallel_pthreads_get_affinity_size();
+#else
+    return 0;
+#endif
+}
+
+void cv::setThreadPool(int pool)
+{
+    CV_Assert(pool >= 0);
+#if defined CV_PARALLEL_PTHREADS
+    parallel_pthreads_set_pool(pool);
+#endif
+}
+
+int cv::getThreadPool()
+{
+#if defined CV_PARALLEL_PTHREADS
+    return parallel_pthreads_get_pool();
+#else
+    return 0;
+#endif
+}
+
+// parses the lists of the form "0-3,8,10-11" used by Linux for the CPU and the node sets
+bool cv::parallel_parse_cpu_list(const char* str, std::vector<int>& cpus)
+{
+    cpus.clear();
+    while(*str)
+    {
+        int first = 0, last = 0, n = 0;
+        if(sscanf(str, "%d%n", &first, &n) != 1 || first < 0)
+            return false;
+        str += n;
+        last = first;
+        if(*str == '-')
+        {
+            if(sscanf(str + 1, "%d%n", &last, &n) != 1 || last < first)
+                return false;
+            str += n + 1;
+        }
+        for(int i = first; i <= last; i++)
+            cpus.push_back(i);
+        while(*str == ',' || *str == ' ' || *str == '\n')
+            str++;
+    }
+    return !cpus.empty();
+}
+
+const double cv::ParallelStripeStats::minParallelTime = 5e-5;
+const double cv::ParallelStripeStats::stripeTime = 2e-5;
+const unsigned cv::ParallelStripeStats::warmupCalls = 2;
+const unsigned cv::ParallelStripeStats::sampleInterval = 16;
+
+bool cv::ParallelStripeStats::sample()
+{
+    calls++;
+    return ticksPerElem < 0 || calls <= warmupCalls || calls % sampleInterval == 0;
+}
+
+void cv::ParallelStripeStats::update(int len, int64 ticks)
+{
+    double t = (double)ticks/std::max(len, 1);
+    if( ticksPerElem < 0 )
+        ticksPerElem = t;
+    else
+        ticksPerElem += (t - ticksPerElem)*0.25;
+}
+
+double cv::ParallelStripeStats::stripes(int len, double ticksPerSecond, double nstripes) const
+{
+    if( ticksPerElem < 0 )
+        return nstripes;
+    double t = ticksPerElem*len/ticksPerSecond;
+    return t < minParallelTime ? 1. : std::max(t/stripeTime, 2.);
+}
+
+#if defined __linux__
+static bool readCPUList(const char* path, std::vector<int>& cpus)
+{
+    char buf[4096];
+    FILE* f = fopen(path, "r");
+    if(!f)
+        return false;
+    char* res = fgets(buf, sizeof(buf), f);
+    fclose(f);
+    return res && cv::parallel_parse_cpu_list(buf, cpus);
+}
+
+// the ids of the online nodes, they are not necessarily contiguous (e.g. "0,2" or "0-1,4-5")
+static std::vector<int>* readNumaNodeIds()
+{
+    std::vector<int>* ids = new std::vector<int>();
+    readCPUList("/sys/devices/system/node/online", *ids);
+    return ids;
+}
+
+static const std::vector<int>& getNumaNodeIds()
+{
+    CV_SINGLETON_LAZY_INIT_REF(std::vector<int>, readNumaNodeIds())
+}
+
+static bool readNumaNodeCPUs(int node, std::vector<int>& cpus)
+{
+    const std::vector<int>& ids = getNumaNodeIds();
+    if(node >= (int)ids.size())
+        return false;
+    char path[64];
+    sprintf(path, "/sys/devices/system/node/node%d/cpulist", ids[node]);
+    return readCPUList(path, cpus);
+}
+#endif
+
+int cv::getNumberOfNumaNodes()
+{
+#if defined __linux__
+    return std::max((int)getNumaNodeIds().size(), 1);
+#else
+    return 1;
+#endif
+}
+
+void cv::getNumaNodeCPUs(int node, std::vector<int>& cpus)
+{
+    CV_Assert(0 <= node && node < getNumberOfNumaNodes());
+#if defined __linux__
+    if(readNumaNodeCPUs(node, cpus))
+        return;
+#endif
+    // a single node with all the CPUs
+    cpus.resize(getNumberOfCPUs());
+    for(size_t i = 0; i < cpus.size(); i++)
+        cpus[i] = (int)i;
+}
+
 #ifdef ANDROID
 static inline int getNumberOfCPUsImpl()
 {
@@ -45,20 +45,46 @@
 #ifdef HAVE_PTHREADS_PF
 
 #include <algorithm>
+#include <deque>
+#include <map>
 #include <pthread.h>
+#include <sched.h>
 
 namespace cv
 {
 
+/*
+   Work-stealing scheduler for parallel_for_.
+
+   Every parallel_for_ call is turned into a ParallelJob. The stripes of the job are
+   split into contiguous chunks, one per thread that takes part in it. A thread takes
+   stripes from the front of its own chunk and, when the chunk is exhausted, steals
+   the upper half of the largest chunk left in the job.
+
+   The thread that called parallel_for_ always works on its own job, the pool threads
+   join the most recent job that still has stripes to give. So a parallel_for_ called
+   from inside a parallel body is executed by the calling thread together with the
+   pool threads that are idle at that moment: there is no serialization of nested
+   regions and no thread is created besides the pool itself.
+
+   The tasks started by parallel_async are executed by the same threads. A task is
+   queued once all its dependencies are done, the pool threads take the queued tasks
+   when no parallel_for_ job needs help, so the short fork-join jobs, which somebody
+   is always waiting for, are not delayed by the long-running tasks.
+
+   There may be several independent pools (ThreadManager objects), the one used by a
+   thread is selected with setThreadPool and is inherited by the pool's own threads.
+   When a pool is pinned to a set of CPUs (setThreadAffinity), the CPUs are ordered by
+   their NUMA node, the i-th pool thread runs on the (i+1)-th CPU and always owns the
+   (i+1)-th chunk of a job, the calling thread owns the first one. So the same part of
+   the range goes to the same CPU from one parallel_for_ to another, and the memory
+   touched first by that CPU stays local to it. The threads steal from the chunks of
+   their own node before going to the other nodes.
+*/
+
 class ThreadManager;
 
-enum ForThreadState
-{
-    eFTNotStarted = 0,
-    eFTStarted = 1,
-    eFTToStop = 2,
-    eFTStoped = 3
-};
+bool parallel_parse_cpu_list(const char* str, std::vector<int>& cpus);
 
 enum ThreadManagerPoolState
 {
@@ -68,110 +94,103 @@ enum ThreadManagerPoolState
     eTMSingleThreaded = 3
 };
 
-struct work_load
+enum AsyncTaskState
 {
-    work_load()
-    {
-        clear();
-    }
+    eTaskWaiting = 0,   // some of the dependencies are not done yet
+    eTaskQueued = 1,
+    eTaskRunning = 2,
+    eTaskDone = 3
+};
 
-    work_load(const cv::Range& range, const cv::ParallelLoopBody& body, int nstripes)
-    {
-        set(range, body, nstripes);
-    }
+// all the fields are protected by the mutex of ThreadManager
+struct AsyncTask::Impl
+{
+    Impl(const Ptr<ParallelTask>& _task, ThreadManager* _manager, bool _pooled) :
+        task(_task), manager(_manager), pooled(_pooled), state(eTaskWaiting), pending_deps(0), failed(false)
+    {}
+
+    Ptr<ParallelTask>               task;
+    ThreadManager*                  manager;      // the pool the task was submitted to
+    bool                            pooled;       // executed by the pool rather than in place
+    int                             state;
+    int                             pending_deps; // dependencies which are not done yet
+    std::vector<Ptr<AsyncTask::Impl> > dependents;
+
+    bool                            failed;
+    cv::Exception                   exception;
+};
 
-    void set(const cv::Range& range, const cv::ParallelLoopBody& body, unsigned int nstripes)
-    {
-        m_body = &body;
-        m_range = &range;
+struct stripe_queue
+{
+    pthread_mutex_t m_mutex;
+    volatile int    m_begin;
+    volatile int    m_end;
+    int             m_owned;  // becomes non-zero once a thread has taken the chunk
+    int             m_node;   // NUMA node of the owner, -1 if not known
+};
 
-        //ensure that nstripes not larger than range length
-        m_nstripes = std::min( unsigned(m_range->end - m_range->start) , nstripes);
+class ParallelJob
+{
+public:
+    ParallelJob(const cv::Range& range, const cv::ParallelLoopBody& body, int nstripes, int nqueues,
+                const std::vector<int>& queue_nodes);
 
-        m_block_size = ((m_range->end - m_range->start - 1)/m_nstripes) + 1;
+    ~ParallelJob();
 
-        //ensure that nstripes not larger than blocks count, so we would never go out of range
-        m_nstripes = std::min(m_nstripes, unsigned(((m_range->end - m_range->start - 1)/m_block_size) + 1) );
-    }
+    //called from any thread taking part in the job, slot is the chunk the thread prefers to own (or -1)
+    void execute(int slot);
 
-    const cv::ParallelLoopBody* m_body;
-    const cv::Range*            m_range;
-    unsigned int                         m_nstripes;
-    int                m_block_size;
+    //called from the thread which has created the job
+    void wait_complete();
 
-    void clear()
-    {
-        m_body = 0;
-        m_range = 0;
-        m_nstripes = 0;
-        m_block_size = 0;
-    }
-};
+    bool has_pending_work() const { return pending() > 0; }
 
-class ForThread
-{
-public:
+private:
 
-    ForThread(): m_task_start(false), m_parent(0), m_state(eFTNotStarted), m_id(0)
-    {
-    }
+    bool pop(int slot, int& stripe);
 
-    //called from manager thread
-    bool init(size_t id, ThreadManager* parent);
+    bool steal(int slot, int node, int& begin, int& end);
 
-    //called from manager thread
-    void run();
+    void run_stripes(int begin, int end);
 
-    //called from manager thread
-    void stop();
+    void notify_complete(int count);
 
-    ~ForThread();
+    //m_pending is changed by the other threads with CV_XADD, so it is read the same way
+    int pending() const { return CV_XADD(const_cast<int*>(&m_pending), 0); }
 
-private:
+    const cv::ParallelLoopBody* m_body;
+    cv::Range                   m_range;
+    int                         m_nstripes;
+    int                         m_block_size;
 
-    //called from worker thread
-    static void* thread_loop_wrapper(void* thread_object);
+    std::vector<stripe_queue>   m_queues;
+    int                         m_next_slot;
 
-    //called from worker thread
-    void execute();
+    int                         m_pending;   // stripes nobody has taken yet
+    int                         m_completed; // stripes which are done
 
-    //called from worker thread
-    void thread_body();
+    pthread_mutex_t             m_complete_mutex;
+    pthread_cond_t              m_cond_complete;
+    bool                        m_complete;
 
-    pthread_t       m_posix_thread;
-    pthread_mutex_t m_thread_mutex;
-    pthread_cond_t  m_cond_thread_task;
-    bool            m_task_start;
+    // the first error raised by the body, it is rethrown in the calling thread
+    volatile bool               m_failed;
+    cv::Exception               m_exception;
 
-    ThreadManager*  m_parent;
-    ForThreadState  m_state;
-    size_t          m_id;
+    ParallelJob(const ParallelJob&);
+    ParallelJob& operator = (const ParallelJob&);
 };
 
 class ThreadManager
 {
 public:
-    friend class ForThread;
 
-    static ThreadManager& instance()
-    {
-        CV_SINGLETON_LAZY_INIT_REF(ThreadManager, new ThreadManager())
-    }
-
-    static void stop()
-    {
-        ThreadManager& manager = instance();
+    // the pool selected by the calling thread
+    static ThreadManager& instance();
 
-        if(manager.m_pool_state == eTMInited)
-        {
-            for(size_t i = 0; i < manager.m_num_threads; ++i)
-            {
-                manager.m_threads[i].stop();
-            }
-        }
+    static int getPoolIndex();
 
-        manager.m_pool_state = eTMNotInited;
-    }
+    static void setPoolIndex(int pool);
 
     void run(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes);
 
@@ -179,41 +198,95 @@ public:
 
     void setNumOfThreads(size_t n);
 
+    // the value passed to setNumThreads() for this pool, 0 disables the parallel execution
+    int getRequestedThreads() const { return m_requested_threads; }
+
+    void setRequestedThreads(int n) { m_requested_threads = n; }
+
+    void setAffinity(const std::vector<int>& cpus);
+
+    void getAffinity(std::vector<int>& cpus);
+
+    // the number of CPUs the pool is pinned to, read without the lock
+    int getAffinitySize() const { return CV_XADD(const_cast<int*>(&m_num_cpus), 0); }
+
+    AsyncTask submit(const Ptr<ParallelTask>& task, const std::vector<AsyncTask>& dependencies, bool use_pool);
+
+    bool isReady(const AsyncTask::Impl& task);
+
+    void wait(AsyncTask::Impl& task);
+
 private:
 
-    ThreadManager();
+    explicit ThreadManager(int pool);
 
     ~ThreadManager();
 
-    void wait_complete();
+    bool initPool();
 
-    void notify_complete();
+    void stopPool();
 
-    bool initPool();
+    void removeJob(const Ptr<ParallelJob>& job);
+
+    //called with m_manager_mutex locked, the tasks to run in place are added to run_now
+    void scheduleTask(const Ptr<AsyncTask::Impl>& task, std::vector<Ptr<AsyncTask::Impl> >& run_now);
+
+    //called with m_manager_mutex locked
+    void completeTask(const Ptr<AsyncTask::Impl>& task, std::vector<Ptr<AsyncTask::Impl> >& run_now);
+
+    //executes the tasks and the ones they have released
+    void runTasks(std::vector<Ptr<AsyncTask::Impl> >& tasks);
+
+    //called from worker thread
+    static void* thread_loop_wrapper(void* arg);
+
+    //called from worker thread
+    void thread_body(int index);
 
     size_t defaultNumberOfThreads();
 
-    std::vector<ForThread> m_threads;
+    void defaultAffinity(std::vector<int>& cpus);
+
+    struct worker_arg_t
+    {
+        ThreadManager* manager;
+        int index;
+    };
+
+    int m_pool;
+
+    std::vector<pthread_t> m_threads;
+    std::vector<worker_arg_t> m_worker_args;
     size_t m_num_threads;
+    int m_requested_threads;
 
-    pthread_mutex_t m_manager_task_mutex;
-    pthread_cond_t  m_cond_thread_task_complete;
-    bool            m_task_complete;
+    // the CPUs the pool is pinned to, ordered by the node, and the node of each of them;
+    // they are replaced under m_manager_mutex, m_num_cpus is their number changed with CV_XADD
+    std::vector<int> m_cpus;
+    std::vector<int> m_cpu_nodes;
+    int m_num_cpus;
 
-    unsigned int m_task_position;
-    unsigned int m_num_of_completed_tasks;
+    // protects the pool and the list of jobs
+    pthread_mutex_t m_manager_mutex;
+    pthread_cond_t  m_cond_new_job;
+    pthread_cond_t  m_cond_task_done;
 
-    pthread_mutex_t m_manager_access_mutex;
+    // active jobs, the most recent (usually the innermost nested one) is the last
+    std::vector<Ptr<ParallelJob> > m_jobs;
 
-    static const char m_env_name[];
-    static const unsigned int m_default_number_of_threads;
+    // asynchronous tasks ready to run
+    std::deque<Ptr<AsyncTask::Impl> > m_tasks;
+    bool m_stop;
 
-    work_load m_work_load;
+    static const char m_env_name[];
+    static const char m_affinity_env_name[];
+    static const unsigned int m_max_stripes_per_thread;
 
     struct work_thread_t
     {
-        work_thread_t(): value(false) { }
+        work_thread_t(): value(false), slot(-1) { }
         bool value;
+        int slot;    // the chunk the thread owns when the pool is pinned
     };
 
     cv::TLSData<work_thread_t> m_is_work_thread;
@@ -222,152 +295,268 @@ private:
 };
 
 const char ThreadManager::m_env_name[] = "OPENCV_FOR_THREADS_NUM";
+const char ThreadManager::m_affinity_env_name[] = "OPENCV_THREAD_AFFINITY";
 
-#ifdef ANDROID
-// many modern phones/tables have 4-core CPUs. Let's use no more
-// than 2 threads by default not to overheat the devices
-const unsigned int ThreadManager::m_default_number_of_threads = 2;
-#else
-const unsigned int ThreadManager::m_default_number_of_threads = 8;
-#endif
+// stripes are the stealing unit, a few of them per thread keep the load balanced
+// while the per-stripe overhead stays negligible
+const unsigned int ThreadManager::m_max_stripes_per_thread = 8;
 
-ForThread::~ForThread()
+ParallelJob::ParallelJob(const cv::Range& range, const cv::ParallelLoopBody& body, int nstripes, int nqueues,
+                         const std::vector<int>& queue_nodes) :
+    m_body(&body), m_range(range), m_next_slot(0), m_complete(false), m_failed(false)
 {
-    if(m_state == eFTStarted)
-    {
-        stop();
+    int len = m_range.end - m_range.start;
+
+    //ensure that nstripes not larger than range length
+    m_nstripes = std::max(std::min(len, nstripes), 1);
+
+    m_block_size = ((len - 1)/m_nstripes) + 1;
+
+    //ensure that nstripes not larger than blocks count, so we would never go out of range
+    m_nstripes = std::min(m_nstripes, ((len - 1)/m_block_size) + 1);
+
+    m_pending = m_nstripes;
+    m_completed = 0;
 
-        pthread_mutex_destroy(&m_thread_mutex);
+    nqueues = std::max(std::min(nqueues, m_nstripes), 1);
+    m_queues.resize(nqueues);
 
-        pthread_cond_destroy(&m_cond_thread_task);
+    for(int i = 0; i < nqueues; ++i)
+    {
+        stripe_queue& q = m_queues[i];
+        pthread_mutex_init(&q.m_mutex, NULL);
+        q.m_begin = (int)((int64)m_nstripes*i/nqueues);
+        q.m_end = (int)((int64)m_nstripes*(i + 1)/nqueues);
+        q.m_owned = 0;
+        q.m_node = i < (int)queue_nodes.size() ? queue_nodes[i] : -1;
     }
+
+    pthread_mutex_init(&m_complete_mutex, NULL);
+    pthread_cond_init(&m_cond_complete, NULL);
 }
 
-bool ForThread::init(size_t id, ThreadManager* parent)
+ParallelJob::~ParallelJob()
 {
-    m_id = id;
-
-    m_parent = parent;
+    for(size_t i = 0; i < m_queues.size(); ++i)
+        pthread_mutex_destroy(&m_queues[i].m_mutex);
 
-    int res = 0;
-
-    res |= pthread_mutex_init(&m_thread_mutex, NULL);
+    pthread_mutex_destroy(&m_complete_mutex);
+    pthread_cond_destroy(&m_cond_complete);
+}
 
-    res |= pthread_cond_init(&m_cond_thread_task, NULL);
+bool ParallelJob::pop(int slot, int& stripe)
+{
+    stripe_queue& q = m_queues[slot];
+    bool res = false;
 
-    if(!res)
+    pthread_mutex_lock(&q.m_mutex);
+    if(q.m_begin < q.m_end)
     {
-        res = pthread_create(&m_posix_thread, NULL, thread_loop_wrapper, (void*)this);
+        stripe = q.m_begin++;
+        res = true;
     }
+    pthread_mutex_unlock(&q.m_mutex);
 
-
-    return res == 0;
+    return res;
 }
 
-void ForThread::stop()
+bool ParallelJob::steal(int slot, int node, int& begin, int& end)
 {
-    if(m_state == eFTStarted)
+    int nqueues = (int)m_queues.size();
+
+    while(pending() > 0)
     {
-        pthread_mutex_lock(&m_thread_mutex);
-        m_state = eFTToStop;
-        pthread_mutex_unlock(&m_thread_mutex);
+        // look for the largest chunk without locking, then recheck it under the lock;
+        // a chunk of the same node is preferred to a larger one of another node
+        int victim = -1, victim_size = 0;
+        int local_victim = -1, local_victim_size = 0;
+        for(int i = 0; i < nqueues; ++i)
+        {
+            int size = m_queues[i].m_end - m_queues[i].m_begin;
+            if(i == slot)
+                continue;
+            if(size > victim_size)
+            {
+                victim = i;
+                victim_size = size;
+            }
+            if(node >= 0 && m_queues[i].m_node == node && size > local_victim_size)
+            {
+                local_victim = i;
+                local_victim_size = size;
+            }
+        }
+
+        if(local_victim >= 0)
+            victim = local_victim;
 
-        run();
+        if(victim < 0)
+            return false;
 
-        pthread_join(m_posix_thread, NULL);
+        stripe_queue& q = m_queues[victim];
+        pthread_mutex_lock(&q.m_mutex);
+        int size = q.m_end - q.m_begin;
+        if(size > 0)
+        {
+            // the owner keeps the lower half and continues from its front
+            end = q.m_end;
+            q.m_end -= (size + 1)/2;
+            begin = q.m_end;
+        }
+        pthread_mutex_unlock(&q.m_mutex);
+
+        if(size > 0)
+            return true;
     }
 
-    pthread_mutex_lock(&m_thread_mutex);
-    m_state = eFTStoped;
-    pthread_mutex_unlock(&m_thread_mutex);
+    return false;
 }
 
-void ForThread::run()
+void ParallelJob::run_stripes(int begin, int end)
 {
-    pthread_mutex_lock(&m_thread_mutex);
+    CV_XADD(&m_pending, begin - end);
 
-    m_task_start = true;
-
-    pthread_cond_signal(&m_cond_thread_task);
+    for(int i = begin; i < end; ++i)
+    {
+        int start = m_range.start + i*m_block_size;
 
-    pthread_mutex_unlock(&m_thread_mutex);
-}
+        try
+        {
+            if(!m_failed)
+                m_body->operator()(cv::Range(start, std::min(start + m_block_size, m_range.end)));
+        }
+        catch(const cv::Exception& e)
+        {
+            pthread_mutex_lock(&m_complete_mutex);
+            if(!m_failed)
+                m_exception = e;
+            m_failed = true;
+            pthread_mutex_unlock(&m_complete_mutex);
+        }
+        catch(const std::exception& e)
+        {
+            pthread_mutex_lock(&m_complete_mutex);
+            if(!m_failed)
+                m_exception = cv::Exception(cv::Error::StsError, e.what(), CV_Func, __FILE__, __LINE__);
+            m_failed = true;
+            pthread_mutex_unlock(&m_complete_mutex);
+        }
+        catch(...)
+        {
+            pthread_mutex_lock(&m_complete_mutex);
+            if(!m_failed)
+                m_exception = cv::Exception(cv::Error::StsError, "Unknown exception in parallel_for_ body",
+                                            CV_Func, __FILE__, __LINE__);
+            m_failed = true;
+            pthread_mutex_unlock(&m_complete_mutex);
+        }
+    }
 
-void* ForThread::thread_loop_wrapper(void* thread_object)
-{
-    ((ForThread*)thread_object)->thread_body();
-    return 0;
+    notify_complete(end - begin);
 }
 
-void ForThread::execute()
+void ParallelJob::notify_complete(int count)
 {
-    unsigned int m_current_pos = CV_XADD(&m_parent->m_task_position, 1);
-
-    work_load& load = m_parent->m_work_load;
-
-    while(m_current_pos < load.m_nstripes)
+    if(CV_XADD(&m_completed, count) + count == m_nstripes)
     {
-        int start = load.m_range->start + m_current_pos*load.m_block_size;
-        int end = std::min(start + load.m_block_size, load.m_range->end);
+        pthread_mutex_lock(&m_complete_mutex);
+
+        m_complete = true;
 
-        load.m_body->operator()(cv::Range(start, end));
+        pthread_cond_broadcast(&m_cond_complete);
 
-        m_current_pos = CV_XADD(&m_parent->m_task_position, 1);
+        pthread_mutex_unlock(&m_complete_mutex);
     }
 }
 
-void ForThread::thread_body()
+void ParallelJob::execute(int slot)
 {
-    m_parent->m_is_work_thread.get()->value = true;
-
-    pthread_mutex_lock(&m_thread_mutex);
+    int nqueues = (int)m_queues.size();
+    int node = 0 <= slot && slot < nqueues ? m_queues[slot].m_node : -1;
 
-    m_state = eFTStarted;
+    // take the preferred chunk if it is free, otherwise the first free one
+    if(slot < 0 || slot >= nqueues || CV_XADD(&m_queues[slot].m_owned, 1) != 0)
+    {
+        do
+            slot = CV_XADD(&m_next_slot, 1);
+        while(slot < nqueues && CV_XADD(&m_queues[slot].m_owned, 1) != 0);
+    }
 
-    while(m_state == eFTStarted)
+    if(slot >= nqueues)
     {
-        //to handle spurious wakeups
-        while( !m_task_start && m_state != eFTToStop )
-            pthread_cond_wait(&m_cond_thread_task, &m_thread_mutex);
+        // all the chunks are owned already, only stealing is possible
+        int begin = 0, end = 0;
+        while(steal(-1, node, begin, end))
+            run_stripes(begin, end);
+        return;
+    }
+
+    node = m_queues[slot].m_node;
+    stripe_queue& own = m_queues[slot];
 
-        if(m_state == eFTStarted)
+    for(;;)
+    {
+        int stripe = 0;
+        if(pop(slot, stripe))
         {
-            execute();
+            run_stripes(stripe, stripe + 1);
+            continue;
+        }
 
-            m_task_start = false;
+        int begin = 0, end = 0;
+        if(!steal(slot, node, begin, end))
+            break;
 
-            m_parent->notify_complete();
-        }
+        // keep the first stolen stripe and expose the rest to the other threads
+        pthread_mutex_lock(&own.m_mutex);
+        own.m_begin = begin + 1;
+        own.m_end = end;
+        pthread_mutex_unlock(&own.m_mutex);
+
+        run_stripes(begin, begin + 1);
     }
+}
+
+void ParallelJob::wait_complete()
+{
+    pthread_mutex_lock(&m_complete_mutex);
+
+    //to handle spurious wakeups
+    while(!m_complete)
+        pthread_cond_wait(&m_cond_complete, &m_complete_mutex);
+
+    pthread_mutex_unlock(&m_complete_mutex);
 
-    pthread_mutex_unlock(&m_thread_mutex);
+    if(m_failed)
+        throw m_exception;
 }
 
-ThreadManager::ThreadManager(): m_num_threads(0), m_task_complete(false), m_num_of_completed_tasks(0), m_pool_state(eTMNotInited)
+ThreadManager::ThreadManager(int pool): m_pool(pool), m_num_threads(0), m_requested_threads(-1), m_num_cpus(0),
+    m_stop(false), m_pool_state(eTMNotInited)
 {
     int res = 0;
 
-    pthread_mutexattr_t attr;
-    pthread_mutexattr_init(&attr);
-    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
-    res |= pthread_mutex_init(&m_manager_access_mutex, &attr);
-    pthread_mutexattr_destroy(&attr);
+    res |= pthread_mutex_init(&m_manager_mutex, NULL);
 
-    res |= pthread_mutex_init(&m_manager_task_mutex, NULL);
+    res |= pthread_cond_init(&m_cond_new_job, NULL);
 
-    res |= pthread_cond_init(&m_cond_thread_task_complete, NULL);
+    res |= pthread_cond_init(&m_cond_task_done, NULL);
 
     if(!res)
     {
-        setNumOfThreads(defaultNumberOfThreads());
+        std::vector<int> cpus;
+        if(m_pool == 0)
+            defaultAffinity(cpus);
 
-        m_task_position = 0;
+        if(!cpus.empty())
+            setAffinity(cpus);
+        else
+            setNumOfThreads(defaultNumberOfThreads());
     }
     else
     {
         m_num_threads = 1;
         m_pool_state = eTMFailedToInit;
-        m_task_position = 0;
 
         //print error;
     }
@@ -375,166 +564,480 @@ ThreadManager::ThreadManager(): m_num_threads(0), m_task_complete(false), m_num_
 
 ThreadManager::~ThreadManager()
 {
-    stop();
+    stopPool();
 
-    pthread_mutex_destroy(&m_manager_task_mutex);
+    pthread_mutex_destroy(&m_manager_mutex);
 
-    pthread_cond_destroy(&m_cond_thread_task_complete);
+    pthread_cond_destroy(&m_cond_new_job);
 
-    pthread_mutex_destroy(&m_manager_access_mutex);
+    pthread_cond_destroy(&m_cond_task_done);
 }
 
 void ThreadManager::run(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes)
 {
-    bool is_work_thread = m_is_work_thread.get()->value;
+    if( (getNumOfThreads() > 1) &&
+        (range.end - range.start > 1) && (nstripes <= 0 || nstripes >= 1.5) &&
+        initPool() )
+    {
+        int num_threads = (int)getNumOfThreads();
+        double max_stripes = (double)m_max_stripes_per_thread*num_threads;
+
+        if(nstripes < 1) nstripes = max_stripes;
+
+        nstripes = std::min(nstripes, max_stripes);
+
+        pthread_mutex_lock(&m_manager_mutex);
+
+        Ptr<ParallelJob> job = makePtr<ParallelJob>(range, body, cvCeil(nstripes), num_threads, m_cpu_nodes);
+        bool pinned = !m_cpus.empty();
 
-    if( (getNumOfThreads() > 1) && !is_work_thread &&
-        (range.end - range.start > 1) && (nstripes <= 0 || nstripes >= 1.5) )
+        m_jobs.push_back(job);
+
+        pthread_cond_broadcast(&m_cond_new_job);
+
+        pthread_mutex_unlock(&m_manager_mutex);
+
+        // in a pinned pool the thread which is not a pool one takes the first chunk
+        int slot = m_is_work_thread.get()->slot;
+        if(slot < 0 && pinned)
+            slot = 0;
+
+        job->execute(slot);
+
+        removeJob(job);
+
+        job->wait_complete();
+    }
+    else
     {
-        int res = pthread_mutex_trylock(&m_manager_access_mutex);
+        body(range);
+    }
+}
 
-        if(!res)
-        {
-            if(initPool())
-            {
-                if(nstripes < 1) nstripes = 4*m_threads.size();
+void ThreadManager::removeJob(const Ptr<ParallelJob>& job)
+{
+    pthread_mutex_lock(&m_manager_mutex);
+
+    std::vector<Ptr<ParallelJob> >::iterator it = std::find(m_jobs.begin(), m_jobs.end(), job);
+    if(it != m_jobs.end())
+        m_jobs.erase(it);
 
-                double max_stripes = 4*m_threads.size();
+    pthread_mutex_unlock(&m_manager_mutex);
+}
+
+void* ThreadManager::thread_loop_wrapper(void* arg)
+{
+    worker_arg_t* worker = (worker_arg_t*)arg;
+    worker->manager->thread_body(worker->index);
+    return 0;
+}
 
-                nstripes = std::min(nstripes, max_stripes);
+void ThreadManager::thread_body(int index)
+{
+    work_thread_t* tls = m_is_work_thread.get();
+    tls->value = true;
 
-                pthread_mutex_lock(&m_manager_task_mutex);
+    // the nested loops and the tasks started by this thread go to the same pool
+    setPoolIndex(m_pool);
 
-                m_num_of_completed_tasks = 0;
+    pthread_mutex_lock(&m_manager_mutex);
+    int cpu = m_cpus.empty() ? -1 : m_cpus[(index + 1) % m_cpus.size()];
+    pthread_mutex_unlock(&m_manager_mutex);
 
-                m_task_position = 0;
+    if(cpu >= 0)
+    {
+        tls->slot = index + 1;
+#if defined __linux__ && !defined ANDROID
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#endif
+    }
 
-                m_task_complete = false;
+    for(;;)
+    {
+        Ptr<ParallelJob> job;
+        std::vector<Ptr<AsyncTask::Impl> > tasks;
 
-                m_work_load.set(range, body, cvCeil(nstripes));
+        pthread_mutex_lock(&m_manager_mutex);
 
-                for(size_t i = 0; i < m_threads.size(); ++i)
+        //to handle spurious wakeups
+        while(!m_stop)
+        {
+            // prefer the most recent job: it is usually a nested one the others are waiting for
+            for(size_t i = m_jobs.size(); i > 0; --i)
+            {
+                if(m_jobs[i - 1]->has_pending_work())
                 {
-                    m_threads[i].run();
+                    job = m_jobs[i - 1];
+                    break;
                 }
-
-                wait_complete();
             }
-            else
+
+            if(!job.empty())
+                break;
+
+            if(!m_tasks.empty())
             {
-                //print error
-                body(range);
+                tasks.push_back(m_tasks.front());
+                m_tasks.pop_front();
+                tasks.back()->state = eTaskRunning;
+                break;
             }
+
+            pthread_cond_wait(&m_cond_new_job, &m_manager_mutex);
         }
-        else
+
+        bool stop = m_stop;
+
+        pthread_mutex_unlock(&m_manager_mutex);
+
+        if(stop)
+            break;
+
+        if(!tasks.empty())
         {
-            body(range);
+            runTasks(tasks);
+            continue;
         }
+
+        job->execute(tls->slot);
+
+        // the stripes left are being moved between two threads, let them finish it
+        if(job->has_pending_work())
+            sched_yield();
     }
-    else
+}
+
+bool ThreadManager::initPool()
+{
+    if(m_pool_state == eTMInited)
+        return true;
+
+    pthread_mutex_lock(&m_manager_mutex);
+
+    if(m_pool_state == eTMNotInited && m_num_threads > 1)
     {
-        body(range);
+        bool res = true;
+
+        // the thread which calls parallel_for_ is a worker too
+        m_threads.resize(m_num_threads - 1);
+        m_worker_args.resize(m_threads.size());
+
+        for(size_t i = 0; i < m_threads.size(); ++i)
+        {
+            m_worker_args[i].manager = this;
+            m_worker_args[i].index = (int)i;
+            if(pthread_create(&m_threads[i], NULL, thread_loop_wrapper, (void*)&m_worker_args[i]) != 0)
+            {
+                m_threads.resize(i);
+                res = false;
+                break;
+            }
+        }
+
+        m_pool_state = res ? eTMInited : eTMFailedToInit;
     }
+
+    bool res = m_pool_state == eTMInited;
+
+    pthread_mutex_unlock(&m_manager_mutex);
+
+    return res;
 }
 
-void ThreadManager::wait_complete()
+void ThreadManager::stopPool()
 {
-    //to handle spurious wakeups
-    while(!m_task_complete)
-        pthread_cond_wait(&m_cond_thread_task_complete, &m_manager_task_mutex);
+    pthread_mutex_lock(&m_manager_mutex);
 
-    pthread_mutex_unlock(&m_manager_task_mutex);
+    m_stop = true;
 
-    pthread_mutex_unlock(&m_manager_access_mutex);
+    pthread_cond_broadcast(&m_cond_new_job);
+
+    pthread_mutex_unlock(&m_manager_mutex);
+
+    // the jobs in progress are finished by the threads which have started them
+    for(size_t i = 0; i < m_threads.size(); ++i)
+    {
+        pthread_join(m_threads[i], NULL);
+    }
+
+    pthread_mutex_lock(&m_manager_mutex);
+
+    m_threads.clear();
+
+    m_stop = false;
+
+    pthread_mutex_unlock(&m_manager_mutex);
 }
 
-void ThreadManager::notify_complete()
+size_t ThreadManager::getNumOfThreads()
 {
+    return m_num_threads;
+}
 
-    unsigned int comp = CV_XADD(&m_num_of_completed_tasks, 1);
+void ThreadManager::setNumOfThreads(size_t n)
+{
+    // the pool can't be restarted from one of its own threads
+    if(m_is_work_thread.get()->value)
+        return;
 
-    if(comp == (m_num_threads - 1))
+    if(n == 0)
     {
-        pthread_mutex_lock(&m_manager_task_mutex);
+        n = defaultNumberOfThreads();
+    }
 
-        m_task_complete = true;
+    if(n != m_num_threads && m_pool_state != eTMFailedToInit)
+    {
+        if(m_pool_state == eTMInited)
+        {
+            stopPool();
+        }
 
-        pthread_cond_signal(&m_cond_thread_task_complete);
+        m_num_threads = n;
 
-        pthread_mutex_unlock(&m_manager_task_mutex);
+        if(m_num_threads == 1)
+        {
+            m_pool_state = eTMSingleThreaded;
+        }
+        else
+        {
+            m_pool_state = eTMNotInited;
+        }
+    }
+
+    // the tasks queued for the previous pool are taken by the new one or executed here
+    pthread_mutex_lock(&m_manager_mutex);
+    bool have_tasks = !m_tasks.empty();
+    pthread_mutex_unlock(&m_manager_mutex);
+
+    if(have_tasks && !(m_num_threads > 1 && initPool()))
+    {
+        for(;;)
+        {
+            std::vector<Ptr<AsyncTask::Impl> > tasks;
+
+            pthread_mutex_lock(&m_manager_mutex);
+            if(!m_tasks.empty())
+            {
+                tasks.push_back(m_tasks.front());
+                m_tasks.pop_front();
+                tasks.back()->state = eTaskRunning;
+            }
+            pthread_mutex_unlock(&m_manager_mutex);
+
+            if(tasks.empty())
+                break;
+
+            runTasks(tasks);
+        }
     }
 }
 
-bool ThreadManager::initPool()
+AsyncTask ThreadManager::submit(const Ptr<ParallelTask>& task, const std::vector<AsyncTask>& dependencies, bool use_pool)
 {
-    if(m_pool_state != eTMNotInited || m_num_threads == 1)
-        return true;
+    bool pooled = use_pool && getNumOfThreads() > 1 && initPool();
 
-    m_threads.resize(m_num_threads);
+    // the dependencies are tracked under the lock of the pool
+    for(size_t i = 0; i < dependencies.size(); ++i)
+        CV_Assert(!dependencies[i].valid() || dependencies[i].p->manager == this);
 
-    bool res = true;
+    AsyncTask result;
+    result.p = makePtr<AsyncTask::Impl>(task, this, pooled);
 
-    for(size_t i = 0; i < m_threads.size(); ++i)
+    const Ptr<AsyncTask::Impl>& t = result.p;
+    std::vector<Ptr<AsyncTask::Impl> > run_now;
+
+    pthread_mutex_lock(&m_manager_mutex);
+
+    for(size_t i = 0; i < dependencies.size(); ++i)
     {
-        res |= m_threads[i].init(i, this);
+        if(!dependencies[i].valid())
+            continue;
+
+        AsyncTask::Impl& dep = *dependencies[i].p;
+        if(dep.state != eTaskDone)
+        {
+            dep.dependents.push_back(t);
+            t->pending_deps++;
+        }
+        else if(dep.failed && !t->failed)
+        {
+            t->failed = true;
+            t->exception = dep.exception;
+        }
     }
 
-    if(res)
+    if(t->pending_deps == 0)
+        scheduleTask(t, run_now);
+
+    pthread_mutex_unlock(&m_manager_mutex);
+
+    runTasks(run_now);
+
+    return result;
+}
+
+void ThreadManager::scheduleTask(const Ptr<AsyncTask::Impl>& task, std::vector<Ptr<AsyncTask::Impl> >& run_now)
+{
+    if(task->pooled && !task->failed && m_pool_state == eTMInited)
     {
-        m_pool_state = eTMInited;
+        task->state = eTaskQueued;
+        m_tasks.push_back(task);
+
+        pthread_cond_signal(&m_cond_new_job);
+
+        // the threads waiting for a task help to execute the queued ones
+        pthread_cond_broadcast(&m_cond_task_done);
     }
     else
     {
-        //TODO: join threads?
-        m_pool_state = eTMFailedToInit;
+        // a task whose dependency has failed goes here too, to be completed without running
+        task->state = eTaskRunning;
+        run_now.push_back(task);
     }
-
-    return res;
 }
 
-size_t ThreadManager::getNumOfThreads()
+void ThreadManager::completeTask(const Ptr<AsyncTask::Impl>& task, std::vector<Ptr<AsyncTask::Impl> >& run_now)
 {
-    return m_num_threads;
+    task->state = eTaskDone;
+
+    std::vector<Ptr<AsyncTask::Impl> > dependents;
+    std::swap(dependents, task->dependents);
+
+    for(size_t i = 0; i < dependents.size(); ++i)
+    {
+        const Ptr<AsyncTask::Impl>& dep = dependents[i];
+
+        if(task->failed && !dep->failed)
+        {
+            dep->failed = true;
+            dep->exception = task->exception;
+        }
+
+        if(--dep->pending_deps == 0)
+            scheduleTask(dep, run_now);
+    }
+
+    pthread_cond_broadcast(&m_cond_task_done);
 }
 
-void ThreadManager::setNumOfThreads(size_t n)
+void ThreadManager::runTasks(std::vector<Ptr<AsyncTask::Impl> >& tasks)
 {
-    int res = pthread_mutex_lock(&m_manager_access_mutex);
-
-    if(!res)
+    while(!tasks.empty())
     {
-        if(n == 0)
+        Ptr<AsyncTask::Impl> task = tasks.back();
+        tasks.pop_back();
+
+        // failed is only set before the task is scheduled, so it can be read without the lock
+        if(task->failed)
         {
-            n = defaultNumberOfThreads();
+            pthread_mutex_lock(&m_manager_mutex);
+            completeTask(task, tasks);
+            pthread_mutex_unlock(&m_manager_mutex);
+            continue;
         }
 
-        if(n != m_num_threads && m_pool_state != eTMFailedToInit)
+        bool failed = false;
+        cv::Exception exception;
+
+        try
         {
-            if(m_pool_state == eTMInited)
-            {
-                stop();
-                m_threads.clear();
-            }
+            (*task->task)();
+        }
+        catch(const cv::Exception& e)
+        {
+            failed = true;
+            exception = e;
+        }
+        catch(const std::exception& e)
+        {
+            failed = true;
+            exception = cv::Exception(cv::Error::StsError, e.what(), CV_Func, __FILE__, __LINE__);
+        }
+        catch(...)
+        {
+            failed = true;
+            exception = cv::Exception(cv::Error::StsError, "Unknown exception in parallel_async task",
+                                      CV_Func, __FILE__, __LINE__);
+        }
 
-            m_num_threads = n;
+        // the task object may hold big data, don't keep it while the handles are alive
+        task->task.release();
 
-            if(m_num_threads == 1)
-            {
-                m_pool_state = eTMSingleThreaded;
-            }
-            else
+        pthread_mutex_lock(&m_manager_mutex);
+
+        if(failed)
+        {
+            task->failed = true;
+            task->exception = exception;
+        }
+
+        completeTask(task, tasks);
+
+        pthread_mutex_unlock(&m_manager_mutex);
+    }
+}
+
+bool ThreadManager::isReady(const AsyncTask::Impl& task)
+{
+    pthread_mutex_lock(&m_manager_mutex);
+    bool res = task.state == eTaskDone;
+    pthread_mutex_unlock(&m_manager_mutex);
+
+    return res;
+}
+
+void ThreadManager::wait(AsyncTask::Impl& task)
+{
+    pthread_mutex_lock(&m_manager_mutex);
+
+    while(task.state != eTaskDone)
+    {
+        if(!m_tasks.empty())
+        {
+            // help the pool instead of blocking, starting from the awaited task if it is queued:
+            // this also keeps a task waiting for another one from deadlocking the pool
+            std::deque<Ptr<AsyncTask::Impl> >::iterator it = m_tasks.begin();
+            for(; it != m_tasks.end(); ++it)
             {
-                m_pool_state = eTMNotInited;
+                if(it->get() == &task)
+                    break;
             }
+            if(it == m_tasks.end())
+                it = m_tasks.begin();
+
+            std::vector<Ptr<AsyncTask::Impl> > tasks(1, *it);
+            m_tasks.erase(it);
+            tasks.back()->state = eTaskRunning;
+
+            pthread_mutex_unlock(&m_manager_mutex);
+
+            runTasks(tasks);
+
+            pthread_mutex_lock(&m_manager_mutex);
+            continue;
         }
 
-        pthread_mutex_unlock(&m_manager_access_mutex);
+        pthread_cond_wait(&m_cond_task_done, &m_manager_mutex);
     }
+
+    pthread_mutex_unlock(&m_manager_mutex);
+
+    if(task.failed)
+        throw task.exception;
 }
 
 size_t ThreadManager::defaultNumberOfThreads()
 {
-    unsigned int result = m_default_number_of_threads;
+#ifdef ANDROID
+    // many modern phones/tables have 4-core CPUs. Let's use no more
+    // than 2 threads by default not to overheat the devices
+    unsigned int result = 2;
+#else
+    unsigned int result = (unsigned int)std::max(cv::getNumberOfCPUs(), 1);
+#endif
 
     char * env = getenv(m_env_name);
 
@@ -549,17 +1052,169 @@ size_t ThreadManager::defaultNumberOfThreads()
     return result;
 }
 
+void ThreadManager::defaultAffinity(std::vector<int>& cpus)
+{
+    cpus.clear();
+
+    const char* env = getenv(m_affinity_env_name);
+    if(env == NULL || *env == '\0')
+        return;
+
+    std::vector<int> list;
+    bool nodes = strncmp(env, "node:", 5) == 0;
+    if(!parallel_parse_cpu_list(nodes ? env + 5 : env, list))
+        return;
+
+    if(!nodes)
+    {
+        cpus = list;
+        return;
+    }
+
+    for(size_t i = 0; i < list.size(); ++i)
+    {
+        if(list[i] >= getNumberOfNumaNodes())
+            continue;
+        std::vector<int> node_cpus;
+        getNumaNodeCPUs(list[i], node_cpus);
+        cpus.insert(cpus.end(), node_cpus.begin(), node_cpus.end());
+    }
+}
+
+void ThreadManager::setAffinity(const std::vector<int>& cpus)
+{
+    // the pool can't be restarted from one of its own threads
+    if(m_is_work_thread.get()->value || m_pool_state == eTMFailedToInit)
+        return;
+
+    // order the CPUs by the node, keeping the order inside the node
+    int nnodes = getNumberOfNumaNodes();
+    std::vector<int> cpu_node;
+    for(int node = 0; node < nnodes; ++node)
+    {
+        std::vector<int> node_cpus;
+        getNumaNodeCPUs(node, node_cpus);
+        for(size_t i = 0; i < node_cpus.size(); ++i)
+        {
+            if(node_cpus[i] >= (int)cpu_node.size())
+                cpu_node.resize(node_cpus[i] + 1, 0);
+            cpu_node[node_cpus[i]] = node;
+        }
+    }
+
+    std::vector<int> sorted, nodes;
+    for(int node = 0; node < nnodes; ++node)
+    {
+        for(size_t i = 0; i < cpus.size(); ++i)
+        {
+            int cpu_node_i = cpus[i] < (int)cpu_node.size() ? cpu_node[cpus[i]] : 0;
+            if(cpu_node_i == node && std::find(sorted.begin(), sorted.end(), cpus[i]) == sorted.end())
+            {
+                sorted.push_back(cpus[i]);
+                nodes.push_back(node);
+            }
+        }
+    }
+
+    // the running threads are pinned to the previous CPUs
+    if(m_pool_state == eTMInited)
+        stopPool();
+
+    pthread_mutex_lock(&m_manager_mutex);
+    m_cpus.swap(sorted);
+    m_cpu_nodes.swap(nodes);
+    CV_XADD(&m_num_cpus, (int)m_cpus.size() - m_num_cpus);
+    pthread_mutex_unlock(&m_manager_mutex);
+
+    m_pool_state = eTMNotInited;
+    m_num_threads = 0;
+
+    setNumOfThreads((size_t)getAffinitySize());
+}
+
+void ThreadManager::getAffinity(std::vector<int>& cpus)
+{
+    pthread_mutex_lock(&m_manager_mutex);
+    cpus = m_cpus;
+    pthread_mutex_unlock(&m_manager_mutex);
+}
+
+struct PoolIndex
+{
+    PoolIndex(): value(0) { }
+    int value;
+};
+
+static TLSData<PoolIndex>& getPoolIndexTLS()
+{
+    CV_SINGLETON_LAZY_INIT_REF(TLSData<PoolIndex>, new TLSData<PoolIndex>())
+}
+
+typedef std::map<int, ThreadManager*> ThreadPoolMap;
+
+static ThreadPoolMap& getPools()
+{
+    CV_SINGLETON_LAZY_INIT_REF(ThreadPoolMap, new ThreadPoolMap())
+}
+
+ThreadManager& ThreadManager::instance()
+{
+    int pool = getPoolIndex();
+    if(pool == 0)
+    {
+        CV_SINGLETON_LAZY_INIT_REF(ThreadManager, new ThreadManager(0))
+    }
+
+    ThreadPoolMap& pools = getPools();
+
+    cv::AutoLock lock(cv::getInitializationMutex());
+    ThreadPoolMap::iterator it = pools.find(pool);
+    if(it != pools.end())
+        return *it->second;
+
+    // the pools live until the process exits, like the default one
+    ThreadManager* manager = new ThreadManager(pool);
+    pools[pool] = manager;
+    return *manager;
+}
+
+int ThreadManager::getPoolIndex()
+{
+    return getPoolIndexTLS().get()->value;
+}
+
+void ThreadManager::setPoolIndex(int pool)
+{
+    getPoolIndexTLS().get()->value = pool;
+}
+
 void parallel_for_pthreads(const cv::Range& range, const cv::ParallelLoopBody& body, double nstripes);
 size_t parallel_pthreads_get_threads_num();
+int parallel_pthreads_get_requested_threads();
 void parallel_pthreads_set_threads_num(int num);
+AsyncTask parallel_pthreads_async(const Ptr<ParallelTask>& task, const std::vector<AsyncTask>& dependencies, bool use_pool);
+bool parallel_pthreads_task_ready(const AsyncTask::Impl& task);
+void parallel_pthreads_task_wait(AsyncTask::Impl& task);
+void parallel_pthreads_set_affinity(const std::vector<int>& cpus);
+void parallel_pthreads_get_affinity(std::vector<int>& cpus);
+int parallel_pthreads_get_affinity_size();
+void parallel_pthreads_set_pool(int pool);
+int parallel_pthreads_get_pool();
 
 size_t parallel_pthreads_get_threads_num()
 {
     return ThreadManager::instance().getNumOfThreads();
 }
 
+int parallel_pthreads_get_requested_threads()
+{
+    return ThreadManager::instance().getRequestedThreads();
+}
+
 void parallel_pthreads_set_threads_num(int num)
 {
+    ThreadManager::instance().setRequestedThreads(num);
+
     if(num < 0)
     {
         ThreadManager::instance().setNumOfThreads(0);
@@ -575,6 +1230,46 @@ void parallel_for_pthreads(const cv::Range& range, const cv::ParallelLoopBody& b
     ThreadManager::instance().run(range, body, nstripes);
 }
 
+AsyncTask parallel_pthreads_async(const Ptr<ParallelTask>& task, const std::vector<AsyncTask>& dependencies, bool use_pool)
+{
+    return ThreadManager::instance().submit(task, dependencies, use_pool);
+}
+
+bool parallel_pthreads_task_ready(const AsyncTask::Impl& task)
+{
+    return task.manager->isReady(task);
+}
+
+void parallel_pthreads_task_wait(AsyncTask::Impl& task)
+{
+    task.manager->wait(task);
+}
+
+void parallel_pthreads_set_affinity(const std::vector<int>& cpus)
+{
+    ThreadManager::instance().setAffinity(cpus);
+}
+
+void parallel_pthreads_get_affinity(std::vector<int>& cpus)
+{
+    ThreadManager::instance().getAffinity(cpus);
+}
+
+int parallel_pthreads_get_affinity_size()
+{
+    return ThreadManager::instance().getAffinitySize();
+}
+
+void parallel_pthreads_set_pool(int pool)
+{
+    ThreadManager::setPoolIndex(pool);
+}
+
+int parallel_pthreads_get_pool()
+{
+    return ThreadManager::getPoolIndex();
+}
+
 }
 
 #endif
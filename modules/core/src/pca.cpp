@@ -50,6 +50,42 @@
 namespace cv
 {
 
+// the randomized truncated SVD is used when the number of the components is much smaller than the dimension
+enum { PCA_RANDOMIZED_RATIO = 8, PCA_RANDOMIZED_MIN_COUNT = 512 };
+
+// The truncated SVD of the centered data gives the leading eigenvectors of the covariance matrix
+// without computing it: for the samples as rows A = U*W*V^T, A^T*A = V*W^2*V^T.
+static void randomizedPCA(PCA& pca, const Mat& data, const Mat& _mean, int flags, int out_count)
+{
+    bool asCols = (flags & CV_PCA_DATA_AS_COL) != 0;
+    int ctype = std::max(CV_32F, data.depth());
+    int nsamples = asCols ? data.cols : data.rows;
+
+    if( !_mean.empty() )
+    {
+        CV_Assert( _mean.size() == (asCols ? Size(1, data.rows) : Size(data.cols, 1)) );
+        _mean.convertTo(pca.mean, ctype);
+    }
+    else
+        reduce(data, pca.mean, asCols ? 1 : 0, REDUCE_AVG, ctype);
+
+    Mat centered;
+    data.convertTo(centered, ctype);
+    centered -= repeat(pca.mean, data.rows/pca.mean.rows, data.cols/pca.mean.cols);
+
+    Mat w;
+    if( asCols )
+    {
+        Mat u;
+        SVD::computeTruncated(centered, w, u, noArray(), out_count);
+        transpose(u, pca.eigenvectors);
+    }
+    else
+        SVD::computeTruncated(centered, w, noArray(), pca.eigenvectors, out_count);
+
+    multiply(w, w, pca.eigenvalues, 1./nsamples);
+}
+
 PCA::PCA() {}
 
 PCA::PCA(InputArray data, InputArray _mean, int flags, int maxComponents)
@@ -89,6 +125,12 @@ PCA& PCA::operator()(InputArray _data, InputArray __mean, int flags, int maxComp
     if( maxComponents > 0 )
         out_count = std::min(count, maxComponents);
 
+    if( out_count*PCA_RANDOMIZED_RATIO <= count && count >= PCA_RANDOMIZED_MIN_COUNT )
+    {
+        randomizedPCA(*this, data, _mean, flags, out_count);
+        return *this;
+    }
+
     // "scrambled" way to compute PCA (when cols(A)>rows(A)):
     // B = A'A; B*x=b*x; C = AA'; C*y=c*y -> AA'*y=c*y -> A'A*(A'*y)=c*(A'*y) -> c = b, x=A'*y
     if( len <= in_count )
@@ -107,7 +149,10 @@ PCA& PCA::operator()(InputArray _data, InputArray __mean, int flags, int maxComp
     }
 
     calcCovarMatrix( data, covar, mean, covar_flags, ctype );
-    eigen( covar, eigenvalues, eigenvectors );
+    if( out_count < count )
+        eigen( covar, eigenvalues, eigenvectors, out_count );
+    else
+        eigen( covar, eigenvalues, eigenvectors );
 
     if( !(covar_flags & CV_COVAR_NORMAL) )
     {
@@ -125,7 +170,7 @@ PCA& PCA::operator()(InputArray _data, InputArray __mean, int flags, int maxComp
             tmp_data = tmp_mean;
         }
 
-        Mat evects1(count, len, ctype);
+        Mat evects1(eigenvectors.rows, len, ctype);
         gemm( eigenvectors, tmp_data, 1, Mat(), 0, evects1,
             (flags & CV_PCA_DATA_AS_COL) ? CV_GEMM_B_T : 0);
         eigenvectors = evects1;
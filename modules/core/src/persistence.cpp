@@ -47,6 +47,7 @@
 #include <sstream>
 #include <string>
 #include <iterator>
+#include <map>
 
 #define USE_ZLIB 1
 
@@ -243,6 +244,60 @@ typedef void (*CvWriteString)( struct CvFileStorage* fs, const char* key,
 typedef void (*CvWriteComment)( struct CvFileStorage* fs, const char* comment, int eol_comment );
 typedef void (*CvStartNextStream)( struct CvFileStorage* fs );
 
+// index of the nodes of a file opened with CV_STORAGE_LAZY: the top-level nodes and the elements
+// of the top-level plain maps; each entry is parsed from the mapped file on the first access
+struct CvFileStorageLazyIndex
+{
+    struct Entry
+    {
+        std::string key;
+        size_t begin, end;
+        int lineno;
+        int children; // index of the map with the elements of the node or -1
+        bool parsed;
+        bool failed; // the parse has thrown, the error is re-thrown on every access
+        cv::Exception error;
+    };
+
+    // the indexed elements of a map node
+    struct Map
+    {
+        Map() : node(0), unparsed(0) {}
+
+        CvFileNode* node; // NULL until the map node is created
+        std::vector<Entry> entries;
+        std::map<std::string, size_t> keys;
+        size_t unparsed;
+    };
+
+    CvFileStorageLazyIndex() : u(0), data(0), size(0), unparsed(0), share_mats(false) {}
+
+    cv::UMatData* u;
+    uchar* data;
+    size_t size;
+    std::vector<Map> maps; // maps[0] is the root
+    std::map<const CvFileNode*, size_t> nodes; // the created map nodes that are indexed
+    size_t unparsed; // the total number of unparsed entries
+    bool share_mats; // the matrices read from a binary storage refer to the data
+};
+
+// the state of the binary storage writer, the top-level nodes are indexed as they are written
+struct CvFSBinaryWriter
+{
+    struct Entry
+    {
+        std::string key;
+        uint64 begin, end;
+    };
+
+    CvFSBinaryWriter() : pos(0), node_begin(0) {}
+
+    uint64 pos;
+    uint64 node_begin;
+    std::string node_key;
+    std::vector<Entry> index;
+};
+
 typedef struct CvFileStorage
 {
     int flags;
@@ -293,6 +348,9 @@ typedef struct CvFileStorage
     char* delayed_type_name;
 
     bool is_opened;
+
+    CvFileStorageLazyIndex* lazy;
+    CvFSBinaryWriter* binary_writer;
 }
 CvFileStorage;
 
@@ -392,6 +450,56 @@ namespace base64
     void cvWriteRawDataBase64(::CvFileStorage* fs, const void* _data, int len, const char* dt);
 }
 
+typedef struct CvFileNodeBlobSegment
+{
+    const uchar* data;
+    int count;
+    struct CvFileNodeBlobSegment* next;
+}
+CvFileNodeBlobSegment;
+
+// a sequence of numbers read from a binary storage; it keeps the raw data written by
+// cvWriteRawData and creates the elements (CvFileNode's) only when they are accessed
+typedef struct CvFileNodeBlob
+{
+    CV_SEQUENCE_FIELDS()
+    int signature;
+    int nscalars;
+    CvString dt;
+    CvFileNodeBlobSegment* head;
+    CvFileNodeBlobSegment* tail;
+    volatile int expanded;
+}
+CvFileNodeBlob;
+
+#define CV_FILE_NODE_BLOB_SIGNATURE 0x424f4c42
+
+// returns the raw data of the sequence node if its elements have not been created yet
+static inline CvFileNodeBlob* icvGetBlob( const CvFileNode* node )
+{
+    if( !node || !CV_NODE_IS_SEQ(node->tag) || !node->data.seq ||
+        node->data.seq->header_size != (int)sizeof(CvFileNodeBlob) )
+        return 0;
+    CvFileNodeBlob* blob = (CvFileNodeBlob*)node->data.seq;
+    return blob->signature == CV_FILE_NODE_BLOB_SIGNATURE && !blob->expanded ? blob : 0;
+}
+
+// creates the elements of the sequence node read from a binary storage
+static void icvExpandBlob( const CvFileNode* node )
+{
+    CvFileNodeBlob* blob = icvGetBlob( node );
+    if( !blob )
+        return;
+
+    cv::AutoLock lock( cv::getInitializationMutex() );
+    if( blob->expanded )
+        return;
+    cvSetSeqBlockSize( (CvSeq*)blob, MAX(MIN(blob->nscalars, 1 << 14), 8) );
+    for( CvFileNodeBlobSegment* seg = blob->head; seg != 0; seg = seg->next )
+        base64::make_seq( (void*)seg->data, seg->count, blob->dt.ptr, *(CvSeq*)blob );
+    blob->expanded = 1;
+}
+
 
 static void icvPuts( CvFileStorage* fs, const char* str )
 {
@@ -480,6 +588,7 @@ static void icvRewind( CvFileStorage* fs )
 #define CV_XML_INDENT  2
 #define CV_YML_INDENT_FLOW  1
 #define CV_FS_MAX_LEN 4096
+#define CV_FS_MAX_FMT_PAIRS  128
 
 #define CV_FILE_STORAGE ('Y' + ('A' << 8) + ('M' << 16) + ('L' << 24))
 #define CV_IS_FILE_STORAGE(fs) ((fs) != 0 && (fs)->flags == CV_FILE_STORAGE)
@@ -659,6 +768,8 @@ icvFSFlush( CvFileStorage* fs )
 }
 
 
+static void icvBinaryWriteIndex( CvFileStorage* fs );
+
 static void
 icvClose( CvFileStorage* fs, cv::String* out )
 {
@@ -677,11 +788,16 @@ icvClose( CvFileStorage* fs, cv::String* out )
                 while( fs->write_stack->total > 0 )
                     cvEndWriteStruct(fs);
             }
-            icvFSFlush(fs);
-            if( fs->fmt == CV_STORAGE_FORMAT_XML )
-                icvPuts( fs, "</opencv_storage>\n" );
-            else if ( fs->fmt == CV_STORAGE_FORMAT_JSON )
-                icvPuts( fs, "}\n" );
+            if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+                icvBinaryWriteIndex( fs );
+            else
+            {
+                icvFSFlush(fs);
+                if( fs->fmt == CV_STORAGE_FORMAT_XML )
+                    icvPuts( fs, "</opencv_storage>\n" );
+                else if ( fs->fmt == CV_STORAGE_FORMAT_JSON )
+                    icvPuts( fs, "}\n" );
+            }
         }
 
         icvCloseFile(fs);
@@ -716,6 +832,14 @@ cvReleaseFileStorage( CvFileStorage** p_fs )
         delete fs->base64_writer;
         delete[] fs->delayed_struct_key;
         delete[] fs->delayed_type_name;
+        if( fs->lazy )
+        {
+            cv::UMatData* u = fs->lazy->u;
+            if( CV_XADD(&u->refcount, -1) == 1 )
+                u->currAllocator->unmap(u);
+            delete fs->lazy;
+        }
+        delete fs->binary_writer;
 
         memset( fs, 0, sizeof(*fs) );
         cvFree( &fs );
@@ -774,6 +898,14 @@ cvGetHashedKey( CvFileStorage* fs, const char* str, int len, int create_missing
 }
 
 
+static void icvLazyLoad( CvFileStorage* fs, const CvFileNode* node, const char* key, int len );
+
+// true if some nodes of a lazily read storage are not parsed yet
+static inline bool icvIsLazy( const CvFileStorage* fs )
+{
+    return fs->lazy && fs->lazy->unparsed > 0;
+}
+
 CV_IMPL CvFileNode*
 cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
                const CvStringHashNode* key,
@@ -790,6 +922,9 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
     if( !key )
         CV_Error( CV_StsNullPtr, "Null key element" );
 
+    if( !create_missing && icvIsLazy( fs ) )
+        icvLazyLoad( fs, _map_node, key->str.ptr, key->str.len );
+
     if( _map_node )
     {
         if( !fs->roots )
@@ -870,6 +1005,9 @@ cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const
     hashval &= INT_MAX;
     len = i;
 
+    if( icvIsLazy( fs ) )
+        icvLazyLoad( (CvFileStorage*)fs, _map_node, str, len );
+
     if( !_map_node )
     {
         if( !fs->roots )
@@ -3644,160 +3782,1437 @@ static char* icvJSONParseValue( CvFileStorage* fs, char* ptr, CvFileNode* node )
         ptr++;
     }
 
-    return ptr;
+    return ptr;
+}
+
+static char* icvJSONParseSeq( CvFileStorage* fs, char* ptr, CvFileNode* node );
+static char* icvJSONParseMap( CvFileStorage* fs, char* ptr, CvFileNode* node );
+
+static char* icvJSONParseSeq( CvFileStorage* fs, char* ptr, CvFileNode* node )
+{
+    if ( *ptr != '[' )
+        CV_PARSE_ERROR( "'[' - left-brace of seq is missing" );
+    else
+        ptr++;
+
+    memset( node, 0, sizeof(*node) );
+    icvFSCreateCollection( fs, CV_NODE_SEQ, node );
+
+    for (;;)
+    {
+        ptr = icvJSONSkipSpaces( fs, ptr );
+        if ( ptr == 0 || fs->dummy_eof )
+            break;
+
+        if ( *ptr != ']' )
+        {
+            CvFileNode* child = (CvFileNode*)cvSeqPush( node->data.seq, 0 );
+
+            if ( *ptr == '[' )
+                ptr = icvJSONParseSeq( fs, ptr, child );
+            else if ( *ptr == '{' )
+                ptr = icvJSONParseMap( fs, ptr, child );
+            else
+                ptr = icvJSONParseValue( fs, ptr, child );
+        }
+
+        ptr = icvJSONSkipSpaces( fs, ptr );
+        if ( ptr == 0 || fs->dummy_eof )
+            break;
+
+        if ( *ptr == ',' )
+            ptr++;
+        else if ( *ptr == ']' )
+            break;
+        else
+            CV_PARSE_ERROR( "Unexpected character" );
+    }
+
+    if ( *ptr != ']' )
+        CV_PARSE_ERROR( "']' - right-brace of seq is missing" );
+    else
+        ptr++;
+
+    return ptr;
+}
+
+static char* icvJSONParseMap( CvFileStorage* fs, char* ptr, CvFileNode* node )
+{
+    if ( *ptr != '{' )
+        CV_PARSE_ERROR( "'{' - left-brace of map is missing" );
+    else
+        ptr++;
+
+    memset( node, 0, sizeof(*node) );
+    icvFSCreateCollection( fs, CV_NODE_MAP, node );
+
+    for ( ;; )
+    {
+        ptr = icvJSONSkipSpaces( fs, ptr );
+        if ( ptr == 0 || fs->dummy_eof )
+            break;
+
+        if ( *ptr == '"' )
+        {
+            CvFileNode* child = 0;
+            ptr = icvJSONParseKey( fs, ptr, node, &child );
+            ptr = icvJSONSkipSpaces( fs, ptr );
+            if ( ptr == 0 || fs->dummy_eof )
+                break;
+
+            if ( child == 0 )
+            {   /* type_id */
+                CvFileNode tmp;
+                ptr = icvJSONParseValue( fs, ptr, &tmp );
+                if ( CV_NODE_IS_STRING(tmp.tag) )
+                {
+                    node->info = cvFindType( tmp.data.str.ptr );
+                    if ( node->info )
+                        node->tag |= CV_NODE_USER;
+                    // delete tmp.data.str
+                }
+                else
+                {
+                    CV_PARSE_ERROR( "\"type_id\" should be of type string" );
+                }
+            }
+            else
+            {   /* normal */
+                if ( *ptr == '[' )
+                    ptr = icvJSONParseSeq( fs, ptr, child );
+                else if ( *ptr == '{' )
+                    ptr = icvJSONParseMap( fs, ptr, child );
+                else
+                    ptr = icvJSONParseValue( fs, ptr, child );
+            }
+        }
+
+        ptr = icvJSONSkipSpaces( fs, ptr );
+        if ( ptr == 0 || fs->dummy_eof )
+            break;
+
+        if ( *ptr == ',' )
+            ptr++;
+        else if ( *ptr == '}' )
+            break;
+        else
+            CV_PARSE_ERROR( "Unexpected character" );
+    }
+
+    if ( *ptr != '}' )
+        CV_PARSE_ERROR( "'}' - right-brace of map is missing" );
+    else
+        ptr++;
+
+    return ptr;
+}
+
+
+static void
+icvJSONParse( CvFileStorage* fs )
+{
+    char* ptr = fs->buffer_start;
+    ptr = icvJSONSkipSpaces( fs, ptr );
+    if ( ptr == 0 || fs->dummy_eof )
+        return;
+
+    if ( *ptr == '{' )
+    {
+        CvFileNode* root_node = (CvFileNode*)cvSeqPush( fs->roots, 0 );
+        ptr = icvJSONParseMap( fs, ptr, root_node );
+    }
+    else if ( *ptr == '[' )
+    {
+        CvFileNode* root_node = (CvFileNode*)cvSeqPush( fs->roots, 0 );
+        ptr = icvJSONParseSeq( fs, ptr, root_node );
+    }
+    else
+    {
+        CV_PARSE_ERROR( "left-brace of top level is missing" );
+    }
+
+    if ( fs->dummy_eof != 0 )
+        CV_PARSE_ERROR( "Unexpected End-Of-File" );
+}
+
+
+/****************************************************************************************\
+*                                     Binary Parser                                      *
+\****************************************************************************************/
+
+/* The binary format keeps the same node tree as the text formats, so that it could be read
+   without any parsing and the raw data (e.g. the matrix elements) could be used in place:
+
+   header:   "CVFSBIN\0", uint32 byte order mark, uint32 format version
+   node:     uint8 tag (CV_NODE_INT, CV_NODE_REAL, ... + CV_NODE_FLOW), then the key of the map
+             elements (uint32 length + characters) and the value:
+             int - int32, real - float64, string - uint32 length + characters,
+             seq/map - type name (uint32 length + characters), the elements, uint8 CV_FS_BINARY_END
+   raw data: uint8 CV_FS_BINARY_RAW, dt (uint32 length + characters), uint64 number of elements,
+             padding to CV_FS_BINARY_ALIGN bytes from the beginning of the file, the elements
+             packed as C structures
+   index:    uint32 number of the top-level nodes, for each of them the key and the uint64 offsets
+             of the beginning and the end of the node
+   trailer:  uint64 offset of the index, "CVFSIDX\0"
+
+   All the numbers are stored in the native byte order. */
+
+static const char icvBinarySignature[] = "CVFSBIN";
+static const char icvBinaryIndexSignature[] = "CVFSIDX";
+
+enum
+{
+    CV_FS_BINARY_VERSION = 1,
+    CV_FS_BINARY_BYTE_ORDER = 0x01020304,
+    CV_FS_BINARY_RAW = 7,
+    CV_FS_BINARY_END = 255,
+    CV_FS_BINARY_ALIGN = 64,
+    CV_FS_BINARY_HEADER_SIZE = sizeof(icvBinarySignature) + 2*sizeof(unsigned),
+    CV_FS_BINARY_TRAILER_SIZE = sizeof(uint64) + sizeof(icvBinaryIndexSignature)
+};
+
+static int icvDecodeFormat( const char* dt, int* fmt_pairs, int max_len );
+
+// bounds-checked reading of the mapped storage data
+struct CvFSBinaryReader
+{
+    CvFSBinaryReader( CvFileStorage* _fs, const uchar* _base, const uchar* _ptr, const uchar* _end )
+        : fs(_fs), base(_base), ptr(_ptr), end(_end) {}
+
+    const uchar* get( size_t n )
+    {
+        if( (size_t)(end - ptr) < n )
+            CV_PARSE_ERROR( "Unexpected end of the binary data" );
+        const uchar* p = ptr;
+        ptr += n;
+        return p;
+    }
+
+    template<typename _Tp> _Tp read()
+    {
+        _Tp value;
+        memcpy( &value, get(sizeof(value)), sizeof(value) );
+        return value;
+    }
+
+    const char* readString( int& len )
+    {
+        unsigned n = read<unsigned>();
+        if( n > (unsigned)INT_MAX )
+            CV_PARSE_ERROR( "Too long string" );
+        len = (int)n;
+        return (const char*)get(n);
+    }
+
+    int peek() const { return ptr < end ? *ptr : -1; }
+
+    CvFileStorage* fs;
+    const uchar* base;
+    const uchar* ptr;
+    const uchar* end;
+};
+
+
+static void
+icvBinaryParseValue( CvFileStorage* fs, CvFSBinaryReader& r, int tag, CvFileNode* node, bool keep_raw );
+
+static void
+icvBinaryParseRaw( CvFileStorage* fs, CvFSBinaryReader& r, CvFileNode* node )
+{
+    int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], fmt_pair_count, cn = 0, dt_len = 0;
+    char dt[CV_FS_MAX_FMT_PAIRS*4];
+
+    const char* dt_ptr = r.readString( dt_len );
+    if( dt_len == 0 || dt_len >= (int)sizeof(dt) )
+        CV_PARSE_ERROR( "Invalid format of the raw data" );
+    memcpy( dt, dt_ptr, dt_len );
+    dt[dt_len] = '\0';
+    uint64 count = r.read<uint64>();
+
+    fmt_pair_count = icvDecodeFormat( dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
+    for( int k = 0; k < fmt_pair_count; k++ )
+        cn += fmt_pairs[k*2];
+    // e.g. a format with the counts only
+    if( fmt_pair_count == 0 || cn == 0 )
+        CV_PARSE_ERROR( "Invalid format of the raw data" );
+    size_t step = (size_t)icvCalcStructSize( dt, 0 );
+
+    size_t pos = (size_t)(r.ptr - r.base);
+    r.get( cv::alignSize( pos, CV_FS_BINARY_ALIGN ) - pos );
+    if( count > (uint64)(INT_MAX/cn) || count*step > (uint64)(r.end - r.ptr) )
+        CV_PARSE_ERROR( "The raw data is too long" );
+    const uchar* data = r.get( (size_t)count*step );
+
+    CvFileNodeBlob* blob = icvGetBlob( node );
+    if( blob && (!blob->dt.ptr || strcmp( blob->dt.ptr, dt ) == 0) &&
+        (int)count <= INT_MAX/cn - blob->nscalars )
+    {
+        // the data stays where it is until the elements are accessed
+        CvFileNodeBlobSegment* seg = (CvFileNodeBlobSegment*)cvMemStorageAlloc( fs->memstorage, sizeof(*seg) );
+        seg->data = data;
+        seg->count = (int)count;
+        seg->next = 0;
+        if( blob->tail )
+            blob->tail->next = seg;
+        else
+            blob->head = seg;
+        blob->tail = seg;
+        if( !blob->dt.ptr )
+            blob->dt = cvMemStorageAllocString( fs->memstorage, dt, dt_len );
+        blob->nscalars += (int)count*cn;
+    }
+    else
+    {
+        icvExpandBlob( node );
+        base64::make_seq( (void*)data, (int)count, dt, *node->data.seq );
+    }
+}
+
+
+// is_mat - the node is a matrix; its elements are kept as they are until they are accessed
+static void
+icvBinaryParseCollection( CvFileStorage* fs, CvFSBinaryReader& r, CvFileNode* node, bool is_mat )
+{
+    for(;;)
+    {
+        int tag = r.read<uchar>();
+        if( tag == CV_FS_BINARY_END )
+            break;
+
+        if( CV_NODE_IS_MAP(node->tag) )
+        {
+            int len = 0;
+            const char* key = r.readString( len );
+            if( len == 0 )
+                CV_PARSE_ERROR( "Map element should have a name" );
+            CvFileNode* elem = cvGetFileNode( fs, node, cvGetHashedKey( fs, key, len, 1 ), 1 );
+            icvBinaryParseValue( fs, r, tag, elem, is_mat && len == 4 && memcmp( key, "data", 4 ) == 0 );
+            elem->tag |= CV_NODE_NAMED;
+        }
+        else if( tag == CV_FS_BINARY_RAW )
+            icvBinaryParseRaw( fs, r, node );
+        else
+        {
+            icvExpandBlob( node );
+            icvBinaryParseValue( fs, r, tag, (CvFileNode*)cvSeqPush( node->data.seq, 0 ), false );
+        }
+    }
+}
+
+
+static void
+icvBinaryParseValue( CvFileStorage* fs, CvFSBinaryReader& r, int tag, CvFileNode* node, bool keep_raw )
+{
+    memset( node, 0, sizeof(*node) );
+
+    switch( CV_NODE_TYPE(tag) )
+    {
+    case CV_NODE_INT:
+        node->tag = CV_NODE_INT;
+        node->data.i = r.read<int>();
+        break;
+    case CV_NODE_REAL:
+        node->tag = CV_NODE_REAL;
+        node->data.f = r.read<double>();
+        break;
+    case CV_NODE_STRING:
+        {
+        int len = 0;
+        const char* str = r.readString( len );
+        node->tag = CV_NODE_STRING;
+        node->data.str = cvMemStorageAllocString( fs->memstorage, str, len );
+        }
+        break;
+    case CV_NODE_SEQ:
+    case CV_NODE_MAP:
+        {
+        int len = 0;
+        const char* type_name = r.readString( len );
+        std::string type_str( type_name, len );
+        if( keep_raw && CV_NODE_IS_SEQ(tag) && r.peek() == CV_FS_BINARY_RAW )
+        {
+            CvFileNodeBlob* blob = (CvFileNodeBlob*)cvCreateSeq( 0, sizeof(CvFileNodeBlob),
+                                                                 sizeof(CvFileNode), fs->memstorage );
+            blob->signature = CV_FILE_NODE_BLOB_SIGNATURE;
+            blob->nscalars = 0;
+            blob->dt.ptr = 0;
+            blob->dt.len = 0;
+            blob->head = blob->tail = 0;
+            blob->expanded = 0;
+            node->data.seq = (CvSeq*)blob;
+            node->tag = CV_NODE_SEQ;
+        }
+        else
+            icvFSCreateCollection( fs, CV_NODE_TYPE(tag), node );
+        node->tag |= tag & CV_NODE_FLOW;
+
+        if( len > 0 )
+        {
+            node->info = cvFindType( type_str.c_str() );
+            if( node->info )
+                node->tag |= CV_NODE_USER;
+        }
+        icvBinaryParseCollection( fs, r, node, CV_NODE_IS_MAP(tag) &&
+                                  (type_str == CV_TYPE_NAME_MAT || type_str == CV_TYPE_NAME_MATND) );
+        }
+        break;
+    default:
+        CV_PARSE_ERROR( "Invalid node type" );
+    }
+}
+
+
+// parses the top-level node placed at [begin, end) into the root map
+static void
+icvBinaryParseEntry( CvFileStorage* fs, CvFileNode* root, size_t begin, size_t end )
+{
+    CvFileStorageLazyIndex* lazy = fs->lazy;
+    CvFSBinaryReader r( fs, lazy->data, lazy->data + begin, lazy->data + end );
+
+    int tag = r.read<uchar>(), len = 0;
+    const char* key = r.readString( len );
+    if( len == 0 )
+        CV_PARSE_ERROR( "Map element should have a name" );
+    CvFileNode* node = cvGetFileNode( fs, root, cvGetHashedKey( fs, key, len, 1 ), 1 );
+    icvBinaryParseValue( fs, r, tag, node, false );
+    node->tag |= CV_NODE_NAMED;
+    if( r.ptr != r.end )
+        CV_PARSE_ERROR( "Invalid size of the node" );
+}
+
+
+// loads a binary storage: plain files are mapped copy-on-write, so that the matrices sharing
+// their data with the storage stay writable; compressed ones are decompressed into memory
+static cv::UMatData*
+icvBinaryLoad( CvFileStorage* fs )
+{
+#if USE_ZLIB
+    if( fs->gzfile )
+    {
+        std::vector<uchar> buf;
+        size_t size = 0;
+        gzrewind( fs->gzfile );
+        for(;;)
+        {
+            buf.resize( std::max( size*2, (size_t)1 << 20 ) );
+            size_t block = std::min( buf.size() - size, (size_t)1 << 30 );
+            int n = gzread( fs->gzfile, &buf[size], (unsigned)block );
+            if( n < 0 )
+                CV_Error( CV_StsError, "Can't read the compressed file storage" );
+            size += n;
+            if( n == 0 )
+                break;
+        }
+
+        cv::UMatData* u = new cv::UMatData( cv::Mat::getStdAllocator() );
+        u->data = u->origdata = (uchar*)cv::fastMalloc( std::max( size, (size_t)1 ) );
+        u->size = size;
+        u->refcount = 1;
+        if( size > 0 )
+            memcpy( u->data, &buf[0], size );
+        return u;
+    }
+#endif
+    cv::UMatData* u = cv::mapFileData( fs->filename, cv::MAP_MAT_COPY_ON_WRITE );
+    if( !u )
+        CV_Error_( CV_StsError, ("Can't open the file %s", fs->filename) );
+    return u;
+}
+
+
+/****************************************************************************************\
+*                                Lazy (indexed) reading                                  *
+\****************************************************************************************/
+
+// A simple bounded cursor over the mapped file, used to find the indexed nodes
+// without building the node tree. The scanners are deliberately conservative:
+// whenever the file looks unusual they give up and the whole file is parsed as usual.
+class CvLazyScanner
+{
+public:
+    CvLazyScanner( const char* _data, size_t _size )
+        : data(_data), ptr(_data), end(_data + _size), lineno(1)
+    {
+        if( _size >= 3 && memcmp( ptr, "\xEF\xBB\xBF", 3 ) == 0 )
+            ptr += 3;
+    }
+
+    bool eof() const { return ptr >= end; }
+    char peek( size_t ofs = 0 ) const { return ptr + ofs < end ? ptr[ofs] : '\0'; }
+    size_t offset() const { return (size_t)(ptr - data); }
+
+    bool startsWith( const char* str ) const
+    {
+        size_t len = strlen(str);
+        return (size_t)(end - ptr) >= len && memcmp( ptr, str, len ) == 0;
+    }
+
+    void advance( size_t n = 1 )
+    {
+        for( ; n > 0 && ptr < end; n--, ptr++ )
+            lineno += *ptr == '\n';
+    }
+
+    void skipSpaces()
+    {
+        while( ptr < end && cv_isspace(*ptr) )
+            advance();
+    }
+
+    // moves the cursor right after the next occurrence of str
+    bool skipPast( const char* str )
+    {
+        size_t len = strlen(str);
+        while( ptr < end )
+        {
+            if( startsWith(str) )
+            {
+                advance(len);
+                return true;
+            }
+            advance();
+        }
+        return false;
+    }
+
+    void skipLine()
+    {
+        while( ptr < end && *ptr != '\n' )
+            ptr++;
+        advance();
+    }
+
+    const char* data;
+    const char* ptr;
+    const char* end;
+    int lineno;
+};
+
+
+static bool
+icvLazyAddEntry( CvFileStorageLazyIndex::Map& map, const std::string& key,
+                 size_t begin, size_t end, int lineno )
+{
+    // duplicated keys are reported by the regular parser
+    if( key.empty() || !map.keys.insert(std::make_pair(key, map.entries.size())).second )
+        return false;
+    CvFileStorageLazyIndex::Entry e;
+    e.key = key;
+    e.begin = begin;
+    e.end = end;
+    e.lineno = lineno;
+    e.children = -1;
+    e.parsed = e.failed = false;
+    map.entries.push_back(e);
+    return true;
+}
+
+
+// attaches the indexed elements to the last top-level entry, which is a plain map;
+// then only the map node is created when the entry is accessed
+static void
+icvLazyAddChildren( CvFileStorageLazyIndex* lazy, const CvFileStorageLazyIndex::Map& children )
+{
+    if( children.entries.empty() )
+        return;
+    lazy->maps[0].entries.back().children = (int)lazy->maps.size();
+    lazy->maps.push_back( children );
+}
+
+
+static bool
+icvXMLSkipComments( CvLazyScanner& sc )
+{
+    for(;;)
+    {
+        sc.skipSpaces();
+        if( !sc.startsWith("<!--") )
+            return true;
+        if( !sc.skipPast("-->") )
+            return false;
+    }
+}
+
+
+// the name of the tag the scanner points at
+static std::string
+icvXMLTagName( const CvLazyScanner& sc, size_t start )
+{
+    size_t len = start;
+    while( cv_isprint(sc.peek(len)) && !cv_isspace(sc.peek(len)) &&
+           sc.peek(len) != '>' && sc.peek(len) != '/' )
+        len++;
+    return std::string( sc.ptr + start, len - start );
+}
+
+
+// true if the opening tag [ptr, tag_end] starts a plain map, i.e. it has no attributes
+// or its type_id does not name a special node type or a registered type
+static bool
+icvXMLIsPlainMapTag( const char* ptr, const char* tag_end )
+{
+    const char* attr = "type_id";
+    size_t attr_len = strlen(attr);
+
+    for( ptr++; ptr < tag_end && !cv_isspace(*ptr) && *ptr != '/'; ptr++ )
+        ;
+    for( ; ptr < tag_end && cv_isspace(*ptr); ptr++ )
+        ;
+    if( ptr == tag_end )
+        return true;
+    if( (size_t)(tag_end - ptr) <= attr_len || memcmp( ptr, attr, attr_len ) != 0 )
+        return false;
+    for( ptr += attr_len; ptr < tag_end && cv_isspace(*ptr); ptr++ )
+        ;
+    if( ptr == tag_end || *ptr != '=' )
+        return false;
+    for( ptr++; ptr < tag_end && cv_isspace(*ptr); ptr++ )
+        ;
+    if( ptr == tag_end || (*ptr != '\"' && *ptr != '\'') )
+        return false;
+    const char* type_end = (const char*)memchr( ptr + 1, *ptr, tag_end - ptr - 1 );
+    if( !type_end )
+        return false;
+    std::string type_name( ptr + 1, type_end - ptr - 1 );
+    for( ptr = type_end + 1; ptr < tag_end && cv_isspace(*ptr); ptr++ )
+        ;
+    return ptr == tag_end && (type_name == "map" ||
+        (type_name != "str" && type_name != "seq" && type_name != "binary" &&
+         !cvFindType( type_name.c_str() )));
+}
+
+
+static bool
+icvXMLBuildLazyIndex( CvFileStorageLazyIndex* lazy )
+{
+    CvLazyScanner sc( (const char*)lazy->data, lazy->size );
+
+    sc.skipSpaces();
+    if( !sc.startsWith("<?xml") || !sc.skipPast("?>") ||
+        !icvXMLSkipComments(sc) || !sc.startsWith("<opencv_storage>") )
+        return false;
+    sc.advance(strlen("<opencv_storage>"));
+
+    for(;;)
+    {
+        if( !icvXMLSkipComments(sc) || sc.eof() || sc.peek() != '<' )
+            return false;
+
+        if( sc.startsWith("</opencv_storage") )
+        {
+            // only a single stream can be indexed
+            return sc.skipPast(">") && icvXMLSkipComments(sc) && sc.eof();
+        }
+
+        size_t begin = sc.offset();
+        int lineno = sc.lineno;
+        std::string key = icvXMLTagName( sc, 1 );
+        if( key == "_" )
+            return false;
+
+        // find the matching closing tag; text between the tags can't contain '<'.
+        // The elements of a plain map (depth 1) are indexed on the way
+        CvFileStorageLazyIndex::Map children;
+        std::string child_key;
+        size_t child_begin = 0;
+        int child_lineno = 0, depth = 0;
+        bool plain_map = true;
+        for(;;)
+        {
+            if( sc.startsWith("<!--") )
+            {
+                if( !sc.skipPast("-->") )
+                    return false;
+            }
+            else
+            {
+                bool closing = sc.peek(1) == '/';
+                if( sc.peek(1) == '?' || sc.peek(1) == '!' )
+                    return false;
+                const char* tag_end = (const char*)memchr( sc.ptr, '>', sc.end - sc.ptr );
+                if( !tag_end )
+                    return false;
+                bool empty = tag_end[-1] == '/';
+                if( depth == 0 )
+                    plain_map = icvXMLIsPlainMapTag( sc.ptr, tag_end );
+                else if( depth == 1 && !closing )
+                {
+                    child_key = icvXMLTagName( sc, 1 );
+                    child_begin = sc.offset();
+                    child_lineno = sc.lineno;
+                }
+                sc.advance( tag_end - sc.ptr + 1 );
+                depth += closing ? -1 : empty ? 0 : 1;
+                if( depth <= 0 )
+                    break;
+                if( depth == 1 && (closing || empty) && plain_map )
+                    plain_map = child_key != "_" &&
+                        icvLazyAddEntry( children, child_key, child_begin, sc.offset(), child_lineno );
+            }
+            while( !sc.eof() && sc.peek() != '<' )
+            {
+                // a map can't have text elements
+                plain_map = plain_map && (depth != 1 || cv_isspace(sc.peek()));
+                sc.advance();
+            }
+            if( sc.eof() )
+                return false;
+        }
+
+        if( !icvLazyAddEntry( lazy->maps[0], key, begin, sc.offset(), lineno ) )
+            return false;
+        if( plain_map )
+            icvLazyAddChildren( lazy, children );
+    }
+}
+
+
+// indexes the elements of the top-level node [begin, end) if it is a block map without a tag
+static bool
+icvYMLIndexChildren( const CvFileStorageLazyIndex* lazy, size_t begin, size_t end, int lineno,
+                     CvFileStorageLazyIndex::Map& children )
+{
+    CvLazyScanner sc( (const char*)lazy->data + begin, end - begin );
+    sc.lineno = lineno;
+
+    // nothing but a comment may follow the key of the map
+    const char* ptr = (const char*)memchr( sc.ptr, ':', sc.end - sc.ptr );
+    if( !ptr )
+        return false;
+    for( ptr++; ptr < sc.end && *ptr == ' '; ptr++ )
+        ;
+    if( ptr < sc.end && *ptr != '\n' && *ptr != '\r' && *ptr != '#' )
+        return false;
+
+    std::string key;
+    size_t child_begin = 0;
+    int child_lineno = 0, indent = -1;
+    for( sc.skipLine(); !sc.eof(); sc.skipLine() )
+    {
+        int n = 0;
+        while( sc.peek(n) == ' ' )
+            n++;
+        char c = sc.peek(n);
+        if( c == '\n' || c == '\r' || c == '#' || c == '\0' )
+            continue;
+        if( indent < 0 )
+            indent = n;
+        if( n > indent )
+            continue;
+        // sequences, flow collections, quoted keys etc. are left to the regular parser
+        if( n < indent || !(cv_isalnum(c) || c == '_') )
+            return false;
+
+        if( !key.empty() && !icvLazyAddEntry( children, key, begin + child_begin,
+                                              begin + sc.offset(), child_lineno ) )
+            return false;
+        const char* colon = sc.ptr + n;
+        while( colon < sc.end && *colon != ':' && *colon != '\n' )
+            colon++;
+        if( colon >= sc.end || *colon != ':' )
+            return false;
+        const char* key_end = colon;
+        while( key_end > sc.ptr + n && key_end[-1] == ' ' )
+            key_end--;
+        key.assign( sc.ptr + n, key_end - sc.ptr - n );
+        child_begin = sc.offset();
+        child_lineno = sc.lineno;
+    }
+
+    return !key.empty() && icvLazyAddEntry( children, key, begin + child_begin, end, child_lineno );
+}
+
+
+static bool
+icvYMLAddTopLevelEntry( CvFileStorageLazyIndex* lazy, const std::string& key,
+                        size_t begin, size_t end, int lineno )
+{
+    if( !icvLazyAddEntry( lazy->maps[0], key, begin, end, lineno ) )
+        return false;
+    CvFileStorageLazyIndex::Map children;
+    if( icvYMLIndexChildren( lazy, begin, end, lineno, children ) )
+        icvLazyAddChildren( lazy, children );
+    return true;
+}
+
+
+static bool
+icvYMLBuildLazyIndex( CvFileStorageLazyIndex* lazy )
+{
+    CvLazyScanner sc( (const char*)lazy->data, lazy->size );
+    bool header = true, stream_end = false;
+    size_t begin = 0;
+    int lineno = 0;
+    std::string key;
+
+    // the file is processed line by line; every top-level key starts at column 0
+    // and the node lasts until the next line that starts at column 0
+    for( ; !sc.eof(); sc.skipLine() )
+    {
+        char c = sc.peek();
+        if( c == ' ' || c == '\n' || c == '\r' || c == '#' )
+            continue;
+
+        bool is_key = cv_isalnum(c) || c == '_';
+        if( stream_end )
+            return false;
+
+        if( !is_key && !header )
+        {
+            // anything but the end of the (single) stream is not supported
+            if( !sc.startsWith("...") ||
+                (!key.empty() && !icvYMLAddTopLevelEntry( lazy, key, begin, sc.offset(), lineno )) )
+                return false;
+            key.clear();
+            stream_end = true;
+            continue;
+        }
+
+        if( header && !is_key )
+        {
+            if( c == '%' )
+                continue;
+            if( !sc.startsWith("---") )
+                return false;
+            header = false;
+            continue;
+        }
+
+        header = false;
+        if( !key.empty() && !icvYMLAddTopLevelEntry( lazy, key, begin, sc.offset(), lineno ) )
+            return false;
+
+        const char* colon = sc.ptr;
+        while( colon < sc.end && *colon != ':' && *colon != '\n' )
+            colon++;
+        if( colon >= sc.end || *colon != ':' )
+            return false;
+        const char* key_end = colon;
+        while( key_end > sc.ptr && key_end[-1] == ' ' )
+            key_end--;
+        key.assign( sc.ptr, key_end - sc.ptr );
+        begin = sc.offset();
+        lineno = sc.lineno;
+    }
+
+    return key.empty() || icvYMLAddTopLevelEntry( lazy, key, begin, sc.offset(), lineno );
+}
+
+
+static bool
+icvJSONSkipComments( CvLazyScanner& sc )
+{
+    for(;;)
+    {
+        sc.skipSpaces();
+        if( sc.startsWith("//") )
+            sc.skipLine();
+        else if( sc.startsWith("/*") )
+        {
+            if( !sc.skipPast("*/") )
+                return false;
+        }
+        else
+            return true;
+    }
+}
+
+
+// indexes the members of the object whose '{' has just been passed, up to and including its '}';
+// map is NULL for the root object, then the members of its plain objects are indexed as well
+static bool
+icvJSONIndexObject( CvLazyScanner& sc, CvFileStorageLazyIndex* lazy, CvFileStorageLazyIndex::Map* map )
+{
+    for(;;)
+    {
+        if( !icvJSONSkipComments(sc) )
+            return false;
+        if( sc.peek() == '}' )
+        {
+            sc.advance();
+            return true;
+        }
+        if( sc.peek() != '"' )
+            return false;
+
+        size_t begin = sc.offset(), len = 1;
+        int lineno = sc.lineno;
+        while( cv_isprint(sc.peek(len)) && sc.peek(len) != '"' )
+            len++;
+        if( sc.peek(len) != '"' )
+            return false;
+        std::string key( sc.ptr + 1, len - 1 );
+        // "type_id" changes the type of the object itself
+        if( key == "type_id" )
+            return false;
+        sc.advance(len + 1);
+        if( !icvJSONSkipComments(sc) || sc.peek() != ':' )
+            return false;
+        sc.advance();
+
+        CvFileStorageLazyIndex::Map children;
+        bool plain_map = false;
+        if( !map && icvJSONSkipComments(sc) && sc.peek() == '{' )
+        {
+            CvLazyScanner start = sc;
+            sc.advance();
+            plain_map = icvJSONIndexObject( sc, lazy, &children );
+            if( !plain_map )
+                sc = start;
+        }
+
+        // skip the value up to the ',' or '}' that terminates it
+        int depth = 0;
+        for(;;)
+        {
+            char c = sc.peek();
+            if( sc.eof() )
+                return false;
+            if( c == '"' )
+            {
+                for( sc.advance(); !sc.eof() && sc.peek() != '"'; sc.advance() )
+                    if( sc.peek() == '\\' )
+                        sc.advance();
+            }
+            else if( c == '/' && (sc.peek(1) == '/' || sc.peek(1) == '*') )
+            {
+                if( !icvJSONSkipComments(sc) )
+                    return false;
+                continue;
+            }
+            else if( c == '{' || c == '[' )
+                depth++;
+            else if( c == '}' || c == ']' || c == ',' )
+            {
+                if( depth == 0 )
+                    break;
+                depth -= c != ',';
+            }
+            sc.advance();
+        }
+
+        // the root map is taken from the index each time, since adding the children may move it
+        if( !icvLazyAddEntry( map ? *map : lazy->maps[0], key, begin, sc.offset(), lineno ) )
+            return false;
+        if( plain_map )
+            icvLazyAddChildren( lazy, children );
+        if( sc.peek() == ',' )
+            sc.advance();
+    }
+}
+
+
+static bool
+icvJSONBuildLazyIndex( CvFileStorageLazyIndex* lazy )
+{
+    CvLazyScanner sc( (const char*)lazy->data, lazy->size );
+
+    if( !icvJSONSkipComments(sc) || sc.peek() != '{' )
+        return false;
+    sc.advance();
+
+    return icvJSONIndexObject( sc, lazy, 0 ) &&
+           icvJSONSkipComments(sc) && sc.eof();
+}
+
+
+// the binary storage keeps the index of the top-level nodes at the end of the file
+static bool
+icvBinaryBuildLazyIndex( CvFileStorage* fs, CvFileStorageLazyIndex* lazy )
+{
+    const uchar* data = lazy->data;
+    size_t size = lazy->size;
+
+    if( size < (size_t)(CV_FS_BINARY_HEADER_SIZE + CV_FS_BINARY_TRAILER_SIZE) ||
+        memcmp( data, icvBinarySignature, sizeof(icvBinarySignature) ) != 0 )
+        CV_PARSE_ERROR( "Invalid binary file storage" );
+
+    CvFSBinaryReader r( fs, data, data + sizeof(icvBinarySignature), data + size );
+    if( r.read<unsigned>() != CV_FS_BINARY_BYTE_ORDER )
+        CV_PARSE_ERROR( "The binary file storage has been written with a different byte order" );
+    if( r.read<unsigned>() != CV_FS_BINARY_VERSION )
+        CV_PARSE_ERROR( "Unsupported version of the binary file storage" );
+
+    const uchar* trailer = data + size - CV_FS_BINARY_TRAILER_SIZE;
+    uint64 index_pos;
+    memcpy( &index_pos, trailer, sizeof(index_pos) );
+    if( memcmp( trailer + sizeof(index_pos), icvBinaryIndexSignature, sizeof(icvBinaryIndexSignature) ) != 0 ||
+        index_pos < (uint64)CV_FS_BINARY_HEADER_SIZE || index_pos > (uint64)(trailer - data) )
+        CV_PARSE_ERROR( "The index of the binary file storage is not found, the file may be truncated" );
+
+    r.ptr = data + (size_t)index_pos;
+    r.end = trailer;
+    unsigned n = r.read<unsigned>();
+    for( unsigned i = 0; i < n; i++ )
+    {
+        int len = 0;
+        const char* key = r.readString( len );
+        uint64 begin = r.read<uint64>(), end = r.read<uint64>();
+        if( begin < (uint64)CV_FS_BINARY_HEADER_SIZE || begin >= end || end > index_pos )
+            CV_PARSE_ERROR( "Invalid index of the binary file storage" );
+        if( !icvLazyAddEntry( lazy->maps[0], std::string( key, len ), (size_t)begin, (size_t)end, 0 ) )
+            CV_PARSE_ERROR( "Duplicated key" );
+    }
+    return true;
+}
+
+
+static bool
+icvBuildLazyIndex( CvFileStorage* fs, CvFileStorageLazyIndex* lazy )
+{
+    switch( fs->fmt )
+    {
+    case CV_STORAGE_FORMAT_XML : return icvXMLBuildLazyIndex( lazy );
+    case CV_STORAGE_FORMAT_YAML: return icvYMLBuildLazyIndex( lazy );
+    case CV_STORAGE_FORMAT_JSON: return icvJSONBuildLazyIndex( lazy );
+    case CV_STORAGE_FORMAT_BINARY: return icvBinaryBuildLazyIndex( fs, lazy );
+    default: return false;
+    }
+}
+
+
+// parses the entry from the mapped file into the map node
+static void
+icvLazyReadEntry( CvFileStorage* fs, CvFileNode* root, const CvFileStorageLazyIndex::Entry& e )
+{
+    CvFileStorageLazyIndex* lazy = fs->lazy;
+
+    if( e.children >= 0 )
+    {
+        // only the map node is created, its elements are parsed on access
+        CvFileNode* node = cvGetFileNode( fs, root, cvGetHashedKey( fs, e.key.c_str(), (int)e.key.size(), 1 ), 1 );
+        memset( node, 0, sizeof(*node) );
+        icvFSCreateCollection( fs, CV_NODE_MAP, node );
+        if( fs->fmt != CV_STORAGE_FORMAT_JSON )
+            node->tag |= CV_NODE_NAMED;
+        lazy->maps[e.children].node = node;
+        lazy->nodes[node] = (size_t)e.children;
+        return;
+    }
+
+    if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+    {
+        icvBinaryParseEntry( fs, root, e.begin, e.end );
+        return;
+    }
+
+    size_t buf_size = e.end - e.begin;
+    buf_size = MIN( buf_size, (size_t)(1 << 20) );
+    buf_size = MAX( buf_size, (size_t)(CV_FS_MAX_LEN*2 + 1024) );
+
+    // the entry is read straight from the mapped file, line by line
+    fs->strbuf = (const char*)lazy->data + e.begin;
+    fs->strbufsize = e.end - e.begin;
+    fs->strbufpos = 0;
+    fs->lineno = e.lineno - 1;
+    fs->dummy_eof = 0;
+    fs->buffer = fs->buffer_start = (char*)cvAlloc( buf_size + 256 );
+    fs->buffer_end = fs->buffer_start + buf_size;
+    fs->buffer[0] = '\n';
+    fs->buffer[1] = '\0';
+
+    try
+    {
+        char* ptr = fs->buffer_start;
+        CvFileNode node;
+
+        if( fs->fmt == CV_STORAGE_FORMAT_JSON )
+        {
+            CvFileNode* child = 0;
+            ptr = icvJSONSkipSpaces( fs, ptr );
+            ptr = icvJSONParseKey( fs, ptr, root, &child );
+            if( ptr )
+                ptr = icvJSONSkipSpaces( fs, ptr );
+            if( !ptr || fs->dummy_eof || !child )
+                CV_PARSE_ERROR( "Unexpected End-Of-File" );
+            if( *ptr == '[' )
+                icvJSONParseSeq( fs, ptr, child );
+            else if( *ptr == '{' )
+                icvJSONParseMap( fs, ptr, child );
+            else
+                icvJSONParseValue( fs, ptr, child );
+        }
+        else
+        {
+            // the entry is parsed as a single-element map, which is then merged into the parent
+            if( fs->fmt == CV_STORAGE_FORMAT_XML )
+                icvXMLParseValue( fs, ptr, &node, CV_NODE_NONE );
+            else
+            {
+                ptr = icvYMLSkipSpaces( fs, ptr, 0, INT_MAX );
+                icvYMLParseValue( fs, ptr, &node, CV_NODE_NONE, 0 );
+            }
+
+            if( !CV_NODE_IS_MAP(node.tag) )
+                CV_PARSE_ERROR( "Invalid top-level node" );
+
+            CvSet* map = (CvSet*)node.data.map;
+            CvSeqReader reader;
+            cvStartReadSeq( (CvSeq*)map, &reader, 0 );
+            for( int i = 0; i < map->total; i++ )
+            {
+                CvFileMapNode* elem = (CvFileMapNode*)reader.ptr;
+                if( CV_IS_SET_ELEM(elem) )
+                    *cvGetFileNode( fs, root, elem->key, 1 ) = elem->value;
+                CV_NEXT_SEQ_ELEM( map->elem_size, reader );
+            }
+        }
+    }
+    catch(...)
+    {
+        cvFree( &fs->buffer_start );
+        fs->buffer = fs->buffer_end = 0;
+        fs->strbuf = 0;
+        throw;
+    }
+
+    cvFree( &fs->buffer_start );
+    fs->buffer = fs->buffer_end = 0;
+    fs->strbuf = 0;
+    fs->strbufsize = fs->strbufpos = 0;
+}
+
+
+// the entry is marked as parsed only on success; a broken entry may have left a partial node
+// behind, so it is not parsed again and its error is reported on every access instead
+static void
+icvLazyParseEntry( CvFileStorage* fs, CvFileStorageLazyIndex::Map& parent, CvFileStorageLazyIndex::Entry& e )
+{
+    if( e.failed )
+        throw e.error;
+
+    try
+    {
+        icvLazyReadEntry( fs, parent.node, e );
+    }
+    catch( const cv::Exception& exc )
+    {
+        e.failed = true;
+        e.error = exc;
+        throw;
+    }
+
+    e.parsed = true;
+    parent.unparsed--;
+    fs->lazy->unparsed--;
+}
+
+
+// parses the element of the indexed map node (the root if node is NULL) with the given key,
+// or all the remaining elements if key is NULL; other nodes are left intact
+static void
+icvLazyLoad( CvFileStorage* fs, const CvFileNode* node, const char* key, int len )
+{
+    CvFileStorageLazyIndex* lazy = fs->lazy;
+    if( !node )
+        node = (const CvFileNode*)cvGetSeqElem( fs->roots, 0 );
+
+    std::map<const CvFileNode*, size_t>::const_iterator mit = lazy->nodes.find( node );
+    if( mit == lazy->nodes.end() || lazy->maps[mit->second].unparsed == 0 )
+        return;
+    CvFileStorageLazyIndex::Map& map = lazy->maps[mit->second];
+
+    if( key )
+    {
+        std::map<std::string, size_t>::const_iterator it = map.keys.find( std::string(key, len) );
+        if( it != map.keys.end() && !map.entries[it->second].parsed )
+            icvLazyParseEntry( fs, map, map.entries[it->second] );
+    }
+    else
+    {
+        for( size_t i = 0; i < map.entries.size() && map.unparsed > 0; i++ )
+            if( !map.entries[i].parsed )
+                icvLazyParseEntry( fs, map, map.entries[i] );
+    }
+}
+
+
+// indexes the nodes of the mapped file, the storage takes the ownership of the mapping;
+// returns false if the file should be parsed as usual
+static bool
+icvLazyOpen( CvFileStorage* fs, cv::UMatData* u )
+{
+    if( !u )
+        return false;
+
+    CvFileStorageLazyIndex* lazy = new CvFileStorageLazyIndex;
+    lazy->u = u;
+    lazy->data = u->data;
+    lazy->size = u->size;
+    lazy->maps.resize(1);
+    fs->lazy = lazy;
+    if( !icvBuildLazyIndex( fs, lazy ) )
+    {
+        if( CV_XADD(&u->refcount, -1) == 1 )
+            u->currAllocator->unmap(u);
+        delete lazy;
+        fs->lazy = 0;
+        return false;
+    }
+
+    for( size_t i = 0; i < lazy->maps.size(); i++ )
+    {
+        lazy->maps[i].unparsed = lazy->maps[i].entries.size();
+        lazy->unparsed += lazy->maps[i].unparsed;
+    }
+
+    CvFileNode* root = (CvFileNode*)cvSeqPush( fs->roots, 0 );
+    memset( root, 0, sizeof(*root) );
+    icvFSCreateCollection( fs, CV_NODE_MAP, root );
+    lazy->maps[0].node = root;
+    lazy->nodes[root] = 0;
+    return true;
+}
+
+
+/****************************************************************************************\
+*                                     Binary Emitter                                     *
+\****************************************************************************************/
+
+static void
+icvBinaryWrite( CvFileStorage* fs, const void* data, size_t len )
+{
+    if( len == 0 )
+        return;
+    if( fs->file )
+    {
+        if( fwrite( data, 1, len, fs->file ) != len )
+            CV_Error( CV_StsError, "Can't write to the file storage" );
+    }
+#if USE_ZLIB
+    else if( fs->gzfile )
+    {
+        const char* ptr = (const char*)data;
+        for( size_t ofs = 0; ofs < len; )
+        {
+            unsigned block = (unsigned)std::min( len - ofs, (size_t)1 << 30 );
+            if( gzwrite( fs->gzfile, ptr + ofs, block ) != (int)block )
+                CV_Error( CV_StsError, "Can't write to the file storage" );
+            ofs += block;
+        }
+    }
+#endif
+    else
+        CV_Error( CV_StsError, "The storage is not opened" );
+    fs->binary_writer->pos += len;
+}
+
+
+template<typename _Tp> static inline void
+icvBinaryWriteValue( CvFileStorage* fs, _Tp value )
+{
+    icvBinaryWrite( fs, &value, sizeof(value) );
+}
+
+
+static void
+icvBinaryWriteString( CvFileStorage* fs, const char* str )
+{
+    size_t len = str ? strlen(str) : 0;
+    if( len > (size_t)INT_MAX )
+        CV_Error( CV_StsOutOfRange, "Too long string" );
+    icvBinaryWriteValue( fs, (unsigned)len );
+    icvBinaryWrite( fs, str, len );
+}
+
+
+// writes the node tag and, inside maps, the node name
+static void
+icvBinaryWriteHeader( CvFileStorage* fs, const char* key, int tag )
+{
+    CvFSBinaryWriter* writer = fs->binary_writer;
+    bool top_level = fs->write_stack->total == 0;
+    bool is_map = top_level || CV_NODE_IS_MAP(fs->struct_flags);
+
+    if( is_map && (!key || key[0] == '\0') )
+        CV_Error( CV_StsBadArg, "Map elements should have a name" );
+    if( !is_map && key )
+        CV_Error( CV_StsBadArg, "Sequence elements should not have a name" );
+
+    if( top_level )
+    {
+        writer->node_begin = writer->pos;
+        writer->node_key = key;
+    }
+    icvBinaryWriteValue( fs, (uchar)tag );
+    if( is_map )
+        icvBinaryWriteString( fs, key );
+}
+
+
+// adds the just written top-level node to the index
+static void
+icvBinaryEndNode( CvFileStorage* fs )
+{
+    CvFSBinaryWriter* writer = fs->binary_writer;
+    if( fs->write_stack->total > 0 )
+        return;
+    CvFSBinaryWriter::Entry e;
+    e.key = writer->node_key;
+    e.begin = writer->node_begin;
+    e.end = writer->pos;
+    writer->index.push_back(e);
+}
+
+
+static void
+icvBinaryStartWriteStruct( CvFileStorage* fs, const char* key, int struct_flags,
+                           const char* type_name )
+{
+    int parent_flags;
+    struct_flags = (struct_flags & (CV_NODE_TYPE_MASK|CV_NODE_FLOW)) | CV_NODE_EMPTY;
+    if( !CV_NODE_IS_COLLECTION(struct_flags))
+        CV_Error( CV_StsBadArg,
+        "Some collection type - CV_NODE_SEQ or CV_NODE_MAP, must be specified" );
+
+    icvBinaryWriteHeader( fs, key, struct_flags & (CV_NODE_TYPE_MASK|CV_NODE_FLOW) );
+    icvBinaryWriteString( fs, type_name );
+
+    parent_flags = fs->struct_flags;
+    cvSeqPush( fs->write_stack, &parent_flags );
+    fs->struct_flags = struct_flags;
 }
 
-static char* icvJSONParseSeq( CvFileStorage* fs, char* ptr, CvFileNode* node );
-static char* icvJSONParseMap( CvFileStorage* fs, char* ptr, CvFileNode* node );
 
-static char* icvJSONParseSeq( CvFileStorage* fs, char* ptr, CvFileNode* node )
+static void
+icvBinaryEndWriteStruct( CvFileStorage* fs )
 {
-    if ( *ptr != '[' )
-        CV_PARSE_ERROR( "'[' - left-brace of seq is missing" );
-    else
-        ptr++;
+    int parent_flags = 0;
 
-    memset( node, 0, sizeof(*node) );
-    icvFSCreateCollection( fs, CV_NODE_SEQ, node );
+    if( fs->write_stack->total == 0 )
+        CV_Error( CV_StsError, "EndWriteStruct w/o matching StartWriteStruct" );
 
-    for (;;)
-    {
-        ptr = icvJSONSkipSpaces( fs, ptr );
-        if ( ptr == 0 || fs->dummy_eof )
-            break;
+    icvBinaryWriteValue( fs, (uchar)CV_FS_BINARY_END );
+    cvSeqPop( fs->write_stack, &parent_flags );
+    fs->struct_flags = parent_flags;
+    icvBinaryEndNode( fs );
+}
 
-        if ( *ptr != ']' )
-        {
-            CvFileNode* child = (CvFileNode*)cvSeqPush( node->data.seq, 0 );
 
-            if ( *ptr == '[' )
-                ptr = icvJSONParseSeq( fs, ptr, child );
-            else if ( *ptr == '{' )
-                ptr = icvJSONParseMap( fs, ptr, child );
-            else
-                ptr = icvJSONParseValue( fs, ptr, child );
-        }
+static void
+icvBinaryStartNextStream( CvFileStorage* )
+{
+    CV_Error( CV_StsNotImplemented, "The binary file storage can contain only one stream" );
+}
 
-        ptr = icvJSONSkipSpaces( fs, ptr );
-        if ( ptr == 0 || fs->dummy_eof )
-            break;
 
-        if ( *ptr == ',' )
-            ptr++;
-        else if ( *ptr == ']' )
-            break;
-        else
-            CV_PARSE_ERROR( "Unexpected character" );
-    }
+static void
+icvBinaryWriteInt( CvFileStorage* fs, const char* key, int value )
+{
+    icvBinaryWriteHeader( fs, key, CV_NODE_INT );
+    icvBinaryWriteValue( fs, value );
+    icvBinaryEndNode( fs );
+}
 
-    if ( *ptr != ']' )
-        CV_PARSE_ERROR( "']' - right-brace of seq is missing" );
-    else
-        ptr++;
 
-    return ptr;
+static void
+icvBinaryWriteReal( CvFileStorage* fs, const char* key, double value )
+{
+    icvBinaryWriteHeader( fs, key, CV_NODE_REAL );
+    icvBinaryWriteValue( fs, value );
+    icvBinaryEndNode( fs );
 }
 
-static char* icvJSONParseMap( CvFileStorage* fs, char* ptr, CvFileNode* node )
+
+static void
+icvBinaryWriteString( CvFileStorage* fs, const char* key, const char* str, int /*quote*/ )
 {
-    if ( *ptr != '{' )
-        CV_PARSE_ERROR( "'{' - left-brace of map is missing" );
-    else
-        ptr++;
+    icvBinaryWriteHeader( fs, key, CV_NODE_STRING );
+    icvBinaryWriteString( fs, str );
+    icvBinaryEndNode( fs );
+}
 
-    memset( node, 0, sizeof(*node) );
-    icvFSCreateCollection( fs, CV_NODE_MAP, node );
 
-    for ( ;; )
-    {
-        ptr = icvJSONSkipSpaces( fs, ptr );
-        if ( ptr == 0 || fs->dummy_eof )
+static void
+icvBinaryWriteComment( CvFileStorage*, const char*, int )
+{
+    // the comments are not stored in the binary format
+}
+
+
+// writes the elements as they are, aligned so that they could be used without copying
+static void
+icvBinaryWriteRawData( CvFileStorage* fs, const void* data, int len, const char* dt )
+{
+    int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], k, fmt_pair_count;
+
+    if( len < 0 )
+        CV_Error( CV_StsOutOfRange, "Negative number of elements" );
+    if( fs->write_stack->total == 0 || !CV_NODE_IS_SEQ(fs->struct_flags) )
+        CV_Error( CV_StsBadArg, "The raw data can only be written into a sequence" );
+
+    fmt_pair_count = icvDecodeFormat( dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
+    if( !len )
+        return;
+    if( !data )
+        CV_Error( CV_StsNullPtr, "Null data pointer" );
+
+    for( k = 0; k < fmt_pair_count; k++ )
+        if( fmt_pairs[k*2+1] == CV_USRTYPE1 )
             break;
 
-        if ( *ptr == '"' )
+    if( k < fmt_pair_count )
+    {
+        // references can't be stored as raw data, so the elements are written one by one
+        const uchar* data0 = (const uchar*)data;
+        int offset = 0;
+        for( ; len--; )
         {
-            CvFileNode* child = 0;
-            ptr = icvJSONParseKey( fs, ptr, node, &child );
-            ptr = icvJSONSkipSpaces( fs, ptr );
-            if ( ptr == 0 || fs->dummy_eof )
-                break;
-
-            if ( child == 0 )
-            {   /* type_id */
-                CvFileNode tmp;
-                ptr = icvJSONParseValue( fs, ptr, &tmp );
-                if ( CV_NODE_IS_STRING(tmp.tag) )
-                {
-                    node->info = cvFindType( tmp.data.str.ptr );
-                    if ( node->info )
-                        node->tag |= CV_NODE_USER;
-                    // delete tmp.data.str
-                }
-                else
+            for( k = 0; k < fmt_pair_count; k++ )
+            {
+                int i, count = fmt_pairs[k*2], elem_type = fmt_pairs[k*2+1];
+                int elem_size = CV_ELEM_SIZE(elem_type);
+                offset = cvAlign( offset, elem_size );
+                for( i = 0; i < count; i++, offset += elem_size )
                 {
-                    CV_PARSE_ERROR( "\"type_id\" should be of type string" );
+                    const uchar* ptr = data0 + offset;
+                    switch( elem_type )
+                    {
+                    case CV_8U: icvBinaryWriteInt( fs, 0, *(const uchar*)ptr ); break;
+                    case CV_8S: icvBinaryWriteInt( fs, 0, *(const schar*)ptr ); break;
+                    case CV_16U: icvBinaryWriteInt( fs, 0, *(const ushort*)ptr ); break;
+                    case CV_16S: icvBinaryWriteInt( fs, 0, *(const short*)ptr ); break;
+                    case CV_32S: icvBinaryWriteInt( fs, 0, *(const int*)ptr ); break;
+                    case CV_32F: icvBinaryWriteReal( fs, 0, *(const float*)ptr ); break;
+                    case CV_64F: icvBinaryWriteReal( fs, 0, *(const double*)ptr ); break;
+                    default: icvBinaryWriteInt( fs, 0, (int)*(const size_t*)ptr );
+                    }
                 }
             }
-            else
-            {   /* normal */
-                if ( *ptr == '[' )
-                    ptr = icvJSONParseSeq( fs, ptr, child );
-                else if ( *ptr == '{' )
-                    ptr = icvJSONParseMap( fs, ptr, child );
-                else
-                    ptr = icvJSONParseValue( fs, ptr, child );
-            }
         }
-
-        ptr = icvJSONSkipSpaces( fs, ptr );
-        if ( ptr == 0 || fs->dummy_eof )
-            break;
-
-        if ( *ptr == ',' )
-            ptr++;
-        else if ( *ptr == '}' )
-            break;
-        else
-            CV_PARSE_ERROR( "Unexpected character" );
+        return;
     }
 
-    if ( *ptr != '}' )
-        CV_PARSE_ERROR( "'}' - right-brace of map is missing" );
-    else
-        ptr++;
+    size_t step = (size_t)icvCalcStructSize( dt, 0 );
+    icvBinaryWriteValue( fs, (uchar)CV_FS_BINARY_RAW );
+    icvBinaryWriteString( fs, dt );
+    icvBinaryWriteValue( fs, (uint64)len );
 
-    return ptr;
+    static const uchar zeros[CV_FS_BINARY_ALIGN] = {0};
+    size_t pos = (size_t)fs->binary_writer->pos;
+    icvBinaryWrite( fs, zeros, cv::alignSize( pos, CV_FS_BINARY_ALIGN ) - pos );
+    icvBinaryWrite( fs, data, len*step );
 }
 
 
 static void
-icvJSONParse( CvFileStorage* fs )
+icvBinaryWriteIndex( CvFileStorage* fs )
 {
-    char* ptr = fs->buffer_start;
-    ptr = icvJSONSkipSpaces( fs, ptr );
-    if ( ptr == 0 || fs->dummy_eof )
-        return;
+    CvFSBinaryWriter* writer = fs->binary_writer;
+    uint64 index_pos = writer->pos;
 
-    if ( *ptr == '{' )
-    {
-        CvFileNode* root_node = (CvFileNode*)cvSeqPush( fs->roots, 0 );
-        ptr = icvJSONParseMap( fs, ptr, root_node );
-    }
-    else if ( *ptr == '[' )
-    {
-        CvFileNode* root_node = (CvFileNode*)cvSeqPush( fs->roots, 0 );
-        ptr = icvJSONParseSeq( fs, ptr, root_node );
-    }
-    else
+    icvBinaryWriteValue( fs, (unsigned)writer->index.size() );
+    for( size_t i = 0; i < writer->index.size(); i++ )
     {
-        CV_PARSE_ERROR( "left-brace of top level is missing" );
+        const CvFSBinaryWriter::Entry& e = writer->index[i];
+        icvBinaryWriteString( fs, e.key.c_str() );
+        icvBinaryWriteValue( fs, e.begin );
+        icvBinaryWriteValue( fs, e.end );
     }
-
-    if ( fs->dummy_eof != 0 )
-        CV_PARSE_ERROR( "Unexpected End-Of-File" );
+    icvBinaryWriteValue( fs, index_pos );
+    icvBinaryWrite( fs, icvBinaryIndexSignature, sizeof(icvBinaryIndexSignature) );
 }
 
-
 /****************************************************************************************\
 *                                       JSON Emitter                                     *
 \****************************************************************************************/
@@ -4123,6 +5538,34 @@ icvJSONWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
 *                              Common High-Level Functions                               *
 \****************************************************************************************/
 
+// checks for the ".cvbin" extension, possibly followed by the compression suffix
+static bool
+icvHasBinaryExtension( const char* filename )
+{
+    std::string name( filename );
+    size_t dot = name.rfind( '.' );
+    if( dot != std::string::npos && name.compare( dot, 3, ".gz" ) == 0 &&
+        (dot + 3 == name.size() || (dot + 4 == name.size() && cv_isdigit(name[dot + 3]))) )
+        name.resize( dot );
+    dot = name.rfind( '.' );
+    return dot != std::string::npos && cv_strcasecmp( name.c_str() + dot, ".cvbin" );
+}
+
+
+// checks whether an existing file starts with the binary storage signature
+static bool
+icvHasBinarySignature( const char* filename )
+{
+    char buf[sizeof(icvBinarySignature)] = {0};
+    FILE* f = fopen( filename, "rb" );
+    if( !f )
+        return false;
+    size_t count = fread( buf, 1, sizeof(buf), f );
+    fclose( f );
+    return count == sizeof(buf) && memcmp( buf, icvBinarySignature, sizeof(buf) ) == 0;
+}
+
+
 CV_IMPL CvFileStorage*
 cvOpenFileStorage( const char* query, CvMemStorage* dststorage, int flags, const char* encoding )
 {
@@ -4159,6 +5602,13 @@ cvOpenFileStorage( const char* query, CvMemStorage* dststorage, int flags, const
     if( mem && append )
         CV_Error( CV_StsBadFlag, "CV_STORAGE_APPEND and CV_STORAGE_MEMORY are not currently compatible" );
 
+    bool binary = (write_mode || append) &&
+        ((flags & CV_STORAGE_FORMAT_MASK) == CV_STORAGE_FORMAT_BINARY ||
+         ((flags & CV_STORAGE_FORMAT_MASK) == CV_STORAGE_FORMAT_AUTO && filename && icvHasBinaryExtension( filename )) ||
+         (append && icvHasBinarySignature( filename )));
+    if( binary && (mem || append) )
+        CV_Error( CV_StsNotImplemented, "The binary file storage can only be written to a new file" );
+
     fs = (CvFileStorage*)cvAlloc( sizeof(*fs) );
     memset( fs, 0, sizeof(*fs));
 
@@ -4192,7 +5642,7 @@ cvOpenFileStorage( const char* query, CvMemStorage* dststorage, int flags, const
 
         if( !isGZ )
         {
-            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : !append ? "wt" : "a+t" );
+            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : binary ? "wb" : !append ? "wt" : "a+t" );
             if( !fs->file )
                 goto _exit_;
         }
@@ -4222,7 +5672,11 @@ cvOpenFileStorage( const char* query, CvMemStorage* dststorage, int flags, const
         if( mem )
             fs->outbuf = new std::deque<char>;
 
-        if( fmt == CV_STORAGE_FORMAT_AUTO && filename )
+        if( binary )
+        {
+            fs->fmt = CV_STORAGE_FORMAT_BINARY;
+        }
+        else if( fmt == CV_STORAGE_FORMAT_AUTO && filename )
         {
             const char* dot_pos = strrchr( filename, '.' );
             fs->fmt
@@ -4352,6 +5806,22 @@ cvOpenFileStorage( const char* query, CvMemStorage* dststorage, int flags, const
             fs->write_comment = icvYMLWriteComment;
             fs->start_next_stream = icvYMLStartNextStream;
         }
+        else if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+        {
+            // the raw data is always written as is
+            fs->is_default_using_base64 = false;
+            fs->binary_writer = new CvFSBinaryWriter;
+            icvBinaryWrite( fs, icvBinarySignature, sizeof(icvBinarySignature) );
+            icvBinaryWriteValue( fs, (unsigned)CV_FS_BINARY_BYTE_ORDER );
+            icvBinaryWriteValue( fs, (unsigned)CV_FS_BINARY_VERSION );
+            fs->start_write_struct = icvBinaryStartWriteStruct;
+            fs->end_write_struct = icvBinaryEndWriteStruct;
+            fs->write_int = icvBinaryWriteInt;
+            fs->write_real = icvBinaryWriteReal;
+            fs->write_string = icvBinaryWriteString;
+            fs->write_comment = icvBinaryWriteComment;
+            fs->start_next_stream = icvBinaryStartNextStream;
+        }
         else
         {
             if( !append )
@@ -4412,7 +5882,13 @@ cvOpenFileStorage( const char* query, CvMemStorage* dststorage, int flags, const
         char* bufPtr = cv_skip_BOM(buf);
         size_t bufOffset = bufPtr - buf;
 
-        if(strncmp( bufPtr, yaml_signature, strlen(yaml_signature) ) == 0)
+        if(strncmp( bufPtr, icvBinarySignature, sizeof(icvBinarySignature) ) == 0)
+        {
+            if( mem )
+                CV_Error(CV_BADARG_ERR, "The binary file storage can not be read from memory");
+            fs->fmt = CV_STORAGE_FORMAT_BINARY;
+        }
+        else if(strncmp( bufPtr, yaml_signature, strlen(yaml_signature) ) == 0)
             fs->fmt = CV_STORAGE_FORMAT_YAML;
         else if(strncmp( bufPtr, json_signature, strlen(json_signature) ) == 0)
             fs->fmt = CV_STORAGE_FORMAT_JSON;
@@ -4444,33 +5920,68 @@ cvOpenFileStorage( const char* query, CvMemStorage* dststorage, int flags, const
         fs->roots = cvCreateSeq( 0, sizeof(CvSeq),
                         sizeof(CvFileNode), fs->memstorage );
 
-        fs->buffer = fs->buffer_start = (char*)cvAlloc( buf_size + 256 );
-        fs->buffer_end = fs->buffer_start + buf_size;
-        fs->buffer[0] = '\n';
-        fs->buffer[1] = '\0';
-
-        //mode = cvGetErrMode();
-        //cvSetErrMode( CV_ErrModeSilent );
-        try
+        // in the lazy mode only the top-level nodes and the elements of the top-level plain maps
+        // are indexed here, when the file allows it
+        bool indexed = false;
+        if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
         {
-            switch (fs->fmt)
+            // the binary storage is always indexed; the nodes are read from the loaded file
+            try
+            {
+                indexed = icvLazyOpen( fs, icvBinaryLoad( fs ) );
+                fs->lazy->share_mats = (flags & CV_STORAGE_LAZY) != 0;
+                if( !(flags & CV_STORAGE_LAZY) )
+                    icvLazyLoad( fs, 0, 0, 0 );
+            }
+            catch (...)
             {
-            case CV_STORAGE_FORMAT_XML : { icvXMLParse ( fs ); break; }
-            case CV_STORAGE_FORMAT_YAML: { icvYMLParse ( fs ); break; }
-            case CV_STORAGE_FORMAT_JSON: { icvJSONParse( fs ); break; }
-            default: break;
+                cvReleaseFileStorage( &fs );
+                throw;
             }
         }
-        catch (...)
+        else if( (flags & CV_STORAGE_LAZY) && !mem && !isGZ )
         {
-            cvReleaseFileStorage( &fs );
-            throw;
+            try
+            {
+                indexed = icvLazyOpen( fs, cv::mapFileData( fs->filename, cv::MAP_MAT_READ_ONLY ) );
+            }
+            catch (...)
+            {
+                cvReleaseFileStorage( &fs );
+                throw;
+            }
         }
-        //cvSetErrMode( mode );
 
-        // release resources that we do not need anymore
-        cvFree( &fs->buffer_start );
-        fs->buffer = fs->buffer_end = 0;
+        if( !indexed )
+        {
+            fs->buffer = fs->buffer_start = (char*)cvAlloc( buf_size + 256 );
+            fs->buffer_end = fs->buffer_start + buf_size;
+            fs->buffer[0] = '\n';
+            fs->buffer[1] = '\0';
+
+            //mode = cvGetErrMode();
+            //cvSetErrMode( CV_ErrModeSilent );
+            try
+            {
+                switch (fs->fmt)
+                {
+                case CV_STORAGE_FORMAT_XML : { icvXMLParse ( fs ); break; }
+                case CV_STORAGE_FORMAT_YAML: { icvYMLParse ( fs ); break; }
+                case CV_STORAGE_FORMAT_JSON: { icvJSONParse( fs ); break; }
+                default: break;
+                }
+            }
+            catch (...)
+            {
+                cvReleaseFileStorage( &fs );
+                throw;
+            }
+            //cvSetErrMode( mode );
+
+            // release resources that we do not need anymore
+            cvFree( &fs->buffer_start );
+            fs->buffer = fs->buffer_end = 0;
+        }
     }
     fs->is_opened = true;
 
@@ -4499,6 +6010,11 @@ cvStartWriteStruct( CvFileStorage* fs, const char* key, int struct_flags,
                     const char* type_name, CvAttrList /*attributes*/ )
 {
     CV_CHECK_OUTPUT_FILE_STORAGE(fs);
+    if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+    {
+        fs->start_write_struct( fs, key, struct_flags, type_name );
+        return;
+    }
     check_if_write_struct_is_delayed( fs );
     if ( fs->state_of_writing_base64 == base64::fs::NotUse )
         switch_to_Base64_state( fs, base64::fs::Uncertain );
@@ -4548,6 +6064,11 @@ CV_IMPL void
 cvEndWriteStruct( CvFileStorage* fs )
 {
     CV_CHECK_OUTPUT_FILE_STORAGE(fs);
+    if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+    {
+        fs->end_write_struct( fs );
+        return;
+    }
     check_if_write_struct_is_delayed( fs );
 
     if ( fs->state_of_writing_base64 != base64::fs::Uncertain )
@@ -4598,7 +6119,6 @@ cvStartNextStream( CvFileStorage* fs )
 
 
 static const char icvTypeSymbol[] = "ucwsifdr";
-#define CV_FS_MAX_FMT_PAIRS  128
 
 static char*
 icvEncodeFormat( int elem_type, char* dt )
@@ -4727,9 +6247,28 @@ icvDecodeSimpleFormat( const char* dt )
 }
 
 
+// checks whether two format strings describe the same layout ("u" and "1u", for example)
+static bool
+icvIsSameFormat( const char* dt1, const char* dt2 )
+{
+    int fmt_pairs1[CV_FS_MAX_FMT_PAIRS*2], fmt_pairs2[CV_FS_MAX_FMT_PAIRS*2];
+    if( !dt1 || !dt2 )
+        return false;
+    int fmt_pair_count = icvDecodeFormat( dt1, fmt_pairs1, CV_FS_MAX_FMT_PAIRS );
+    return fmt_pair_count == icvDecodeFormat( dt2, fmt_pairs2, CV_FS_MAX_FMT_PAIRS ) &&
+        memcmp( fmt_pairs1, fmt_pairs2, fmt_pair_count*2*sizeof(fmt_pairs1[0]) ) == 0;
+}
+
+
 CV_IMPL void
 cvWriteRawData( CvFileStorage* fs, const void* _data, int len, const char* dt )
 {
+    if( fs && fs->fmt == CV_STORAGE_FORMAT_BINARY )
+    {
+        CV_CHECK_OUTPUT_FILE_STORAGE( fs );
+        icvBinaryWriteRawData( fs, _data, len, dt );
+        return;
+    }
     if (fs->is_default_using_base64 ||
         fs->state_of_writing_base64 == base64::fs::InUse )
     {
@@ -4859,6 +6398,7 @@ cvStartReadRawData( const CvFileStorage* fs, const CvFileNode* src, CvSeqReader*
     }
     else if( node_type == CV_NODE_SEQ )
     {
+        icvExpandBlob( src );
         cvStartReadSeq( src->data.seq, reader, 0 );
     }
     else if( node_type == CV_NODE_NONE )
@@ -5028,6 +6568,20 @@ cvReadRawData( const CvFileStorage* fs, const CvFileNode* src,
     if( !src || !data )
         CV_Error( CV_StsNullPtr, "Null pointers to source file node or destination array" );
 
+    CvFileNodeBlob* blob = icvGetBlob( src );
+    if( blob && icvIsSameFormat( blob->dt.ptr, dt ) )
+    {
+        // the data read from a binary storage has the requested layout already
+        size_t step = (size_t)icvCalcStructSize( dt, 0 );
+        uchar* dst = (uchar*)data;
+        for( CvFileNodeBlobSegment* seg = blob->head; seg != 0; seg = seg->next )
+        {
+            memcpy( dst, seg->data, seg->count*step );
+            dst += seg->count*step;
+        }
+        return;
+    }
+
     cvStartReadRawData( fs, src, &reader );
     cvReadRawDataSlice( fs, &reader, CV_NODE_IS_SEQ(src->tag) ?
                         src->data.seq->total : 1, data, dt );
@@ -5040,6 +6594,7 @@ icvWriteFileNode( CvFileStorage* fs, const char* name, const CvFileNode* node );
 static void
 icvWriteCollection( CvFileStorage* fs, const CvFileNode* node )
 {
+    icvExpandBlob( node );
     int i, total = node->data.seq->total;
     int elem_size = node->data.seq->elem_size;
     int is_map = CV_NODE_IS_MAP(node->tag);
@@ -5187,6 +6742,9 @@ icvWriteMat( CvFileStorage* fs, const char* name,
 static int
 icvFileNodeSeqLen( CvFileNode* node )
 {
+    CvFileNodeBlob* blob = icvGetBlob( node );
+    if( blob )
+        return blob->nscalars;
     return CV_NODE_IS_COLLECTION(node->tag) ? node->data.seq->total :
         CV_NODE_TYPE(node->tag) != CV_NODE_NONE;
 }
@@ -6969,6 +8527,7 @@ FileNode FileNode::operator[](const char* nodename) const
 
 FileNode FileNode::operator[](int i) const
 {
+    icvExpandBlob( node );
     return isSeq() ? FileNode(fs, (CvFileNode*)cvGetSeqElem(node->data.seq, i)) :
         i == 0 ? *this : FileNode();
 }
@@ -7004,6 +8563,9 @@ FileNodeIterator::FileNodeIterator(const CvFileStorage* _fs,
         container = _node;
         if( !(_node->tag & FileNode::USER) && (node_type == FileNode::SEQ || node_type == FileNode::MAP) )
         {
+            if( icvIsLazy( _fs ) )
+                icvLazyLoad( (CvFileStorage*)_fs, _node, 0, 0 );
+            icvExpandBlob( _node );
             cvStartReadSeq( _node->data.seq, (CvSeqReader*)&reader );
             remaining = FileNode(_fs, _node).size();
         }
@@ -7201,6 +8763,54 @@ internal::WriteStructContext::~WriteStructContext()
 }
 
 
+// makes the matrix refer to the data of a binary storage opened with FileStorage::LAZY
+static bool icvReadSharedMat( const CvFileStorage* fs, const CvFileNode* node, Mat& mat )
+{
+    CvFileStorageLazyIndex* lazy = fs ? fs->lazy : 0;
+    if( !lazy || !lazy->share_mats || !CV_NODE_IS_MAP(node->tag) || !node->info )
+        return false;
+    bool is_mat = strcmp( node->info->type_name, CV_TYPE_NAME_MAT ) == 0;
+    if( !is_mat && strcmp( node->info->type_name, CV_TYPE_NAME_MATND ) != 0 )
+        return false;
+
+    const char* dt = cvReadStringByName( fs, node, "dt", 0 );
+    CvFileNodeBlob* blob = icvGetBlob( cvGetFileNodeByName( fs, node, "data" ) );
+    if( !dt || !blob || !blob->head || blob->head != blob->tail || !icvIsSameFormat( blob->dt.ptr, dt ) )
+        return false;
+
+    int i, dims = 2, sizes[CV_MAX_DIM], type = icvDecodeSimpleFormat( dt );
+    if( is_mat )
+    {
+        sizes[0] = cvReadIntByName( fs, node, "rows", -1 );
+        sizes[1] = cvReadIntByName( fs, node, "cols", -1 );
+    }
+    else
+    {
+        CvFileNode* sizes_node = cvGetFileNodeByName( fs, node, "sizes" );
+        dims = sizes_node ? icvFileNodeSeqLen( sizes_node ) : 0;
+        if( dims <= 0 || dims > CV_MAX_DIM )
+            return false;
+        cvReadRawData( fs, sizes_node, sizes, "i" );
+    }
+
+    // anything unusual is reported by the regular code path
+    size_t total = CV_MAT_CN(type);
+    for( i = 0; i < dims; i++ )
+    {
+        if( sizes[i] <= 0 )
+            return false;
+        total *= sizes[i];
+    }
+    if( total != (size_t)blob->nscalars )
+        return false;
+
+    Mat m( dims, sizes, type, (void*)blob->head->data );
+    m.u = lazy->u;
+    CV_XADD( &m.u->refcount, 1 );
+    mat = m;
+    return true;
+}
+
 void read( const FileNode& node, Mat& mat, const Mat& default_mat )
 {
     if( node.empty() )
@@ -7208,6 +8818,8 @@ void read( const FileNode& node, Mat& mat, const Mat& default_mat )
         default_mat.copyTo(mat);
         return;
     }
+    if( icvReadSharedMat( node.fs, *node, mat ) )
+        return;
     void* obj = cvRead((CvFileStorage*)node.fs, (CvFileNode*)*node);
     if(CV_IS_MAT_HDR_Z(obj))
     {
@@ -7303,6 +8915,9 @@ bool FileNode::isNamed() const { return !node ? false : (node->tag & NAMED) != 0
 
 size_t FileNode::size() const
 {
+    if( fs && node && icvIsLazy( fs ) )
+        icvLazyLoad( (CvFileStorage*)fs, node, 0, 0 );
+    icvExpandBlob( node );
     int t = type();
     return t == MAP ? (size_t)((CvSet*)node->data.map)->active_count :
         t == SEQ ? (size_t)node->data.seq->total : (size_t)!isNone();
@@ -8255,6 +9870,13 @@ void base64::cvWriteRawDataBase64(::CvFileStorage* fs, const void* _data, int le
     CV_Assert(fs);
     CV_CHECK_OUTPUT_FILE_STORAGE(fs);
 
+    if ( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+    {
+        /* the binary storage keeps the raw data without any encoding */
+        icvBinaryWriteRawData( fs, _data, len, dt );
+        return;
+    }
+
     check_if_write_struct_is_delayed( fs, true );
 
     if ( fs->state_of_writing_base64 == base64::fs::Uncertain )
@@ -304,6 +304,20 @@ extern bool __termination; // skip some cleanups, because process is terminating
 
 cv::Mutex& getInitializationMutex();
 
+// reads a size from the environment variable, "KB" and "MB" suffixes are accepted
+size_t getConfigurationParameterForSize(const char* name, size_t defaultValue);
+
+// maps the whole file (see MapMatFileFlags), returns NULL if the file can't be opened;
+// the mapping is released when the reference counter of the returned UMatData drops to zero
+UMatData* mapFileData(const String& filename, int flags);
+
+// frees the DFT plans cached by all the threads (see cv::dft)
+void releaseDftPlans();
+
+// the number of CPUs the pool of the calling thread is pinned to, 0 if it isn't pinned;
+// unlike getThreadAffinity() it takes no lock and doesn't copy the list
+int getThreadAffinitySize();
+
 // TODO Memory barriers?
 #define CV_SINGLETON_LAZY_INIT_(TYPE, INITIALIZER, RET_VALUE) \
     static TYPE* volatile instance = NULL; \
@@ -43,6 +43,9 @@
 
 #include "precomp.hpp"
 
+#include "split.simd.hpp"
+#include "split.simd_declarations.hpp" // generated by ocv_add_dispatched_file(), see CMakeLists.txt
+
 namespace cv { namespace hal {
 
 #if CV_NEON
@@ -263,6 +266,32 @@ SPLIT4_KERNEL_TEMPLATE(   int,  __m128,   float, _mm_deinterleave_ps, ps);
 
 #endif
 
+#if CV_SSE2
+
+// the 256-bit kernels from split.simd.hpp for the CPUs that support them
+static int splitWide(const uchar* src, uchar** dst, int len, int cn)
+{
+    CV_CPU_DISPATCH(splitWide, (src, dst, len, cn));
+}
+
+static int splitWide(const ushort* src, ushort** dst, int len, int cn)
+{
+    CV_CPU_DISPATCH(splitWide, (src, dst, len, cn));
+}
+
+static int splitWide(const int* src, int** dst, int len, int cn)
+{
+    CV_CPU_DISPATCH(splitWide, (src, dst, len, cn));
+}
+
+template<typename T> static inline int
+splitWide(const T*, T**, int, int)
+{
+    return 0;
+}
+
+#endif
+
 template<typename T> static void
 split_( const T* src, T** dst, int len, int cn )
 {
@@ -338,6 +367,9 @@ split_( const T* src, T** dst, int len, int cn )
             int inc_i = 32/sizeof(T);
             int inc_j = 3 * inc_i;
 
+            i = splitWide(src, dst, len, cn);
+            j = i * cn;
+
             VSplit3<T> vsplit;
 
             if (vsplit.support)
@@ -375,6 +407,9 @@ split_( const T* src, T** dst, int len, int cn )
             int inc_i = 32/sizeof(T);
             int inc_j = 4 * inc_i;
 
+            i = splitWide(src, dst, len, cn);
+            j = i * cn;
+
             VSplit4<T> vsplit;
             if (vsplit.support)
             {
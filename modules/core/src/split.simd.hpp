@@ -0,0 +1,131 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+// The 256-bit kernels of cv::split. The file is compiled into the regular build (the cpu_baseline
+// namespace, via split.cpp) and once more for each instruction set listed in
+// ocv_add_dispatched_file() of modules/core/CMakeLists.txt. Without CV_SIMD256 the functions
+// process nothing, so split_() goes on with the 128-bit kernels from the beginning of the row.
+
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv { namespace hal {
+CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN
+
+// split the first len pixels of a 3- or 4-channel row as far as the 256-bit kernels go,
+// returns the number of processed pixels
+int splitWide(const uchar* src, uchar** dst, int len, int cn);
+int splitWide(const ushort* src, ushort** dst, int len, int cn);
+int splitWide(const int* src, int** dst, int len, int cn);
+
+#ifndef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+#if CV_SIMD256
+
+// the kernels consume the same 32 bytes per channel as the SSE ones in split.cpp;
+// only the layouts where they are measurably faster are enabled
+
+template<typename T, typename VT> static int
+splitWide3_( const T* src, T** dst, int len )
+{
+    T *dst0 = dst[0], *dst1 = dst[1], *dst2 = dst[2];
+    const int inc_i = VT::nlanes;
+    int i = 0;
+
+    for( ; i <= len - inc_i; i += inc_i, src += inc_i*3 )
+    {
+        VT a, b, c;
+        v_load_deinterleave(src, a, b, c);
+        v_store(dst0 + i, a);
+        v_store(dst1 + i, b);
+        v_store(dst2 + i, c);
+    }
+    return i;
+}
+
+template<typename T, typename VT> static int
+splitWide4_( const T* src, T** dst, int len )
+{
+    T *dst0 = dst[0], *dst1 = dst[1], *dst2 = dst[2], *dst3 = dst[3];
+    const int inc_i = VT::nlanes;
+    int i = 0;
+
+    for( ; i <= len - inc_i; i += inc_i, src += inc_i*4 )
+    {
+        VT a, b, c, d;
+        v_load_deinterleave(src, a, b, c, d);
+        v_store(dst0 + i, a);
+        v_store(dst1 + i, b);
+        v_store(dst2 + i, c);
+        v_store(dst3 + i, d);
+    }
+    return i;
+}
+
+int splitWide(const uchar* src, uchar** dst, int len, int cn)
+{
+    return cn == 4 ? splitWide4_<uchar, v_uint8x32>(src, dst, len) : 0;
+}
+
+int splitWide(const ushort* src, ushort** dst, int len, int cn)
+{
+    return cn == 3 ? splitWide3_<ushort, v_uint16x16>(src, dst, len) :
+           cn == 4 ? splitWide4_<ushort, v_uint16x16>(src, dst, len) : 0;
+}
+
+int splitWide(const int* src, int** dst, int len, int cn)
+{
+    return cn == 3 ? splitWide3_<int, v_int32x8>(src, dst, len) :
+           cn == 4 ? splitWide4_<int, v_int32x8>(src, dst, len) : 0;
+}
+
+#else
+
+int splitWide(const uchar*, uchar**, int, int) { return 0; }
+int splitWide(const ushort*, ushort**, int, int) { return 0; }
+int splitWide(const int*, int**, int, int) { return 0; }
+
+#endif
+
+#endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+CV_CPU_OPTIMIZATION_NAMESPACE_END
+}} // cv::hal::
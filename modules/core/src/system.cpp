@@ -56,6 +56,36 @@ Mutex& getInitializationMutex()
 // force initialization (single-threaded environment)
 Mutex* __initialization_mutex_initializer = &getInitializationMutex();
 
+size_t getConfigurationParameterForSize(const char* name, size_t defaultValue)
+{
+#ifdef NO_GETENV
+    const char* envValue = NULL;
+#else
+    const char* envValue = getenv(name);
+#endif
+    if (envValue == NULL)
+    {
+        return defaultValue;
+    }
+    cv::String value = envValue;
+    size_t pos = 0;
+    for (; pos < value.size(); pos++)
+    {
+        if (!isdigit(value[pos]))
+            break;
+    }
+    cv::String valueStr = value.substr(0, pos);
+    cv::String suffixStr = value.substr(pos, value.length() - pos);
+    size_t v = (size_t)atol(valueStr.c_str());
+    if (suffixStr.length() == 0)
+        return v;
+    else if (suffixStr == "MB" || suffixStr == "Mb" || suffixStr == "mb")
+        return v * 1024 * 1024;
+    else if (suffixStr == "KB" || suffixStr == "Kb" || suffixStr == "kb")
+        return v * 1024;
+    CV_ErrorNoReturn(cv::Error::StsBadArg, cv::format("Invalid value for %s parameter: %s", name, value.c_str()));
+}
+
 } // namespace cv
 
 #ifdef _MSC_VER
@@ -1329,11 +1359,33 @@ InstrNode* getTrace()
 #endif
 }
 
+#ifdef ENABLE_INSTRUMENTATION
+// drops the regions recorded before the last resetTrace() call; mutexTimeline must be locked
+static void clearInstrumentTimeline(InstrTimeline* pTimeline)
+{
+    InstrStruct& instr = getInstrumentStruct();
+    pTimeline->written = 0;
+    if(pTimeline->events.size() != (size_t)instr.timelineCapacity)
+        std::vector<InstrTimelineEvent>(instr.timelineCapacity).swap(pTimeline->events);
+    pTimeline->generation = instr.timelineGeneration;
+}
+#endif
+
 void resetTrace()
 {
 #ifdef ENABLE_INSTRUMENTATION
-    getInstrumentStruct().rootNode.removeChilds();
-    getInstrumentTLSStruct().pCurrentNode = &getInstrumentStruct().rootNode;
+    InstrStruct& instr = getInstrumentStruct();
+    instr.rootNode.removeChilds();
+    getInstrumentTLSStruct().pCurrentNode = &instr.rootNode;
+
+    // the recorded regions refer to the names stored in the removed nodes; the buffers of the other
+    // threads may be written concurrently, so each thread clears its own one on the next region,
+    // and until then the buffer is ignored by dumpTimeline()
+    cv::AutoLock lock(instr.mutexTimeline);
+    CV_XADD(&instr.timelineGeneration, 1);
+    InstrTimeline* pTimeline = getInstrumentTLSStruct().pTimeline;
+    if(pTimeline)
+        clearInstrumentTimeline(pTimeline);
 #endif
 }
 
@@ -1354,6 +1406,103 @@ FLAGS getFlags()
 #endif
 }
 
+void setTimelineCapacity(int regions)
+{
+#ifdef ENABLE_INSTRUMENTATION
+    CV_Assert(regions > 0);
+    cv::AutoLock lock(getInstrumentStruct().mutexTimeline);
+    getInstrumentStruct().timelineCapacity = regions;
+#else
+    CV_UNUSED(regions);
+#endif
+}
+
+#ifdef ENABLE_INSTRUMENTATION
+static void writeJSONString(FILE* f, const char* str)
+{
+    fputc('"', f);
+    for(; str && *str; str++)
+    {
+        uchar c = (uchar)*str;
+        if(c == '"' || c == '\\')
+            fprintf(f, "\\%c", c);
+        else if(c < ' ')
+            fprintf(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    }
+    fputc('"', f);
+}
+#endif
+
+bool dumpTimeline(const String& filename)
+{
+#ifdef ENABLE_INSTRUMENTATION
+    static const char* typeNames[] = { "general", "marker", "wrapper", "function" };
+    static const char* implNames[] = { "plain", "ipp", "opencl" };
+
+    InstrStruct& instr = getInstrumentStruct();
+    cv::AutoLock lock(instr.mutexTimeline);
+
+    // the events of every thread are taken from its ring buffer, from the oldest to the newest one
+    std::vector<std::pair<int, std::vector<InstrTimelineEvent> > > threads(instr.timelines.size());
+    uint64 start = 0, dropped = 0;
+    bool first = true;
+    for(size_t i = 0; i < instr.timelines.size(); i++)
+    {
+        const InstrTimeline* pTimeline = instr.timelines[i];
+        uint64 written = pTimeline->generation == instr.timelineGeneration ? pTimeline->written : 0;
+        uint64 capacity = pTimeline->events.size();
+        uint64 count = std::min(written, capacity);
+        threads[i].first = pTimeline->threadId;
+        threads[i].second.reserve((size_t)count);
+        for(uint64 j = written - count; j < written; j++)
+        {
+            const InstrTimelineEvent& e = pTimeline->events[(size_t)(j % capacity)];
+            threads[i].second.push_back(e);
+            if(first || e.begin < start)
+                start = e.begin;
+            first = false;
+        }
+        dropped += written - count;
+    }
+
+    FILE* f = fopen(filename.c_str(), "wt");
+    if(!f)
+        return false;
+
+    double scale = 1e6/getTickFrequency(); // ticks to microseconds
+    fprintf(f, "{\"traceEvents\":[\n");
+    for(size_t i = 0; i < threads.size(); i++)
+    {
+        int tid = threads[i].first;
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                i == 0 ? "" : ",\n", tid, tid);
+        for(size_t j = 0; j < threads[i].second.size(); j++)
+        {
+            const InstrTimelineEvent& e = threads[i].second[j];
+            const char* impl = implNames[e.implType];
+            fprintf(f, ",\n{\"name\":");
+            writeJSONString(f, e.name);
+            if(e.instrType == TYPE_MARKER)
+                fprintf(f, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f", (e.begin - start)*scale);
+            else
+                fprintf(f, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", (e.begin - start)*scale, (e.end - e.begin)*scale);
+            fprintf(f, ",\"cat\":\"%s\",\"pid\":0,\"tid\":%d,\"args\":{\"type\":\"%s\",\"impl\":\"%s\"}}",
+                    impl, tid, typeNames[e.instrType], impl);
+        }
+    }
+    fprintf(f, "\n],\n\"displayTimeUnit\":\"ms\",\n\"otherData\":{\"version\":\"%s\",\"dropped_regions\":\"%llu\"}}\n",
+            CV_VERSION, (unsigned long long)dropped);
+    bool ok = !ferror(f);
+    ok = fclose(f) == 0 && ok;
+    return ok;
+#else
+    CV_UNUSED(filename);
+    return false;
+#endif
+}
+
 NodeData::NodeData(const char* funName, const char* fileName, int lineNum, void* retAddress, bool alwaysExpand, cv::instr::TYPE instrType, cv::instr::IMPL implType)
 {
     m_funName       = funName;
@@ -1422,6 +1571,25 @@ InstrNode* getCurrentNode()
     return getInstrumentTLSStruct().pCurrentNode;
 }
 
+InstrTimeline* getInstrumentTimeline()
+{
+    InstrTLSStruct* pTLS = &getInstrumentTLSStruct();
+    InstrStruct* pStruct = &getInstrumentStruct();
+    if(!pTLS->pTimeline)
+    {
+        cv::AutoLock guard(pStruct->mutexTimeline);
+        pTLS->pTimeline = new InstrTimeline((int)pStruct->timelines.size(), pStruct->timelineCapacity, pStruct->timelineGeneration);
+        pStruct->timelines.push_back(pTLS->pTimeline);
+    }
+    else if(pTLS->pTimeline->generation != pStruct->timelineGeneration)
+    {
+        // resetTrace() has been called since the last region of this thread
+        cv::AutoLock guard(pStruct->mutexTimeline);
+        clearInstrumentTimeline(pTLS->pTimeline);
+    }
+    return pTLS->pTimeline;
+}
+
 IntrumentationRegion::IntrumentationRegion(const char* funName, const char* fileName, int lineNum, void *retAddress, bool alwaysExpand, TYPE instrType, IMPL implType)
 {
     m_disabled    = false;
@@ -1491,7 +1659,8 @@ IntrumentationRegion::~IntrumentationRegion()
                 cv::ocl::finish(); // TODO Support "async" OpenCL instrumentation
             }
 
-            uint64 ticks = (getTickCount() - m_regionTicks);
+            uint64 regionEnd = getTickCount();
+            uint64 ticks = (regionEnd - m_regionTicks);
             {
                 cv::AutoLock guard(pStruct->mutexCount); // Concurrent ticks accumulation
                 pTLS->pCurrentNode->m_payload.m_counter++;
@@ -1499,6 +1668,21 @@ IntrumentationRegion::~IntrumentationRegion()
                 pTLS->pCurrentNode->m_payload.m_tls.get()->m_ticksTotal += ticks;
             }
 
+            if(pStruct->flags&FLAGS_TIMELINE)
+            {
+                // No synchronization: the buffer belongs to this thread, dumpTimeline() takes the written events only
+                InstrTimeline* pTimeline = getInstrumentTimeline();
+                const NodeData& payload = pTLS->pCurrentNode->m_payload;
+                InstrTimelineEvent& e = pTimeline->events[(size_t)(pTimeline->written % pTimeline->events.size())];
+                e.name      = payload.m_funName.c_str();
+                e.begin     = m_regionTicks;
+                e.end       = regionEnd;
+                e.instrType = payload.m_instrType;
+                e.implType  = payload.m_implType;
+                CV_XADD(&pTimeline->sync, 1); // full barrier, the event is complete before it is counted
+                pTimeline->written++;
+            }
+
             pTLS->pCurrentNode = pTLS->pCurrentNode->m_pParent;
         }
     }
@@ -986,3 +986,106 @@ protected:
 
 TEST(Core_DFT, reverse) { Core_DXTReverseTest test(Core_DXTReverseTest::ModeDFT); test.safe_run(); }
 TEST(Core_DCT, reverse) { Core_DXTReverseTest test(Core_DXTReverseTest::ModeDCT); test.safe_run(); }
+
+TEST(Core_DFT, plan_cache)
+{
+    RNG& rng = theRNG();
+    const int flags[] = { 0, DFT_ROWS, DFT_SCALE, DFT_COMPLEX_OUTPUT, DFT_ROWS | DFT_COMPLEX_OUTPUT };
+
+    // the same transforms are interleaved with others, their results should not change
+    for (int iter = 0; iter < 3; iter++)
+    {
+        for (int i = 0; i < 40; i++)
+        {
+            int type = i % 2 ? CV_64FC1 : CV_32FC2;
+            int f = flags[i % 5];
+            Size sz(i % 7 + 1, i % 5 + 1);
+            if (CV_MAT_CN(type) == 2)
+                f &= ~DFT_COMPLEX_OUTPUT;
+
+            Mat big(sz.height + 2, sz.width + 3, type), src, dst, inv, expected;
+            rng.fill(big, RNG::UNIFORM, -1, 1);
+            src = big(Rect(1, 1, sz.width, sz.height)).clone();
+            dft(src, expected, f);
+
+            // not continuous input
+            dft(big(Rect(1, 1, sz.width, sz.height)), dst, f);
+            EXPECT_LE(cvtest::norm(expected, dst, NORM_INF), 1e-5) << sz << " flags=" << f;
+
+            // in-place
+            if (expected.type() == type)
+            {
+                dst = src.clone();
+                dft(dst, dst, f);
+                EXPECT_LE(cvtest::norm(expected, dst, NORM_INF), 1e-5) << sz << " flags=" << f;
+            }
+
+            // the first row only
+            if ((f & DFT_ROWS) != 0 && sz.width > 1)
+            {
+                dft(src, dst, f, 1);
+                EXPECT_LE(cvtest::norm(expected.row(0), dst.row(0), NORM_INF), 1e-5) << sz << " flags=" << f;
+            }
+
+            dft(expected, inv, DFT_INVERSE | DFT_SCALE | (f & DFT_ROWS) |
+                (CV_MAT_CN(type) == 1 ? DFT_REAL_OUTPUT : 0));
+            Mat ref = src;
+            if ((f & DFT_SCALE) != 0)
+            {
+                double scale = (f & DFT_ROWS) ? sz.width : sz.area();
+                src.convertTo(ref, -1, 1./scale);
+            }
+            EXPECT_LE(cvtest::norm(ref, inv, NORM_INF), 1e-5) << sz << " flags=" << f;
+        }
+
+        // setNumThreads() frees the cached plans
+        if (iter == 1)
+            setNumThreads(getNumThreads());
+    }
+
+    // the plan of a transform which is bigger than the cache limit is used once and dropped
+    Mat src(1, 1 << 20, CV_64FC2), dst1, dst2;
+    rng.fill(src, RNG::UNIFORM, -1, 1);
+    dft(src, dst1);
+    dft(src, dst2);
+    EXPECT_EQ(0, cvtest::norm(dst1, dst2, NORM_INF));
+}
+
+TEST(Core_DFT, batch)
+{
+    RNG& rng = theRNG();
+    std::vector<Mat> src(9), dst, inv;
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        src[i].create(30, 45, CV_32F);
+        rng.fill(src[i], RNG::UNIFORM, -1, 1);
+    }
+
+    dftBatch(src, dst, DFT_COMPLEX_OUTPUT);
+    ASSERT_EQ(src.size(), dst.size());
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        Mat expected;
+        dft(src[i], expected, DFT_COMPLEX_OUTPUT);
+        ASSERT_EQ(expected.type(), dst[i].type());
+        EXPECT_EQ(0, cvtest::norm(expected, dst[i], NORM_INF));
+    }
+
+    // in-place
+    inv = dst;
+    dftBatch(inv, inv, DFT_INVERSE | DFT_SCALE);
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        EXPECT_EQ(dst[i].data, inv[i].data);
+        std::vector<Mat> planes;
+        split(inv[i], planes);
+        EXPECT_LE(cvtest::norm(src[i], planes[0], NORM_INF), 1e-5);
+    }
+
+    std::vector<Mat> empty;
+    dftBatch(empty, dst);
+    EXPECT_TRUE(dst.empty());
+
+    src.push_back(Mat(30, 44, CV_32F, Scalar::all(0)));
+    EXPECT_THROW(dftBatch(src, dst), cv::Exception);
+}
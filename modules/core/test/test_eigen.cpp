@@ -412,3 +412,128 @@ TEST(Core_Eigen, scalar_32) {Core_EigenTest_Scalar_32 test; test.safe_run(); }
 TEST(Core_Eigen, scalar_64) {Core_EigenTest_Scalar_64 test; test.safe_run(); }
 TEST(Core_Eigen, vector_32) { Core_EigenTest_32 test; test.safe_run(); }
 TEST(Core_Eigen, vector_64) { Core_EigenTest_64 test; test.safe_run(); }
+
+// checks src*v_i = w_i*v_i, the orthonormality of v_i and the descending order of w_i
+static void checkEigenPairs(const Mat& src, const Mat& w, const Mat& v, double eps)
+{
+    Mat src64, w64, v64;
+    src.convertTo(src64, CV_64F);
+    w.convertTo(w64, CV_64F);
+    v.convertTo(v64, CV_64F);
+    ASSERT_EQ(v64.rows, w64.rows);
+    ASSERT_EQ(v64.cols, src.cols);
+
+    double scale = norm(src64, NORM_INF);
+    Mat diff = src64*v64.t() - v64.t()*Mat::diag(w64);
+    EXPECT_LE(norm(diff, NORM_INF), eps*scale*src.rows);
+    EXPECT_LE(norm(Mat(v64*v64.t()), Mat::eye(v64.rows, v64.rows, CV_64F), NORM_INF), eps*src.rows);
+    for (int i = 1; i < w64.rows; i++)
+        EXPECT_GE(w64.at<double>(i-1), w64.at<double>(i));
+}
+
+static Mat makeSymmetricMat(int n, int type, RNG& rng)
+{
+    Mat a(n, n, CV_64F), src;
+    rng.fill(a, RNG::UNIFORM, -1, 1);
+    a += a.t();
+    a.convertTo(src, type);
+    return src;
+}
+
+TEST(Core_Eigen, large_symmetric)
+{
+    RNG& rng = theRNG();
+    for (int type = CV_32F; type <= CV_64F; type++)
+    {
+        Mat src = makeSymmetricMat(150, type, rng), w, v;
+        ASSERT_TRUE(eigen(src, w, v));
+        checkEigenPairs(src, w, v, type == CV_32F ? 1e-5 : 1e-13);
+    }
+}
+
+TEST(Core_Eigen, top_k)
+{
+    RNG& rng = theRNG();
+    const int sizes[] = { 16, 200 };
+    for (int i = 0; i < 2; i++)
+        for (int type = CV_32F; type <= CV_64F; type++)
+        {
+            int n = sizes[i], k = n/8 + 1;
+            Mat src = makeSymmetricMat(n, type, rng), w, v, wall, vall;
+            ASSERT_TRUE(eigen(src, w, v, k));
+            ASSERT_TRUE(eigen(src, wall, vall));
+            checkEigenPairs(src, w, v, type == CV_32F ? 1e-5 : 1e-13);
+
+            double eps = type == CV_32F ? 1e-4 : 1e-10;
+            EXPECT_LE(norm(w, wall.rowRange(0, k), NORM_INF), eps*n);
+
+            Mat wonly;
+            ASSERT_TRUE(eigen(src, wonly, noArray(), k));
+            EXPECT_LE(norm(w, wonly, NORM_INF), eps*n);
+        }
+}
+
+TEST(Core_Eigen, repeated_eigenvalues)
+{
+    const int n = 100;
+    RNG& rng = theRNG();
+    Mat q, w(n, 1, CV_64F), u, vt;
+    rng.fill(w, RNG::UNIFORM, -1, 1);
+    w.rowRange(0, 10).setTo(5);
+    w.rowRange(10, 30).setTo(3);
+    SVD::compute(makeSymmetricMat(n, CV_64F, rng), q, u, vt);
+    Mat src = u*Mat::diag(w)*u.t();
+    completeSymm(src);
+
+    Mat evals, evects;
+    ASSERT_TRUE(eigen(src, evals, evects));
+    checkEigenPairs(src, evals, evects, 1e-12);
+    ASSERT_TRUE(eigen(src, evals, evects, 25));
+    checkEigenPairs(src, evals, evects, 1e-12);
+    EXPECT_LE(norm(evals.rowRange(0, 10), Mat(10, 1, CV_64F, Scalar(5)), NORM_INF), 1e-12);
+    EXPECT_LE(norm(evals.rowRange(10, 25), Mat(15, 1, CV_64F, Scalar(3)), NORM_INF), 1e-12);
+}
+
+TEST(Core_LDA, generalized_eigenproblem)
+{
+    const int N = 300, D = 20, C = 4;
+    RNG& rng = theRNG();
+    Mat data(N, D, CV_64F);
+    std::vector<int> labels(N);
+    rng.fill(data, RNG::NORMAL, 0, 1);
+    for (int i = 0; i < N; i++)
+    {
+        labels[i] = i % C;
+        data.at<double>(i, labels[i]) += 3;
+    }
+
+    LDA lda(data, labels);
+    Mat w = lda.eigenvalues(), v = lda.eigenvectors();
+    ASSERT_EQ(C - 1, w.cols);
+    ASSERT_EQ(C - 1, v.cols);
+
+    // Sb*v = lambda*Sw*v
+    Mat mean, Sw = Mat::zeros(D, D, CV_64F), Sb = Mat::zeros(D, D, CV_64F);
+    reduce(data, mean, 0, REDUCE_AVG);
+    for (int c = 0; c < C; c++)
+    {
+        Mat samples;
+        for (int i = c; i < N; i += C)
+            samples.push_back(data.row(i));
+        Mat cmean, covar;
+        calcCovarMatrix(samples, covar, cmean, COVAR_NORMAL | COVAR_ROWS, CV_64F);
+        Sw += covar;
+        Mat d = cmean - mean;
+        Sb += d.t()*d;
+    }
+    for (int i = 0; i < w.cols; i++)
+    {
+        Mat x = v.col(i);
+        EXPECT_NEAR(1., norm(x), 1e-10);
+        EXPECT_LE(norm(Sb*x - w.at<double>(i)*(Sw*x)), 1e-8*norm(Sb));
+        if (i > 0)
+        {
+            EXPECT_GE(w.at<double>(i-1), w.at<double>(i));
+        }
+    }
+}
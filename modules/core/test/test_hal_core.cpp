@@ -120,6 +120,50 @@ TEST(Core_HAL, mathfuncs)
     }
 }
 
+// the variants of the functions dispatched at run time (see mathfuncs_core.simd.hpp) must agree
+// with the baseline ones, which are used when the optimizations are turned off
+TEST(Core_HAL, mathfuncs_dispatch)
+{
+    const int n = 1003; // not a multiple of any vector width, so the tails are covered too
+    bool prevUseOptimized = useOptimized();
+
+    for( int depth = CV_32F; depth <= CV_64F; depth++ )
+    {
+        double eps = depth == CV_32F ? 1e-5 : 1e-10;
+        Mat x(1, n, depth), y(1, n, depth), p(1, n, depth);
+        randu(x, -100, 100);
+        randu(y, -100, 100);
+        randu(p, 0.01, 100);
+
+        Mat dst[2][4];
+        for( int k = 0; k < 2; k++ )
+        {
+            setUseOptimized(k == 1);
+            for( int f = 0; f < 4; f++ )
+                dst[k][f].create(1, n, depth);
+            if( depth == CV_32F )
+            {
+                hal::fastAtan32f(y.ptr<float>(), x.ptr<float>(), dst[k][0].ptr<float>(), n, true);
+                hal::magnitude32f(x.ptr<float>(), y.ptr<float>(), dst[k][1].ptr<float>(), n);
+                hal::sqrt32f(p.ptr<float>(), dst[k][2].ptr<float>(), n);
+                hal::invSqrt32f(p.ptr<float>(), dst[k][3].ptr<float>(), n);
+            }
+            else
+            {
+                hal::fastAtan64f(y.ptr<double>(), x.ptr<double>(), dst[k][0].ptr<double>(), n, true);
+                hal::magnitude64f(x.ptr<double>(), y.ptr<double>(), dst[k][1].ptr<double>(), n);
+                hal::sqrt64f(p.ptr<double>(), dst[k][2].ptr<double>(), n);
+                hal::invSqrt64f(p.ptr<double>(), dst[k][3].ptr<double>(), n);
+            }
+        }
+        setUseOptimized(prevUseOptimized);
+
+        for( int f = 0; f < 4; f++ )
+            EXPECT_LE(cvtest::norm(dst[0][f], dst[1][f], NORM_INF | NORM_RELATIVE), eps)
+                << "function #" << f << ", depth=" << depth;
+    }
+}
+
 namespace {
 
 enum
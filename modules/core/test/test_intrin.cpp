@@ -999,6 +999,172 @@ TEST(hal_intrin, float16x4) {
 }
 #endif
 
+#if CV_SIMD256
+
+// 256-bit types are checked against the scalar code. They are only available when the whole library
+// is built with AVX2; otherwise they are compiled only into the dispatched AVX2 kernels
+// (see ocv_add_dispatched_file() in modules/core/CMakeLists.txt), which are covered by
+// the split/merge/convertTo/divide tests on AVX2 capable CPUs
+
+TEST(hal_intrin256, uint8x32)
+{
+    uchar CV_DECL_ALIGNED(32) a[128], b[128], out[128];
+    for (int i = 0; i < 128; i++)
+    {
+        a[i] = (uchar)(i * 7 + 3);
+        b[i] = (uchar)(255 - i * 3);
+    }
+
+    v_uint8x32 va = v256_load(a), vb = v256_load(b);
+    v_store(out, va + vb);
+    for (int i = 0; i < 32; i++)
+        EXPECT_EQ(saturate_cast<uchar>(a[i] + b[i]), out[i]);
+    v_store(out, va - vb);
+    for (int i = 0; i < 32; i++)
+        EXPECT_EQ(saturate_cast<uchar>(a[i] - b[i]), out[i]);
+    v_store(out, v_absdiff(va, vb));
+    for (int i = 0; i < 32; i++)
+        EXPECT_EQ(std::abs(a[i] - b[i]), out[i]);
+    v_store(out, v_select(va < vb, va, vb));
+    for (int i = 0; i < 32; i++)
+        EXPECT_EQ(std::min(a[i], b[i]), out[i]);
+
+    v_uint16x16 w0, w1;
+    v_expand(va, w0, w1);
+    ushort wout[32];
+    v_store(wout, w0);
+    v_store(wout + 16, w1);
+    for (int i = 0; i < 32; i++)
+        EXPECT_EQ(a[i], wout[i]);
+    v_store(out, v_pack(w1, w0));
+    for (int i = 0; i < 32; i++)
+        EXPECT_EQ(a[(i + 16) % 32], out[i]);
+
+    for (int cn = 2; cn <= 4; cn++)
+    {
+        v_uint8x32 c0, c1, c2, c3;
+        uchar ch[4][32];
+        memset(out, 0, sizeof(out));
+        if (cn == 2)
+        {
+            v_load_deinterleave(a, c0, c1);
+            v_store_interleave(out, c0, c1);
+        }
+        else if (cn == 3)
+        {
+            v_load_deinterleave(a, c0, c1, c2);
+            v_store_interleave(out, c0, c1, c2);
+        }
+        else
+        {
+            v_load_deinterleave(a, c0, c1, c2, c3);
+            v_store_interleave(out, c0, c1, c2, c3);
+        }
+        v_store(ch[0], c0); v_store(ch[1], c1);
+        if (cn > 2) v_store(ch[2], c2);
+        if (cn > 3) v_store(ch[3], c3);
+        for (int i = 0; i < 32; i++)
+            for (int c = 0; c < cn; c++)
+                EXPECT_EQ(a[i*cn + c], ch[c][i]) << "cn=" << cn << " i=" << i;
+        for (int i = 0; i < 32*cn; i++)
+            EXPECT_EQ(a[i], out[i]) << "cn=" << cn;
+    }
+
+    EXPECT_EQ(v_signmask(v256_setall_u8(0x80)), -1);
+    EXPECT_TRUE(v_check_all(va == va));
+    EXPECT_FALSE(v_check_any(va != va));
+}
+
+TEST(hal_intrin256, int16x16)
+{
+    short CV_DECL_ALIGNED(32) a[16], b[16];
+    for (int i = 0; i < 16; i++)
+    {
+        a[i] = (short)(i * 4001 - 30000);
+        b[i] = (short)(i * 113 - 700);
+    }
+
+    v_int16x16 va = v256_load(a), vb = v256_load(b);
+    short out[16];
+    v_store(out, va + vb);
+    for (int i = 0; i < 16; i++)
+        EXPECT_EQ(saturate_cast<short>(a[i] + b[i]), out[i]);
+    v_store(out, va >> 3);
+    for (int i = 0; i < 16; i++)
+        EXPECT_EQ(a[i] >> 3, out[i]);
+
+    v_int32x8 p0, p1;
+    int iout[16];
+    v_mul_expand(va, vb, p0, p1);
+    v_store(iout, p0);
+    v_store(iout + 8, p1);
+    for (int i = 0; i < 16; i++)
+        EXPECT_EQ(a[i] * b[i], iout[i]);
+    v_store(iout, v_dotprod(va, vb));
+    for (int i = 0; i < 8; i++)
+        EXPECT_EQ(a[i*2] * b[i*2] + a[i*2+1] * b[i*2+1], iout[i]);
+
+    uchar uout[32];
+    v_store(uout, v_pack_u(va, vb));
+    for (int i = 0; i < 16; i++)
+    {
+        EXPECT_EQ(saturate_cast<uchar>(a[i]), uout[i]);
+        EXPECT_EQ(saturate_cast<uchar>(b[i]), uout[i + 16]);
+    }
+
+    int mask = 0;
+    for (int i = 0; i < 16; i++)
+        mask |= (a[i] < 0) << i;
+    EXPECT_EQ(mask, v_signmask(va));
+}
+
+TEST(hal_intrin256, float32x8)
+{
+    float CV_DECL_ALIGNED(32) a[8], b[8];
+    for (int i = 0; i < 8; i++)
+    {
+        a[i] = (float)(i * 1.75 - 5.3);
+        b[i] = (float)(i * 0.5 + 0.25);
+    }
+
+    v_float32x8 va = v256_load_aligned(a), vb = v256_load_aligned(b);
+    float out[8];
+    int iout[8];
+    v_store(out, v_muladd(va, vb, vb));
+    for (int i = 0; i < 8; i++)
+        EXPECT_FLOAT_EQ(a[i] * b[i] + b[i], out[i]);
+    v_store(out, va / vb);
+    for (int i = 0; i < 8; i++)
+        EXPECT_FLOAT_EQ(a[i] / b[i], out[i]);
+    v_store(out, v_sqrt(vb));
+    for (int i = 0; i < 8; i++)
+        EXPECT_FLOAT_EQ(std::sqrt(b[i]), out[i]);
+    v_store(iout, v_round(va));
+    for (int i = 0; i < 8; i++)
+        EXPECT_EQ(cvRound(a[i]), iout[i]);
+    v_store(iout, v_floor(va));
+    for (int i = 0; i < 8; i++)
+        EXPECT_EQ(cvFloor(a[i]), iout[i]);
+
+    float sum = 0.f, maxval = a[0];
+    for (int i = 0; i < 8; i++)
+    {
+        sum += a[i];
+        maxval = std::max(maxval, a[i]);
+    }
+    EXPECT_FLOAT_EQ(sum, v_reduce_sum(va));
+    EXPECT_EQ(maxval, v_reduce_max(va));
+
+    v_float64x4 d0 = v_cvt_f64(va), d1 = v_cvt_f64_high(va);
+    double dout[8];
+    v_store(dout, d0);
+    v_store(dout + 4, d1);
+    for (int i = 0; i < 8; i++)
+        EXPECT_EQ((double)a[i], dout[i]);
+}
+
+#endif
+
 };
 
 };
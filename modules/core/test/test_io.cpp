@@ -996,3 +996,398 @@ TEST(Core_InputOutput, filestorage_vec_vec_io)
         remove((fileName + formats[i]).c_str());
     }
 }
+
+TEST(Core_InputOutput, mapped_mat_file)
+{
+    std::string file = cv::tempfile(".cvmat");
+
+    RNG& rng = theRNG();
+    std::vector<Mat> src(4);
+    src[0].create(480, 640, CV_8UC3);
+    rng.fill(src[0], RNG::UNIFORM, 0, 256);
+    int sz[] = { 3, 5, 7 };
+    src[1].create(3, sz, CV_32F);
+    rng.fill(src[1], RNG::UNIFORM, -1, 1);
+    // a non-continuous one and an empty one
+    Mat big(100, 100, CV_64FC2);
+    rng.fill(big, RNG::UNIFORM, -1, 1);
+    src[2] = big(Rect(3, 5, 17, 31));
+
+    ASSERT_NO_THROW(saveMatFile(file, src));
+
+    std::vector<Mat> dst;
+    ASSERT_NO_THROW(mapMatFile(file, dst));
+    ASSERT_EQ(src.size(), dst.size());
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        ASSERT_EQ(src[i].type(), dst[i].type()) << i;
+        ASSERT_EQ(src[i].size, dst[i].size) << i;
+        if (src[i].empty())
+        {
+            EXPECT_TRUE(dst[i].empty()) << i;
+            continue;
+        }
+        EXPECT_EQ(0, cvtest::norm(src[i], dst[i], NORM_INF)) << i;
+        EXPECT_EQ(0u, (size_t)dst[i].data % 64) << i;
+    }
+
+    // the mapping stays alive while some of the matrices refer to it
+    Mat roi = dst[2](Rect(1, 1, 5, 5));
+    dst.clear();
+    EXPECT_EQ(0, cvtest::norm(src[2](Rect(1, 1, 5, 5)), roi, NORM_INF));
+    Mat copy = roi.clone();
+    roi.release();
+    EXPECT_EQ(0, cvtest::norm(src[2](Rect(1, 1, 5, 5)), copy, NORM_INF));
+
+    // the changes of a copy-on-write mapping don't reach the file
+    {
+        Mat m = mapMatFile(file, MAP_MAT_COPY_ON_WRITE);
+        ASSERT_EQ(0, cvtest::norm(src[0], m, NORM_INF));
+        m.setTo(Scalar::all(0));
+        EXPECT_EQ(0, countNonZero(m.reshape(1)));
+    }
+    Mat first = mapMatFile(file);
+    EXPECT_EQ(0, cvtest::norm(src[0], first, NORM_INF));
+    first.release();
+
+    // a single matrix
+    ASSERT_NO_THROW(saveMatFile(file, src[1]));
+    Mat single = mapMatFile(file);
+    EXPECT_EQ(0, cvtest::norm(src[1], single, NORM_INF));
+    single.release();
+
+    // broken files
+    FILE* f = fopen(file.c_str(), "r+b");
+    ASSERT_TRUE(f != NULL);
+    fputc('X', f);
+    fclose(f);
+    EXPECT_THROW(mapMatFile(file), cv::Exception);
+    EXPECT_THROW(mapMatFile(file + ".missing"), cv::Exception);
+
+    remove(file.c_str());
+}
+
+TEST(Core_InputOutput, filestorage_lazy)
+{
+    RNG& rng = theRNG();
+    Mat big(300, 200, CV_32FC3), small(2, 3, CV_8S);
+    rng.fill(big, RNG::UNIFORM, -10, 10);
+    rng.fill(small, RNG::UNIFORM, -100, 100);
+    std::vector<int> seq;
+    for (int i = 0; i < 50; i++)
+        seq.push_back(i*i);
+
+    const char* formats[] = { "xml", "yml", "json" };
+    for (size_t i = 0; i < sizeof(formats)/sizeof(formats[0]); i++)
+    {
+        String file = cv::tempfile(formats[i]);
+        {
+            FileStorage fs(file, FileStorage::WRITE);
+            fs << "big" << big;
+            fs.writeComment("a comment between the nodes");
+            fs << "params" << "{" << "name" << "lazy \"node\"" << "scale" << 0.5 << "small" << small << "}";
+            fs << "seq" << seq;
+            fs << "empty_seq" << "[" << "]";
+            fs << "value" << 42;
+        }
+
+        FileStorage full(file, FileStorage::READ);
+        FileStorage lazy(file, FileStorage::READ + FileStorage::LAZY);
+        ASSERT_TRUE(lazy.isOpened()) << formats[i];
+
+        // the nodes are accessed in an order different from the file one
+        EXPECT_EQ(42, (int)lazy["value"]) << formats[i];
+        EXPECT_TRUE(lazy["missing"].empty()) << formats[i];
+        FileNode params = lazy["params"];
+        EXPECT_EQ(String("lazy \"node\""), (String)params["name"]) << formats[i];
+        EXPECT_EQ(0.5, (double)params["scale"]) << formats[i];
+        Mat m;
+        params["small"] >> m;
+        EXPECT_EQ(0, cvtest::norm(small, m, NORM_INF)) << formats[i];
+        EXPECT_EQ(3u, params.size()) << formats[i];
+        lazy["big"] >> m;
+        EXPECT_EQ(0, cvtest::norm(big, m, NORM_INF)) << formats[i];
+        // the second access reuses the parsed node
+        lazy["big"] >> m;
+        EXPECT_EQ(0, cvtest::norm(big, m, NORM_INF)) << formats[i];
+
+        // iterating over the root parses the rest of the file
+        FileNode root = lazy.root();
+        ASSERT_EQ(full.root().size(), root.size()) << formats[i];
+        std::vector<int> seq2;
+        lazy["seq"] >> seq2;
+        EXPECT_EQ(seq, seq2) << formats[i];
+        EXPECT_EQ(full["empty_seq"].type(), lazy["empty_seq"].type()) << formats[i];
+        std::vector<String> names, full_names;
+        for (FileNodeIterator it = root.begin(); it != root.end(); ++it)
+            names.push_back((*it).name());
+        FileNode full_root = full.root();
+        for (FileNodeIterator it = full_root.begin(); it != full_root.end(); ++it)
+            full_names.push_back((*it).name());
+        EXPECT_EQ(5u, names.size()) << formats[i];
+        std::sort(names.begin(), names.end());
+        std::sort(full_names.begin(), full_names.end());
+        EXPECT_EQ(full_names, names) << formats[i];
+
+        lazy.release();
+        full.release();
+        remove(file.c_str());
+    }
+}
+
+TEST(Core_InputOutput, filestorage_lazy_errors)
+{
+    String file = cv::tempfile("xml");
+    {
+        FILE* f = fopen(file.c_str(), "wt");
+        ASSERT_TRUE(f != NULL);
+        fputs("<?xml version=\"1.0\"?>\n<opencv_storage>\n"
+              "<good>1</good>\n"
+              "<bad>2</wrong>\n"
+              "</opencv_storage>\n", f);
+        fclose(f);
+    }
+    EXPECT_THROW(FileStorage(file, FileStorage::READ), cv::Exception);
+
+    // a broken node is only reported when it is accessed
+    FileStorage fs(file, FileStorage::READ + FileStorage::LAZY);
+    ASSERT_TRUE(fs.isOpened());
+    EXPECT_EQ(1, (int)fs["good"]);
+    // ... and on every later access too, not as an empty node
+    String msg[2];
+    for (int i = 0; i < 2; i++)
+    {
+        try { fs["bad"]; }
+        catch (const cv::Exception& e) { msg[i] = e.msg; }
+    }
+    EXPECT_FALSE(msg[0].empty());
+    EXPECT_EQ(msg[0], msg[1]);
+    fs.release();
+
+    // files that can't be indexed, e.g. with several streams, are parsed as usual
+    {
+        FILE* f = fopen(file.c_str(), "wt");
+        ASSERT_TRUE(f != NULL);
+        fputs("%YAML:1.0\n---\na: 1\n...\n---\nb: 2\n", f);
+        fclose(f);
+    }
+    fs.open(file, FileStorage::READ + FileStorage::LAZY);
+    ASSERT_TRUE(fs.isOpened());
+    EXPECT_EQ(1, (int)fs["a"]);
+    EXPECT_EQ(2, (int)fs["b"]);
+    fs.release();
+
+    remove(file.c_str());
+}
+
+TEST(Core_InputOutput, filestorage_lazy_map_elements)
+{
+    // files with a single top-level map, like cascades, are indexed one level deeper
+    const char* formats[] = { "xml", "yml", "json" };
+    const char* contents[] = {
+        "<?xml version=\"1.0\"?>\n<opencv_storage>\n<cascade>\n"
+        "  <good>1</good>\n  <nested><a>2</a></nested>\n  <bad>3</wrong>\n"
+        "</cascade>\n</opencv_storage>\n",
+        "%YAML:1.0\n---\ncascade:\n"
+        "   good: 1\n   nested:\n      a: 2\n   bad: [ 3,\n",
+        "{\n    \"cascade\": {\n"
+        "        \"good\": 1,\n        \"nested\": { \"a\": 2 },\n        \"bad\": tru\n"
+        "    }\n}\n"
+    };
+    for (size_t i = 0; i < sizeof(formats)/sizeof(formats[0]); i++)
+    {
+        String file = cv::tempfile(formats[i]);
+        {
+            FILE* f = fopen(file.c_str(), "wt");
+            ASSERT_TRUE(f != NULL);
+            fputs(contents[i], f);
+            fclose(f);
+        }
+        EXPECT_THROW(FileStorage(file, FileStorage::READ), cv::Exception) << formats[i];
+
+        // the broken element is only reported when it is accessed
+        FileStorage fs(file, FileStorage::READ + FileStorage::LAZY);
+        ASSERT_TRUE(fs.isOpened()) << formats[i];
+        FileNode cascade = fs["cascade"];
+        EXPECT_TRUE(cascade.isMap()) << formats[i];
+        EXPECT_EQ(1, (int)cascade["good"]) << formats[i];
+        EXPECT_TRUE(cascade["missing"].empty()) << formats[i];
+        EXPECT_EQ(2, (int)cascade["nested"]["a"]) << formats[i];
+        EXPECT_THROW(cascade["bad"], cv::Exception) << formats[i];
+        fs.release();
+
+        remove(file.c_str());
+    }
+}
+
+TEST(Core_InputOutput, filestorage_binary)
+{
+    RNG& rng = theRNG();
+    Mat big(300, 200, CV_32FC3), small(3, 5, CV_8SC2), roi;
+    rng.fill(big, RNG::UNIFORM, -10, 10);
+    rng.fill(small, RNG::UNIFORM, -100, 100);
+    roi = big(Rect(10, 20, 30, 40));
+    int sizes[] = { 4, 3, 5 };
+    Mat nd(3, sizes, CV_64F);
+    rng.fill(nd, RNG::UNIFORM, -1, 1);
+    std::vector<int> seq;
+    for (int i = 0; i < 50; i++)
+        seq.push_back(i*i);
+    std::vector<KeyPoint> kpts;
+    kpts.push_back(KeyPoint(1.5f, 2.5f, 3.f, 45.f, 0.5f, 1, 2));
+    kpts.push_back(KeyPoint(10.f, 20.f, 4.f));
+
+    const char* names[] = { "cvbin", "cvbin.gz" };
+    for (size_t i = 0; i < sizeof(names)/sizeof(names[0]); i++)
+    {
+        String file = cv::tempfile(names[i]);
+        {
+            FileStorage fs(file, FileStorage::WRITE);
+            ASSERT_TRUE(fs.isOpened());
+            fs << "big" << big;
+            fs.writeComment("comments are skipped");
+            fs << "params" << "{" << "name" << "binary \"node\"\n" << "scale" << 0.5
+               << "small" << small << "roi" << roi << "}";
+            fs << "nd" << nd;
+            fs << "empty" << Mat();
+            fs << "seq" << seq;
+            fs << "flow" << "[:" << 1 << 2.5 << "three" << "]";
+            fs << "kpts" << kpts;
+            fs << "value" << 42;
+        }
+
+        for (int lazy = 0; lazy < 2; lazy++)
+        {
+            FileStorage fs(file, FileStorage::READ + (lazy ? FileStorage::LAZY : 0));
+            ASSERT_TRUE(fs.isOpened()) << names[i];
+            EXPECT_EQ(42, (int)fs["value"]);
+            EXPECT_TRUE(fs["missing"].empty());
+            FileNode params = fs["params"];
+            EXPECT_EQ(String("binary \"node\"\n"), (String)params["name"]);
+            EXPECT_EQ(0.5, (double)params["scale"]);
+            Mat m;
+            params["small"] >> m;
+            EXPECT_EQ(0, cvtest::norm(small, m, NORM_INF));
+            params["roi"] >> m;
+            EXPECT_EQ(0, cvtest::norm(roi, m, NORM_INF));
+            fs["big"] >> m;
+            EXPECT_EQ(0, cvtest::norm(big, m, NORM_INF));
+            fs["nd"] >> m;
+            EXPECT_EQ(0, cvtest::norm(nd, m, NORM_INF));
+            fs["empty"] >> m;
+            EXPECT_TRUE(m.empty());
+            std::vector<int> seq2;
+            fs["seq"] >> seq2;
+            EXPECT_EQ(seq, seq2);
+            FileNode flow = fs["flow"];
+            ASSERT_EQ(3u, flow.size());
+            EXPECT_EQ(1, (int)flow[0]);
+            EXPECT_EQ(2.5, (double)flow[1]);
+            EXPECT_EQ(String("three"), (String)flow[2]);
+            std::vector<KeyPoint> kpts2;
+            fs["kpts"] >> kpts2;
+            ASSERT_EQ(kpts.size(), kpts2.size());
+            EXPECT_EQ(kpts[0].pt, kpts2[0].pt);
+            EXPECT_EQ(kpts[0].class_id, kpts2[0].class_id);
+
+            // the matrix elements can also be accessed one by one
+            FileNode data = fs["big"]["data"];
+            ASSERT_EQ(big.total()*big.channels(), data.size());
+            EXPECT_EQ(big.at<Vec3f>(0, 0)[1], (float)data[1]);
+            EXPECT_EQ(big.at<Vec3f>(299, 199)[2], (float)data[(int)data.size() - 1]);
+
+            std::vector<String> keys;
+            FileNode root = fs.root();
+            for (FileNodeIterator it = root.begin(); it != root.end(); ++it)
+                keys.push_back((*it).name());
+            EXPECT_EQ(8u, keys.size());
+            EXPECT_EQ(1, (int)std::count(keys.begin(), keys.end(), String("kpts")));
+        }
+
+        {
+            // in the lazy mode the matrices refer to the loaded storage
+            Mat m1, m2;
+            {
+                FileStorage fs(file, FileStorage::READ + FileStorage::LAZY);
+                fs["big"] >> m1;
+                fs["big"] >> m2;
+            }
+            EXPECT_EQ(m1.data, m2.data);
+            EXPECT_EQ(0u, (size_t)m1.data % 16);
+            EXPECT_EQ(0, cvtest::norm(big, m1, NORM_INF));
+            m1.setTo(Scalar::all(0));
+
+            Mat nd1, nd2;
+            {
+                FileStorage fs(file, FileStorage::READ + FileStorage::LAZY);
+                fs["nd"] >> nd1;
+                fs["nd"] >> nd2;
+            }
+            EXPECT_EQ(nd1.data, nd2.data);
+            EXPECT_EQ(0, cvtest::norm(nd, nd1, NORM_INF));
+
+            FileStorage fs(file, FileStorage::READ);
+            fs["big"] >> m2;
+            EXPECT_EQ(0, cvtest::norm(big, m2, NORM_INF));
+        }
+        remove(file.c_str());
+    }
+}
+
+TEST(Core_InputOutput, filestorage_binary_errors)
+{
+    String file = cv::tempfile("dat");
+    Mat m(10, 10, CV_32S, Scalar(7));
+    {
+        FileStorage fs(file, FileStorage::WRITE + FileStorage::FORMAT_BINARY);
+        fs << "m" << m << "v" << 5;
+        EXPECT_THROW(cvWriteInt(*fs, 0, 1), cv::Exception);
+        EXPECT_THROW(cvStartNextStream(*fs), cv::Exception);
+    }
+    EXPECT_THROW(FileStorage(file, FileStorage::APPEND), cv::Exception);
+    EXPECT_THROW(FileStorage("a.cvbin", FileStorage::WRITE + FileStorage::MEMORY), cv::Exception);
+    {
+        // the format is detected by the content
+        FileStorage fs(file, FileStorage::READ);
+        EXPECT_EQ(5, (int)fs["v"]);
+    }
+
+    std::vector<char> buf;
+    {
+        FILE* f = fopen(file.c_str(), "rb");
+        ASSERT_TRUE(f != NULL);
+        int c;
+        while ((c = fgetc(f)) != EOF)
+            buf.push_back((char)c);
+        fclose(f);
+    }
+
+    // a truncated file has no index
+    {
+        FILE* f = fopen(file.c_str(), "wb");
+        ASSERT_TRUE(f != NULL);
+        fwrite(&buf[0], 1, buf.size() - 3, f);
+        fclose(f);
+    }
+    EXPECT_THROW(FileStorage(file, FileStorage::READ), cv::Exception);
+    EXPECT_THROW(FileStorage(file, FileStorage::READ + FileStorage::LAZY), cv::Exception);
+
+    // the format of the raw data has no element type: "15" instead of "1i"
+    const char raw_header[] = { 2, 0, 0, 0, '1', 'i', 100, 0, 0, 0, 0, 0, 0, 0 };
+    std::vector<char>::iterator raw = std::search(buf.begin(), buf.end(), raw_header, raw_header + sizeof(raw_header));
+    ASSERT_TRUE(raw != buf.end());
+    raw[5] = '5';
+    {
+        FILE* f = fopen(file.c_str(), "wb");
+        ASSERT_TRUE(f != NULL);
+        fwrite(&buf[0], 1, buf.size(), f);
+        fclose(f);
+    }
+    EXPECT_THROW(FileStorage(file, FileStorage::READ), cv::Exception);
+    {
+        FileStorage fs(file, FileStorage::READ + FileStorage::LAZY);
+        EXPECT_EQ(5, (int)fs["v"]);
+        EXPECT_THROW(fs["m"], cv::Exception);
+    }
+    remove(file.c_str());
+}
@@ -1367,6 +1367,92 @@ TEST(Core_SVD, orthogonality)
     }
 }
 
+// the low-rank matrix with the decaying singular values plus a little noise
+static Mat makeLowRankMat(RNG& rng, int m, int n, int rank, int type)
+{
+    Mat a(m, rank, CV_64F), b(rank, n, CV_64F), noise(m, n, CV_64F), dst;
+    rng.fill(a, RNG::NORMAL, 0, 1);
+    rng.fill(b, RNG::NORMAL, 0, 1);
+    rng.fill(noise, RNG::NORMAL, 0, 1e-3);
+    for( int i = 0; i < rank; i++ )
+        a.col(i) *= std::pow(0.8, i);
+    Mat(a*b + noise).convertTo(dst, type);
+    return dst;
+}
+
+TEST(Core_SVD, truncated)
+{
+    RNG& rng = theRNG();
+    for( int i = 0; i < 4; i++ )
+    {
+        int type = i % 2 == 0 ? CV_32F : CV_64F;
+        int m = i < 2 ? 150 : 260, n = i < 2 ? 260 : 150, k = 8;
+        Mat src = makeLowRankMat(rng, m, n, 30, type);
+
+        Mat w0, u0, vt0, w, u, vt;
+        SVD::compute(src, w0, u0, vt0);
+        SVD::computeTruncated(src, w, u, vt, k);
+        ASSERT_EQ(type, w.type());
+        ASSERT_EQ(Size(1, k), w.size());
+        ASSERT_EQ(Size(k, m), u.size());
+        ASSERT_EQ(Size(n, k), vt.size());
+
+        double wmax = cvtest::norm(w0, NORM_INF);
+        EXPECT_LE(cvtest::norm(w, w0.rowRange(0, k), NORM_INF), 1e-4*wmax);
+        EXPECT_LE(cvtest::norm(u.t()*u, Mat::eye(k, k, type), NORM_INF), 1e-4);
+        EXPECT_LE(cvtest::norm(vt*vt.t(), Mat::eye(k, k, type), NORM_INF), 1e-4);
+        for( int j = 0; j < k; j++ )
+        {
+            EXPECT_GT(std::abs(u.col(j).dot(u0.col(j))), 0.999) << "component " << j;
+            EXPECT_GT(std::abs(vt.row(j).dot(vt0.row(j))), 0.999) << "component " << j;
+        }
+
+        // too many components, the full decomposition is used
+        SVD::computeTruncated(src, w, u, noArray(), std::min(m, n) - 2);
+        EXPECT_LE(cvtest::norm(w, w0.rowRange(0, w.rows), NORM_INF), 1e-4*wmax);
+        EXPECT_EQ(std::min(m, n) - 2, u.cols);
+    }
+
+    Mat src(10, 20, CV_32F, Scalar(1)), w;
+    EXPECT_THROW(SVD::computeTruncated(src, w, noArray(), noArray(), 11), cv::Exception);
+    EXPECT_THROW(SVD::computeTruncated(src, w, noArray(), noArray(), 0), cv::Exception);
+}
+
+TEST(Core_PCA, randomized)
+{
+    RNG& rng = theRNG();
+    // the number of the components is small enough for the randomized SVD
+    const int nsamples = 700, dims = 1024, maxComponents = 12;
+    Mat data = makeLowRankMat(rng, nsamples, dims, 40, CV_32F) + 3;
+
+    // the reference is the eigen decomposition of the covariance matrix
+    Mat covar, mean, evals, evects;
+    calcCovarMatrix(data, covar, mean, COVAR_NORMAL | COVAR_ROWS | COVAR_SCALE, CV_32F);
+    eigen(covar, evals, evects);
+
+    PCA rowPCA(data, noArray(), PCA::DATA_AS_ROW, maxComponents);
+    PCA colPCA(data.t(), noArray(), PCA::DATA_AS_COL, maxComponents);
+    ASSERT_EQ(Size(dims, maxComponents), rowPCA.eigenvectors.size());
+    ASSERT_EQ(Size(1, maxComponents), rowPCA.eigenvalues.size());
+    ASSERT_EQ(Size(dims, maxComponents), colPCA.eigenvectors.size());
+    EXPECT_LE(cvtest::norm(rowPCA.mean, mean, NORM_INF), 1e-4);
+    EXPECT_LE(cvtest::norm(colPCA.mean, mean.t(), NORM_INF), 1e-4);
+
+    for( int i = 0; i < maxComponents; i++ )
+    {
+        float ev = evals.at<float>(i);
+        EXPECT_NEAR(ev, rowPCA.eigenvalues.at<float>(i), ev*1e-3) << "component " << i;
+        EXPECT_NEAR(ev, colPCA.eigenvalues.at<float>(i), ev*1e-3) << "component " << i;
+        EXPECT_GT(std::abs(rowPCA.eigenvectors.row(i).dot(evects.row(i))), 0.999) << "component " << i;
+        EXPECT_GT(std::abs(colPCA.eigenvectors.row(i).dot(evects.row(i))), 0.999) << "component " << i;
+    }
+
+    // the samples are restored from the projections, as the data is almost low-rank
+    Mat samples = data.rowRange(0, 10);
+    Mat restored = rowPCA.backProject(rowPCA.project(samples));
+    EXPECT_LE(cvtest::norm(restored, samples, NORM_L2), 0.2*cvtest::norm(samples - repeat(mean, 10, 1), NORM_L2));
+}
+
 
 TEST(Core_SparseMat, footprint)
 {
@@ -1571,3 +1657,353 @@ TEST(Mat, regression_7873_mat_vector_initialize)
     ASSERT_EQ(3, sub_mat.size[1]);
     ASSERT_EQ(2, sub_mat.size[2]);
 }
+
+TEST(Mat, pool_allocator)
+{
+    MatAllocator* a = Mat::getPoolAllocator();
+    BufferPoolController* pool = a->getBufferPoolController();
+    ASSERT_TRUE(pool != NULL);
+
+    size_t prevMaxReservedSize = pool->getMaxReservedSize();
+    pool->freeAllReservedBuffers();
+    pool->setMaxReservedSize(64 << 20);
+    pool->resetStatistics();
+
+    size_t hits = 0, misses = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        Mat m;
+        m.allocator = a;
+        // sizes of the same class share the buffers
+        m.create(480, 640 - (i & 1)*2, CV_8UC3);
+        ASSERT_EQ(0u, (size_t)m.data % 16);
+        m.setTo(Scalar::all(i));
+        EXPECT_EQ(i, (int)sum(m)[0] / (m.rows*m.cols));
+    }
+    pool->getStatistics(hits, misses);
+    EXPECT_EQ(1u, misses);
+    EXPECT_EQ(9u, hits);
+    EXPECT_GE(pool->getReservedSize(), (size_t)480*640*3);
+
+    // small buffers are not pooled
+    {
+        Mat m;
+        m.allocator = a;
+        m.create(10, 10, CV_8UC1);
+    }
+    size_t hits2 = 0, misses2 = 0;
+    pool->getStatistics(hits2, misses2);
+    EXPECT_EQ(hits, hits2);
+    EXPECT_EQ(misses, misses2);
+
+    pool->freeAllReservedBuffers();
+    EXPECT_EQ(0u, pool->getReservedSize());
+
+    // a buffer bigger than the limit is not reserved
+    pool->setMaxReservedSize(512 << 10);
+    {
+        Mat m;
+        m.allocator = a;
+        m.create(480, 640, CV_8UC3);
+    }
+    EXPECT_EQ(0u, pool->getReservedSize());
+
+    // large frames are reused as long as they fit into the limit
+    pool->setMaxReservedSize(64 << 20);
+    pool->resetStatistics();
+    for (int i = 0; i < 3; i++)
+    {
+        Mat m;
+        m.allocator = a;
+        m.create(2160, 3840, CV_8UC3);
+    }
+    pool->getStatistics(hits, misses);
+    EXPECT_EQ(1u, misses);
+    EXPECT_EQ(2u, hits);
+    EXPECT_GE(pool->getReservedSize(), (size_t)2160*3840*3);
+    pool->freeAllReservedBuffers();
+
+    // the buffers released by several threads
+    pool->setMaxReservedSize(64 << 20);
+    class AllocBody : public ParallelLoopBody
+    {
+    public:
+        AllocBody(MatAllocator* _a) : a(_a) {}
+        void operator()(const Range& r) const
+        {
+            for (int i = r.start; i < r.end; i++)
+            {
+                Mat m;
+                m.allocator = a;
+                m.create(100 + i % 7, 100, CV_32F);
+                m.setTo(Scalar::all(i));
+                CV_Assert(countNonZero(m != (float)i) == 0);
+            }
+        }
+    protected:
+        MatAllocator* a;
+    };
+    EXPECT_NO_THROW(parallel_for_(Range(0, 200), AllocBody(a)));
+    EXPECT_LE(pool->getReservedSize(), (size_t)64 << 20);
+
+    pool->setMaxReservedSize(0);
+    EXPECT_EQ(0u, pool->getReservedSize());
+    pool->setMaxReservedSize(prevMaxReservedSize);
+}
+
+template<typename T> static void checkSortedVectors(const Mat& src, const Mat& dst, const Mat& idx, int flags)
+{
+    bool sortRows = (flags & 1) == SORT_EVERY_ROW;
+    bool sortDescending = (flags & SORT_DESCENDING) != 0;
+    int n = sortRows ? src.rows : src.cols, len = sortRows ? src.cols : src.rows;
+    std::vector<T> ref(len);
+    std::vector<uchar> used(len);
+
+    for( int i = 0; i < n; i++ )
+    {
+        for( int j = 0; j < len; j++ )
+            ref[j] = sortRows ? src.at<T>(i, j) : src.at<T>(j, i);
+        std::sort(ref.begin(), ref.end());
+        if( sortDescending )
+            std::reverse(ref.begin(), ref.end());
+
+        std::fill(used.begin(), used.end(), (uchar)0);
+        for( int j = 0; j < len; j++ )
+        {
+            T v = sortRows ? dst.at<T>(i, j) : dst.at<T>(j, i);
+            ASSERT_EQ(ref[j], v) << "vector " << i << ", element " << j;
+
+            int k = sortRows ? idx.at<int>(i, j) : idx.at<int>(j, i);
+            ASSERT_TRUE(0 <= k && k < len && !used[k]) << "vector " << i << ", index " << k;
+            used[k] = 1;
+            ASSERT_EQ(ref[j], sortRows ? src.at<T>(i, k) : src.at<T>(k, i));
+        }
+    }
+}
+
+template<typename T> static void testSort(int type)
+{
+    // the short vectors go through the sorting network, the long ones through the radix sort
+    const int lengths[] = { 1, 2, 3, 5, 8, 15, 16, 17, 63, 64, 100, 255, 256, 1023, 1024, 3000 };
+    const int allFlags[] =
+    {
+        SORT_EVERY_ROW | SORT_ASCENDING, SORT_EVERY_ROW | SORT_DESCENDING,
+        SORT_EVERY_COLUMN | SORT_ASCENDING, SORT_EVERY_COLUMN | SORT_DESCENDING
+    };
+    RNG& rng = theRNG();
+
+    for( size_t l = 0; l < sizeof(lengths)/sizeof(lengths[0]); l++ )
+        for( size_t f = 0; f < sizeof(allFlags)/sizeof(allFlags[0]); f++ )
+        {
+            int len = lengths[l], flags = allFlags[f];
+            int n = rng.uniform(1, len <= 16 ? 70 : 20);
+            Mat src = (flags & 1) == SORT_EVERY_ROW ? Mat(n, len, type) : Mat(len, n, type);
+            // the small range produces a lot of the duplicates
+            if( rng.uniform(0, 2) == 0 )
+                rng.fill(src, RNG::UNIFORM, -10, 10);
+            else
+                cvtest::randUni(rng, src, Scalar::all(-1e5), Scalar::all(1e5));
+
+            SCOPED_TRACE(cv::format("len=%d, n=%d, flags=%d", len, n, flags));
+            Mat dst, idx;
+            cv::sort(src, dst, flags);
+            cv::sortIdx(src, idx, flags);
+            ASSERT_EQ(src.size(), dst.size());
+            ASSERT_EQ(src.size(), idx.size());
+            ASSERT_EQ(CV_32S, idx.type());
+            ASSERT_NO_FATAL_FAILURE(checkSortedVectors<T>(src, dst, idx, flags));
+
+            Mat inplace = src.clone();
+            cv::sort(inplace, inplace, flags);
+            ASSERT_EQ(0, cvtest::norm(dst, inplace, NORM_INF));
+
+            // a submatrix is not continuous
+            Mat big(src.rows + 2, src.cols + 3, type, Scalar::all(0));
+            Mat roi = big(Rect(1, 1, src.cols, src.rows));
+            src.copyTo(roi);
+            cv::sort(roi, dst, flags);
+            cv::sortIdx(roi, idx, flags);
+            ASSERT_NO_FATAL_FAILURE(checkSortedVectors<T>(src, dst, idx, flags));
+        }
+}
+
+TEST(Core_Sort, accuracy_8u) { testSort<uchar>(CV_8U); }
+TEST(Core_Sort, accuracy_8s) { testSort<schar>(CV_8S); }
+TEST(Core_Sort, accuracy_16u) { testSort<ushort>(CV_16U); }
+TEST(Core_Sort, accuracy_16s) { testSort<short>(CV_16S); }
+TEST(Core_Sort, accuracy_32s) { testSort<int>(CV_32S); }
+TEST(Core_Sort, accuracy_32f) { testSort<float>(CV_32F); }
+TEST(Core_Sort, accuracy_64f) { testSort<double>(CV_64F); }
+
+TEST(Core_Sort, negative_zero_and_inf)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    float data[] = { 1.f, -0.f, inf, -1e-30f, 0.f, -inf, 3.5f, -2.f };
+    Mat src(1, (int)(sizeof(data)/sizeof(data[0])), CV_32F, data);
+    src = repeat(src, 1, 100);
+
+    Mat dst, idx;
+    cv::sort(src, dst, SORT_EVERY_ROW | SORT_ASCENDING);
+    cv::sortIdx(src, idx, SORT_EVERY_ROW | SORT_ASCENDING);
+    EXPECT_EQ(-inf, dst.at<float>(0));
+    EXPECT_EQ(inf, dst.at<float>(dst.cols - 1));
+    for( int j = 1; j < dst.cols; j++ )
+    {
+        ASSERT_LE(dst.at<float>(j - 1), dst.at<float>(j));
+        ASSERT_LE(src.at<float>(idx.at<int>(j - 1)), src.at<float>(idx.at<int>(j)));
+    }
+}
+
+TEST(Core_Reduce, parallel)
+{
+    const int ops[] = { REDUCE_SUM, REDUCE_AVG, REDUCE_MAX, REDUCE_MIN };
+    // the sizes, where the work is split between threads, with the widths not multiple of the vector size
+    const Size sizes[] = { Size(1001, 377), Size(77, 3001), Size(3001, 77), Size(1, 70000), Size(70000, 1) };
+    const int types[][2] =
+    {
+        { CV_8U, CV_32S }, { CV_8U, CV_8U }, { CV_16U, CV_32F }, { CV_16S, CV_32F },
+        { CV_16S, CV_16S }, { CV_32F, CV_32F }, { CV_32F, CV_64F }, { CV_64F, CV_64F }
+    };
+    RNG& rng = theRNG();
+
+    for( size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ )
+        for( size_t t = 0; t < sizeof(types)/sizeof(types[0]); t++ )
+        {
+            int sdepth = types[t][0], ddepth = types[t][1];
+            for( int cn = 1; cn <= 3; cn += 2 )
+            {
+                Mat src(sizes[s], CV_MAKETYPE(sdepth, cn));
+                cvtest::randUni(rng, src, Scalar::all(0), Scalar::all(100));
+                Mat src64;
+                src.convertTo(src64, CV_64F);
+
+                for( int dim = 0; dim < 2; dim++ )
+                    for( size_t o = 0; o < sizeof(ops)/sizeof(ops[0]); o++ )
+                    {
+                        int op = ops[o];
+                        if( (op == REDUCE_MAX || op == REDUCE_MIN) && sdepth != ddepth )
+                            continue;
+                        if( (op == REDUCE_SUM || op == REDUCE_AVG) && sdepth == ddepth && sdepth < CV_32F )
+                            continue;
+
+                        SCOPED_TRACE(cv::format("size=%dx%d, sdepth=%d, ddepth=%d, cn=%d, dim=%d, op=%d",
+                                                src.cols, src.rows, sdepth, ddepth, cn, dim, op));
+                        Mat dst, ref;
+                        cv::reduce(src, dst, dim, op, ddepth);
+                        cv::reduce(src64, ref, dim, op, CV_64F);
+                        ASSERT_EQ(CV_MAKETYPE(ddepth, cn), dst.type());
+                        ASSERT_EQ(ref.size(), dst.size());
+
+                        Mat dst64;
+                        dst.convertTo(dst64, CV_64F);
+                        double eps = ddepth == CV_32F ? 1e-5 : ddepth == CV_64F ? 1e-10 : 0;
+                        double maxdiff = eps*(1 + cvtest::norm(ref, NORM_INF));
+                        // the integer average is rounded
+                        if( op == REDUCE_AVG && ddepth == CV_32S )
+                            maxdiff = 1;
+                        EXPECT_LE(cvtest::norm(dst64, ref, NORM_INF), maxdiff);
+                    }
+            }
+        }
+}
+
+static Mat makeSparseDenseMat(int rows, int cols, int type, double density, RNG& rng)
+{
+    Mat m(rows, cols, type), mask(rows, cols, CV_8U);
+    rng.fill(m, RNG::UNIFORM, -1, 1);
+    rng.fill(mask, RNG::UNIFORM, 0, 256);
+    m.setTo(Scalar::all(0), mask >= 256*density);
+    return m;
+}
+
+TEST(Core_CsrMat, conversions)
+{
+    RNG& rng = theRNG();
+    for (int type = CV_32F; type <= CV_64F; type++)
+    {
+        Mat dense = makeSparseDenseMat(37, 53, type, 0.1, rng), dense2;
+        CsrMat a(dense);
+        ASSERT_EQ(countNonZero(dense), a.nnz());
+        ASSERT_EQ(type, a.type());
+        a.copyTo(dense2);
+        EXPECT_EQ(0, cvtest::norm(dense, dense2, NORM_INF));
+
+        // the hash table order of SparseMat is arbitrary, the CSR rows must be sorted anyway
+        SparseMat sparse(dense), sparse2;
+        CsrMat b(sparse);
+        ASSERT_EQ(a.nnz(), b.nnz());
+        EXPECT_EQ(0, cvtest::norm(a.colIdx, b.colIdx, NORM_INF));
+        EXPECT_EQ(0, cvtest::norm(a.values, b.values, NORM_INF));
+        EXPECT_EQ(0, cvtest::norm(a.rowPtr, b.rowPtr, NORM_INF));
+
+        b.copyTo(sparse2);
+        sparse2.copyTo(dense2);
+        EXPECT_EQ(0, cvtest::norm(dense, dense2, NORM_INF));
+
+        CsrMat at = a.t();
+        at.copyTo(dense2);
+        EXPECT_EQ(0, cvtest::norm(Mat(dense.t()), dense2, NORM_INF));
+
+        for (int k = 0; k < 100; k++)
+        {
+            int i = rng.uniform(0, dense.rows), j = rng.uniform(0, dense.cols);
+            double v = type == CV_32F ? dense.at<float>(i, j) : dense.at<double>(i, j);
+            EXPECT_EQ(v, a.value(i, j));
+        }
+    }
+
+    CsrMat empty(10, 20, CV_32F);
+    Mat dense;
+    empty.copyTo(dense);
+    EXPECT_EQ(0, empty.nnz());
+    EXPECT_EQ(Size(20, 10), dense.size());
+    EXPECT_EQ(0, countNonZero(dense));
+}
+
+TEST(Core_CsrMat, gemm)
+{
+    RNG& rng = theRNG();
+    const int ncols[] = { 1, 7, 64 };
+    for (int type = CV_32F; type <= CV_64F; type++)
+        for (int t = 0; t < 3; t++)
+            for (int flags = 0; flags <= GEMM_1_T + GEMM_2_T + GEMM_3_T; flags++)
+            {
+                int m = 300, n = 200, k = ncols[t];
+                Mat dense = makeSparseDenseMat(m, n, type, 0.05, rng);
+                // a few dense rows to make the stripes unbalanced by the row count
+                rng.fill(dense.rowRange(10, 13), RNG::UNIFORM, -1, 1);
+                CsrMat a(dense);
+
+                Size bsz(k, flags & GEMM_1_T ? m : n), csz(k, flags & GEMM_1_T ? n : m);
+                if (flags & GEMM_2_T)
+                    std::swap(bsz.width, bsz.height);
+                if (flags & GEMM_3_T)
+                    std::swap(csz.width, csz.height);
+                Mat b(bsz, type), c(csz, type), dst, ref;
+                rng.fill(b, RNG::UNIFORM, -1, 1);
+                rng.fill(c, RNG::UNIFORM, -1, 1);
+
+                SCOPED_TRACE(cv::format("type=%d, k=%d, flags=%d", type, k, flags));
+                cv::gemm(a, b, 0.5, c, -2, dst, flags);
+                cv::gemm(dense, b, 0.5, c, -2, ref, flags);
+                ASSERT_EQ(ref.size(), dst.size());
+                EXPECT_LE(cvtest::norm(dst, ref, NORM_INF), type == CV_32F ? 1e-4 : 1e-12);
+
+                cv::gemm(a, b, 1, noArray(), 0, dst, flags & (GEMM_1_T + GEMM_2_T));
+                cv::gemm(dense, b, 1, noArray(), 0, ref, flags & (GEMM_1_T + GEMM_2_T));
+                EXPECT_LE(cvtest::norm(dst, ref, NORM_INF), type == CV_32F ? 1e-4 : 1e-12);
+            }
+}
+
+TEST(Core_CsrMat, gemm_inplace)
+{
+    RNG& rng = theRNG();
+    Mat dense = makeSparseDenseMat(100, 100, CV_64F, 0.1, rng);
+    CsrMat a(dense);
+    Mat x(100, 3, CV_64F), ref;
+    rng.fill(x, RNG::UNIFORM, -1, 1);
+
+    cv::gemm(dense, x, 1, x, 1, ref);
+    cv::gemm(a, x, 1, x, 1, x);
+    EXPECT_LE(cvtest::norm(x, ref, NORM_INF), 1e-12);
+}
@@ -2859,6 +2859,160 @@ TEST_P(Core_KMeans_InputVariants, singular)
 
 INSTANTIATE_TEST_CASE_P(AllVariants, Core_KMeans_InputVariants, KMeansInputVariant::all());
 
+// the samples around K well separated centers, labels get the true clusters
+static void makeKMeansBlobs(RNG& rng, int N, int dims, int K, float offset, Mat& data, Mat& labels)
+{
+    Mat centers(K, dims, CV_32F);
+    rng.fill(centers, RNG::UNIFORM, offset - 100, offset + 100);
+    data.create(N, dims, CV_32F);
+    labels.create(N, 1, CV_32S);
+    for( int i = 0; i < N; i++ )
+    {
+        int k = rng.uniform(0, K);
+        Mat sample = data.row(i);
+        rng.fill(sample, RNG::NORMAL, 0, 3);
+        sample += centers.row(k);
+        labels.at<int>(i) = k;
+    }
+}
+
+TEST(Core_KMeans, bounds_give_same_result)
+{
+    RNG& rng = theRNG();
+    const int flags[] = { KMEANS_ELKAN, KMEANS_HAMERLY };
+    for( int iter = 0; iter < 10; iter++ )
+    {
+        int K = rng.uniform(1, 40), dims = rng.uniform(1, 20), N = rng.uniform(K, 3000);
+        Mat data, trueLabels;
+        makeKMeansBlobs(rng, N, dims, K, 0, data, trueLabels);
+
+        // the random initial labels make the centers move a lot during the first iterations
+        Mat initLabels(N, 1, CV_32S);
+        rng.fill(initLabels, RNG::UNIFORM, 0, K);
+        TermCriteria criteria(TermCriteria::MAX_ITER + TermCriteria::EPS, 30, 0);
+
+        Mat refLabels = initLabels.clone(), refCenters;
+        double refCompactness = kmeans(data, K, refLabels, criteria, 1, KMEANS_USE_INITIAL_LABELS, refCenters);
+
+        for( size_t f = 0; f < sizeof(flags)/sizeof(flags[0]); f++ )
+        {
+            SCOPED_TRACE(cv::format("iter=%d, N=%d, dims=%d, K=%d, flags=%d", iter, N, dims, K, flags[f]));
+            Mat labels = initLabels.clone(), centers;
+            double compactness = kmeans(data, K, labels, criteria, 1, KMEANS_USE_INITIAL_LABELS | flags[f], centers);
+            EXPECT_EQ(0, cvtest::norm(labels, refLabels, NORM_INF));
+            EXPECT_LE(cvtest::norm(centers, refCenters, NORM_INF), 1e-3);
+            EXPECT_NEAR(refCompactness, compactness, 1e-5*refCompactness);
+        }
+    }
+}
+
+TEST(Core_KMeans, gemm)
+{
+    RNG& rng = theRNG();
+    for( int iter = 0; iter < 10; iter++ )
+    {
+        int K = rng.uniform(1, 40), dims = rng.uniform(1, 70), N = rng.uniform(K, 3000);
+        // far from the origin, so the product loses the precision
+        float offset = iter % 2 ? 1000.f : 0.f;
+        Mat data, trueLabels;
+        makeKMeansBlobs(rng, N, dims, K, offset, data, trueLabels);
+        TermCriteria criteria(TermCriteria::MAX_ITER + TermCriteria::EPS, 30, 0);
+
+        SCOPED_TRACE(cv::format("iter=%d, N=%d, dims=%d, K=%d", iter, N, dims, K));
+        Mat refLabels = trueLabels.clone(), refCenters;
+        double refCompactness = kmeans(data, K, refLabels, criteria, 1, KMEANS_USE_INITIAL_LABELS, refCenters);
+        Mat labels = trueLabels.clone(), centers;
+        double compactness = kmeans(data, K, labels, criteria, 1, KMEANS_USE_INITIAL_LABELS | KMEANS_USE_GEMM, centers);
+        EXPECT_EQ(0, cvtest::norm(labels, refLabels, NORM_INF));
+        EXPECT_LE(cvtest::norm(centers, refCenters, NORM_INF), 1e-3);
+        EXPECT_NEAR(refCompactness, compactness, 1e-5*refCompactness);
+    }
+}
+
+TEST(Core_KMeans, mini_batch)
+{
+    RNG& rng = theRNG();
+    const int N = 20000, dims = 8, K = 10;
+    Mat data, trueLabels;
+    makeKMeansBlobs(rng, N, dims, K, 0, data, trueLabels);
+    TermCriteria criteria(TermCriteria::MAX_ITER + TermCriteria::EPS, 30, 0);
+
+    Mat refLabels, refCenters;
+    double refCompactness = kmeans(data, K, refLabels, criteria, 3, KMEANS_PP_CENTERS, refCenters);
+
+    for( int useGEMM = 0; useGEMM < 2; useGEMM++ )
+    {
+        SCOPED_TRACE(useGEMM ? "gemm" : "direct");
+        Mat labels, centers;
+        double compactness = kmeans(data, K, labels, criteria, 3,
+                                    KMEANS_PP_CENTERS | KMEANS_MINI_BATCH | (useGEMM ? KMEANS_USE_GEMM : 0), centers);
+        ASSERT_EQ(N, labels.rows);
+        ASSERT_EQ(K, centers.rows);
+        EXPECT_LE(compactness, refCompactness*1.05);
+
+        // the clusters are not empty, the centers are their means
+        Mat sums(K, dims, CV_64F, Scalar(0));
+        std::vector<int> counts(K, 0);
+        for( int i = 0; i < N; i++ )
+        {
+            int k = labels.at<int>(i);
+            ASSERT_TRUE(0 <= k && k < K);
+            Mat row;
+            data.row(i).convertTo(row, CV_64F);
+            sums.row(k) += row;
+            counts[k]++;
+        }
+        for( int k = 0; k < K; k++ )
+        {
+            ASSERT_GT(counts[k], 0);
+            Mat mean;
+            centers.row(k).convertTo(mean, CV_64F);
+            EXPECT_LE(cvtest::norm(mean, sums.row(k)/counts[k], NORM_INF), 1e-3);
+        }
+    }
+}
+
+TEST(Core_KMeans, singular_accelerated)
+{
+    RNG& rng = theRNG();
+    const int flags[] = { KMEANS_ELKAN, KMEANS_HAMERLY, KMEANS_MINI_BATCH, KMEANS_USE_GEMM,
+                          KMEANS_MINI_BATCH | KMEANS_USE_GEMM };
+    for( size_t f = 0; f < sizeof(flags)/sizeof(flags[0]); f++ )
+        for( int iter = 0; iter < 30; iter++ )
+        {
+            // a lot of the duplicated samples, the clusters tend to become empty
+            int N = rng.uniform(1, 101), N0 = rng.uniform(1, MAX(N/10, 2));
+            int K = rng.uniform(1, N+1), dims = rng.uniform(1, 6);
+            Mat data0(N0, dims, CV_32F);
+            rng.fill(data0, RNG::UNIFORM, -1, 1);
+            Mat data(N, dims, CV_32F);
+            for( int i = 0; i < N; i++ )
+                data0.row(rng.uniform(0, N0)).copyTo(data.row(i));
+
+            SCOPED_TRACE(cv::format("flags=%d, N=%d, N0=%d, K=%d", flags[f], N, N0, K));
+            Mat labels;
+            ASSERT_NO_THROW(kmeans(data, K, labels, TermCriteria(TermCriteria::MAX_ITER + TermCriteria::EPS, 30, 0),
+                                   5, KMEANS_PP_CENTERS | flags[f]));
+            std::vector<int> counts(K, 0);
+            for( int i = 0; i < N; i++ )
+            {
+                int k = labels.at<int>(i);
+                ASSERT_TRUE(0 <= k && k < K);
+                counts[k]++;
+            }
+            for( int k = 0; k < K; k++ )
+                ASSERT_GT(counts[k], 0);
+        }
+}
+
+TEST(Core_KMeans, bad_flags)
+{
+    Mat data(100, 2, CV_32F), labels;
+    randu(data, Scalar(0), Scalar(1));
+    EXPECT_THROW(kmeans(data, 3, labels, TermCriteria(), 1, KMEANS_ELKAN | KMEANS_HAMERLY), cv::Exception);
+    EXPECT_THROW(kmeans(data, 3, labels, TermCriteria(), 1, KMEANS_HAMERLY | KMEANS_MINI_BATCH), cv::Exception);
+}
+
 TEST(CovariationMatrixVectorOfMat, accuracy)
 {
     unsigned int col_problem_size = 8, row_problem_size = 8, vector_size = 16;
@@ -3041,4 +3195,83 @@ TEST(Core_QR_Solver, accuracy64f)
     ASSERT_FALSE(solve(A, B, solutionQR, DECOMP_QR));
 }
 
+static void gemmNaive( const Mat& _a, const Mat& _b, double alpha, const Mat& _c, double beta, Mat& d, int flags )
+{
+    Mat a, b, c;
+    _a.convertTo(a, CV_MAKETYPE(CV_64F, _a.channels()));
+    _b.convertTo(b, CV_MAKETYPE(CV_64F, _b.channels()));
+    _c.convertTo(c, CV_MAKETYPE(CV_64F, _c.channels()));
+    if( flags & GEMM_1_T ) a = a.t();
+    if( flags & GEMM_2_T ) b = b.t();
+    if( flags & GEMM_3_T ) c = c.t();
+
+    d.create(a.rows, b.cols, a.type());
+    for( int i = 0; i < d.rows; i++ )
+        for( int j = 0; j < d.cols; j++ )
+        {
+            if( a.channels() == 1 )
+            {
+                double s = 0;
+                for( int k = 0; k < a.cols; k++ )
+                    s += a.at<double>(i, k)*b.at<double>(k, j);
+                d.at<double>(i, j) = alpha*s + beta*c.at<double>(i, j);
+            }
+            else
+            {
+                Vec2d s;
+                for( int k = 0; k < a.cols; k++ )
+                {
+                    Vec2d u = a.at<Vec2d>(i, k), v = b.at<Vec2d>(k, j);
+                    s[0] += u[0]*v[0] - u[1]*v[1];
+                    s[1] += u[0]*v[1] + u[1]*v[0];
+                }
+                d.at<Vec2d>(i, j) = s*alpha + c.at<Vec2d>(i, j)*beta;
+            }
+        }
+}
+
+TEST(Core_GEMM, large_blocked)
+{
+    const int types[] = { CV_32FC1, CV_64FC1, CV_32FC2, CV_64FC2 };
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < 4; t++ )
+        for( int flags = 0; flags < 8; flags++ )
+        {
+            int type = types[t];
+            int m = 67 + rng.uniform(0, 100), n = 71 + rng.uniform(0, 300), k = 300 + rng.uniform(0, 300);
+            Mat a = flags & GEMM_1_T ? Mat(k, m, type) : Mat(m, k, type);
+            Mat b = flags & GEMM_2_T ? Mat(n, k, type) : Mat(k, n, type);
+            Mat c = flags & GEMM_3_T ? Mat(n, m, type) : Mat(m, n, type);
+            rng.fill(a, RNG::UNIFORM, -1, 1);
+            rng.fill(b, RNG::UNIFORM, -1, 1);
+            rng.fill(c, RNG::UNIFORM, -1, 1);
+
+            Mat d, d0;
+            cv::gemm(a, b, 0.7, c, -1.3, d, flags);
+            gemmNaive(a, b, 0.7, c, -1.3, d0, flags);
+
+            Mat d64;
+            d.convertTo(d64, d0.type());
+            double eps = CV_MAT_DEPTH(type) == CV_32F ? 1e-5 : 1e-12;
+            EXPECT_LE(cvtest::norm(d64, d0, NORM_INF | NORM_RELATIVE), eps)
+                << "type=" << type << ", flags=" << flags;
+        }
+}
+
+TEST(Core_GEMM, long_product_32f)
+{
+    // the blocked engine must not lose the precision of the double accumulator
+    // used by the single-pass kernels when K is much longer than one block
+    Mat a(32, 16384, CV_32F), b(16384, 32, CV_32F);
+    theRNG().fill(a, RNG::UNIFORM, 0, 1);
+    theRNG().fill(b, RNG::UNIFORM, 0, 1);
+
+    Mat d, d0, d64;
+    cv::gemm(a, b, 1, noArray(), 0, d);
+    gemmNaive(a, b, 1, Mat::zeros(32, 32, CV_32F), 0, d0, 0);
+    d.convertTo(d64, CV_64F);
+    EXPECT_LE(cvtest::norm(d64, d0, NORM_INF | NORM_RELATIVE), 2e-7);
+}
+
 /* End of file. */
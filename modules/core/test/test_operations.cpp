@@ -1240,3 +1240,143 @@ protected:
 };
 
 TEST(Core_SparseMat, iterations) { CV_SparseMatTest test; test.safe_run(); }
+
+// The chains of element-wise operations are evaluated by the fused expressions;
+// the results should be the same as if every operation were done by the corresponding function
+TEST(Core_MatExpr, fused_chains)
+{
+    const int types[] = { CV_8UC1, CV_16SC1, CV_32FC1, CV_64FC1, CV_8UC3, CV_32FC3 };
+    RNG& rng = theRNG();
+
+    for( size_t t = 0; t < sizeof(types)/sizeof(types[0]); t++ )
+    {
+        int type = types[t];
+        double eps = CV_MAT_DEPTH(type) <= CV_32S ? 0 : 1e-5;
+        Mat a(123, 457, type), b(123, 457, type), c(123, 457, type), t1, t2, t3, ref;
+        rng.fill(a, RNG::UNIFORM, 0, 100);
+        rng.fill(b, RNG::UNIFORM, 0, 100);
+        rng.fill(c, RNG::UNIFORM, 1, 50);
+
+        Mat r = abs(a - b)*0.7 + c;
+        absdiff(a, b, t1); t1.convertTo(t2, -1, 0.7); add(t2, c, ref);
+        EXPECT_EQ(type, r.type());
+        EXPECT_LE(cvtest::norm(r, ref, NORM_INF | NORM_RELATIVE), eps) << "type=" << type;
+
+        r = (a + b).mul(c - a, 0.5);
+        add(a, b, t1); subtract(c, a, t2); multiply(t1, t2, ref, 0.5);
+        EXPECT_LE(cvtest::norm(r, ref, NORM_INF | NORM_RELATIVE), eps) << "type=" << type;
+
+        r = (a + b)/(c + a) + Scalar::all(10);
+        add(a, b, t1); add(c, a, t2); divide(t1, t2, t3); add(t3, Scalar::all(10), ref);
+        EXPECT_LE(cvtest::norm(r, ref, NORM_INF | NORM_RELATIVE), eps) << "type=" << type;
+
+        r = 300./(a + c);
+        add(a, c, t1); divide(300., t1, ref);
+        EXPECT_LE(cvtest::norm(r, ref, NORM_INF | NORM_RELATIVE), eps) << "type=" << type;
+
+        r = min(a, b) + max(b, c) - a*2;
+        min(a, b, t1); max(b, c, t2); add(t1, t2, t3); a.convertTo(t1, -1, 2); subtract(t3, t1, ref);
+        EXPECT_LE(cvtest::norm(r, ref, NORM_INF | NORM_RELATIVE), eps) << "type=" << type;
+
+        if( CV_MAT_CN(type) == 1 )
+        {
+            Mat_<double> rd = abs(a - b) + c;
+            absdiff(a, b, t1); add(t1, c, t2); t2.convertTo(ref, CV_64F);
+            EXPECT_LE(cvtest::norm(Mat(rd), ref, NORM_INF | NORM_RELATIVE), eps) << "type=" << type;
+
+            r = abs(a - b) > 30;
+            absdiff(a, b, t1); compare(t1, 30, ref, CMP_GT);
+            EXPECT_EQ(0, cvtest::norm(r, ref, NORM_INF)) << "type=" << type;
+
+            r = 30 <= min(a, b)*0.5;
+            min(a, b, t1); t1.convertTo(t2, -1, 0.5); compare(t2, 30, ref, CMP_GE);
+            EXPECT_EQ(0, cvtest::norm(r, ref, NORM_INF)) << "type=" << type;
+
+            r = (a > b) + (b > c);
+            compare(a, b, t1, CMP_GT); compare(b, c, t2, CMP_GT); add(t1, t2, ref);
+            EXPECT_EQ(0, cvtest::norm(r, ref, NORM_INF)) << "type=" << type;
+        }
+    }
+}
+
+TEST(Core_MatExpr, fused_roi_inplace)
+{
+    Mat a(100, 200, CV_32FC2), b(100, 200, CV_32FC2), c(100, 200, CV_32FC2), t1, t2, ref;
+    randu(a, -10, 10);
+    randu(b, -10, 10);
+    randu(c, -10, 10);
+
+    absdiff(a, b, t1); multiply(t1, c, t2); add(t2, a, ref);
+
+    Rect roi(13, 7, 150, 60);
+    Mat r = (abs(a - b).mul(c) + a)(roi);
+    EXPECT_EQ(roi.size(), r.size());
+    EXPECT_LE(cvtest::norm(r, ref(roi), NORM_INF | NORM_RELATIVE), 1e-6);
+
+    Mat d = a.clone();
+    uchar* data = d.data;
+    d = abs(d - b).mul(c) + d;
+    EXPECT_EQ(data, d.data);
+    EXPECT_LE(cvtest::norm(d, ref, NORM_INF | NORM_RELATIVE), 1e-6);
+}
+
+TEST(Core_MatExpr, fused_long_chain)
+{
+    Mat x(64, 64, CV_32F), sq, ref;
+    randu(x, 0, 1);
+    multiply(x, x, sq);
+
+    MatExpr e = x.mul(x) + x;
+    add(sq, x, ref);
+    for( int i = 0; i < 100; i++ )
+    {
+        e = e + abs(x - 0.5);
+        Mat t;
+        absdiff(x, Scalar::all(0.5), t);
+        add(ref, t, ref);
+    }
+    EXPECT_LE(cvtest::norm(Mat(e), ref, NORM_INF | NORM_RELATIVE), 1e-5);
+}
+
+TEST(Core_MatExpr, fused_full_chain)
+{
+    // a chain of exactly FUSED_MAX_INSTRS instructions is evaluated before it is scaled,
+    // the scale and the scalar must not be folded into its load
+    Mat a(8, 16, CV_32F, Scalar::all(1)), b(8, 16, CV_32F, Scalar::all(1));
+    MatExpr e = (a + b) + b;
+    Mat ref = (a + b) + b;
+    for( int i = 0; i < 13; i++ )
+    {
+        e = e.mul(b);
+        ref = ref.mul(b);
+    }
+    e = e*2;
+    ref = ref*2;
+    EXPECT_EQ(0, cvtest::norm(Mat(e), ref, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(Mat(e*3), Mat(8, 16, CV_32F, Scalar::all(18)), NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(Mat(e + 5), Mat(8, 16, CV_32F, Scalar::all(11)), NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(Mat(e*3 - 5), Mat(8, 16, CV_32F, Scalar::all(13)), NORM_INF));
+}
+
+TEST(Core_MatExpr, fused_copies)
+{
+    // the copies of a fused expression share its operands and operations
+    MatExpr e;
+    {
+        Mat a(10, 20, CV_32F, Scalar::all(3)), b(10, 20, CV_32F, Scalar::all(1));
+        MatExpr e1 = abs(a - b)*2 + a;
+        e = e1;
+        a.setTo(Scalar::all(5));
+    }
+    EXPECT_EQ(Size(20, 10), e.size());
+    EXPECT_EQ(CV_32F, e.type());
+    MatExpr e2 = e(Range(2, 5), Range::all());
+    e = MatExpr();
+    EXPECT_EQ(0, cvtest::norm(Mat(e2), Mat(3, 20, CV_32F, Scalar::all(13)), NORM_INF));
+
+    // replacing the operands of a fused expression is reported instead of crashing
+    MatExpr e3 = e2;
+    e3.c = Mat();
+    EXPECT_THROW(Mat m = e3, cv::Exception);
+    EXPECT_EQ(0, cvtest::norm(Mat(e2), Mat(3, 20, CV_32F, Scalar::all(13)), NORM_INF));
+}
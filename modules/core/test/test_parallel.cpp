@@ -0,0 +1,524 @@
+#include "test_precomp.hpp"
+
+using namespace cv;
+
+namespace {
+
+class CountingBody : public ParallelLoopBody
+{
+public:
+    CountingBody(std::vector<int>& _hits) : hits(&_hits) {}
+
+    void operator()(const Range& r) const
+    {
+        for (int i = r.start; i < r.end; i++)
+            CV_XADD(&(*hits)[i], 1);
+    }
+
+protected:
+    std::vector<int>* hits;
+};
+
+// the work per index grows with the index, so the stripes at the end are much heavier
+class ImbalancedBody : public ParallelLoopBody
+{
+public:
+    ImbalancedBody(std::vector<double>& _out) : out(&_out) {}
+
+    void operator()(const Range& r) const
+    {
+        for (int i = r.start; i < r.end; i++)
+        {
+            double s = 0;
+            for (int k = 0; k < i * 10; k++)
+                s += std::sqrt((double)k);
+            (*out)[i] = s;
+        }
+    }
+
+protected:
+    std::vector<double>* out;
+};
+
+class NestedBody : public ParallelLoopBody
+{
+public:
+    NestedBody(Mat& _m) : m(&_m) {}
+
+    void operator()(const Range& r) const
+    {
+        for (int y = r.start; y < r.end; y++)
+        {
+            std::vector<int> hits(m->cols, 0);
+            parallel_for_(Range(0, m->cols), CountingBody(hits));
+            int* row = m->ptr<int>(y);
+            for (int x = 0; x < m->cols; x++)
+                row[x] += hits[x];
+        }
+    }
+
+protected:
+    Mat* m;
+};
+
+// counts the calls of the body, to see how the range has been split
+class CallCountingBody : public ParallelLoopBody
+{
+public:
+    CallCountingBody(int* _calls, int _work) : calls(_calls), work(_work) {}
+
+    void operator()(const Range& r) const
+    {
+        CV_XADD(calls, 1);
+        volatile double s = 0;
+        for (int i = r.start; i < r.end; i++)
+            for (int k = 0; k < work; k++)
+                s += std::sqrt((double)k);
+    }
+
+protected:
+    int* calls;
+    int work;
+};
+
+class ThrowingBody : public ParallelLoopBody
+{
+public:
+    void operator()(const Range& r) const
+    {
+        if (r.start <= 50 && 50 < r.end)
+            CV_Error(Error::StsBadArg, "parallel_for_ test exception");
+    }
+};
+
+// records the order in which the tasks finish
+class StampTask : public ParallelTask
+{
+public:
+    StampTask(int* _counter, int* _stamp, bool _fail = false) : counter(_counter), stamp(_stamp), fail(_fail) {}
+
+    void operator()()
+    {
+        if (fail)
+            CV_Error(Error::StsBadArg, "parallel_async test exception");
+        *stamp = CV_XADD(counter, 1);
+    }
+
+protected:
+    int* counter;
+    int* stamp;
+    bool fail;
+};
+
+// a long-running call which is parallel itself
+class RowSumTask : public ParallelTask
+{
+public:
+    RowSumTask(const Mat& _src, Mat* _dst) : src(_src), dst(_dst) {}
+
+    void operator()()
+    {
+        reduce(src, *dst, 1, REDUCE_SUM, CV_64F);
+        Mat m(src.rows, src.cols, CV_32S, Scalar::all(0));
+        parallel_for_(Range(0, m.rows), NestedBody(m));
+        CV_Assert(countNonZero(m != 1) == 0);
+    }
+
+protected:
+    Mat src;
+    Mat* dst;
+};
+
+// waits for a task it has started itself
+class WaitingTask : public ParallelTask
+{
+public:
+    WaitingTask(int* _counter, int* _stamp) : counter(_counter), stamp(_stamp) {}
+
+    void operator()()
+    {
+        int inner = -1;
+        AsyncTask t = parallel_async(makePtr<StampTask>(counter, &inner));
+        t.wait();
+        CV_Assert(inner >= 0);
+        *stamp = CV_XADD(counter, 1);
+    }
+
+protected:
+    int* counter;
+    int* stamp;
+};
+
+}
+
+TEST(Core_Parallel, every_index_is_processed_once)
+{
+    int prevThreads = getNumThreads();
+    const int threads[] = { 1, 2, 3, 8, 0 };
+    const int lengths[] = { 1, 2, 7, 100, 1001 };
+    const double stripes[] = { -1, 1, 2, 3, 1000 };
+
+    for (size_t t = 0; t < sizeof(threads)/sizeof(threads[0]); t++)
+    {
+        setNumThreads(threads[t]);
+        for (size_t l = 0; l < sizeof(lengths)/sizeof(lengths[0]); l++)
+            for (size_t s = 0; s < sizeof(stripes)/sizeof(stripes[0]); s++)
+            {
+                std::vector<int> hits(lengths[l] + 10, 0);
+                parallel_for_(Range(10, lengths[l] + 10), CountingBody(hits), stripes[s]);
+                for (int i = 0; i < (int)hits.size(); i++)
+                    ASSERT_EQ(i < 10 ? 0 : 1, hits[i])
+                        << "threads=" << threads[t] << " len=" << lengths[l] << " nstripes=" << stripes[s];
+            }
+    }
+
+    setNumThreads(prevThreads);
+}
+
+TEST(Core_Parallel, imbalanced_load)
+{
+    const int n = 500;
+    std::vector<double> res(n, -1.), ref(n, -1.);
+
+    ImbalancedBody serial(ref);
+    serial(Range(0, n));
+    parallel_for_(Range(0, n), ImbalancedBody(res));
+
+    for (int i = 0; i < n; i++)
+        ASSERT_EQ(ref[i], res[i]) << i;
+}
+
+TEST(Core_Parallel, nested_regions)
+{
+    int prevThreads = getNumThreads();
+    const int threads[] = { 2, 4, 0 };
+
+    for (size_t t = 0; t < sizeof(threads)/sizeof(threads[0]); t++)
+    {
+        setNumThreads(threads[t]);
+
+        Mat m(64, 77, CV_32S, Scalar::all(0));
+        parallel_for_(Range(0, m.rows), NestedBody(m));
+
+        EXPECT_EQ(0, cvtest::norm(m, Mat(m.size(), m.type(), Scalar::all(1)), NORM_INF))
+            << "threads=" << threads[t];
+    }
+
+    setNumThreads(prevThreads);
+}
+
+TEST(Core_Parallel, concurrent_callers)
+{
+    class CallerBody : public ParallelLoopBody
+    {
+    public:
+        void operator()(const Range& r) const
+        {
+            for (int i = r.start; i < r.end; i++)
+            {
+                std::vector<int> hits(1000, 0);
+                parallel_for_(Range(0, 1000), CountingBody(hits), 16);
+                for (size_t k = 0; k < hits.size(); k++)
+                    CV_Assert(hits[k] == 1);
+            }
+        }
+    };
+
+    EXPECT_NO_THROW(parallel_for_(Range(0, 32), CallerBody()));
+}
+
+TEST(Core_Parallel, exception_is_propagated)
+{
+    // other backends don't transfer exceptions between threads
+    if (String(currentParallelFramework() ? currentParallelFramework() : "") != "pthreads")
+        return;
+
+    int prevThreads = getNumThreads();
+    setNumThreads(4);
+
+    EXPECT_THROW(parallel_for_(Range(0, 100), ThrowingBody()), cv::Exception);
+
+    // the pool must stay usable
+    std::vector<int> hits(100, 0);
+    parallel_for_(Range(0, 100), CountingBody(hits));
+    for (size_t i = 0; i < hits.size(); i++)
+        EXPECT_EQ(1, hits[i]);
+
+    setNumThreads(prevThreads);
+}
+
+TEST(Core_Parallel, async_dependencies)
+{
+    int prevThreads = getNumThreads();
+    const int threads[] = { 1, 2, 4, 0 };
+
+    for (size_t t = 0; t < sizeof(threads)/sizeof(threads[0]); t++)
+    {
+        setNumThreads(threads[t]);
+
+        // diamond: a -> (b, c) -> d
+        int counter = 0, a = -1, b = -1, c = -1, d = -1;
+        AsyncTask ta = parallel_async(makePtr<StampTask>(&counter, &a));
+        std::vector<AsyncTask> deps(1, ta);
+        AsyncTask tb = parallel_async(makePtr<StampTask>(&counter, &b), deps);
+        AsyncTask tc = parallel_async(makePtr<StampTask>(&counter, &c), deps);
+        deps.clear();
+        deps.push_back(tb);
+        deps.push_back(tc);
+        deps.push_back(AsyncTask()); // ignored
+        AsyncTask td = parallel_async(makePtr<StampTask>(&counter, &d), deps);
+
+        ASSERT_TRUE(td.valid());
+        td.wait();
+        EXPECT_TRUE(ta.ready() && tb.ready() && tc.ready() && td.ready());
+        EXPECT_EQ(4, counter);
+        EXPECT_EQ(0, a) << "threads=" << threads[t];
+        EXPECT_LT(a, b);
+        EXPECT_LT(a, c);
+        EXPECT_EQ(3, d);
+
+        // a dependency which is done already
+        AsyncTask te = parallel_async(makePtr<StampTask>(&counter, &a), std::vector<AsyncTask>(1, td));
+        te.wait();
+        EXPECT_EQ(4, a);
+    }
+
+    setNumThreads(prevThreads);
+}
+
+TEST(Core_Parallel, async_tasks_share_the_pool)
+{
+    int prevThreads = getNumThreads();
+    const int threads[] = { 1, 3, 0 };
+
+    for (size_t t = 0; t < sizeof(threads)/sizeof(threads[0]); t++)
+    {
+        setNumThreads(threads[t]);
+
+        const int ntasks = 8;
+        std::vector<Mat> src(ntasks), dst(ntasks);
+        std::vector<AsyncTask> tasks;
+        for (int i = 0; i < ntasks; i++)
+        {
+            src[i].create(100 + i, 50, CV_32F);
+            randu(src[i], 0, 1);
+            tasks.push_back(parallel_async(makePtr<RowSumTask>(src[i], &dst[i])));
+        }
+
+        int counter = 0, stamp = -1;
+        AsyncTask last = parallel_async(makePtr<WaitingTask>(&counter, &stamp), tasks);
+        last.wait();
+        EXPECT_EQ(1, stamp);
+
+        for (int i = 0; i < ntasks; i++)
+        {
+            ASSERT_TRUE(tasks[i].ready());
+            Mat ref;
+            reduce(src[i], ref, 1, REDUCE_SUM, CV_64F);
+            EXPECT_EQ(0, cvtest::norm(ref, dst[i], NORM_INF)) << "threads=" << threads[t] << " task=" << i;
+        }
+    }
+
+    setNumThreads(prevThreads);
+}
+
+TEST(Core_Parallel, async_wait_from_tasks)
+{
+    int prevThreads = getNumThreads();
+    setNumThreads(2);
+
+    // more waiting tasks than threads in the pool
+    const int ntasks = 16;
+    int counter = 0;
+    std::vector<int> stamps(ntasks, -1);
+    std::vector<AsyncTask> tasks;
+    for (int i = 0; i < ntasks; i++)
+        tasks.push_back(parallel_async(makePtr<WaitingTask>(&counter, &stamps[i])));
+    for (int i = 0; i < ntasks; i++)
+        tasks[i].wait();
+
+    EXPECT_EQ(2*ntasks, counter);
+    for (int i = 0; i < ntasks; i++)
+        EXPECT_GE(stamps[i], 0);
+
+    setNumThreads(prevThreads);
+}
+
+TEST(Core_Parallel, async_exception_is_propagated)
+{
+    int prevThreads = getNumThreads();
+    const int threads[] = { 1, 4 };
+
+    for (size_t t = 0; t < sizeof(threads)/sizeof(threads[0]); t++)
+    {
+        setNumThreads(threads[t]);
+
+        int counter = 0, a = -1, b = -1, c = -1;
+        AsyncTask ta = parallel_async(makePtr<StampTask>(&counter, &a, true));
+        AsyncTask tb = parallel_async(makePtr<StampTask>(&counter, &b), std::vector<AsyncTask>(1, ta));
+        AsyncTask tc = parallel_async(makePtr<StampTask>(&counter, &c));
+
+        EXPECT_THROW(ta.wait(), cv::Exception);
+        EXPECT_THROW(tb.wait(), cv::Exception);
+        EXPECT_NO_THROW(tc.wait());
+        EXPECT_EQ(-1, b) << "the task depending on the failed one must not run";
+        EXPECT_EQ(0, c);
+    }
+
+    setNumThreads(prevThreads);
+}
+
+TEST(Core_Parallel, numa_topology)
+{
+    int nnodes = getNumberOfNumaNodes();
+    ASSERT_GE(nnodes, 1);
+
+    size_t ncpus = 0;
+    for (int node = 0; node < nnodes; node++)
+    {
+        std::vector<int> cpus;
+        getNumaNodeCPUs(node, cpus);
+        ncpus += cpus.size();
+    }
+    EXPECT_GE(ncpus, 1u);
+}
+
+TEST(Core_Parallel, pinned_pool)
+{
+    if (String(currentParallelFramework() ? currentParallelFramework() : "") != "pthreads")
+        return;
+
+    std::vector<int> prevCpus, cpus, node_cpus;
+    getThreadAffinity(prevCpus);
+
+    // all the CPUs of the system, starting from the last node, to check the reordering
+    for (int node = getNumberOfNumaNodes() - 1; node >= 0; node--)
+    {
+        getNumaNodeCPUs(node, node_cpus);
+        cpus.insert(cpus.end(), node_cpus.begin(), node_cpus.end());
+    }
+
+    setThreadAffinity(cpus);
+
+    std::vector<int> pinned;
+    getThreadAffinity(pinned);
+    ASSERT_EQ(cpus.size(), pinned.size());
+    EXPECT_EQ((int)cpus.size(), getNumThreads());
+    getNumaNodeCPUs(0, node_cpus);
+    EXPECT_EQ(node_cpus[0], pinned[0]);
+
+    for (int iter = 0; iter < 3; iter++)
+    {
+        std::vector<int> hits(1001, 0);
+        parallel_for_(Range(0, 1001), CountingBody(hits));
+        for (size_t i = 0; i < hits.size(); i++)
+            ASSERT_EQ(1, hits[i]) << i;
+
+        Mat m(64, 77, CV_32S, Scalar::all(0));
+        parallel_for_(Range(0, m.rows), NestedBody(m));
+        ASSERT_EQ(0, cvtest::norm(m, Mat(m.size(), m.type(), Scalar::all(1)), NORM_INF));
+    }
+
+    // large matrices are touched by the pinned threads on creation
+    Mat big(2048, 2048, CV_32F, Scalar::all(1));
+    EXPECT_EQ(2048.*2048., sum(big)[0]);
+
+    setThreadAffinity(prevCpus);
+    getThreadAffinity(pinned);
+    EXPECT_EQ(prevCpus.size(), pinned.size());
+}
+
+TEST(Core_Parallel, separate_pools)
+{
+    if (String(currentParallelFramework() ? currentParallelFramework() : "") != "pthreads")
+        return;
+
+    int prevThreads = getNumThreads();
+    setNumThreads(2);
+
+    setThreadPool(1);
+    EXPECT_EQ(1, getThreadPool());
+    int prevPoolThreads = getNumThreads();
+    setNumThreads(3);
+    EXPECT_EQ(3, getNumThreads());
+
+    std::vector<int> hits(500, 0);
+    parallel_for_(Range(0, 500), CountingBody(hits));
+
+    // a task of the pool 1 can be waited from anywhere
+    int counter = 0, a = -1;
+    AsyncTask task = parallel_async(makePtr<StampTask>(&counter, &a));
+
+    setThreadPool(0);
+    EXPECT_EQ(0, getThreadPool());
+    EXPECT_EQ(2, getNumThreads());
+
+    task.wait();
+    EXPECT_EQ(0, a);
+    for (size_t i = 0; i < hits.size(); i++)
+        EXPECT_EQ(1, hits[i]) << i;
+
+    // disabling the threads of the pool 1 leaves the pool 0 alone
+    setThreadPool(1);
+    setNumThreads(0);
+    EXPECT_EQ(1, getNumThreads());
+    setThreadPool(0);
+    EXPECT_EQ(2, getNumThreads());
+
+    setThreadPool(1);
+    setNumThreads(prevPoolThreads);
+    setThreadPool(0);
+    setNumThreads(prevThreads);
+}
+
+TEST(Core_Parallel, adaptive_stripes)
+{
+    const double freq = 1e9;
+    ParallelStripeStats stats;
+
+    // an unknown call site keeps the default
+    EXPECT_EQ(-1., stats.stripes(1000, freq, -1.));
+
+    // the first calls are timed, then only one in sampleInterval
+    int timed = 0, ncalls = 10*(int)ParallelStripeStats::sampleInterval;
+    for (int i = 0; i < ncalls; i++)
+    {
+        if (stats.sample())
+        {
+            timed++;
+            stats.update(1000, 1000);
+        }
+    }
+    EXPECT_EQ((int)(ParallelStripeStats::warmupCalls + ncalls/ParallelStripeStats::sampleInterval), timed);
+    EXPECT_FALSE(stats.sample());
+
+    // 1 tick per element: 1 microsecond in total, too cheap to wake up the pool
+    EXPECT_DOUBLE_EQ(1., stats.ticksPerElem);
+    EXPECT_EQ(1., stats.stripes(1000, freq, -1.));
+
+    // a heavy loop is split into the stripes of stripeTime seconds, at least 2 of them
+    ParallelStripeStats heavy;
+    heavy.update(1000, (int64)(freq*ParallelStripeStats::stripeTime*100));
+    EXPECT_DOUBLE_EQ(100., heavy.stripes(1000, freq, -1.));
+    EXPECT_DOUBLE_EQ(200., heavy.stripes(2000, freq, -1.));
+    // and a single cheap call does not make it serial
+    heavy.update(1000, (int64)(freq*ParallelStripeStats::minParallelTime));
+    EXPECT_LE(2., heavy.stripes(1000, freq, -1.));
+
+    // the estimate follows the changes of the time smoothly
+    ParallelStripeStats changing;
+    changing.update(100, 100*1000);
+    changing.update(100, 100*2000);
+    EXPECT_DOUBLE_EQ(1250., changing.ticksPerElem);
+
+    if (String(currentParallelFramework() ? currentParallelFramework() : "") != "pthreads")
+        return;
+
+    // an explicit nstripes is not changed
+    int prevThreads = getNumThreads();
+    setNumThreads(4);
+    int calls = 0;
+    parallel_for_(Range(0, 64), CallCountingBody(&calls, 1), 64);
+    EXPECT_GT(calls, 1);
+    setNumThreads(prevThreads);
+}
@@ -220,6 +220,70 @@ TEST(CommandLineParser, positional_regression_5074_equal_sign)
 }
 
 
+#ifdef ENABLE_INSTRUMENTATION
+class TimelineAddBody : public ParallelLoopBody
+{
+public:
+    TimelineAddBody(const Mat& _src) : src(_src) {}
+
+    void operator()(const Range& range) const
+    {
+        Mat dst;
+        for (int i = range.start; i < range.end; i++)
+            cv::add(src, src, dst);
+    }
+
+    Mat src;
+};
+#endif
+
+TEST(Core_Instrumentation, timeline)
+{
+    String file = cv::tempfile(".json");
+#ifdef ENABLE_INSTRUMENTATION
+    bool useInstr = cv::instr::useInstrumentation();
+    cv::instr::FLAGS flags = cv::instr::getFlags();
+    cv::instr::setUseInstrumentation(true);
+    cv::instr::setFlags(cv::instr::FLAGS_MAPPING | cv::instr::FLAGS_TIMELINE);
+
+    // the regions recorded by the other threads before the reset are dropped as well
+    Mat src(512, 512, CV_32F, Scalar::all(1)), dst;
+    parallel_for_(Range(0, 16), TimelineAddBody(src));
+    cv::instr::resetTrace();
+
+    for (int i = 0; i < 3; i++)
+        cv::add(src, src, dst);
+
+    bool dumped = cv::instr::dumpTimeline(file);
+    cv::instr::setFlags(flags);
+    cv::instr::resetTrace();
+    cv::instr::setUseInstrumentation(useInstr);
+    ASSERT_TRUE(dumped);
+
+    // the trace is a valid JSON file
+    FileStorage fs(file, FileStorage::READ);
+    FileNode events = fs["traceEvents"];
+    ASSERT_TRUE(events.isSeq());
+    int regions = 0;
+    double last = -1;
+    for (FileNodeIterator it = events.begin(); it != events.end(); ++it)
+    {
+        FileNode e = *it;
+        if ((String)e["ph"] != "X" || (String)e["name"] != "add")
+            continue;
+        EXPECT_EQ(String("plain"), (String)e["cat"]);
+        EXPECT_GE((double)e["dur"], 0.);
+        EXPECT_GT((double)e["ts"], last);
+        last = (double)e["ts"];
+        regions++;
+    }
+    EXPECT_EQ(3, regions);
+#else
+    EXPECT_FALSE(cv::instr::dumpTimeline(file));
+#endif
+    remove(file.c_str());
+}
+
 TEST(AutoBuffer, allocate_test)
 {
     AutoBuffer<int, 5> abuf(2);
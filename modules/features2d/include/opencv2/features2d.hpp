@@ -1261,6 +1261,10 @@ class CV_EXPORTS_W BOWKMeansTrainer : public BOWTrainer
 public:
     /** @brief The constructor.
 
+    The parameters are passed to cv::kmeans. For the large vocabularies use KMEANS_MINI_BATCH or
+    KMEANS_HAMERLY, combined with KMEANS_USE_GEMM where applicable. The descriptors of other than
+    CV_32F type are converted to floats before clustering.
+
     @see cv::kmeans
     */
     CV_WRAP BOWKMeansTrainer( int clusterCount, const TermCriteria& termcrit=TermCriteria(),
@@ -110,8 +110,10 @@ Mat BOWKMeansTrainer::cluster( const Mat& _descriptors ) const
 {
     CV_INSTRUMENT_REGION()
 
-    Mat labels, vocabulary;
-    kmeans( _descriptors, clusterCount, labels, termcrit, attempts, flags, vocabulary );
+    Mat labels, vocabulary, samples = _descriptors;
+    if( samples.type() != CV_32F )
+        _descriptors.convertTo( samples, CV_32F );
+    kmeans( samples, clusterCount, labels, termcrit, attempts, flags, vocabulary );
     return vocabulary;
 }
 
@@ -1354,15 +1354,37 @@ positive and odd. Or, they can be zero's and then they are computed from sigma.
 equal to sigmaX, if both sigmas are zeros, they are computed from ksize.width and ksize.height,
 respectively (see cv::getGaussianKernel for details); to fully control the result regardless of
 possible future modifications of all this semantics, it is recommended to specify all of ksize,
-sigmaX, and sigmaY.
+sigmaX, and sigmaY. When ksize is zero and both sigmas are 10 or larger, the image is blurred by
+recursiveGaussianBlur, unless src is a ROI whose borders are taken from the parent image.
 @param borderType pixel extrapolation method, see cv::BorderTypes
 
-@sa  sepFilter2D, filter2D, blur, boxFilter, bilateralFilter, medianBlur
+@sa  sepFilter2D, filter2D, blur, boxFilter, bilateralFilter, medianBlur, recursiveGaussianBlur
  */
 CV_EXPORTS_W void GaussianBlur( InputArray src, OutputArray dst, Size ksize,
                                 double sigmaX, double sigmaY = 0,
                                 int borderType = BORDER_DEFAULT );
 
+/** @brief Blurs an image using the recursive approximation of a Gaussian filter.
+
+The function approximates the Gaussian with a third-order recursive filter run forward and backward
+along the columns and then along the rows (Young, van Vliet and van Ginkel, 2002), so its cost does
+not depend on sigma. For sigma of a few pixels and larger the result is within about 1% of the
+dynamic range from the one of GaussianBlur with the kernel size computed from sigma. The image is
+processed in double precision, and the borders are extrapolated at the edges of src as if
+BORDER_ISOLATED was specified. In-place filtering is supported.
+
+@param src input image with 1 to 4 channels of depth CV_8U, CV_16U, CV_16S, CV_32F or CV_64F.
+@param dst output image of the same size and type as src.
+@param sigmaX Gaussian standard deviation in X direction; it must be positive.
+@param sigmaY Gaussian standard deviation in Y direction; if it is not positive, it is set to be
+equal to sigmaX.
+@param borderType pixel extrapolation method, see cv::BorderTypes (BORDER_TRANSPARENT is not supported)
+
+@sa  GaussianBlur
+ */
+CV_EXPORTS_W void recursiveGaussianBlur( InputArray src, OutputArray dst, double sigmaX,
+                                         double sigmaY = 0, int borderType = BORDER_DEFAULT );
+
 /** @brief Applies the bilateral filter to an image.
 
 The function applies bilateral filtering to the input image, as described in
@@ -2823,6 +2845,111 @@ same as src. dst[1] is the next pyramid layer, a smoothed and down-sized src, an
 CV_EXPORTS void buildPyramid( InputArray src, OutputArrayOfArrays dst,
                               int maxlevel, int borderType = BORDER_DEFAULT );
 
+/** @brief Constructs the Laplacian pyramid for an image.
+
+The function builds the Gaussian pyramid with buildPyramid and stores the differences between its
+layers and the upsampled next layers: `dst[i] = G[i] - pyrUp(G[i+1], G[i].size())` for i < maxlevel,
+while `dst[maxlevel] = G[maxlevel]`. The image can be restored by adding the upsampled layers back,
+starting from the smallest one.
+
+@param src Source image. Check pyrDown for the list of supported types.
+@param dst Destination vector of maxlevel+1 images of the same size as the layers of the Gaussian
+pyramid. dst[maxlevel] has the same type as src.
+@param maxlevel 0-based index of the last (the smallest) pyramid layer. It must be non-negative.
+@param ddepth Depth of the layers 0 ... maxlevel-1; when it is negative, CV_16S is used for 8-bit
+images, CV_32F for 16-bit unsigned ones and the depth of src otherwise.
+@param borderType Pixel extrapolation method for the Gaussian pyramid, see cv::BorderTypes
+(BORDER_CONSTANT isn't supported)
+ */
+CV_EXPORTS void buildLaplacianPyramid( InputArray src, OutputArrayOfArrays dst, int maxlevel,
+                                       int ddepth = -1, int borderType = BORDER_DEFAULT );
+
+/** @brief Chain of row-local image operations executed without the full-size intermediate images.
+
+The pipeline applies the added operations one after another, giving the same result as the
+sequence of the corresponding function calls, with one exception: addGaussianBlur always filters
+with the explicit kernel, while GaussianBlur with ksize=(0,0) and both sigmas 10 or larger switches
+to recursiveGaussianBlur, which is not row-local and gives a slightly different result. Instead of passing the whole image through every
+operation, it splits the output into horizontal bands processed in parallel and pushes the source
+rows of every band through the whole chain a few rows at a time, so the intermediate rows stay in
+the cache. The filters keep the rows they still need in the row buffers of their filter engines.
+
+Only the operations that compute an output row from a few neighbour rows of their input can be
+chained. The arithmetic operations take a scalar operand only: the operations with a second image,
+such as the sum or the difference of two images, are not supported. The borders are extrapolated at the edges of the source image, as if BORDER_ISOLATED
+was specified.
+@code
+    Ptr<ImagePipeline> edges = createImagePipeline();
+    edges->addCvtColor(COLOR_BGR2GRAY);
+    edges->addGaussianBlur(Size(5, 5), 1.5);
+    edges->addSobel(CV_16S, 1, 0);
+    edges->addConvertScaleAbs();
+    edges->addThreshold(100, 255, THRESH_BINARY);
+    edges->apply(frame, mask);
+@endcode
+ */
+class CV_EXPORTS ImagePipeline : public Algorithm
+{
+public:
+    virtual ~ImagePipeline();
+
+    /** @brief Adds cvtColor to the chain.
+
+    The conversions that change the image size (YUV 4:2:0) and the demosaicing are not supported.
+     */
+    virtual void addCvtColor(int code, int dstCn = 0) = 0;
+
+    //! Adds sepFilter2D to the chain.
+    virtual void addSepFilter2D(int ddepth, InputArray kernelX, InputArray kernelY,
+                                Point anchor = Point(-1,-1), double delta = 0,
+                                int borderType = BORDER_DEFAULT) = 0;
+
+    /** @brief Adds GaussianBlur to the chain.
+
+    The explicit kernel is used for any sigma, the recursive filter GaussianBlur may switch to for
+    large sigmas is never used here.
+     */
+    virtual void addGaussianBlur(Size ksize, double sigmaX, double sigmaY = 0,
+                                 int borderType = BORDER_DEFAULT) = 0;
+
+    //! Adds Sobel to the chain.
+    virtual void addSobel(int ddepth, int dx, int dy, int ksize = 3, double scale = 1,
+                          double delta = 0, int borderType = BORDER_DEFAULT) = 0;
+
+    /** @brief Adds threshold to the chain.
+
+    THRESH_OTSU and THRESH_TRIANGLE are not supported.
+     */
+    virtual void addThreshold(double thresh, double maxval, int type) = 0;
+
+    //! Adds Mat::convertTo to the chain. A negative ddepth keeps the depth.
+    virtual void addConvertTo(int ddepth, double alpha = 1, double beta = 0) = 0;
+
+    //! Adds convertScaleAbs to the chain.
+    virtual void addConvertScaleAbs(double alpha = 1, double beta = 0) = 0;
+
+    //! Adds add(src, value, dst, noArray(), ddepth) to the chain. A negative ddepth keeps the depth.
+    virtual void addAdd(const Scalar& value, int ddepth = -1) = 0;
+
+    //! Adds multiply(src, value, dst, scale, ddepth) to the chain. A negative ddepth keeps the depth.
+    virtual void addMultiply(const Scalar& value, double scale = 1, int ddepth = -1) = 0;
+
+    //! Adds absdiff(src, value, dst) to the chain.
+    virtual void addAbsdiff(const Scalar& value) = 0;
+
+    /** @brief Applies the chain to the image.
+
+    @param src Source image.
+    @param dst Destination image of the same size as src and the type produced by the last operation.
+    It may be the same as src.
+     */
+    virtual void apply(InputArray src, OutputArray dst) = 0;
+};
+
+/** @brief Creates an empty ImagePipeline.
+ */
+CV_EXPORTS Ptr<ImagePipeline> createImagePipeline();
+
 //! @} imgproc_filter
 
 //! @addtogroup imgproc_transform
@@ -205,3 +205,35 @@ PERF_TEST_P(Size_MatType_BorderType, blur5x5,
 
     SANITY_CHECK(dst, 1);
 }
+
+typedef std::tr1::tuple<MatType, double, bool> Type_Sigma_Recursive_t;
+typedef perf::TestBaseWithParam<Type_Sigma_Recursive_t> Type_Sigma_Recursive;
+
+// the explicit kernel and the recursive filter for the large sigmas
+PERF_TEST_P(Type_Sigma_Recursive, GaussianBlur_largeSigma,
+            testing::Combine(
+                testing::Values(CV_8UC1, CV_8UC3, CV_32FC1),
+                testing::Values(5., 10., 30., 80.),
+                testing::Bool()
+                )
+            )
+{
+    int type = get<0>(GetParam());
+    double sigma = get<1>(GetParam());
+    bool recursive = get<2>(GetParam());
+
+    Mat src(sz1080p, type), dst(sz1080p, type);
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    if (recursive)
+    {
+        TEST_CYCLE() recursiveGaussianBlur(src, dst, sigma);
+    }
+    else
+    {
+        int ksize = cvRound(sigma*(CV_MAT_DEPTH(type) == CV_8U ? 3 : 4)*2 + 1) | 1;
+        TEST_CYCLE() GaussianBlur(src, dst, Size(ksize, ksize), sigma);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
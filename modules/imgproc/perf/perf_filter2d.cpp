@@ -72,3 +72,32 @@ PERF_TEST_P( Image_KernelSize, GaborFilter2d,
 
     SANITY_CHECK(filteredImage, 1e-6, ERROR_RELATIVE);
 }
+
+typedef TestBaseWithParam< tr1::tuple<int, int> > KernelSize_Threads;
+
+PERF_TEST_P( KernelSize_Threads, Filter2d_scaling,
+             Combine(
+                Values( 3, 7 ),
+                Values( 1, 2, 4, 8 )
+             )
+)
+{
+    int kSize = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Mat src(sz1080p, CV_8UC1);
+    Mat dst(sz1080p, CV_8UC1);
+
+    Mat kernel(kSize, kSize, CV_32FC1);
+    randu(kernel, -3, 10);
+    double s = fabs( sum(kernel)[0] );
+    if(s > 1e-3) kernel /= s;
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() filter2D(src, dst, -1, kernel);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -39,3 +39,51 @@ PERF_TEST_P(Size_MatType, dilate, TYPICAL_MATS_MORPH)
 
     SANITY_CHECK(dst);
 }
+
+typedef perf::TestBaseWithParam< std::tr1::tuple<int, int> > KSize_Threads;
+
+PERF_TEST_P(KSize_Threads, erode_rect_scaling,
+            testing::Combine(
+                testing::Values(3, 15, 31, 61),
+                testing::Values(1, 2, 4, 8)
+            )
+)
+{
+    int ksize = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Mat src(sz2160p, CV_8UC1);
+    Mat dst(sz2160p, CV_8UC1);
+    Mat kernel = getStructuringElement(MORPH_RECT, Size(ksize, ksize));
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() erode(src, dst, kernel);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(KSize_Threads, open_rect_scaling,
+            testing::Combine(
+                testing::Values(3, 31, 61),
+                testing::Values(1, 4)
+            )
+)
+{
+    int ksize = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Mat src(sz1080p, CV_8UC1);
+    Mat dst(sz1080p, CV_8UC1);
+    Mat kernel = getStructuringElement(MORPH_RECT, Size(ksize, ksize));
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() morphologyEx(src, dst, MORPH_OPEN, kernel);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -0,0 +1,51 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef perf::TestBaseWithParam<std::tr1::tuple<bool, int> > Pipeline_Threads;
+
+// the edge detection chain called function by function and as the pipeline
+PERF_TEST_P(Pipeline_Threads, edges,
+            testing::Combine(
+                testing::Bool(),
+                testing::Values(1, 2, 4, 8)
+            )
+          )
+{
+    bool usePipeline = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Mat src(Size(3840, 2160), CV_8UC3), dst(src.size(), CV_8UC1);
+    Mat gray, blurred, gx;
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    Ptr<ImagePipeline> edges = createImagePipeline();
+    edges->addCvtColor(COLOR_BGR2GRAY);
+    edges->addGaussianBlur(Size(5, 5), 1.5);
+    edges->addSobel(CV_16S, 1, 0);
+    edges->addConvertScaleAbs();
+    edges->addThreshold(100, 255, THRESH_BINARY);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE()
+    {
+        if (!usePipeline)
+        {
+            cvtColor(src, gray, COLOR_BGR2GRAY);
+            GaussianBlur(gray, blurred, Size(5, 5), 1.5);
+            Sobel(blurred, gx, CV_16S, 1, 0);
+            convertScaleAbs(gx, dst);
+            threshold(dst, dst, 100, 255, THRESH_BINARY);
+        }
+        else
+            edges->apply(src, dst);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
@@ -74,3 +74,47 @@ PERF_TEST_P(Size_MatType, buildPyramid, testing::Combine(
     SANITY_CHECK(dst3, eps, error_type);
     SANITY_CHECK(dst4, eps, error_type);
 }
+
+typedef perf::TestBaseWithParam< std::tr1::tuple<int, int> > MatType_Threads;
+
+PERF_TEST_P(MatType_Threads, buildPyramid_scaling, testing::Combine(
+                testing::Values(CV_8UC1, CV_8UC3),
+                testing::Values(1, 2, 4, 8)
+                )
+            )
+{
+    int matType = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+    int maxLevel = 8;
+    Mat src(sz2160p, matType);
+    std::vector<Mat> dst;
+
+    declare.in(src, WARMUP_RNG);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() buildPyramid(src, dst, maxLevel);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(MatType_Threads, buildLaplacianPyramid_scaling, testing::Combine(
+                testing::Values(CV_8UC1, CV_32FC1),
+                testing::Values(1, 4)
+                )
+            )
+{
+    int matType = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+    int maxLevel = 5;
+    Mat src(sz2160p, matType);
+    std::vector<Mat> dst;
+
+    declare.in(src, WARMUP_RNG);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() buildLaplacianPyramid(src, dst, maxLevel);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -242,3 +242,29 @@ PERF_TEST_P(Size_MatType_dx_dy_Border3x3ROI, scharrViaSobelFilter,
 
     SANITY_CHECK(dst);
 }
+
+/**************** Scaling with the number of threads ********************/
+
+typedef perf::TestBaseWithParam<std::tr1::tuple<int, int> > KSize_Threads;
+
+PERF_TEST_P(KSize_Threads, sepFilter2D_scaling,
+            testing::Combine(
+                testing::Values(3, 7, 15),
+                testing::Values(1, 2, 4, 8)
+            )
+          )
+{
+    int ksize = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Mat src(sz1080p, CV_8UC1), dst(sz1080p, CV_16SC1);
+    Mat kx = getGaussianKernel(ksize, 0, CV_32F), ky = kx.clone();
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    declare.tbb_threads(threads);
+
+    TEST_CYCLE() sepFilter2D(src, dst, CV_16S, kx, ky);
+
+    SANITY_CHECK_NOTHING();
+}
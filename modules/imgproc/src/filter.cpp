@@ -45,6 +45,9 @@
 #include "opencl_kernels_imgproc.hpp"
 #include "hal_replacement.hpp"
 
+#include "filter.simd.hpp"
+#include "filter.simd_declarations.hpp" // generated by ocv_add_dispatched_file(), see CMakeLists.txt
+
 /****************************************************************************************\
                                     Base Image Filter
 \****************************************************************************************/
@@ -391,6 +394,67 @@ void FilterEngine::apply(const Mat& src, Mat& dst, const Size & wsz, const Point
             (int)dst.step );
 }
 
+FilterEngineFactory::~FilterEngineFactory() {}
+
+/*
+   Every band is filtered as a ROI of the whole image: the engine takes the rows above and below
+   the band from the image itself and interpolates only the rows outside of the whole image, so
+   the result is the same as when the image is filtered at once. The price is that the rows around
+   the boundaries of the bands are passed through the row filter twice, hence the minimal height
+   of a band, which is proportional to the kernel height.
+*/
+class FilterBandInvoker : public ParallelLoopBody
+{
+public:
+    FilterBandInvoker(const FilterEngineFactory& _factory, const Mat& _src, Mat& _dst,
+                      const Size& _wsz, const Point& _ofs, int _nbands)
+        : factory(_factory), src(_src), dst(_dst), wsz(_wsz), ofs(_ofs), nbands(_nbands)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        int y0 = (int)((int64)src.rows*range.start/nbands);
+        int y1 = (int)((int64)src.rows*range.end/nbands);
+
+        Mat srcBand = src.rowRange(y0, y1), dstBand = dst.rowRange(y0, y1);
+        Ptr<FilterEngine> f = factory.create();
+        f->apply(srcBand, dstBand, wsz, Point(ofs.x, ofs.y + y0));
+    }
+
+private:
+    const FilterEngineFactory& factory;
+    const Mat& src;
+    Mat& dst;
+    Size wsz;
+    Point ofs;
+    int nbands;
+};
+
+void FilterEngine::apply(const Mat& src, Mat& dst, const Size& wsz, const Point& ofs,
+                         const FilterEngineFactory& factory)
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( src.type() == srcType && dst.type() == dstType && src.size() == dst.size() );
+
+    const int minBandHeight = std::max(32, ksize.height*4);
+    const double minParallelWork = 1 << 18;
+
+    int nthreads = getNumThreads();
+    int nbands = std::min(src.rows/minBandHeight, nthreads*2);
+
+    // the in-place filtering needs the source rows above the band, which have been overwritten by then
+    if( nthreads <= 1 || nbands < 2 || (double)src.total()*ksize.area() < minParallelWork ||
+        src.empty() || isOverlapped(src, dst) )
+    {
+        apply(src, dst, wsz, ofs);
+        return;
+    }
+
+    parallel_for_(Range(0, nbands), FilterBandInvoker(factory, src, dst, wsz, ofs, nbands), nbands);
+}
+
 }
 
 /****************************************************************************************\
@@ -1349,6 +1413,18 @@ struct SymmColumnVec_32f16s
 
 /////////////////////////////////////// 32f //////////////////////////////////
 
+// the 256-bit kernels from filter.simd.hpp for the CPUs that support them
+static int rowFilterWide32f(const float* src, float* dst, const float* kx, int ksize, int width, int cn)
+{
+    CV_CPU_DISPATCH(rowFilterWide32f, (src, dst, kx, ksize, width, cn));
+}
+
+static int symmColumnFilterWide32f(const float** src, float* dst, const float* ky, int ksize2,
+                                   float delta, int width, bool symmetrical)
+{
+    CV_CPU_DISPATCH(symmColumnFilterWide32f, (src, dst, ky, ksize2, delta, width, symmetrical));
+}
+
 struct RowVec_32f
 {
     RowVec_32f()
@@ -1383,7 +1459,7 @@ struct RowVec_32f
         if( !haveSSE )
             return 0;
 
-        int i = 0, k;
+        int i = rowFilterWide32f(src0, dst, _kx, _ksize, width, cn), k;
         width *= cn;
 
         for( ; i <= width - 8; i += 8 )
@@ -1662,11 +1738,11 @@ struct SymmColumnVec_32f
 
         int ksize2 = (kernel.rows + kernel.cols - 1)/2;
         const float* ky = kernel.ptr<float>() + ksize2;
-        int i = 0, k;
         bool symmetrical = (symmetryType & KERNEL_SYMMETRICAL) != 0;
         const float** src = (const float**)_src;
         const float *S, *S2;
         float* dst = (float*)_dst;
+        int i = symmColumnFilterWide32f(src, dst, ky, ksize2, delta, width, symmetrical), k;
         __m128 d4 = _mm_set1_ps(delta);
 
         if( symmetrical )
@@ -4742,7 +4818,7 @@ struct DftFilter : public hal::Filter2D
     {
         anchor = Point(anchor_x, anchor_y);
         borderType = borderType_;
-        kernel = Mat(Size(kernel_width, kernel_height), kernel_type, kernel_data, kernel_step);
+        kernel = Mat(Size(kernel_width, kernel_height), kernel_type, kernel_data, kernel_step).clone();
         src_type = stype;
         dst_type = dtype;
         delta = delta_;
@@ -4793,12 +4869,16 @@ struct DftFilter : public hal::Filter2D
     }
 };
 
-struct OcvFilter : public hal::Filter2D
+struct OcvFilter : public hal::Filter2D, public FilterEngineFactory
 {
     Ptr<FilterEngine> f;
     int src_type;
     int dst_type;
     bool isIsolated;
+    Mat kernel;
+    Point anchor;
+    double kernelDelta;
+    int borderTypeValue;
 
     bool init(uchar* kernel_data, size_t kernel_step, int kernel_type, int kernel_width,
               int kernel_height, int, int, int stype, int dtype, int borderType, double delta,
@@ -4807,17 +4887,22 @@ struct OcvFilter : public hal::Filter2D
         isIsolated = (borderType & BORDER_ISOLATED) != 0;
         src_type = stype;
         dst_type = dtype;
-        int borderTypeValue = borderType & ~BORDER_ISOLATED;
-        Mat kernel = Mat(Size(kernel_width, kernel_height), kernel_type, kernel_data, kernel_step);
-        f = createLinearFilter(src_type, dst_type, kernel, Point(anchor_x, anchor_y), delta,
-                               borderTypeValue);
+        borderTypeValue = borderType & ~BORDER_ISOLATED;
+        kernel = Mat(Size(kernel_width, kernel_height), kernel_type, kernel_data, kernel_step).clone();
+        anchor = Point(anchor_x, anchor_y);
+        kernelDelta = delta;
+        f = create();
         return true;
     }
+    Ptr<FilterEngine> create() const
+    {
+        return createLinearFilter(src_type, dst_type, kernel, anchor, kernelDelta, borderTypeValue);
+    }
     void apply(uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step, int width, int height, int full_width, int full_height, int offset_x, int offset_y)
     {
         Mat src(Size(width, height), src_type, src_data, src_step);
         Mat dst(Size(width, height), dst_type, dst_data, dst_step);
-        f->apply(src, dst, Size(full_width, full_height), Point(offset_x, offset_y));
+        f->apply(src, dst, Size(full_width, full_height), Point(offset_x, offset_y), *this);
     }
 };
 
@@ -4861,11 +4946,15 @@ struct ReplacementSepFilter : public hal::SepFilter2D
     }
 };
 
-struct OcvSepFilter : public hal::SepFilter2D
+struct OcvSepFilter : public hal::SepFilter2D, public FilterEngineFactory
 {
     Ptr<FilterEngine> f;
     int src_type;
     int dst_type;
+    Mat kernelX, kernelY;
+    Point anchor;
+    double kernelDelta;
+    int borderTypeValue;
     bool init(int stype, int dtype, int ktype,
               uchar * kernelx_data, int kernelx_len,
               uchar * kernely_data, int kernely_len,
@@ -4873,21 +4962,27 @@ struct OcvSepFilter : public hal::SepFilter2D
     {
         src_type = stype;
         dst_type = dtype;
-        Mat kernelX(Size(kernelx_len, 1), ktype, kernelx_data);
-        Mat kernelY(Size(kernely_len, 1), ktype, kernely_data);
+        kernelX = Mat(Size(kernelx_len, 1), ktype, kernelx_data).clone();
+        kernelY = Mat(Size(kernely_len, 1), ktype, kernely_data).clone();
+        anchor = Point(anchor_x, anchor_y);
+        kernelDelta = delta;
+        borderTypeValue = borderType & ~BORDER_ISOLATED;
 
-        f = createSeparableLinearFilter( stype, dtype, kernelX, kernelY,
-                                         Point(anchor_x, anchor_y),
-                                         delta, borderType & ~BORDER_ISOLATED );
+        f = create();
         return true;
     }
+    Ptr<FilterEngine> create() const
+    {
+        return createSeparableLinearFilter( src_type, dst_type, kernelX, kernelY,
+                                            anchor, kernelDelta, borderTypeValue );
+    }
     void apply(uchar* src_data, size_t src_step, uchar* dst_data, size_t dst_step,
              int width, int height, int full_width, int full_height,
              int offset_x, int offset_y)
     {
         Mat src(Size(width, height), src_type, src_data, src_step);
         Mat dst(Size(width, height), dst_type, dst_data, dst_step);
-        f->apply(src, dst, Size(full_width, full_height), Point(offset_x, offset_y));
+        f->apply(src, dst, Size(full_width, full_height), Point(offset_x, offset_y), *this);
     }
 };
 
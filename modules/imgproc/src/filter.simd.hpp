@@ -0,0 +1,140 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+// The 256-bit kernels of the 32f separable filters (RowVec_32f, SymmColumnVec_32f in filter.cpp).
+// The file is compiled into the regular build (the cpu_baseline namespace, via filter.cpp) and once
+// more for each instruction set listed in ocv_add_dispatched_file() of modules/imgproc/CMakeLists.txt.
+// Without CV_SIMD256 the functions process nothing, so the filters go on with the SSE kernels
+// from the beginning of the row.
+
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv {
+CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN
+
+// filter the first width elements of a row of cn-channel floats with the kernel kx of ksize taps,
+// returns the number of processed elements
+int rowFilterWide32f(const float* src, float* dst, const float* kx, int ksize, int width, int cn);
+// filter the first width elements of the rows src[-ksize2] ... src[ksize2] with the symmetrical
+// or asymmetrical kernel ky[-ksize2] ... ky[ksize2] and add delta, returns the number of processed
+// elements
+int symmColumnFilterWide32f(const float** src, float* dst, const float* ky, int ksize2,
+                            float delta, int width, bool symmetrical);
+
+#ifndef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+#if CV_SIMD256
+
+int rowFilterWide32f(const float* src0, float* dst, const float* kx, int ksize, int width, int cn)
+{
+    int i = 0, k;
+    width *= cn;
+
+    for( ; i <= width - 16; i += 16 )
+    {
+        const float* src = src0 + i;
+        v_float32x8 s0 = v256_setzero_f32(), s1 = s0;
+        for( k = 0; k < ksize; k++, src += cn )
+        {
+            v_float32x8 f = v256_setall_f32(kx[k]);
+            s0 = v_muladd(v256_load(src), f, s0);
+            s1 = v_muladd(v256_load(src + 8), f, s1);
+        }
+        v_store(dst + i, s0);
+        v_store(dst + i + 8, s1);
+    }
+    return i;
+}
+
+int symmColumnFilterWide32f(const float** src, float* dst, const float* ky, int ksize2,
+                            float delta, int width, bool symmetrical)
+{
+    int i = 0, k;
+    v_float32x8 d8 = v256_setall_f32(delta);
+
+    for( ; i <= width - 16; i += 16 )
+    {
+        v_float32x8 s0 = d8, s1 = d8;
+        if( symmetrical )
+        {
+            v_float32x8 f = v256_setall_f32(ky[0]);
+            s0 = v_muladd(v256_load(src[0] + i), f, s0);
+            s1 = v_muladd(v256_load(src[0] + i + 8), f, s1);
+        }
+
+        for( k = 1; k <= ksize2; k++ )
+        {
+            const float* S = src[k] + i;
+            const float* S2 = src[-k] + i;
+            v_float32x8 f = v256_setall_f32(ky[k]), x0, x1;
+            if( symmetrical )
+            {
+                x0 = v256_load(S) + v256_load(S2);
+                x1 = v256_load(S + 8) + v256_load(S2 + 8);
+            }
+            else
+            {
+                x0 = v256_load(S) - v256_load(S2);
+                x1 = v256_load(S + 8) - v256_load(S2 + 8);
+            }
+            s0 = v_muladd(x0, f, s0);
+            s1 = v_muladd(x1, f, s1);
+        }
+
+        v_store(dst + i, s0);
+        v_store(dst + i + 8, s1);
+    }
+    return i;
+}
+
+#else
+
+int rowFilterWide32f(const float*, float*, const float*, int, int, int) { return 0; }
+int symmColumnFilterWide32f(const float**, float*, const float*, int, float, int, bool) { return 0; }
+
+#endif
+
+#endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+CV_CPU_OPTIMIZATION_NAMESPACE_END
+} // cv::
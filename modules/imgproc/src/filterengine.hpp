@@ -134,6 +134,23 @@ public:
 };
 
 
+class FilterEngine;
+
+/*!
+ The Factory of Filter Engines for the Parallel Processing
+
+ FilterEngine keeps the state of the filtering (the ring buffer of the rows, the context of
+ the column filter), so every horizontal band processed in parallel needs its own engine.
+ See FilterEngine::apply(const Mat&, Mat&, const Size&, const Point&, const FilterEngineFactory&).
+*/
+class FilterEngineFactory
+{
+public:
+    virtual ~FilterEngineFactory();
+    //! creates a new engine, equivalent to the one the factory is used with
+    virtual Ptr<FilterEngine> create() const = 0;
+};
+
 /*!
  The Main Class for Image Filtering.
 
@@ -240,6 +257,10 @@ public:
                         uchar* dst, int dstStep);
     //! applies filter to the specified ROI of the image. if srcRoi=(0,0,-1,-1), the whole image is filtered.
     virtual void apply(const Mat& src, Mat& dst, const cv::Size &wsz, const cv::Point &ofs);
+    //! the same as above, but the image is split into horizontal bands filtered in parallel
+    //! by the engines created by the factory. The small and the in-place images are filtered by this engine.
+    void apply(const Mat& src, Mat& dst, const cv::Size &wsz, const cv::Point &ofs,
+               const FilterEngineFactory& factory);
 
     //! returns true if the filter is separable
     bool isSeparable() const { return !filter2D; }
@@ -364,6 +385,14 @@ static inline Point normalizeAnchor( Point anchor, Size ksize )
    return anchor;
 }
 
+// checks whether the pixels of the two images share memory, e.g. for the in-place calls on ROIs
+static inline bool isOverlapped( const Mat& a, const Mat& b )
+{
+    const uchar* a1 = a.ptr(a.rows - 1) + a.cols*a.elemSize();
+    const uchar* b1 = b.ptr(b.rows - 1) + b.cols*b.elemSize();
+    return a.ptr() < b1 && b.ptr() < a1;
+}
+
 void preprocess2DKernel( const Mat& kernel, std::vector<Point>& coords, std::vector<uchar>& coeffs );
 void crossCorr( const Mat& src, const Mat& templ, Mat& dst,
                Size corrsize, int ctype,
@@ -840,6 +840,99 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
     VecOp vecOp;
 };
 
+
+/*
+   van Herk/Gil-Werman algorithm for the 1D erosion (dilation) by a line of ksize pixels.
+   The row is split into the blocks of ksize pixels. Within every block h[] accumulates the values
+   from the pixel to the block end, and g accumulates the values of the next block from its start,
+   so that every output is computed by 3 comparisons, whatever the kernel size is:
+   dst[x] = op(h[x], g[x + ksize - 1]).
+   src contains width + ksize - 1 pixels, buf should have room for (ksize + 1)*cn elements.
+*/
+template<class Op> static void
+morphRowVHGW(const uchar* _src, uchar* _dst, int width, int cn, int ksize, uchar* _buf)
+{
+    typedef typename Op::rtype T;
+    const T* src = (const T*)_src;
+    T* dst = (T*)_dst;
+    T* h = (T*)_buf;
+    T* g = h + ksize*cn;
+    Op op;
+
+    for( int s = 0; s < width; s += ksize )
+    {
+        const T* S = src + s*cn;
+        const T* G = S + ksize*cn;
+        T* D = dst + s*cn;
+        int i, j, n = std::min(ksize, width - s);
+
+        for( j = (ksize - 1)*cn; j < ksize*cn; j++ )
+            h[j] = S[j];
+        for( j = (ksize - 1)*cn - 1; j >= 0; j-- )
+            h[j] = op(S[j], h[j + cn]);
+        for( j = 0; j < cn; j++ )
+            D[j] = h[j];
+
+        for( i = 1; i < n; i++ )
+        {
+            const T* Gi = G + (i - 1)*cn;
+            const T* Hi = h + i*cn;
+            T* Di = D + i*cn;
+            for( j = 0; j < cn; j++ )
+            {
+                g[j] = i == 1 ? Gi[j] : op(g[j], Gi[j]);
+                Di[j] = op(Hi[j], g[j]);
+            }
+        }
+    }
+}
+
+typedef void (*MorphRowVHGWFunc)(const uchar* src, uchar* dst, int width, int cn, int ksize, uchar* buf);
+
+/*
+   The same for the columns: dst row y = op(src[y], ..., src[y + ksize - 1]), y < count.
+   The rows are combined by op2, the column filter of the size 2, which has the vectorized
+   implementation. buf should have room for ksize rows of bufstep bytes, aligned as the source rows.
+*/
+static void morphColumnVHGW(const uchar** src, uchar* dst, int dststep, int count, int width,
+                            int ksize, BaseColumnFilter& op2, uchar* buf, size_t bufstep)
+{
+    AutoBuffer<const uchar*> _h(ksize);
+    const uchar** h = _h;
+    uchar* g = buf + (ksize - 1)*bufstep;
+    const uchar* rows[2];
+
+    for( int s = 0; s < count; s += ksize )
+    {
+        const uchar** S = src + s;
+        const uchar** G = S + ksize;
+        int i, n = std::min(ksize, count - s);
+
+        h[ksize - 1] = S[ksize - 1];
+        for( i = ksize - 2; i >= 0; i-- )
+        {
+            rows[0] = S[i]; rows[1] = h[i + 1];
+            op2(rows, buf + i*bufstep, 0, 1, width);
+            h[i] = buf + i*bufstep;
+        }
+        rows[0] = h[0]; rows[1] = h[0];
+        op2(rows, dst + (size_t)s*dststep, 0, 1, width);
+
+        const uchar* gi = G[0];
+        for( i = 1; i < n; i++ )
+        {
+            if( i > 1 )
+            {
+                rows[0] = gi; rows[1] = G[i - 1];
+                op2(rows, g, 0, 1, width);
+                gi = g;
+            }
+            rows[0] = h[i]; rows[1] = gi;
+            op2(rows, dst + (size_t)(s + i)*dststep, 0, 1, width);
+        }
+    }
+}
+
 }
 
 /////////////////////////////////// External Interface /////////////////////////////////////
@@ -977,6 +1070,31 @@ cv::Ptr<cv::BaseFilter> cv::getMorphologyFilter(int op, int type, InputArray _ke
 }
 
 
+namespace cv
+{
+
+// replaces the default border value by the neutral element of the operation
+static Scalar morphologyBorderValue(int op, int type, const Scalar& borderValue)
+{
+    if( borderValue != morphologyDefaultBorderValue() )
+        return borderValue;
+
+    int depth = CV_MAT_DEPTH(type);
+    CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_16S ||
+               depth == CV_32F || depth == CV_64F );
+    if( op == MORPH_ERODE )
+        return Scalar::all( depth == CV_8U ? (double)UCHAR_MAX :
+                            depth == CV_16U ? (double)USHRT_MAX :
+                            depth == CV_16S ? (double)SHRT_MAX :
+                            depth == CV_32F ? (double)FLT_MAX : DBL_MAX);
+    return Scalar::all( depth == CV_8U || depth == CV_16U ?
+                            0. :
+                        depth == CV_16S ? (double)SHRT_MIN :
+                        depth == CV_32F ? (double)-FLT_MAX : -DBL_MAX);
+}
+
+}
+
 cv::Ptr<cv::FilterEngine> cv::createMorphologyFilter( int op, int type, InputArray _kernel,
                                                       Point anchor, int _rowBorderType, int _columnBorderType,
                                                       const Scalar& _borderValue )
@@ -998,23 +1116,8 @@ cv::Ptr<cv::FilterEngine> cv::createMorphologyFilter( int op, int type, InputArr
         filter2D = getMorphologyFilter(op, type, kernel, anchor);
 
     Scalar borderValue = _borderValue;
-    if( (_rowBorderType == BORDER_CONSTANT || _columnBorderType == BORDER_CONSTANT) &&
-            borderValue == morphologyDefaultBorderValue() )
-    {
-        int depth = CV_MAT_DEPTH(type);
-        CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_16S ||
-                   depth == CV_32F || depth == CV_64F );
-        if( op == MORPH_ERODE )
-            borderValue = Scalar::all( depth == CV_8U ? (double)UCHAR_MAX :
-                                       depth == CV_16U ? (double)USHRT_MAX :
-                                       depth == CV_16S ? (double)SHRT_MAX :
-                                       depth == CV_32F ? (double)FLT_MAX : DBL_MAX);
-        else
-            borderValue = Scalar::all( depth == CV_8U || depth == CV_16U ?
-                                           0. :
-                                       depth == CV_16S ? (double)SHRT_MIN :
-                                       depth == CV_32F ? (double)-FLT_MAX : -DBL_MAX);
-    }
+    if( _rowBorderType == BORDER_CONSTANT || _columnBorderType == BORDER_CONSTANT )
+        borderValue = morphologyBorderValue(op, type, borderValue);
 
     return makePtr<FilterEngine>(filter2D, rowFilter, columnFilter,
                                  type, type, type, _rowBorderType, _columnBorderType, borderValue );
@@ -1381,28 +1484,279 @@ static IppMorphBaseImpl * createIppImpl(int type)
 
 // ===== 3. Fallback implementation
 
-struct OcvMorphImpl : public hal::Morph
+// the kernel sizes, starting from which van Herk/Gil-Werman algorithm is faster than
+// the vectorized running filters
+static int rowVHGWMinSize(int depth)
+{
+    return depth == CV_8U ? 48 : depth == CV_16U || depth == CV_16S ? 24 : depth == CV_32F ? 12 : 4;
+}
+
+static const int columnVHGWMinSize = 8;
+
+static MorphRowVHGWFunc getMorphRowVHGW(int op, int depth)
+{
+    if( op == MORPH_ERODE )
+    {
+        if( depth == CV_8U )
+            return morphRowVHGW<MinOp<uchar> >;
+        if( depth == CV_16U )
+            return morphRowVHGW<MinOp<ushort> >;
+        if( depth == CV_16S )
+            return morphRowVHGW<MinOp<short> >;
+        if( depth == CV_32F )
+            return morphRowVHGW<MinOp<float> >;
+        if( depth == CV_64F )
+            return morphRowVHGW<MinOp<double> >;
+    }
+    else
+    {
+        if( depth == CV_8U )
+            return morphRowVHGW<MaxOp<uchar> >;
+        if( depth == CV_16U )
+            return morphRowVHGW<MaxOp<ushort> >;
+        if( depth == CV_16S )
+            return morphRowVHGW<MaxOp<short> >;
+        if( depth == CV_32F )
+            return morphRowVHGW<MaxOp<float> >;
+        if( depth == CV_64F )
+            return morphRowVHGW<MaxOp<double> >;
+    }
+
+    CV_Error_( CV_StsNotImplemented, ("Unsupported data type (=%d)", depth));
+    return 0;
+}
+
+/*
+   Erosion (dilation) by a rectangle, separated into the row and the column passes.
+
+   Every horizontal band of the destination is processed independently: the rows of the band
+   together with ksize.height - 1 rows around it are filtered by the row filter into the buffer,
+   then the column filter combines the rows of the buffer into the destination. The borders are
+   interpolated relatively to the whole image, as FilterEngine does, so the result does not
+   depend on the number of the bands.
+
+   When the source and the destination overlap, the band would overwrite the source rows needed
+   by its neighbours. So the rows around every band are filtered into haloRows first
+   (passes == HALO_PASS), and the bands read only their own source rows afterwards.
+*/
+class MorphRectInvoker : public ParallelLoopBody
+{
+public:
+    enum { HALO_PASS = 1, BAND_PASS = 2 };
+
+    MorphRectInvoker(int op, const Mat& _src, Mat& _dst, const Size& _wsz, const Point& _ofs,
+                     const Size& _ksize, const Point& _anchor, int _borderType, const Scalar& borderValue,
+                     int _nbands, int _passes, std::vector<Mat>* _haloRows)
+        : src(_src), dst(_dst), wsz(_wsz), ofs(_ofs), ksize(_ksize), anchor(_anchor),
+          borderType(_borderType), nbands(_nbands), passes(_passes), haloRows(_haloRows), rowVHGW(0)
+    {
+        int type = src.type(), depth = src.depth();
+        int width = src.cols + ksize.width - 1;
+        esz = (int)src.elemSize();
+        rowstep = alignSize(src.cols*esz, 16);
+
+        if( ksize.width < rowVHGWMinSize(depth) )
+            rowFilter = getMorphologyRowFilter(op, type, ksize.width, anchor.x);
+        else
+            rowVHGW = getMorphRowVHGW(op, depth);
+        if( ksize.height < columnVHGWMinSize )
+            columnFilter = getMorphologyColumnFilter(op, type, ksize.height, anchor.y);
+        else
+            columnOp = getMorphologyColumnFilter(op, type, 2, 0);
+
+        // the pixels [x0, x1) of the padded source row are taken from the source row itself;
+        // the other ones are either constant or taken from the columns listed in borderTab
+        x0 = std::max(anchor.x - ofs.x, 0);
+        x1 = std::min(anchor.x - ofs.x + wsz.width, width);
+        for( int x = 0; x < width; x++ )
+            if( (x < x0 || x >= x1) && borderType != BORDER_CONSTANT )
+            {
+                borderTab.push_back(x);
+                borderTab.push_back(borderInterpolate(x - anchor.x + ofs.x, wsz.width, borderType) - ofs.x);
+            }
+        if( borderType == BORDER_CONSTANT )
+            constRow = Mat(1, width, type, borderValue);
+    }
+
+    void operator()(const Range& range) const
+    {
+        int cn = src.channels(), width = src.cols + ksize.width - 1;
+        int top = anchor.y, bottom = ksize.height - 1 - anchor.y;
+        int maxBandRows = (src.rows + nbands - 1)/nbands + ksize.height - 1;
+        Mat line = constRow.empty() ? Mat(1, width, src.type()) : constRow.clone();
+        AutoBuffer<uchar> rowBuf((ksize.width + 1)*esz);
+        AutoBuffer<const uchar*> _R(maxBandRows);
+        const uchar** R = _R;
+        Mat buf, columnBuf;
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int y0 = (int)((int64)src.rows*b/nbands);
+            int y1 = (int)((int64)src.rows*(b + 1)/nbands);
+            int i, n = y1 - y0;
+
+            if( passes & HALO_PASS )
+            {
+                Mat& halo = (*haloRows)[b];
+                halo.create(std::max(ksize.height - 1, 1), rowstep, CV_8U);
+                for( i = 0; i < top; i++ )
+                    filterRow(y0 - top + i, halo.ptr(i), line.ptr(), rowBuf, cn);
+                for( i = 0; i < bottom; i++ )
+                    filterRow(y1 + i, halo.ptr(top + i), line.ptr(), rowBuf, cn);
+            }
+
+            if( !(passes & BAND_PASS) )
+                continue;
+
+            buf.create(maxBandRows, rowstep, CV_8U);
+            for( i = 0; i < n + ksize.height - 1; i++ )
+            {
+                if( haloRows && (i < top || i >= top + n) )
+                {
+                    R[i] = (*haloRows)[b].ptr(i < top ? i : i - n);
+                    continue;
+                }
+                filterRow(y0 - top + i, buf.ptr(i), line.ptr(), rowBuf, cn);
+                R[i] = buf.ptr(i);
+            }
+
+            if( columnFilter )
+                (*columnFilter)(R, dst.ptr(y0), (int)dst.step, n, src.cols*cn);
+            else
+            {
+                columnBuf.create(ksize.height, rowstep, CV_8U);
+                morphColumnVHGW(R, dst.ptr(y0), (int)dst.step, n, src.cols*cn,
+                                ksize.height, *columnOp, columnBuf.ptr(), rowstep);
+            }
+        }
+    }
+
+private:
+    // applies the row filter to the source row y, padded according to the border type
+    void filterRow(int y, uchar* D, uchar* line, uchar* buf, int cn) const
+    {
+        y += ofs.y;
+        if( y < 0 || y >= wsz.height )
+        {
+            if( borderType == BORDER_CONSTANT )
+            {
+                // the erosion (dilation) of the constant row is the same row
+                memcpy(D, constRow.ptr(), src.cols*esz);
+                return;
+            }
+            y = borderInterpolate(y, wsz.height, borderType);
+        }
+
+        const uchar* S = src.data + (ptrdiff_t)(y - ofs.y)*(ptrdiff_t)src.step - anchor.x*esz;
+        memcpy(line + x0*esz, S + x0*esz, (x1 - x0)*esz);
+        for( size_t k = 0; k < borderTab.size(); k += 2 )
+            memcpy(line + borderTab[k]*esz, S + (borderTab[k + 1] + anchor.x)*esz, esz);
+
+        if( rowVHGW )
+            rowVHGW(line, D, src.cols, cn, ksize.width, buf);
+        else
+            (*rowFilter)(line, D, src.cols, cn);
+    }
+
+    const Mat& src;
+    Mat& dst;
+    Size wsz;
+    Point ofs;
+    Size ksize;
+    Point anchor;
+    int borderType;
+    int nbands;
+    int passes;
+    std::vector<Mat>* haloRows;
+    int esz;
+    int rowstep;
+    int x0, x1;
+    std::vector<int> borderTab;
+    Mat constRow;
+    Ptr<BaseRowFilter> rowFilter;
+    MorphRowVHGWFunc rowVHGW;
+    Ptr<BaseColumnFilter> columnFilter;
+    Ptr<BaseColumnFilter> columnOp;
+};
+
+struct OcvMorphImpl : public hal::Morph, public FilterEngineFactory
 {
     Ptr<FilterEngine> f;
     int iterations;
     int src_type;
     int dst_type;
-    bool init(int op, int _src_type, int _dst_type, int, int,
+    int op;
+    Mat kernel;
+    Point anchor;
+    int borderType;
+    Scalar borderValue;
+    bool isRect;
+
+    bool init(int _op, int _src_type, int _dst_type, int, int,
               int kernel_type, uchar * kernel_data, size_t kernel_step, int kernel_width, int kernel_height,
               int anchor_x, int anchor_y,
-              int borderType, const double _borderValue[4],
+              int _borderType, const double _borderValue[4],
               int _iterations, bool, bool)
     {
+        op = _op;
         iterations = _iterations;
         src_type = _src_type;
         dst_type = _dst_type;
-        Mat kernel(Size(kernel_width, kernel_height), kernel_type, kernel_data, kernel_step);
-        Point anchor(anchor_x, anchor_y);
-        Vec<double, 4> borderValue(_borderValue);
-        f = createMorphologyFilter(op, src_type, kernel, anchor, borderType, borderType, borderValue );
+        kernel = Mat(Size(kernel_width, kernel_height), kernel_type, kernel_data, kernel_step).clone();
+        anchor = Point(anchor_x, anchor_y);
+        borderType = _borderType;
+        borderValue = Vec<double, 4>(_borderValue);
+        isRect = countNonZero(kernel) == kernel.rows*kernel.cols && src_type == dst_type &&
+                 CV_MAT_CN(src_type) <= 4 &&
+                 (borderType == BORDER_CONSTANT || borderType == BORDER_REPLICATE || borderType == BORDER_REFLECT ||
+                  borderType == BORDER_REFLECT_101 || borderType == BORDER_WRAP);
+        if( !isRect )
+            f = create();
         return true;
     }
 
+    Ptr<FilterEngine> create() const
+    {
+        return createMorphologyFilter(op, src_type, kernel, anchor, borderType, borderType, borderValue);
+    }
+
+    void morphRect(const Mat& src, Mat& dst, const Size& wsz, const Point& ofs) const
+    {
+        Scalar value = morphologyBorderValue(op, src_type, borderValue);
+        int nbands = std::max(src.rows/std::max(kernel.rows*4, 64), 1);
+
+        if( !isOverlapped(src, dst) )
+        {
+            MorphRectInvoker body(op, src, dst, wsz, ofs, kernel.size(), anchor, borderType, value,
+                                  nbands, MorphRectInvoker::BAND_PASS, 0);
+            if( nbands > 1 )
+                parallel_for_(Range(0, nbands), body, nbands);
+            else
+                body(Range(0, 1));
+            return;
+        }
+
+        // the band may read the source rows of other bands only when they are shifted
+        if( src.data != dst.data || src.step != dst.step )
+            nbands = 1;
+
+        std::vector<Mat> haloRows(nbands);
+        MorphRectInvoker haloBody(op, src, dst, wsz, ofs, kernel.size(), anchor, borderType, value,
+                                  nbands, MorphRectInvoker::HALO_PASS, &haloRows);
+        MorphRectInvoker bandBody(op, src, dst, wsz, ofs, kernel.size(), anchor, borderType, value,
+                                  nbands, MorphRectInvoker::BAND_PASS, &haloRows);
+        if( nbands > 1 )
+        {
+            parallel_for_(Range(0, nbands), haloBody, nbands);
+            parallel_for_(Range(0, nbands), bandBody, nbands);
+        }
+        else
+        {
+            haloBody(Range(0, 1));
+            bandBody(Range(0, 1));
+        }
+    }
+
     void apply(uchar * src_data, size_t src_step, uchar * dst_data, size_t dst_step, int width, int height,
                int roi_width, int roi_height, int roi_x, int roi_y,
                int roi_width2, int roi_height2, int roi_x2, int roi_y2)
@@ -1412,13 +1766,21 @@ struct OcvMorphImpl : public hal::Morph
         {
             Point ofs(roi_x, roi_y);
             Size wsz(roi_width, roi_height);
-            f->apply( src, dst, wsz, ofs );
+            if( isRect )
+                morphRect( src, dst, wsz, ofs );
+            else
+                f->apply( src, dst, wsz, ofs, *this );
         }
         {
             Point ofs(roi_x2, roi_y2);
             Size wsz(roi_width2, roi_height2);
             for( int i = 1; i < iterations; i++ )
-                f->apply( dst, dst, wsz, ofs );
+            {
+                if( isRect )
+                    morphRect( dst, dst, wsz, ofs );
+                else
+                    f->apply( dst, dst, wsz, ofs, *this );
+            }
         }
     }
 };
@@ -1950,6 +2312,71 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
                d_wsz.width, d_wsz.height, d_ofs.x, d_ofs.y);
 }
 
+// dilates the source band by band and subtracts the eroded image, which is already in dst,
+// so that the gradient needs no full-size temporary. The bands are the ROIs of the source,
+// so their dilation reads the rows of the neighbouring bands and is the same as the one of
+// the whole image.
+class MorphGradientInvoker : public ParallelLoopBody
+{
+public:
+    MorphGradientInvoker(const Mat& _src, Mat& _dst, const Mat& _kernel, Point _anchor, int _iterations,
+                         int _borderType, const Scalar& _borderValue, int _bandRows) :
+        src(_src), dst(_dst), kernel(_kernel), anchor(_anchor), iterations(_iterations),
+        borderType(_borderType), borderValue(_borderValue), bandRows(_bandRows)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        Mat band;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int y0 = i*bandRows, y1 = std::min(y0 + bandRows, src.rows);
+            dilate( src.rowRange(y0, y1), band, kernel, anchor, iterations, borderType, borderValue );
+            Mat d = dst.rowRange(y0, y1);
+            subtract( band, d, d );
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    const Mat& kernel;
+    Point anchor;
+    int iterations;
+    int borderType;
+    Scalar borderValue;
+    int bandRows;
+};
+
+static void morphGradient( const Mat& src, Mat& dst, const Mat& kernel, Point anchor, int iterations,
+                           int borderType, const Scalar& borderValue )
+{
+    bool isRect = countNonZero(kernel) == kernel.rows*kernel.cols;
+
+    // the bands need the source intact and the parent rows around them
+    if( isOverlapped(src, dst) || (borderType & BORDER_ISOLATED) != 0 || (iterations > 1 && !isRect) )
+    {
+        Mat temp;
+        erode( src, temp, kernel, anchor, iterations, borderType, borderValue );
+        dilate( src, dst, kernel, anchor, iterations, borderType, borderValue );
+        dst -= temp;
+        return;
+    }
+
+    erode( src, dst, kernel, anchor, iterations, borderType, borderValue );
+
+    // the rectangular kernels are extended by the iterations
+    int kheight = kernel.rows + (iterations - 1)*(kernel.rows - 1);
+    int bandRows = std::max(kheight*8, 64);
+    int nbands = (src.rows + bandRows - 1)/bandRows;
+    MorphGradientInvoker body(src, dst, kernel, anchor, iterations, borderType, borderValue, bandRows);
+    if( nbands > 1 )
+        parallel_for_(Range(0, nbands), body, nbands);
+    else
+        body(Range(0, nbands));
+}
+
 }
 
 void cv::erode( InputArray src, OutputArray dst, InputArray kernel,
@@ -2079,9 +2506,7 @@ void cv::morphologyEx( InputArray _src, OutputArray _dst, int op,
         erode( dst, dst, kernel, anchor, iterations, borderType, borderValue );
         break;
     case CV_MOP_GRADIENT:
-        erode( src, temp, kernel, anchor, iterations, borderType, borderValue );
-        dilate( src, dst, kernel, anchor, iterations, borderType, borderValue );
-        dst -= temp;
+        morphGradient( src, dst, kernel, anchor, iterations, borderType, borderValue );
         break;
     case CV_MOP_TOPHAT:
         if( src.data != dst.data )
@@ -0,0 +1,498 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+#include "filterengine.hpp"
+
+/****************************************************************************************\
+                                     Image Pipeline
+\****************************************************************************************/
+
+namespace cv
+{
+
+enum
+{
+    // the rows of all the intermediate images processed at once should fit into it
+    PIPELINE_CACHE_SIZE = 1 << 18,
+    PIPELINE_MIN_BAND_ROWS = 32
+};
+
+class PipelineStage
+{
+public:
+    virtual ~PipelineStage() {}
+    //! returns the type of the stage output for the specified input type
+    virtual int dstType(int srcType) const = 0;
+    //! returns the engine for the stages that need the neighbour rows, an empty pointer for the pointwise ones
+    virtual Ptr<FilterEngine> createFilter(int) const { return Ptr<FilterEngine>(); }
+    //! processes the rows of a pointwise stage
+    virtual void apply(const Mat&, Mat&) const { CV_Error( CV_StsNotImplemented, "" ); }
+};
+
+static bool isBayerCode(int code)
+{
+    return (COLOR_BayerBG2BGR <= code && code <= COLOR_BayerGR2BGR) ||
+           (COLOR_BayerBG2BGR_VNG <= code && code <= COLOR_BayerGR2BGR_VNG) ||
+           (COLOR_BayerBG2GRAY <= code && code <= COLOR_BayerGR2GRAY) ||
+           (COLOR_BayerBG2BGR_EA <= code && code <= COLOR_BayerGR2BGR_EA);
+}
+
+class CvtColorStage : public PipelineStage
+{
+public:
+    CvtColorStage(int _code, int _dcn) : code(_code), dcn(_dcn)
+    {
+        if( isBayerCode(code) )
+            CV_Error( CV_StsBadArg, "Demosaicing uses the neighbour rows and is not supported by ImagePipeline" );
+    }
+
+    int dstType(int srcType) const
+    {
+        // cvtColor checks the combination of the code and the type itself. The conversions
+        // that change the image size (YUV 4:2:0) mix several rows and can not be streamed
+        Mat src(6, 6, srcType, Scalar::all(0)), dst;
+        cvtColor(src, dst, code, dcn);
+        if( dst.size() != src.size() )
+            CV_Error( CV_StsBadArg, "Only the color conversions that keep the image size are supported by ImagePipeline" );
+        return dst.type();
+    }
+
+    void apply(const Mat& src, Mat& dst) const
+    {
+        cvtColor(src, dst, code, dcn);
+    }
+
+    int code, dcn;
+};
+
+class SepFilterStage : public PipelineStage
+{
+public:
+    SepFilterStage(int _ddepth, const Mat& _kx, const Mat& _ky, Point _anchor, double _delta, int _borderType)
+        : ddepth(_ddepth), kx(_kx.clone()), ky(_ky.clone()), anchor(_anchor), delta(_delta), borderType(_borderType)
+    {
+    }
+
+    int dstType(int srcType) const
+    {
+        return CV_MAKETYPE(ddepth < 0 ? CV_MAT_DEPTH(srcType) : ddepth, CV_MAT_CN(srcType));
+    }
+
+    Ptr<FilterEngine> createFilter(int srcType) const
+    {
+        return createSeparableLinearFilter(srcType, dstType(srcType), kx, ky, anchor, delta, borderType);
+    }
+
+    int ddepth;
+    Mat kx, ky;
+    Point anchor;
+    double delta;
+    int borderType;
+};
+
+class GaussianStage : public PipelineStage
+{
+public:
+    GaussianStage(Size _ksize, double _sigma1, double _sigma2, int _borderType)
+        : ksize(_ksize), sigma1(_sigma1), sigma2(_sigma2), borderType(_borderType)
+    {
+    }
+
+    int dstType(int srcType) const { return srcType; }
+
+    Ptr<FilterEngine> createFilter(int srcType) const
+    {
+        return createGaussianFilter(srcType, ksize, sigma1, sigma2, borderType);
+    }
+
+    Size ksize;
+    double sigma1, sigma2;
+    int borderType;
+};
+
+class SobelStage : public PipelineStage
+{
+public:
+    SobelStage(int _ddepth, int _dx, int _dy, int _ksize, double _scale, double _delta, int _borderType)
+        : ddepth(_ddepth), dx(_dx), dy(_dy), ksize(_ksize), scale(_scale), delta(_delta), borderType(_borderType)
+    {
+    }
+
+    int dstType(int srcType) const
+    {
+        return CV_MAKETYPE(ddepth < 0 ? CV_MAT_DEPTH(srcType) : ddepth, CV_MAT_CN(srcType));
+    }
+
+    Ptr<FilterEngine> createFilter(int srcType) const
+    {
+        // the same kernels as in cv::Sobel
+        int dtype = dstType(srcType);
+        int ktype = std::max(CV_32F, std::max(CV_MAT_DEPTH(dtype), CV_MAT_DEPTH(srcType)));
+        Mat kx, ky;
+        getDerivKernels( kx, ky, dx, dy, ksize, false, ktype );
+        if( scale != 1 )
+        {
+            if( dx == 0 )
+                kx *= scale;
+            else
+                ky *= scale;
+        }
+        return createSeparableLinearFilter(srcType, dtype, kx, ky, Point(-1, -1), delta, borderType);
+    }
+
+    int ddepth, dx, dy, ksize;
+    double scale, delta;
+    int borderType;
+};
+
+class ThresholdStage : public PipelineStage
+{
+public:
+    ThresholdStage(double _thresh, double _maxval, int _type)
+        : thresh(_thresh), maxval(_maxval), type(_type)
+    {
+        if( (type & ~THRESH_MASK) != 0 )
+            CV_Error( CV_StsBadArg, "The automatic threshold selection needs the whole image "
+                                    "and is not supported by ImagePipeline" );
+    }
+
+    int dstType(int srcType) const { return srcType; }
+
+    void apply(const Mat& src, Mat& dst) const
+    {
+        threshold(src, dst, thresh, maxval, type);
+    }
+
+    double thresh, maxval;
+    int type;
+};
+
+class ConvertStage : public PipelineStage
+{
+public:
+    ConvertStage(int _ddepth, double _alpha, double _beta)
+        : ddepth(_ddepth), alpha(_alpha), beta(_beta)
+    {
+    }
+
+    int dstType(int srcType) const
+    {
+        return CV_MAKETYPE(ddepth < 0 ? CV_MAT_DEPTH(srcType) : ddepth, CV_MAT_CN(srcType));
+    }
+
+    void apply(const Mat& src, Mat& dst) const
+    {
+        src.convertTo(dst, dst.depth(), alpha, beta);
+    }
+
+    int ddepth;
+    double alpha, beta;
+};
+
+class ConvertScaleAbsStage : public PipelineStage
+{
+public:
+    ConvertScaleAbsStage(double _alpha, double _beta) : alpha(_alpha), beta(_beta) {}
+
+    int dstType(int srcType) const { return CV_8UC(CV_MAT_CN(srcType)); }
+
+    void apply(const Mat& src, Mat& dst) const
+    {
+        convertScaleAbs(src, dst, alpha, beta);
+    }
+
+    double alpha, beta;
+};
+
+// the per-element arithmetic operations with a scalar operand
+class ScalarArithmStage : public PipelineStage
+{
+public:
+    enum { OP_ADD, OP_MUL, OP_ABSDIFF };
+
+    ScalarArithmStage(int _op, const Scalar& _value, double _scale, int _ddepth)
+        : op(_op), value(_value), scale(_scale), ddepth(_ddepth)
+    {
+    }
+
+    int dstType(int srcType) const
+    {
+        return CV_MAKETYPE(ddepth < 0 ? CV_MAT_DEPTH(srcType) : ddepth, CV_MAT_CN(srcType));
+    }
+
+    void apply(const Mat& src, Mat& dst) const
+    {
+        if( op == OP_ADD )
+            add(src, value, dst, noArray(), dst.depth());
+        else if( op == OP_MUL )
+            multiply(src, value, dst, scale, dst.depth());
+        else
+            absdiff(src, value, dst);
+    }
+
+    int op;
+    Scalar value;
+    double scale;
+    int ddepth;
+};
+
+/*
+ Every band of the output rows is produced by its own set of the filter engines. The source rows
+ the band depends on are pushed through the chain by a few at a time: the pointwise stages
+ process them at once, the filters keep the rows they still need in their ring buffers and emit
+ the rows they can already compute, so the intermediate rows are only kept in small buffers.
+*/
+class PipelineInvoker : public ParallelLoopBody
+{
+public:
+    PipelineInvoker(const std::vector<Ptr<PipelineStage> >& _stages, const std::vector<int>& _types,
+                    const Mat& _src, Mat& _dst, int _nbands, int _chunkRows)
+        : stages(_stages), types(_types), src(_src), dst(_dst), nbands(_nbands), chunkRows(_chunkRows)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        int k, n = (int)stages.size();
+        std::vector<Ptr<FilterEngine> > filters(n);
+        std::vector<Mat> bufs(n);
+        int bufRows = chunkRows;
+
+        // a filter may emit up to ksize.height - 1 rows more than it was given
+        for( k = 0; k < n; k++ )
+        {
+            filters[k] = stages[k]->createFilter(types[k]);
+            if( filters[k] )
+                bufRows += filters[k]->ksize.height - 1;
+            if( k < n - 1 )
+                bufs[k].create(bufRows, src.cols, types[k+1]);
+        }
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int y0 = (int)((int64)src.rows*b/nbands), y1 = (int)((int64)src.rows*(b + 1)/nbands);
+
+            // find the rows of every intermediate image the band depends on, from the end of the chain
+            int r0 = y0, r1 = y1;
+            for( k = n - 1; k >= 0; k-- )
+                if( filters[k] )
+                {
+                    filters[k]->start(src.size(), Size(src.cols, r1 - r0), Point(0, r0));
+                    r0 = filters[k]->startY;
+                    r1 = filters[k]->endY;
+                }
+
+            int dy = y0;
+            for( int sy = r0; sy < r1; )
+            {
+                Mat rows = src.rowRange(sy, std::min(sy + chunkRows, r1));
+                sy += rows.rows;
+
+                for( k = 0; k < n; k++ )
+                {
+                    Mat out = k < n - 1 ? bufs[k] : dst.rowRange(dy, y1);
+                    int count = rows.rows;
+                    if( filters[k] )
+                    {
+                        count = filters[k]->proceed(rows.ptr(), (int)rows.step, rows.rows,
+                                                    out.ptr(), (int)out.step);
+                        if( count == 0 )
+                            break;
+                    }
+                    Mat outRows = out.rowRange(0, count);
+                    if( !filters[k] )
+                        stages[k]->apply(rows, outRows);
+                    rows = outRows;
+                }
+                if( k == n )
+                    dy += rows.rows;
+            }
+            CV_Assert( dy == y1 );
+        }
+    }
+
+private:
+    const std::vector<Ptr<PipelineStage> >& stages;
+    const std::vector<int>& types;
+    Mat src;
+    Mat dst;
+    int nbands;
+    int chunkRows;
+};
+
+class ImagePipelineImpl : public ImagePipeline
+{
+public:
+    void addCvtColor(int code, int dstCn)
+    {
+        stages.push_back(makePtr<CvtColorStage>(code, dstCn));
+    }
+
+    void addSepFilter2D(int ddepth, InputArray kernelX, InputArray kernelY,
+                        Point anchor, double delta, int borderType)
+    {
+        stages.push_back(makePtr<SepFilterStage>(ddepth, kernelX.getMat(), kernelY.getMat(), anchor, delta,
+                                                 borderType & ~BORDER_ISOLATED));
+    }
+
+    void addGaussianBlur(Size ksize, double sigmaX, double sigmaY, int borderType)
+    {
+        stages.push_back(makePtr<GaussianStage>(ksize, sigmaX, sigmaY, borderType & ~BORDER_ISOLATED));
+    }
+
+    void addSobel(int ddepth, int dx, int dy, int ksize, double scale, double delta, int borderType)
+    {
+        stages.push_back(makePtr<SobelStage>(ddepth, dx, dy, ksize, scale, delta, borderType & ~BORDER_ISOLATED));
+    }
+
+    void addThreshold(double thresh, double maxval, int type)
+    {
+        stages.push_back(makePtr<ThresholdStage>(thresh, maxval, type));
+    }
+
+    void addConvertTo(int ddepth, double alpha, double beta)
+    {
+        stages.push_back(makePtr<ConvertStage>(ddepth, alpha, beta));
+    }
+
+    void addConvertScaleAbs(double alpha, double beta)
+    {
+        stages.push_back(makePtr<ConvertScaleAbsStage>(alpha, beta));
+    }
+
+    void addAdd(const Scalar& value, int ddepth)
+    {
+        stages.push_back(makePtr<ScalarArithmStage>((int)ScalarArithmStage::OP_ADD, value, 1., ddepth));
+    }
+
+    void addMultiply(const Scalar& value, double scale, int ddepth)
+    {
+        stages.push_back(makePtr<ScalarArithmStage>((int)ScalarArithmStage::OP_MUL, value, scale, ddepth));
+    }
+
+    void addAbsdiff(const Scalar& value)
+    {
+        stages.push_back(makePtr<ScalarArithmStage>((int)ScalarArithmStage::OP_ABSDIFF, value, 1., -1));
+    }
+
+    void apply(InputArray _src, OutputArray _dst);
+
+    void clear() { stages.clear(); }
+
+    bool empty() const { return stages.empty(); }
+
+protected:
+    std::vector<Ptr<PipelineStage> > stages;
+};
+
+void ImagePipelineImpl::apply(InputArray _src, OutputArray _dst)
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( !stages.empty() );
+
+    Mat src = _src.getMat();
+    CV_Assert( src.dims <= 2 );
+
+    int k, n = (int)stages.size();
+    std::vector<int> types(n + 1);
+    types[0] = src.type();
+    for( k = 0; k < n; k++ )
+        types[k+1] = stages[k]->dstType(types[k]);
+
+    _dst.create( src.size(), types[n] );
+    Mat dst = _dst.getMat();
+    if( src.empty() )
+        return;
+
+    // the output rows are written after the source rows they depend on are read,
+    // so the image can be processed in place, but only by a single band
+    bool inplace = false;
+    if( isOverlapped(src, dst) )
+    {
+        if( src.data == dst.data && src.step == dst.step )
+            inplace = true;
+        else
+            src = src.clone();
+    }
+
+    size_t rowSize = 0, ringSize = 0;
+    int kernelRows = 0;
+    for( k = 0; k <= n; k++ )
+        rowSize += src.cols*CV_ELEM_SIZE(types[k]);
+    for( k = 0; k < n; k++ )
+    {
+        Ptr<FilterEngine> f = stages[k]->createFilter(types[k]);
+        if( f )
+        {
+            kernelRows += f->ksize.height - 1;
+            ringSize += (size_t)f->ksize.height*src.cols*CV_ELEM_SIZE(f->bufType);
+        }
+    }
+
+    size_t cacheSize = std::max((size_t)PIPELINE_CACHE_SIZE - std::min(ringSize, (size_t)PIPELINE_CACHE_SIZE),
+                                (size_t)PIPELINE_CACHE_SIZE/4);
+    int chunkRows = (int)std::min(std::max(cacheSize/rowSize, (size_t)1), (size_t)src.rows);
+
+    int nbands = 1;
+    if( !inplace )
+        nbands = std::max(std::min(src.rows/std::max((int)PIPELINE_MIN_BAND_ROWS, kernelRows*8),
+                                   getNumThreads()*2), 1);
+
+    PipelineInvoker body(stages, types, src, dst, nbands, chunkRows);
+    if( nbands > 1 )
+        parallel_for_(Range(0, nbands), body, nbands);
+    else
+        body(Range(0, 1));
+}
+
+ImagePipeline::~ImagePipeline() {}
+
+}
+
+cv::Ptr<cv::ImagePipeline> cv::createImagePipeline()
+{
+    return makePtr<ImagePipelineImpl>();
+}
+
+/* End of file. */
@@ -848,16 +848,20 @@ typedef PyrUpNoVec<float, float> PyrUpVec_32f;
 
 #endif
 
+/*
+   The pyramid functions take the images as the tables of the row pointers, so that the rows
+   can be processed by bands and the rows of the band can come from different buffers.
+   pyrDown_ computes the destination rows [dy0, dy1); only the source rows, which they need
+   (2*dy0 - 2 ... 2*dy1, interpolated at the image borders), are accessed.
+*/
 template<class CastOp, class VecOp> void
-pyrDown_( const Mat& _src, Mat& _dst, int borderType )
+pyrDown_( const uchar** srcRows, Size ssize, uchar** dstRows, Size dsize, int cn, int borderType,
+          int dy0, int dy1 )
 {
     const int PD_SZ = 5;
     typedef typename CastOp::type1 WT;
     typedef typename CastOp::rtype T;
 
-    CV_Assert( !_src.empty() );
-    Size ssize = _src.size(), dsize = _dst.size();
-    int cn = _src.channels();
     int bufstep = (int)alignSize(dsize.width*cn, 16);
     AutoBuffer<WT> _buf(bufstep*PD_SZ + 16);
     WT* buf = alignPtr((WT*)_buf, 16);
@@ -871,7 +875,7 @@ pyrDown_( const Mat& _src, Mat& _dst, int borderType )
     CV_Assert( ssize.width > 0 && ssize.height > 0 &&
                std::abs(dsize.width*2 - ssize.width) <= 2 &&
                std::abs(dsize.height*2 - ssize.height) <= 2 );
-    int k, x, sy0 = -PD_SZ/2, sy = sy0, width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
+    int k, x, sy0 = dy0*2 - PD_SZ/2, sy = sy0, width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
 
     for( x = 0; x <= PD_SZ+1; x++ )
     {
@@ -891,9 +895,9 @@ pyrDown_( const Mat& _src, Mat& _dst, int borderType )
     for( x = 0; x < dsize.width; x++ )
         tabM[x] = (x/cn)*2*cn + x % cn;
 
-    for( int y = 0; y < dsize.height; y++ )
+    for( int y = dy0; y < dy1; y++ )
     {
-        T* dst = _dst.ptr<T>(y);
+        T* dst = (T*)dstRows[y];
         WT *row0, *row1, *row2, *row3, *row4;
 
         // fill the ring buffer (horizontal convolution and decimation)
@@ -901,7 +905,7 @@ pyrDown_( const Mat& _src, Mat& _dst, int borderType )
         {
             WT* row = buf + ((sy - sy0) % PD_SZ)*bufstep;
             int _sy = borderInterpolate(sy, ssize.height, borderType);
-            const T* src = _src.ptr<T>(_sy);
+            const T* src = (const T*)srcRows[_sy];
             int limit = cn;
             const int* tab = tabL;
 
@@ -966,22 +970,26 @@ pyrDown_( const Mat& _src, Mat& _dst, int borderType )
             rows[k] = buf + ((y*2 - PD_SZ/2 + k - sy0) % PD_SZ)*bufstep;
         row0 = rows[0]; row1 = rows[1]; row2 = rows[2]; row3 = rows[3]; row4 = rows[4];
 
-        x = vecOp(rows, dst, (int)_dst.step, dsize.width);
+        x = vecOp(rows, dst, 0, dsize.width);
         for( ; x < dsize.width; x++ )
             dst[x] = castOp(row2[x]*6 + (row1[x] + row3[x])*4 + row0[x] + row4[x]);
     }
 }
 
 
+/*
+   pyrUp_ processes the source rows [sy0, sy1), which give the destination rows [sy0*2, sy1*2),
+   and also the last destination row, when sy1 is the source height and the destination height
+   is odd. The source rows sy0 - 1 ... sy1 are accessed.
+*/
 template<class CastOp, class VecOp> void
-pyrUp_( const Mat& _src, Mat& _dst, int)
+pyrUp_( const uchar** srcRows, Size ssize, uchar** dstRows, Size dsize, int cn, int,
+        int sy0, int sy1 )
 {
     const int PU_SZ = 3;
     typedef typename CastOp::type1 WT;
     typedef typename CastOp::rtype T;
 
-    Size ssize = _src.size(), dsize = _dst.size();
-    int cn = _src.channels();
     int bufstep = (int)alignSize((dsize.width+1)*cn, 16);
     AutoBuffer<WT> _buf(bufstep*PU_SZ + 16);
     WT* buf = alignPtr((WT*)_buf, 16);
@@ -994,7 +1002,8 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
 
     CV_Assert( std::abs(dsize.width - ssize.width*2) == dsize.width % 2 &&
                std::abs(dsize.height - ssize.height*2) == dsize.height % 2);
-    int k, x, sy0 = -PU_SZ/2, sy = sy0;
+    int k, x, dwidth = dsize.width, sy = sy0 - PU_SZ/2;
+    sy0 = sy;
 
     ssize.width *= cn;
     dsize.width *= cn;
@@ -1002,10 +1011,10 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
     for( x = 0; x < ssize.width; x++ )
         dtab[x] = (x/cn)*2*cn + x % cn;
 
-    for( int y = 0; y < ssize.height; y++ )
+    for( int y = sy0 + PU_SZ/2; y < sy1; y++ )
     {
-        T* dst0 = _dst.ptr<T>(y*2);
-        T* dst1 = _dst.ptr<T>(std::min(y*2+1, dsize.height-1));
+        T* dst0 = (T*)dstRows[y*2];
+        T* dst1 = (T*)dstRows[std::min(y*2+1, dsize.height-1)];
         WT *row0, *row1, *row2;
 
         // fill the ring buffer (horizontal convolution and decimation)
@@ -1013,7 +1022,7 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
         {
             WT* row = buf + ((sy - sy0) % PU_SZ)*bufstep;
             int _sy = borderInterpolate(sy*2, ssize.height*2, BORDER_REFLECT_101)/2;
-            const T* src = _src.ptr<T>(_sy);
+            const T* src = (const T*)srcRows[_sy];
 
             if( ssize.width == cn )
             {
@@ -1036,7 +1045,7 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
 
                 if (dsize.width > ssize.width*2)
                 {
-                    row[(_dst.cols-1) + x] = row[dx + cn];
+                    row[(dwidth-1)*cn + x] = row[dx + cn];
                 }
             }
 
@@ -1056,7 +1065,7 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
         row0 = rows[0]; row1 = rows[1]; row2 = rows[2];
         dsts[0] = dst0; dsts[1] = dst1;
 
-        x = vecOp(rows, dsts, (int)_dst.step, dsize.width);
+        x = vecOp(rows, dsts, 0, dsize.width);
         for( ; x < dsize.width; x++ )
         {
             T t1 = castOp((row1[x] + row2[x])*4);
@@ -1065,10 +1074,10 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
         }
     }
 
-    if (dsize.height > ssize.height*2)
+    if (dsize.height > ssize.height*2 && sy1 == ssize.height)
     {
-        T* dst0 = _dst.ptr<T>(ssize.height*2-2);
-        T* dst2 = _dst.ptr<T>(ssize.height*2);
+        T* dst0 = (T*)dstRows[ssize.height*2-2];
+        T* dst2 = (T*)dstRows[ssize.height*2];
 
         for(x = 0; x < dsize.width ; x++ )
         {
@@ -1077,7 +1086,203 @@ pyrUp_( const Mat& _src, Mat& _dst, int)
     }
 }
 
-typedef void (*PyrFunc)(const Mat&, Mat&, int);
+typedef void (*PyrFunc)(const uchar**, Size, uchar**, Size, int, int, int, int);
+
+static PyrFunc getPyrDownFunc(int depth)
+{
+    if( depth == CV_8U )
+        return pyrDown_<FixPtCast<uchar, 8>, PyrDownVec_32s8u>;
+    if( depth == CV_16S )
+        return pyrDown_<FixPtCast<short, 8>, PyrDownVec_32s16s >;
+    if( depth == CV_16U )
+        return pyrDown_<FixPtCast<ushort, 8>, PyrDownVec_32s16u >;
+    if( depth == CV_32F )
+        return pyrDown_<FltCast<float, 8>, PyrDownVec_32f>;
+    if( depth == CV_64F )
+        return pyrDown_<FltCast<double, 8>, PyrDownNoVec<double, double> >;
+    CV_Error( CV_StsUnsupportedFormat, "" );
+    return 0;
+}
+
+static PyrFunc getPyrUpFunc(int depth)
+{
+    if( depth == CV_8U )
+        return pyrUp_<FixPtCast<uchar, 6>, PyrUpVec_32s8u >;
+    if( depth == CV_16S )
+        return pyrUp_<FixPtCast<short, 6>, PyrUpVec_32s16s >;
+    if( depth == CV_16U )
+        return pyrUp_<FixPtCast<ushort, 6>, PyrUpVec_32s16u >;
+    if( depth == CV_32F )
+        return pyrUp_<FltCast<float, 6>, PyrUpVec_32f >;
+    if( depth == CV_64F )
+        return pyrUp_<FltCast<double, 6>, PyrUpNoVec<double, double> >;
+    CV_Error( CV_StsUnsupportedFormat, "" );
+    return 0;
+}
+
+static void getRowTable(const Mat& m, std::vector<uchar*>& rows)
+{
+    rows.resize(m.rows);
+    for( int i = 0; i < m.rows; i++ )
+        rows[i] = (uchar*)m.ptr(i);
+}
+
+// the minimal number of the rows in a band: every band recomputes a few rows around it
+enum { PYR_BAND_ROWS = 32, PYR_FUSED_BAND_ROWS = 128, PYR_FUSED_LEVELS = 3 };
+
+static int getPyrBands(int rows, int minRows)
+{
+    return std::max(rows/minRows, 1);
+}
+
+/*
+   pyrDown or pyrUp by horizontal bands: the destination rows for pyrDown and the source rows
+   for pyrUp are split into nbands parts.
+*/
+class PyrInvoker : public ParallelLoopBody
+{
+public:
+    PyrInvoker(PyrFunc _func, const Mat& _src, Mat& _dst, int _borderType, int _nbands, bool _down)
+        : func(_func), src(_src), dst(_dst), borderType(_borderType), nbands(_nbands), down(_down)
+    {
+        getRowTable(src, srcRows);
+        getRowTable(dst, dstRows);
+    }
+
+    void operator()(const Range& range) const
+    {
+        int rows = down ? dst.rows : src.rows;
+        int y0 = (int)((int64)rows*range.start/nbands), y1 = (int)((int64)rows*range.end/nbands);
+        func((const uchar**)&srcRows[0], src.size(), (uchar**)&dstRows[0], dst.size(),
+             src.channels(), borderType, y0, y1);
+    }
+
+    void run()
+    {
+        if( nbands > 1 )
+            parallel_for_(Range(0, nbands), *this, nbands);
+        else
+            (*this)(Range(0, 1));
+    }
+
+private:
+    PyrFunc func;
+    const Mat& src;
+    Mat& dst;
+    int borderType;
+    int nbands;
+    bool down;
+    std::vector<uchar*> srcRows, dstRows;
+};
+
+/*
+   Builds the levels first + 1 ... last of the Gaussian pyramid at once. The levels are split into
+   the horizontal bands by the rows of the last level, and every band computes its part of all the
+   levels, so that the rows of the previous level are still in the cache when the next level reads
+   them. The band writes only its own rows of every level, proportional to its rows of the last
+   level; the rows around them, which the next level needs too, are computed into the band buffers.
+   The number of the rows recomputed this way grows with the number of the levels, so only a few
+   levels are built together.
+*/
+class PyrDownFusedInvoker : public ParallelLoopBody
+{
+public:
+    PyrDownFusedInvoker(PyrFunc _func, std::vector<Mat>& _levels, int _first, int _last,
+                        int _borderType, int _nbands)
+        : func(_func), levels(_levels), first(_first), last(_last), borderType(_borderType), nbands(_nbands)
+    {
+        getRowTable(levels[first], srcRows);
+    }
+
+    void operator()(const Range& range) const
+    {
+        int n = last - first + 1;
+        AutoBuffer<int> _rows(n*4);
+        int *own0 = _rows, *own1 = own0 + n, *need0 = own1 + n, *need1 = need0 + n;
+        std::vector<std::vector<uchar*> > rows(n);
+        std::vector<Mat> buf(n);
+        int cn = levels[first].channels();
+
+        for( int i = first + 1; i <= last; i++ )
+            rows[i - first].resize(levels[i].rows);
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int k, y;
+
+            own0[n-1] = need0[n-1] = (int)((int64)levels[last].rows*b/nbands);
+            own1[n-1] = need1[n-1] = (int)((int64)levels[last].rows*(b + 1)/nbands);
+            for( k = n - 2; k > 0; k-- )
+            {
+                int h = levels[first + k].rows;
+                own0[k] = std::min(own0[k+1]*2, h);
+                own1[k] = b == nbands - 1 ? h : std::min(own1[k+1]*2, h);
+                // the destination row y of pyrDown reads the source rows y*2 - 2 ... y*2 + 2
+                need0[k] = std::max(std::min(own0[k], need0[k+1]*2 - 2), 0);
+                need1[k] = std::min(std::max(own1[k], need1[k+1]*2 + 1), h);
+            }
+
+            for( k = 1; k < n; k++ )
+            {
+                Mat& level = levels[first + k];
+                std::vector<uchar*>& r = rows[k];
+                buf[k].create(need1[k] - need0[k], level.cols, level.type());
+                for( y = need0[k]; y < need1[k]; y++ )
+                    r[y] = y >= own0[k] && y < own1[k] ? level.ptr(y) : buf[k].ptr(y - need0[k]);
+
+                const std::vector<uchar*>& src = k == 1 ? srcRows : rows[k - 1];
+                func((const uchar**)&src[0], levels[first + k - 1].size(), &r[0], level.size(),
+                     cn, borderType, need0[k], need1[k]);
+            }
+        }
+    }
+
+private:
+    PyrFunc func;
+    std::vector<Mat>& levels;
+    int first, last;
+    int borderType;
+    int nbands;
+    std::vector<uchar*> srcRows;
+};
+
+/*
+   The level of the Laplacian pyramid: lap = gauss - pyrUp(next), computed by the bands of
+   the rows of next, so that the upsampled rows are subtracted while they are in the cache.
+*/
+class LaplacianPyrInvoker : public ParallelLoopBody
+{
+public:
+    LaplacianPyrInvoker(PyrFunc _func, const Mat& _gauss, const Mat& _next, Mat& _lap, int _nbands)
+        : func(_func), gauss(_gauss), next(_next), lap(_lap), nbands(_nbands)
+    {
+        getRowTable(next, srcRows);
+    }
+
+    void operator()(const Range& range) const
+    {
+        int y0 = (int)((int64)next.rows*range.start/nbands), y1 = (int)((int64)next.rows*range.end/nbands);
+        int dy0 = y0*2, dy1 = y1 == next.rows ? gauss.rows : y1*2;
+        Mat up(dy1 - dy0, gauss.cols, gauss.type());
+        std::vector<uchar*> dstRows(gauss.rows);
+
+        for( int y = dy0; y < dy1; y++ )
+            dstRows[y] = up.ptr(y - dy0);
+        func((const uchar**)&srcRows[0], next.size(), &dstRows[0], gauss.size(),
+             gauss.channels(), BORDER_DEFAULT, y0, y1);
+
+        Mat dst = lap.rowRange(dy0, dy1);
+        subtract(gauss.rowRange(dy0, dy1), up, dst, noArray(), lap.depth());
+    }
+
+private:
+    PyrFunc func;
+    const Mat& gauss;
+    const Mat& next;
+    Mat& lap;
+    int nbands;
+    std::vector<uchar*> srcRows;
+};
 
 #ifdef HAVE_OPENCL
 
@@ -1363,21 +1568,8 @@ void cv::pyrDown( InputArray _src, OutputArray _dst, const Size& _dsz, int borde
         ipp_pyrdown( _src,  _dst,  _dsz,  borderType));
 
 
-    PyrFunc func = 0;
-    if( depth == CV_8U )
-        func = pyrDown_<FixPtCast<uchar, 8>, PyrDownVec_32s8u>;
-    else if( depth == CV_16S )
-        func = pyrDown_<FixPtCast<short, 8>, PyrDownVec_32s16s >;
-    else if( depth == CV_16U )
-        func = pyrDown_<FixPtCast<ushort, 8>, PyrDownVec_32s16u >;
-    else if( depth == CV_32F )
-        func = pyrDown_<FltCast<float, 8>, PyrDownVec_32f>;
-    else if( depth == CV_64F )
-        func = pyrDown_<FltCast<double, 8>, PyrDownNoVec<double, double> >;
-    else
-        CV_Error( CV_StsUnsupportedFormat, "" );
-
-    func( src, dst, borderType );
+    CV_Assert( !src.empty() );
+    PyrInvoker(getPyrDownFunc(depth), src, dst, borderType, getPyrBands(dst.rows, PYR_BAND_ROWS), true).run();
 }
 
 
@@ -1471,21 +1663,7 @@ void cv::pyrUp( InputArray _src, OutputArray _dst, const Size& _dsz, int borderT
         ipp_pyrup( _src,  _dst,  _dsz,  borderType));
 
 
-    PyrFunc func = 0;
-    if( depth == CV_8U )
-        func = pyrUp_<FixPtCast<uchar, 6>, PyrUpVec_32s8u >;
-    else if( depth == CV_16S )
-        func = pyrUp_<FixPtCast<short, 6>, PyrUpVec_32s16s >;
-    else if( depth == CV_16U )
-        func = pyrUp_<FixPtCast<ushort, 6>, PyrUpVec_32s16u >;
-    else if( depth == CV_32F )
-        func = pyrUp_<FltCast<float, 6>, PyrUpVec_32f >;
-    else if( depth == CV_64F )
-        func = pyrUp_<FltCast<double, 6>, PyrUpNoVec<double, double> >;
-    else
-        CV_Error( CV_StsUnsupportedFormat, "" );
-
-    func( src, dst, borderType );
+    PyrInvoker(getPyrUpFunc(depth), src, dst, borderType, getPyrBands(src.rows, PYR_BAND_ROWS), false).run();
 }
 
 
@@ -1629,8 +1807,66 @@ void cv::buildPyramid( InputArray _src, OutputArrayOfArrays _dst, int maxlevel,
     CV_IPP_RUN(((IPP_VERSION_X100 >= 810 && IPP_DISABLE_BLOCK) && ((borderType & ~BORDER_ISOLATED) == BORDER_DEFAULT && (!_src.isSubmatrix() || ((borderType & BORDER_ISOLATED) != 0)))),
         ipp_buildpyramid( _src,  _dst,  maxlevel,  borderType));
 
+    // the bands of the fused levels read the rows around them, the wrapped rows are too far
+    if( (borderType & ~BORDER_ISOLATED) == BORDER_WRAP )
+    {
+        for( ; i <= maxlevel; i++ )
+            pyrDown( _dst.getMatRef(i-1), _dst.getMatRef(i), Size(), borderType );
+        return;
+    }
+
+    CV_Assert( !src.empty() );
+    std::vector<Mat> levels(maxlevel + 1);
+    levels[0] = src;
     for( ; i <= maxlevel; i++ )
-        pyrDown( _dst.getMatRef(i-1), _dst.getMatRef(i), Size(), borderType );
+    {
+        Mat& level = _dst.getMatRef(i);
+        level.create((levels[i-1].rows + 1)/2, (levels[i-1].cols + 1)/2, src.type());
+        levels[i] = level;
+    }
+
+    PyrFunc func = getPyrDownFunc(src.depth());
+    for( int first = 0; first < maxlevel; )
+    {
+        int last = std::min(first + (int)PYR_FUSED_LEVELS, maxlevel);
+        int nbands = getPyrBands(levels[last].rows, std::max(PYR_FUSED_BAND_ROWS >> (last - first - 1), 4));
+        PyrDownFusedInvoker body(func, levels, first, last, borderType, nbands);
+        if( nbands > 1 )
+            parallel_for_(Range(0, nbands), body, nbands);
+        else
+            body(Range(0, 1));
+        first = last;
+    }
+}
+
+void cv::buildLaplacianPyramid( InputArray _src, OutputArrayOfArrays _dst, int maxlevel, int ddepth, int borderType )
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( maxlevel >= 0 );
+
+    Mat src = _src.getMat();
+    int depth = src.depth(), cn = src.channels();
+    if( ddepth < 0 )
+        ddepth = depth == CV_8U ? CV_16S : depth == CV_16U ? CV_32F : depth;
+
+    std::vector<Mat> gauss;
+    buildPyramid(src, gauss, maxlevel, borderType);
+
+    _dst.create( maxlevel + 1, 1, 0 );
+    PyrFunc func = getPyrUpFunc(depth);
+    for( int i = 0; i < maxlevel; i++ )
+    {
+        Mat& lap = _dst.getMatRef(i);
+        lap.create(gauss[i].size(), CV_MAKETYPE(ddepth, cn));
+        int nbands = getPyrBands(gauss[i+1].rows, PYR_BAND_ROWS);
+        LaplacianPyrInvoker body(func, gauss[i], gauss[i+1], lap, nbands);
+        if( nbands > 1 )
+            parallel_for_(Range(0, nbands), body, nbands);
+        else
+            body(Range(0, 1));
+    }
+    _dst.getMatRef(maxlevel) = gauss[maxlevel];
 }
 
 CV_IMPL void cvPyrDown( const void* srcarr, void* dstarr, int _filter )
@@ -45,6 +45,9 @@
 #include "opencl_kernels_imgproc.hpp"
 
 #include "opencv2/core/openvx/ovx_defs.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+#include <complex>
 
 /*
  * This file includes the code, contributed by Simon Perreault
@@ -1831,6 +1834,33 @@ static bool ipp_boxfilter( InputArray _src, OutputArray _dst, int ddepth,
 }
 #endif
 
+namespace cv
+{
+
+// creates the engines for the bands of cv::boxFilter processed in parallel
+class BoxFilterFactory : public FilterEngineFactory
+{
+public:
+    BoxFilterFactory(int _srcType, int _dstType, Size _ksize, Point _anchor, bool _normalize, int _borderType)
+        : srcType(_srcType), dstType(_dstType), ksize(_ksize), anchor(_anchor),
+          normalize(_normalize), borderType(_borderType)
+    {
+    }
+
+    Ptr<FilterEngine> create() const
+    {
+        return createBoxFilter(srcType, dstType, ksize, anchor, normalize, borderType);
+    }
+
+private:
+    int srcType, dstType;
+    Size ksize;
+    Point anchor;
+    bool normalize;
+    int borderType;
+};
+
+}
 
 void cv::boxFilter( InputArray _src, OutputArray _dst, int ddepth,
                 Size ksize, Point anchor,
@@ -1886,10 +1916,10 @@ void cv::boxFilter( InputArray _src, OutputArray _dst, int ddepth,
         src.locateROI( wsz, ofs );
     borderType = (borderType&~BORDER_ISOLATED);
 
-    Ptr<FilterEngine> f = createBoxFilter( src.type(), dst.type(),
-                        ksize, anchor, normalize, borderType );
+    BoxFilterFactory factory( src.type(), dst.type(), ksize, anchor, normalize, borderType );
+    Ptr<FilterEngine> f = factory.create();
 
-    f->apply( src, dst, wsz, ofs );
+    f->apply( src, dst, wsz, ofs, factory );
 }
 
 
@@ -2390,6 +2420,292 @@ static bool ipp_GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
 }
 
 
+/****************************************************************************************\
+                                Recursive Gaussian Blur
+\****************************************************************************************/
+
+namespace cv
+{
+
+enum
+{
+    // GaussianBlur switches to the recursive filter when the kernel size is not given
+    // and both sigmas are at least that large
+    GAUSSIAN_IIR_MIN_SIGMA = 10,
+    // the rows filtered by the horizontal pass at once
+    GAUSSIAN_IIR_STRIP = 16,
+    // the width (in scalars) of the column blocks of the vertical pass
+    GAUSSIAN_IIR_BLOCK = 128
+};
+
+/*
+ The third-order recursive approximation of the Gaussian by Young, van Vliet and van Ginkel
+ ("Recursive Gabor filtering", 2002): the poles found for sigma = 2 are moved to get the requested
+ variance, then the filter is run forward and backward. c[0] is the gain, c[1..3] are the weights
+ of the previous outputs.
+
+ For large sigmas the poles approach 1 and c[0] = 1 - c[1] - c[2] - c[3] gets tiny (about 1e-5 for
+ sigma = 80), so rounding the coefficients to float moves the poles and changes the width and the
+ gain of the filter by several percent, and the rounding errors of a float state are amplified by
+ 1/c[0]. Both the coefficients and the state are kept in double.
+*/
+static void getRecursiveGaussianCoeffs( double sigma, double* c )
+{
+    typedef std::complex<double> complexd;
+    const complexd d0[] = { complexd(1.41650, 1.00829), complexd(1.41650, -1.00829), complexd(1.86543, 0.) };
+    complexd p[3];
+
+    // the variance of the forward-backward filter is sum(2*d/(d-1)^2) over the poles d
+    double q = sigma*0.5;
+    for( int iter = 0; iter < 20; iter++ )
+    {
+        double v = 0, dv = 0;
+        for( int i = 0; i < 3; i++ )
+        {
+            complexd d = std::pow(d0[i], 1./q), ld = std::log(d0[i]);
+            complexd t = 2.*d/((d - 1.)*(d - 1.));
+            // d(d)/dq = -d*log(d0)/q^2, d(t)/d(d) = -2*(d + 1)/(d - 1)^3
+            complexd dt = -2.*(d + 1.)/((d - 1.)*(d - 1.)*(d - 1.))*(-d*ld/(q*q));
+            v += t.real();
+            dv += dt.real();
+        }
+        double dq = (v - sigma*sigma)/dv;
+        q -= dq;
+        if( std::abs(dq) < 1e-9*q )
+            break;
+    }
+
+    for( int i = 0; i < 3; i++ )
+        p[i] = 1./std::pow(d0[i], 1./q);
+    double a1 = (p[0] + p[1] + p[2]).real();
+    double a2 = -(p[0]*p[1] + p[0]*p[2] + p[1]*p[2]).real();
+    double a3 = (p[0]*p[1]*p[2]).real();
+    c[0] = 1. - a1 - a2 - a3;
+    c[1] = a1;
+    c[2] = a2;
+    c[3] = a3;
+}
+
+static void recursiveGaussianStep( const double* x, const double* w1, const double* w2, const double* w3,
+                                   double* w, int n, const double* c )
+{
+    int j = 0;
+#if CV_SIMD128_64F
+    v_float64x2 c0 = v_setall_f64(c[0]), c1 = v_setall_f64(c[1]),
+                c2 = v_setall_f64(c[2]), c3 = v_setall_f64(c[3]);
+    for( ; j <= n - 2; j += 2 )
+    {
+        v_float64x2 t = v_muladd(v_load(w3 + j), c3, v_load(w2 + j)*c2);
+        t = v_muladd(v_load(w1 + j), c1, t);
+        v_store(w + j, v_muladd(v_load(x + j), c0, t));
+    }
+#endif
+    for( ; j < n; j++ )
+        w[j] = x[j]*c[0] + (w1[j]*c[1] + (w3[j]*c[3] + w2[j]*c[2]));
+}
+
+template<typename ST> static const double* loadRecursiveGaussianRow( const ST* src, double* buf, int n )
+{
+    for( int j = 0; j < n; j++ )
+        buf[j] = (double)src[j];
+    return buf;
+}
+
+template<> const double* loadRecursiveGaussianRow<double>( const double* src, double*, int )
+{
+    return src;
+}
+
+/*
+ Filters the columns [x0, x1) of the rows of src (each one of width*cn scalars) into dst, which may
+ be the same as src. The borders are emulated by running the filter over margin extrapolated rows
+ on both sides; the steady state for the first (last) value is taken as the initial state.
+*/
+template<typename ST> static void
+recursiveGaussianColumns( const Mat& src, Mat& dst, int x0, int x1, const double* c,
+                          int margin, int borderType, std::vector<double>& _buf )
+{
+    int rows = src.rows, n = x1 - x0;
+    _buf.resize((size_t)(margin + 5)*n);
+    double* ring[3] = { &_buf[0], &_buf[n], &_buf[n*2] };
+    double* xbuf = &_buf[n*3];
+    double* zeros = &_buf[n*4];
+    double* mbuf = &_buf[n*5];
+    std::fill(zeros, zeros + n, 0.);
+
+    // the source rows of the bottom margin are saved first, since dst may overwrite them
+    for( int i = 0; i < margin; i++ )
+    {
+        int y = borderInterpolate(rows + i, rows, borderType);
+        const double* x = y < 0 ? zeros : loadRecursiveGaussianRow(src.ptr<ST>(y) + x0, xbuf, n);
+        memcpy(mbuf + (size_t)i*n, x, n*sizeof(double));
+    }
+
+    // forward pass, starting from the steady state for the first row
+    {
+        int sy = borderInterpolate(-margin, rows, borderType);
+        const double* x = sy < 0 ? zeros : loadRecursiveGaussianRow(src.ptr<ST>(sy) + x0, xbuf, n);
+        for( int k = 0; k < 3; k++ )
+            memcpy(ring[k], x, n*sizeof(double));
+    }
+    const double *w1 = ring[2], *w2 = ring[1], *w3 = ring[0];
+    for( int y = -margin; y < rows + margin; y++ )
+    {
+        const double* x;
+        double* w;
+        if( y < 0 )
+        {
+            int sy = borderInterpolate(y, rows, borderType);
+            x = sy < 0 ? zeros : loadRecursiveGaussianRow(src.ptr<ST>(sy) + x0, xbuf, n);
+            w = ring[(y + margin) % 3];
+        }
+        else if( y < rows )
+        {
+            x = loadRecursiveGaussianRow(src.ptr<ST>(y) + x0, xbuf, n);
+            w = dst.ptr<double>(y) + x0;
+        }
+        else
+            x = w = mbuf + (size_t)(y - rows)*n;
+
+        recursiveGaussianStep(x, w1, w2, w3, w, n, c);
+        w3 = w2; w2 = w1; w1 = w;
+    }
+
+    // backward pass, starting from the steady state for the last row
+    w1 = w2 = w3 = 0;
+    for( int y = rows + margin - 1; y >= 0; y-- )
+    {
+        double* x;
+        double* w;
+        if( y >= rows )
+        {
+            x = mbuf + (size_t)(y - rows)*n;
+            w = ring[(y - rows) % 3];
+        }
+        else
+            x = w = dst.ptr<double>(y) + x0;
+
+        if( !w1 )
+            w1 = w2 = w3 = x;
+        recursiveGaussianStep(x, w1, w2, w3, w, n, c);
+        w3 = w2; w2 = w1; w1 = w;
+    }
+}
+
+typedef void (*RecursiveGaussianColumnsFunc)( const Mat& src, Mat& dst, int x0, int x1, const double* c,
+                                              int margin, int borderType, std::vector<double>& buf );
+
+class RecursiveGaussianVertInvoker : public ParallelLoopBody
+{
+public:
+    RecursiveGaussianVertInvoker( const Mat& _src, Mat& _dst, double sigma, int _borderType )
+        : src(_src), dst(_dst), borderType(_borderType)
+    {
+        getRecursiveGaussianCoeffs(sigma, c);
+        margin = cvCeil(sigma*3);
+
+        int depth = src.depth();
+        func = depth == CV_8U ? recursiveGaussianColumns<uchar> :
+               depth == CV_16U ? recursiveGaussianColumns<ushort> :
+               depth == CV_16S ? recursiveGaussianColumns<short> :
+               depth == CV_32F ? recursiveGaussianColumns<float> :
+               depth == CV_64F ? recursiveGaussianColumns<double> : 0;
+        CV_Assert( func != 0 );
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int width = src.cols*src.channels();
+        Mat d = dst;
+        std::vector<double> buf;
+        for( int i = range.start; i < range.end; i++ )
+            func(src, d, i*GAUSSIAN_IIR_BLOCK, std::min((i + 1)*GAUSSIAN_IIR_BLOCK, width),
+                 c, margin, borderType, buf);
+    }
+
+private:
+    Mat src;
+    Mat dst;
+    int borderType;
+    int margin;
+    double c[4];
+    RecursiveGaussianColumnsFunc func;
+};
+
+// the strips of rows are transposed, filtered as columns and transposed back
+class RecursiveGaussianHorzInvoker : public ParallelLoopBody
+{
+public:
+    RecursiveGaussianHorzInvoker( Mat& _buf, Mat& _dst, double sigma, int _borderType )
+        : buf(_buf), dst(_dst), borderType(_borderType)
+    {
+        getRecursiveGaussianCoeffs(sigma, c);
+        margin = cvCeil(sigma*3);
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int cn = buf.channels();
+        Mat strip, tstrip;
+        std::vector<double> colbuf;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int y0 = i*GAUSSIAN_IIR_STRIP, y1 = std::min(y0 + GAUSSIAN_IIR_STRIP, buf.rows);
+            strip = buf.rowRange(y0, y1);
+            transpose(strip, tstrip);
+            recursiveGaussianColumns<double>(tstrip, tstrip, 0, (y1 - y0)*cn, c, margin, borderType, colbuf);
+            transpose(tstrip, strip);
+            Mat dstStrip = dst.rowRange(y0, y1);
+            strip.convertTo(dstStrip, dst.depth());
+        }
+    }
+
+private:
+    Mat buf;
+    Mat dst;
+    int borderType;
+    int margin;
+    double c[4];
+};
+
+static bool isRecursiveGaussianSupported( int type, int borderType )
+{
+    int depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    borderType &= ~BORDER_ISOLATED;
+    return (depth == CV_8U || depth == CV_16U || depth == CV_16S || depth == CV_32F || depth == CV_64F) &&
+           cn <= 4 && borderType != BORDER_TRANSPARENT;
+}
+
+}
+
+void cv::recursiveGaussianBlur( InputArray _src, OutputArray _dst,
+                                double sigma1, double sigma2, int borderType )
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat src = _src.getMat();
+    int type = src.type();
+    if( sigma2 <= 0 )
+        sigma2 = sigma1;
+    CV_Assert( src.dims <= 2 && sigma1 > 0 );
+    if( !isRecursiveGaussianSupported(type, borderType) )
+        CV_Error( CV_StsUnsupportedFormat, "" );
+    borderType &= ~BORDER_ISOLATED;
+
+    _dst.create( src.size(), type );
+    Mat dst = _dst.getMat();
+    if( src.empty() )
+        return;
+
+    // the vertical pass reads all of src before the horizontal one writes dst, so they may be the same
+    Mat buf(src.size(), CV_64FC(src.channels()));
+    int width = src.cols*src.channels();
+    parallel_for_(Range(0, (width + GAUSSIAN_IIR_BLOCK - 1)/GAUSSIAN_IIR_BLOCK),
+                  RecursiveGaussianVertInvoker(src, buf, sigma2, borderType));
+    parallel_for_(Range(0, (src.rows + GAUSSIAN_IIR_STRIP - 1)/GAUSSIAN_IIR_STRIP),
+                  RecursiveGaussianHorzInvoker(buf, dst, sigma1, borderType));
+}
+
 void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
                    double sigma1, double sigma2,
                    int borderType )
@@ -2414,6 +2730,17 @@ void cv::GaussianBlur( InputArray _src, OutputArray _dst, Size ksize,
         return;
     }
 
+    // the cost of the explicit kernel grows with sigma, the recursive filter takes constant time
+    if( ksize.width <= 0 && ksize.height <= 0 &&
+        std::min(sigma1, sigma2 > 0 ? sigma2 : sigma1) >= GAUSSIAN_IIR_MIN_SIGMA &&
+        isRecursiveGaussianSupported(type, borderType) && _src.dims() <= 2 &&
+        ((borderType & BORDER_ISOLATED) != 0 || !_src.isSubmatrix()) &&
+        !(ocl::useOpenCL() && _dst.isUMat()) )
+    {
+        recursiveGaussianBlur(_src, _dst, sigma1, sigma2, borderType);
+        return;
+    }
+
     CV_OVX_RUN(true,
                openvx_gaussianBlur(_src, _dst, ksize, sigma1, sigma2, borderType))
 
@@ -2065,3 +2065,476 @@ TEST(Imgproc_Sobel, borderTypes)
     EXPECT_EQ(expected_dst.size(), dst.size());
     EXPECT_DOUBLE_EQ(0.0, cvtest::norm(expected_dst, dst, NORM_INF));
 }
+
+TEST(Imgproc_Filtering, parallel_bands)
+{
+    const int borderTypes[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101 };
+    const int ksizes[] = { 3, 7, 31 };
+    int prevThreads = getNumThreads();
+
+    Mat whole(1200, 360, CV_8UC3);
+    randu(whole, 0, 256);
+    // a ROI, so that the bands at the top and the bottom read the rows outside of it
+    Mat src = whole(Rect(5, 7, 340, 1170));
+
+    for (size_t b = 0; b < sizeof(borderTypes)/sizeof(borderTypes[0]); b++)
+        for (size_t k = 0; k < sizeof(ksizes)/sizeof(ksizes[0]); k++)
+        {
+            int border = borderTypes[b], ksize = ksizes[k];
+            Mat kernel(ksize, ksize, CV_32F);
+            randu(kernel, -1, 1);
+            kernel /= ksize*ksize;
+            Mat kx = getGaussianKernel(ksize, 0, CV_32F), ky = getGaussianKernel(ksize, 0, CV_32F);
+
+            Mat ref[5], dst[5];
+            for (int pass = 0; pass < 2; pass++)
+            {
+                setNumThreads(pass == 0 ? 1 : 4);
+                Mat* d = pass == 0 ? ref : dst;
+                filter2D(src, d[0], CV_16S, kernel, Point(-1, -1), 0, border);
+                sepFilter2D(src, d[1], CV_32F, kx, ky, Point(-1, -1), 0, border);
+                Sobel(src, d[2], CV_16S, 1, 1, std::min(ksize, 7), 1, 0, border);
+                boxFilter(src, d[3], -1, Size(ksize, ksize), Point(-1, -1), true, border);
+                GaussianBlur(src, d[4], Size(ksize, ksize), 0, 0, border);
+            }
+            setNumThreads(prevThreads);
+
+            for (int i = 0; i < 5; i++)
+                EXPECT_EQ(0, cvtest::norm(ref[i], dst[i], NORM_INF))
+                    << "function " << i << " border " << border << " ksize " << ksize;
+        }
+
+    // the in-place filtering has to give the same result too
+    Mat inplace = src.clone(), ref;
+    setNumThreads(1);
+    GaussianBlur(inplace, ref, Size(9, 9), 0);
+    setNumThreads(4);
+    GaussianBlur(inplace, inplace, Size(9, 9), 0);
+    setNumThreads(prevThreads);
+    EXPECT_EQ(0, cvtest::norm(ref, inplace, NORM_INF));
+}
+
+TEST(Imgproc_Morphology, large_rect_kernels)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_16SC4, CV_32FC1, CV_64FC2 };
+    const int borderTypes[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101, BORDER_WRAP };
+    const Size ksizes[] = { Size(61, 61), Size(1, 47), Size(47, 1), Size(5, 33), Size(64, 9) };
+    RNG& rng = theRNG();
+
+    for (size_t t = 0; t < sizeof(types)/sizeof(types[0]); t++)
+        for (size_t b = 0; b < sizeof(borderTypes)/sizeof(borderTypes[0]); b++)
+            for (size_t k = 0; k < sizeof(ksizes)/sizeof(ksizes[0]); k++)
+            {
+                int type = types[t], border = borderTypes[b], op = rng.uniform(0, 2);
+                // cvtest::erode() and cvtest::dilate() take the constant border of 8U for any depth
+                // and set it for the first channel only
+                if (border == BORDER_CONSTANT && type != CV_8UC1)
+                    continue;
+
+                Size ksize = ksizes[k];
+                Point anchor(rng.uniform(0, ksize.width), rng.uniform(0, ksize.height));
+                Mat kernel = Mat::ones(ksize, CV_8U);
+                Mat src(rng.uniform(100, 400), rng.uniform(40, 300), type), ref, dst;
+                randu(src, 0, 256);
+
+                if (op == 0)
+                {
+                    cvtest::erode(src, ref, kernel, anchor, border);
+                    erode(src, dst, kernel, anchor, 1, border);
+                }
+                else
+                {
+                    cvtest::dilate(src, ref, kernel, anchor, border);
+                    dilate(src, dst, kernel, anchor, 1, border);
+                }
+                EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF))
+                    << "type " << type << " border " << border << " ksize " << ksize << " anchor " << anchor;
+            }
+
+    // the ROI reads the pixels around it, so it should be filtered the same as the whole image,
+    // whatever the number of the bands is, and in place too
+    int prevThreads = getNumThreads();
+    Mat whole(1000, 400, CV_8UC1);
+    randu(whole, 0, 256);
+    Rect r(13, 21, 360, 950);
+    Mat kernel = getStructuringElement(MORPH_RECT, Size(31, 31)), ref, dst;
+
+    setNumThreads(1);
+    dilate(whole, ref, kernel);
+    setNumThreads(4);
+    dilate(whole(r), dst, kernel);
+    EXPECT_EQ(0, cvtest::norm(ref(r), dst, NORM_INF));
+
+    Mat inplace = whole.clone(), roi = inplace(r);
+    dilate(roi, roi, kernel);
+    EXPECT_EQ(0, cvtest::norm(ref(r), roi, NORM_INF));
+
+    setNumThreads(1);
+    morphologyEx(whole, ref, MORPH_OPEN, kernel);
+    setNumThreads(4);
+    morphologyEx(whole, dst, MORPH_OPEN, kernel);
+    setNumThreads(prevThreads);
+    EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+}
+
+TEST(Imgproc_Morphology, gradient_bands)
+{
+    Mat whole(700, 300, CV_8UC3);
+    randu(whole, 0, 256);
+    Rect r(7, 11, 280, 650);
+    Mat src = whole(r);
+    Mat kernels[] = { getStructuringElement(MORPH_RECT, Size(5, 9)),
+                      getStructuringElement(MORPH_ELLIPSE, Size(7, 7)) };
+    const int borderTypes[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT, BORDER_REFLECT_101 };
+
+    for (int k = 0; k < 2; k++)
+        for (int iterations = 1; iterations <= 2; iterations++)
+            for (int b = 0; b < 4; b++)
+            {
+                int border = borderTypes[b];
+                Mat eroded, dilated, ref, dst;
+                erode(src, eroded, kernels[k], Point(-1, -1), iterations, border);
+                dilate(src, dilated, kernels[k], Point(-1, -1), iterations, border);
+                subtract(dilated, eroded, ref);
+
+                morphologyEx(src, dst, MORPH_GRADIENT, kernels[k], Point(-1, -1), iterations, border);
+                EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF)) << k << " " << iterations << " " << border;
+
+                Mat inplace = whole.clone(), roi = inplace(r);
+                morphologyEx(roi, roi, MORPH_GRADIENT, kernels[k], Point(-1, -1), iterations, border);
+                EXPECT_EQ(0, cvtest::norm(ref, roi, NORM_INF)) << k << " " << iterations << " " << border;
+            }
+}
+
+TEST(Imgproc_Pyramid, fused_levels)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16SC1, CV_32FC4, CV_64FC1 };
+    const int borderTypes[] = { BORDER_REFLECT_101, BORDER_REFLECT, BORDER_REPLICATE, BORDER_WRAP };
+    const Size sizes[] = { Size(1023, 1537), Size(640, 480), Size(7, 5), Size(1, 1) };
+    const int maxlevel = 8;
+    int prevThreads = getNumThreads();
+
+    for (size_t t = 0; t < sizeof(types)/sizeof(types[0]); t++)
+        for (size_t b = 0; b < sizeof(borderTypes)/sizeof(borderTypes[0]); b++)
+            for (size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++)
+            {
+                int type = types[t], border = borderTypes[b];
+                Mat src(sizes[s], type);
+                randu(src, 0, 256);
+
+                std::vector<Mat> pyr;
+                setNumThreads(4);
+                buildPyramid(src, pyr, maxlevel, border);
+                setNumThreads(1);
+
+                ASSERT_EQ((size_t)maxlevel + 1, pyr.size());
+                Mat prev = src;
+                for (int i = 1; i <= maxlevel; i++)
+                {
+                    Mat ref;
+                    pyrDown(prev, ref, Size(), border);
+                    EXPECT_EQ(0, cvtest::norm(ref, pyr[i], NORM_INF))
+                        << "type " << type << " border " << border << " size " << sizes[s] << " level " << i;
+                    prev = ref;
+                }
+            }
+
+    // the bands of pyrUp
+    Mat src(541, 733, CV_8UC3), ref, dst;
+    randu(src, 0, 256);
+    setNumThreads(1);
+    pyrUp(src, ref, Size(src.cols*2 + 1, src.rows*2 + 1));
+    setNumThreads(4);
+    pyrUp(src, dst, Size(src.cols*2 + 1, src.rows*2 + 1));
+    setNumThreads(prevThreads);
+    EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+}
+
+TEST(Imgproc_Pyramid, laplacian)
+{
+    Mat src(1001, 799, CV_8UC1);
+    randu(src, 0, 256);
+    const int maxlevel = 5;
+
+    std::vector<Mat> gauss, lap;
+    buildPyramid(src, gauss, maxlevel);
+    buildLaplacianPyramid(src, lap, maxlevel);
+    ASSERT_EQ((size_t)maxlevel + 1, lap.size());
+    EXPECT_EQ(0, cvtest::norm(gauss[maxlevel], lap[maxlevel], NORM_INF));
+
+    for (int i = 0; i < maxlevel; i++)
+    {
+        Mat up, ref;
+        pyrUp(gauss[i+1], up, gauss[i].size());
+        subtract(gauss[i], up, ref, noArray(), CV_16S);
+        ASSERT_EQ(CV_16SC1, lap[i].type());
+        EXPECT_EQ(0, cvtest::norm(ref, lap[i], NORM_INF)) << "level " << i;
+    }
+
+    // the image is restored exactly by adding the upsampled layers back
+    Mat restored = lap[maxlevel];
+    for (int i = maxlevel - 1; i >= 0; i--)
+    {
+        Mat up;
+        pyrUp(restored, up, lap[i].size());
+        add(lap[i], up, restored, noArray(), CV_8U);
+    }
+    EXPECT_EQ(0, cvtest::norm(src, restored, NORM_INF));
+}
+
+TEST(Imgproc_Pipeline, accuracy)
+{
+    int prevThreads = getNumThreads();
+    Mat src(1037, 613, CV_8UC3);
+    randu(src, 0, 256);
+
+    // the typical edge detection chain
+    Mat gray, blurred, gx, ref;
+    cvtColor(src, gray, COLOR_BGR2GRAY);
+    GaussianBlur(gray, blurred, Size(5, 5), 1.5);
+    Sobel(blurred, gx, CV_16S, 1, 0, 3, 1, 0, BORDER_REFLECT);
+    convertScaleAbs(gx, ref, 2);
+    threshold(ref, ref, 60, 255, THRESH_BINARY);
+
+    Ptr<ImagePipeline> edges = createImagePipeline();
+    edges->addCvtColor(COLOR_BGR2GRAY);
+    edges->addGaussianBlur(Size(5, 5), 1.5);
+    edges->addSobel(CV_16S, 1, 0, 3, 1, 0, BORDER_REFLECT);
+    edges->addConvertScaleAbs(2);
+    edges->addThreshold(60, 255, THRESH_BINARY);
+
+    // several filters in a row, multi-channel floating-point images and the constant border
+    Mat kx = (Mat_<float>(1, 7) << 0.1f, -0.2f, 0.3f, 0.5f, 0.3f, -0.2f, 0.1f);
+    Mat ky = (Mat_<float>(1, 3) << 0.25f, 0.5f, 0.25f);
+    Mat f, s1, s2, ref2;
+    src.convertTo(f, CV_32F, 1./255);
+    sepFilter2D(f, s1, -1, kx, ky, Point(2, 0), 0.5, BORDER_CONSTANT);
+    GaussianBlur(s1, s2, Size(0, 0), 3, 2, BORDER_REPLICATE);
+    Sobel(s2, s1, CV_32F, 1, 1, 5, 0.5, 0, BORDER_REFLECT_101);
+    threshold(s1, ref2, 0.01, 1, THRESH_TOZERO);
+
+    Ptr<ImagePipeline> filters = createImagePipeline();
+    filters->addConvertTo(CV_32F, 1./255);
+    filters->addSepFilter2D(-1, kx, ky, Point(2, 0), 0.5, BORDER_CONSTANT);
+    filters->addGaussianBlur(Size(0, 0), 3, 2, BORDER_REPLICATE);
+    filters->addSobel(CV_32F, 1, 1, 5, 0.5, 0, BORDER_REFLECT_101);
+    filters->addThreshold(0.01, 1, THRESH_TOZERO);
+
+    for (int threads = 1; threads <= 4; threads += 3)
+    {
+        setNumThreads(threads);
+
+        Mat dst;
+        edges->apply(src, dst);
+        EXPECT_EQ(CV_8UC1, dst.type());
+        EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF)) << "threads " << threads;
+
+        // a few rows only
+        Mat small = src.rowRange(0, 3).clone(), smallRef;
+        edges->apply(small, dst);
+        cvtColor(small, gray, COLOR_BGR2GRAY);
+        GaussianBlur(gray, blurred, Size(5, 5), 1.5);
+        Sobel(blurred, gx, CV_16S, 1, 0, 3, 1, 0, BORDER_REFLECT);
+        convertScaleAbs(gx, smallRef, 2);
+        threshold(smallRef, smallRef, 60, 255, THRESH_BINARY);
+        EXPECT_EQ(0, cvtest::norm(smallRef, dst, NORM_INF)) << "threads " << threads;
+
+        filters->apply(src, dst);
+        EXPECT_EQ(CV_32FC3, dst.type());
+        EXPECT_LE(cvtest::norm(ref2, dst, NORM_INF), 1e-5) << "threads " << threads;
+
+        // in place
+        Mat inplace = f.clone();
+        Ptr<ImagePipeline> blur = createImagePipeline();
+        blur->addGaussianBlur(Size(7, 7), 2);
+        blur->addConvertTo(-1, 2, 1);
+        blur->apply(inplace, inplace);
+        GaussianBlur(f, s1, Size(7, 7), 2);
+        s1.convertTo(s1, -1, 2, 1);
+        EXPECT_EQ(0, cvtest::norm(s1, inplace, NORM_INF)) << "threads " << threads;
+    }
+    setNumThreads(prevThreads);
+
+    Ptr<ImagePipeline> p = createImagePipeline();
+    EXPECT_TRUE(p->empty());
+    EXPECT_THROW(p->addCvtColor(COLOR_BayerBG2BGR), cv::Exception);
+    EXPECT_THROW(p->addThreshold(0, 255, THRESH_BINARY | THRESH_OTSU), cv::Exception);
+    p->addCvtColor(COLOR_YUV2BGR_NV12);
+    Mat dst, nv12(30, 20, CV_8UC1, Scalar::all(0));
+    EXPECT_THROW(p->apply(nv12, dst), cv::Exception);
+    p->clear();
+    EXPECT_TRUE(p->empty());
+}
+
+TEST(Imgproc_Pipeline, scalar_arithm)
+{
+    Mat src(301, 207, CV_8UC3);
+    randu(src, 0, 256);
+    Scalar value(10, -20, 30);
+
+    Mat gray, blurred, sum, prod, ref;
+    cvtColor(src, gray, COLOR_BGR2GRAY);
+    GaussianBlur(gray, blurred, Size(3, 3), 0);
+    add(blurred, Scalar::all(-40), sum, noArray(), CV_16S);
+    multiply(sum, Scalar::all(3), prod, 0.5);
+    absdiff(prod, Scalar::all(100), ref);
+
+    Ptr<ImagePipeline> p = createImagePipeline();
+    p->addCvtColor(COLOR_BGR2GRAY);
+    p->addGaussianBlur(Size(3, 3), 0);
+    p->addAdd(Scalar::all(-40), CV_16S);
+    p->addMultiply(Scalar::all(3), 0.5);
+    p->addAbsdiff(Scalar::all(100));
+
+    Mat dst;
+    p->apply(src, dst);
+    EXPECT_EQ(CV_16SC1, dst.type());
+    EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+
+    // multi-channel, the scalar is applied per channel
+    Mat ref3;
+    add(src, value, ref3);
+    Ptr<ImagePipeline> p3 = createImagePipeline();
+    p3->addAdd(value);
+    p3->apply(src, dst);
+    EXPECT_EQ(CV_8UC3, dst.type());
+    EXPECT_EQ(0, cvtest::norm(ref3, dst, NORM_INF));
+}
+
+TEST(Imgproc_GaussianBlur, recursive)
+{
+    int prevThreads = getNumThreads();
+    const int borders[] = { BORDER_REFLECT_101, BORDER_REPLICATE, BORDER_REFLECT, BORDER_CONSTANT };
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC4, CV_16SC1, CV_32FC1, CV_32FC3, CV_64FC1 };
+    const double sigmas[][2] = { { 4, 4 }, { 12, 7 }, { 40, 40 } };
+    RNG& rng = theRNG();
+
+    for (int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++)
+    {
+        int type = types[t], depth = CV_MAT_DEPTH(type);
+        double range = depth == CV_8U ? 255 : depth == CV_16U ? 65535 : depth == CV_16S ? 20000 : 1;
+
+        // a few flat areas over the noise, so both the edges and the borders matter
+        Mat src(203 + rng.uniform(0, 100), 257 + rng.uniform(0, 100), type);
+        randu(src, 0, range*0.2);
+        for (int i = 0; i < 20; i++)
+        {
+            Point p(rng.uniform(0, src.cols), rng.uniform(0, src.rows));
+            Size s(rng.uniform(5, src.cols/2), rng.uniform(5, src.rows/2));
+            rectangle(src, Rect(p, s), Scalar::all(rng.uniform(0., range*0.8)), FILLED);
+        }
+
+        for (int b = 0; b < (int)(sizeof(borders)/sizeof(borders[0])); b++)
+            for (int s = 0; s < (int)(sizeof(sigmas)/sizeof(sigmas[0])); s++)
+            {
+                double sx = sigmas[s][0], sy = sigmas[s][1];
+                Size ksize(cvRound(sx*8 + 1) | 1, cvRound(sy*8 + 1) | 1);
+                Mat f, ref, dst, dst4;
+                // the 8-bit fixed-point kernels of the explicit filter are too coarse for the large sigmas
+                src.convertTo(f, CV_32F);
+                GaussianBlur(f, ref, ksize, sx, sy, borders[b]);
+
+                setNumThreads(1);
+                recursiveGaussianBlur(src, dst, sx, sy, borders[b]);
+                setNumThreads(4);
+                recursiveGaussianBlur(src, dst4, sx, sy, borders[b]);
+                setNumThreads(prevThreads);
+
+                ASSERT_EQ(type, dst.type());
+                dst.convertTo(f, CV_32F);
+                EXPECT_LE(cvtest::norm(ref, f, NORM_INF), range*0.01)
+                    << "type " << type << " border " << borders[b] << " sigma " << sx << "x" << sy;
+                EXPECT_EQ(0, cvtest::norm(dst, dst4, NORM_INF));
+            }
+
+        // the kernel size is computed from sigma: the recursive filter is chosen automatically
+        Mat ref, dst = src.clone();
+        recursiveGaussianBlur(src, ref, 20);
+        GaussianBlur(dst, dst, Size(), 20);
+        EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF)) << "type " << type;
+    }
+
+    // the large sigmas, where the gain c[0] of the recursion is tiny
+    const double bigSigmas[] = { 80, 120 };
+    for (int t = 0; t < 2; t++)
+    {
+        int type = t == 0 ? CV_8UC1 : CV_32FC1;
+        double range = t == 0 ? 255 : 1;
+        Mat src(400, 500, type);
+        randu(src, 0, range*0.2);
+        for (int i = 0; i < 10; i++)
+        {
+            Point p(rng.uniform(0, src.cols), rng.uniform(0, src.rows));
+            Size s(rng.uniform(50, src.cols/2), rng.uniform(50, src.rows/2));
+            rectangle(src, Rect(p, s), Scalar::all(rng.uniform(0., range*0.8)), FILLED);
+        }
+        for (int s = 0; s < (int)(sizeof(bigSigmas)/sizeof(bigSigmas[0])); s++)
+        {
+            double sigma = bigSigmas[s];
+            int ksize = cvRound(sigma*8 + 1) | 1;
+            Mat f, ref, dst;
+            src.convertTo(f, CV_32F);
+            GaussianBlur(f, ref, Size(ksize, ksize), sigma, sigma, BORDER_REFLECT_101);
+            recursiveGaussianBlur(src, dst, sigma, sigma, BORDER_REFLECT_101);
+            dst.convertTo(f, CV_32F);
+            EXPECT_LE(cvtest::norm(ref, f, NORM_INF), range*0.01) << "type " << type << " sigma " << sigma;
+        }
+    }
+
+    // a constant image stays the same, i.e. the gain of the filter is exactly 1
+    const double constSigmas[] = { 10, 40, 80, 120, 200 };
+    for (int s = 0; s < (int)(sizeof(constSigmas)/sizeof(constSigmas[0])); s++)
+        for (int b = 0; b < 3; b++)
+        {
+            Mat src(300, 200, CV_32FC1, Scalar::all(0.5)), src8u(300, 200, CV_8UC3, Scalar::all(200)), dst;
+            recursiveGaussianBlur(src, dst, constSigmas[s], 0, borders[b]);
+            EXPECT_LE(cvtest::norm(dst, src, NORM_INF), 1e-5) << "sigma " << constSigmas[s] << " border " << borders[b];
+            recursiveGaussianBlur(src8u, dst, constSigmas[s], 0, borders[b]);
+            EXPECT_EQ(0, cvtest::norm(dst, src8u, NORM_INF)) << "sigma " << constSigmas[s] << " border " << borders[b];
+        }
+
+    // ... but not for a ROI which takes the border pixels from the parent image
+    Mat big(300, 400, CV_8UC1), ref, dst;
+    randu(big, 0, 256);
+    Mat roi = big(Rect(30, 40, 300, 200));
+    Mat kernel = getGaussianKernel(cvRound(20*6 + 1) | 1, 20, CV_32F);
+    sepFilter2D(roi, ref, -1, kernel, kernel);
+    GaussianBlur(roi, dst, Size(), 20);
+    EXPECT_EQ(0, cvtest::norm(ref, dst, NORM_INF));
+}
+
+// the 32f row and column kernels dispatched at run time (see filter.simd.hpp) must agree with
+// the plain C++ code, which is used when the optimizations are turned off
+TEST(Imgproc_Filtering, sepFilter2D_dispatch)
+{
+    RNG& rng = theRNG();
+    bool prevUseOptimized = useOptimized();
+
+    for (int cn = 1; cn <= 3; cn += 2)
+        for (int ksize = 7; ksize <= 15; ksize += 8)
+            for (int asymm = 0; asymm < 2; asymm++)
+            {
+                // the widths are not multiples of any vector width, so the tails are covered too
+                Mat src(37, 123, CV_32FC(cn)), kx(ksize, 1, CV_32F), ky(ksize, 1, CV_32F);
+                randu(src, -100, 100);
+                for (int i = 0; i <= ksize/2; i++)
+                {
+                    kx.at<float>(i) = kx.at<float>(ksize - 1 - i) = (float)rng.uniform(0.1, 1.);
+                    ky.at<float>(i) = (float)rng.uniform(0.1, 1.);
+                    ky.at<float>(ksize - 1 - i) = asymm ? -ky.at<float>(i) : ky.at<float>(i);
+                }
+                if (asymm)
+                    ky.at<float>(ksize/2) = 0.f;
+
+                Mat dst[2];
+                for (int k = 0; k < 2; k++)
+                {
+                    setUseOptimized(k == 1);
+                    sepFilter2D(src, dst[k], CV_32F, kx, ky, Point(-1, -1), 3, BORDER_REFLECT_101);
+                }
+                setUseOptimized(prevUseOptimized);
+
+                EXPECT_LE(cvtest::norm(dst[0], dst[1], NORM_INF | NORM_RELATIVE), 1e-5)
+                    << "cn=" << cn << " ksize=" << ksize << " asymm=" << asymm;
+            }
+}
@@ -442,6 +442,9 @@ private:
     unsigned int runsPerIteration;
     unsigned int perfValidationStage;
 
+    // the number of threads to restore after the test, -2 if declare.tbb_threads() was not called
+    int prevNumThreads;
+
     performance_metrics metrics;
     void validateMetrics();
 
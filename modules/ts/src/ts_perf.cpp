@@ -47,6 +47,7 @@ static bool         param_collect_impl;
 #endif
 #ifdef ENABLE_INSTRUMENTATION
 static int          param_instrument;
+static std::string  param_instrument_timeline;
 #endif
 
 namespace cvtest {
@@ -987,6 +988,7 @@ void TestBase::Init(const std::vector<std::string> & availableImpls,
 #endif
 #ifdef ENABLE_INSTRUMENTATION
         "{   perf_instrument             |0        |instrument code to collect implementations trace: 1 - perform instrumentation; 2 - separate functions with the same name }"
+        "{   perf_instrument_timeline    |         |write the timeline of every test to <prefix><test name>.json in Chrome trace format }"
 #endif
         "{   help h                      |false    |print help info}"
 #ifdef HAVE_CUDA
@@ -1041,6 +1043,7 @@ void TestBase::Init(const std::vector<std::string> & availableImpls,
 #endif
 #ifdef ENABLE_INSTRUMENTATION
     param_instrument    = args.get<int>("perf_instrument");
+    param_instrument_timeline = args.get<std::string>("perf_instrument_timeline");
 #endif
 #ifdef ANDROID
     param_affinity_mask   = args.get<int>("perf_affinity_mask");
@@ -1073,7 +1076,9 @@ void TestBase::Init(const std::vector<std::string> & availableImpls,
         cv::setUseCollection(0);
 #endif
 #ifdef ENABLE_INSTRUMENTATION
-    if(param_instrument > 0)
+    if(!param_instrument_timeline.empty())
+        cv::instr::setFlags(cv::instr::getFlags()|cv::instr::FLAGS_TIMELINE);
+    if(param_instrument > 0 || !param_instrument_timeline.empty())
     {
         if(param_instrument == 2)
             cv::instr::setFlags(cv::instr::getFlags()|cv::instr::FLAGS_EXPAND_SAME_NAMES);
@@ -1227,6 +1232,7 @@ TestBase::TestBase(): testStrategy(PERF_STRATEGY_DEFAULT), declare(this)
     lastTime = totalTime = timeLimit = 0;
     nIters = currentIter = runsPerIteration = 0;
     minIters = param_min_samples;
+    prevNumThreads = -2;
     verified = false;
     perfValidationStage = 0;
 }
@@ -1712,6 +1718,14 @@ void TestBase::reportMetrics(bool toJUnitXML)
             RecordProperty("functions_hierarchy", tree.c_str());
             RecordProperty("total_ipp_weight",    cv::format("%.1f", ((double)getImplTime(cv::instr::IMPL_IPP)*100/(double)getTotalTime())));
             RecordProperty("total_opencl_weight", cv::format("%.1f", ((double)getImplTime(cv::instr::IMPL_OPENCL)*100/(double)getTotalTime())));
+            if(!param_instrument_timeline.empty())
+            {
+                const ::testing::TestInfo* const test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+                std::string name = cv::format("%s%s.%s", param_instrument_timeline.c_str(), test_info->test_case_name(), test_info->name());
+                std::replace(name.begin() + param_instrument_timeline.size(), name.end(), '/', '_');
+                if(!cv::instr::dumpTimeline(name + ".json"))
+                    printf("[ WARN     ] Can't write the timeline to %s.json\n", name.c_str());
+            }
             cv::instr::resetTrace();
         }
 #endif
@@ -1838,6 +1852,9 @@ void TestBase::SetUp()
 
 void TestBase::TearDown()
 {
+    if (prevNumThreads != -2)
+        cv::setNumThreads(prevNumThreads);
+
     if (metrics.terminationReason == performance_metrics::TERM_SKIP_TEST)
     {
         LOGI("\tTest was skipped");
@@ -2013,6 +2030,9 @@ TestBase::_declareHelper& TestBase::_declareHelper::time(double timeLimitSecs)
 
 TestBase::_declareHelper& TestBase::_declareHelper::tbb_threads(int n)
 {
+    // TearDown() restores the previous value
+    if (test->prevNumThreads == -2)
+        test->prevNumThreads = cv::getNumThreads();
     cv::setNumThreads(n);
     return *this;
 }